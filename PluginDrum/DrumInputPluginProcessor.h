@@ -55,6 +55,12 @@ protected:
     {
         return 32;
     }
+    bool captureNote(DrumMidiEvent const& event, int& note, int& velocity) const override
+    {
+        note = event.note;
+        velocity = event.velocity;
+        return true;
+    }
 
 private:
     void calculateCustomValues(DrumMusician& m, IPCSongInfo::IPCMusician* musi) override final;
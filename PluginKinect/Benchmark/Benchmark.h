@@ -0,0 +1,67 @@
+/**
+* @file Benchmark.h
+* @author FH-Minden Musikinformatik 2015, KinectPlugin (Tine, Philipp, Isabell)
+* @brief Times a piece of code for the benchmarks of the Kinect plugin
+*/
+
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace ttmm
+{
+namespace benchmark
+{
+
+static const int RUNS = 5; ///<each measurement is repeated this often, the fastest run counts
+
+/**
+	* Time a piece of code
+	*
+	* @param iterations how often the code is run per measurement
+	* @param code called with the number of the iteration
+	* @return the time of one iteration in nanoseconds, of the fastest run
+	*/
+template <class Code>
+double measure(int iterations, Code code)
+{
+    double best = 0;
+    for (int run = 0; run < RUNS; ++run)
+    {
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < iterations; ++i)
+        {
+            code(i);
+        }
+        double elapsed = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+        best = run == 0 ? elapsed : std::min(best, elapsed);
+    }
+    return best / iterations;
+}
+
+/**
+	* Keep the compiler from removing a result nobody reads
+	*
+	* The value is handed to an empty assembly block, which the compiler has to assume reads it and
+	* touches all memory. MSVC has no inline assembly on x64, there the value is stored to a volatile
+	* and a compiler barrier follows.
+	*/
+inline void keep(float value)
+{
+#if defined(_MSC_VER)
+    static volatile float sink;
+    sink = value;
+    _ReadWriteBarrier();
+#else
+    asm volatile("" : : "r,m"(value) : "memory");
+#endif
+}
+
+}
+}
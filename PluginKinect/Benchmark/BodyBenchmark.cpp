@@ -0,0 +1,87 @@
+/***********************************************************************
+* Module:  BodyBenchmark.cpp
+* Purpose: Time the joints of a frame in a Body against a map of joints
+***********************************************************************/
+
+#include <algorithm>
+#include <map>
+#include <vector>
+
+#include "Benchmark.h"
+#include "Body.h"
+
+namespace
+{
+// the joints set by the KinectDevice and read by the musician and the display
+const JointType SUPPORTED[] = {JointType_HandLeft,  JointType_HandRight, JointType_SpineShoulder,
+                               JointType_SpineBase, JointType_KneeLeft,  JointType_KneeRight,
+                               JointType_FootLeft,  JointType_FootRight, JointType_Head,
+                               JointType_ElbowLeft, JointType_ElbowRight};
+const int SUPPORTED_COUNT = sizeof(SUPPORTED) / sizeof(SUPPORTED[0]);
+
+// the Body before the flat arrays: a map of joints, and a vector of the supported joints searched per joint
+class MapBody
+{
+  public:
+    MapBody() : supportedTypes(std::begin(SUPPORTED), std::end(SUPPORTED))
+    {
+        for (JointType type : supportedTypes)
+        {
+            joints[type] = D2D1::Point2F(0, 0);
+        }
+    }
+    void setJoint(float x, float y, JointType type)
+    {
+        auto joint = joints.find(type);
+        if (joint != joints.end())
+        {
+            joint->second = D2D1::Point2F(x, y);
+        }
+    }
+    D2D1_POINT_2F getJointPosition(JointType type) { return joints.find(type)->second; }
+    bool isSupported(JointType type)
+    {
+        return std::find(supportedTypes.begin(), supportedTypes.end(), type) != supportedTypes.end();
+    }
+
+  private:
+    std::map<JointType, D2D1_POINT_2F> joints;
+    std::vector<JointType> supportedTypes;
+};
+
+// one frame: the device sets the supported joints out of all of them, the musician and the display read them
+template <class B>
+float frame(B &body, int number)
+{
+    for (int j = 0; j < JointType_Count; ++j)
+    {
+        JointType type = static_cast<JointType>(j);
+        if (body.isSupported(type))
+        {
+            body.setJoint(number * 0.001f + j, j * 2.0f, type);
+        }
+    }
+    float sum = 0;
+    for (JointType type : SUPPORTED)
+    {
+        sum += body.getJointPosition(type).y;
+    }
+    return sum;
+}
+}
+
+int main()
+{
+    const int FRAMES = 1000000;
+
+    MapBody mapBody;
+    double map = ttmm::benchmark::measure(FRAMES, [&](int i) { ttmm::benchmark::keep(frame(mapBody, i)); });
+
+    ttmm::Body body;
+    double arrays = ttmm::benchmark::measure(FRAMES, [&](int i) { ttmm::benchmark::keep(frame(body, i)); });
+
+    std::printf("Body, set %d of %d joints and read them, per frame:\n", SUPPORTED_COUNT, JointType_Count);
+    std::printf("  map of joints  %8.1f ns\n", map);
+    std::printf("  flat arrays    %8.1f ns\n", arrays);
+    return 0;
+}
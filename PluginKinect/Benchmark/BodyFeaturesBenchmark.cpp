@@ -0,0 +1,118 @@
+/***********************************************************************
+* Module:  BodyFeaturesBenchmark.cpp
+* Purpose: Time the features of all bodies of a frame in one batch against the features computed per body
+***********************************************************************/
+
+#include <cmath>
+#include <cstdio>
+
+#include "Benchmark.h"
+#include "BodyFeatures.h"
+
+namespace
+{
+const int MAX_BODIES = 6; // bodies the Kinect tracks
+
+// the features of one body, as PoseClassifier and GestureRecognizer computed them for their musician before
+int bodyFeatures(ttmm::Body const &body, float (&features)[ttmm::BodyFeatures::FEATURES])
+{
+    float const *x = body.getX();
+    float const *y = body.getY();
+    float dx = x[JointType_SpineBase] - x[JointType_SpineShoulder];
+    float dy = y[JointType_SpineBase] - y[JointType_SpineShoulder];
+    float torso = std::sqrt(dx * dx + dy * dy);
+    if (torso < 1.0f)
+    {
+        return 0;
+    }
+    features[0] = (x[JointType_HandLeft] - x[JointType_SpineShoulder]) / torso;
+    features[1] = (y[JointType_HandLeft] - y[JointType_SpineShoulder]) / torso;
+    features[2] = (x[JointType_HandRight] - x[JointType_SpineShoulder]) / torso;
+    features[3] = (y[JointType_HandRight] - y[JointType_SpineShoulder]) / torso;
+    features[4] = (y[JointType_FootLeft] - y[JointType_SpineBase]) / torso;
+    features[5] = (y[JointType_FootRight] - y[JointType_SpineBase]) / torso;
+    features[6] = (x[JointType_ElbowRight] - x[JointType_ElbowLeft]) / torso;
+    features[7] = (x[JointType_Head] - x[JointType_SpineBase]) / torso;
+    return 1;
+}
+
+// a dancer standing at a place of its own, its arms moving with the frame
+void pose(ttmm::Body &body, int dancer, int frame)
+{
+    float left = 100.0f * dancer;
+    float swing = static_cast<float>(frame % 50);
+    body.setJoint(left + 50, 100, JointType_Head);
+    body.setJoint(left + 50, 150, JointType_SpineShoulder);
+    body.setJoint(left + 50, 300, JointType_SpineBase);
+    body.setJoint(left + 10, 200, JointType_ElbowLeft);
+    body.setJoint(left + 90, 200, JointType_ElbowRight);
+    body.setJoint(left, 100 + swing, JointType_HandLeft);
+    body.setJoint(left + 100, 250 - swing, JointType_HandRight);
+    body.setJoint(left + 30, 450, JointType_FootLeft);
+    body.setJoint(left + 70, 450 - swing / 5, JointType_FootRight);
+}
+}
+
+int main()
+{
+    const int FRAMES = 1000000;
+
+    ttmm::Body bodies[MAX_BODIES];
+    std::printf("BodyFeatures, the features of the arms and of the gestures of all bodies, per frame,\n"
+                "with the time to set the joints of the new frame:\n");
+    std::printf("  bodies     joints   per body  one batch\n");
+    ttmm::BodyFeatures batch;
+    for (int count = 1; count <= MAX_BODIES; ++count)
+    {
+        // every frame moves the dancers, so no feature can be computed once for all frames
+        double joints = ttmm::benchmark::measure(FRAMES, [&](int i) {
+            for (int b = 0; b < count; ++b)
+            {
+                pose(bodies[b], b, i);
+            }
+            ttmm::benchmark::keep(bodies[i % count].getY()[JointType_HandLeft]);
+        });
+
+        // the features per body, once for the PoseClassifier and once for the GestureRecognizer
+        double perBody = ttmm::benchmark::measure(FRAMES, [&](int i) {
+            float sum = 0;
+            for (int b = 0; b < count; ++b)
+            {
+                pose(bodies[b], b, i);
+                float features[ttmm::BodyFeatures::FEATURES];
+                for (int pass = 0; pass < 2; ++pass)
+                {
+                    if (bodyFeatures(bodies[b], features) > 0)
+                    {
+                        sum += features[i % ttmm::BodyFeatures::FEATURES];
+                    }
+                }
+            }
+            ttmm::benchmark::keep(sum);
+        });
+
+        // the device gathers the bodies into one batch, each musician reads its column twice
+        double batched = ttmm::benchmark::measure(FRAMES, [&](int i) {
+            batch.clear();
+            for (int b = 0; b < count; ++b)
+            {
+                pose(bodies[b], b, i);
+                batch.gather(b, bodies[b]);
+            }
+            batch.compute();
+            float sum = 0;
+            for (int b = 0; b < count; ++b)
+            {
+                float arms[ttmm::PoseClassifier::FEATURES];
+                float gesture[ttmm::GestureRecognizer::FEATURES];
+                if (batch.getArmFeatures(b, arms) > 0 && batch.getGestureFeatures(b, gesture))
+                {
+                    sum += arms[i % ttmm::PoseClassifier::FEATURES] + gesture[i % ttmm::GestureRecognizer::FEATURES];
+                }
+            }
+            ttmm::benchmark::keep(sum);
+        });
+        std::printf("  %6d %8.1f ns %8.1f ns %8.1f ns\n", count, joints, perBody, batched);
+    }
+    return 0;
+}
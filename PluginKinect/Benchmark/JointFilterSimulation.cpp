@@ -0,0 +1,118 @@
+/***********************************************************************
+* Module:  JointFilterSimulation.cpp
+* Purpose: Count the pose changes of a jittering hand near a tolerance, raw and through the JointFilter
+***********************************************************************/
+
+#include <cmath>
+#include <cstdio>
+#include <random>
+
+#include "JointFilter.h"
+
+namespace
+{
+const double FRAME_RATE = 30.0;  // frames of the Kinect per second
+const double NOISE = 2.0;        // standard deviation of the position of the hand in pixels
+const float LINE = 200.0f;       // the hand is above or below this height, the tolerance between two poses
+const double REST = 5.0;         // pixels from the line where the hand rests between two changes
+const double MOVE = 0.1;         // seconds the hand takes to cross the line
+const int CHANGES = 300;         // changes of the pose the hand makes
+
+// the filtered hand may change its pose at most this much more often than the hand and detect a change at most
+// this many seconds later than the raw hand
+const double MAX_EXTRA_CHANGES = 0.2;
+const double MAX_DELAY = 0.02;
+
+int failures = 0;
+
+void check(bool condition, char const *what)
+{
+    if (!condition)
+    {
+        std::printf("FAILED: %s\n", what);
+        ++failures;
+    }
+}
+
+ttmm::Timestamp at(double seconds)
+{
+    return ttmm::Timestamp(std::chrono::duration_cast<ttmm::Duration>(std::chrono::duration<double>(seconds)));
+}
+
+// the pose of the hand, it changes with every crossing of the line
+struct Classification
+{
+    bool below = false;   // the hand is below the line
+    int changes = 0;      // changes of the pose
+    bool waiting = false; // the pose has not followed the current true change yet
+    double delay = 0.0;   // seconds from the true changes to the first frame with the new pose, summed
+    int detected = 0;     // true changes the pose followed
+
+    void update(float y, double time, bool trueBelow, double trueChange)
+    {
+        if ((y > LINE) != below)
+        {
+            below = !below;
+            changes++;
+        }
+        if (waiting && time >= trueChange && below == trueBelow)
+        {
+            delay += time - trueChange;
+            detected++;
+            waiting = false;
+        }
+    }
+};
+}
+
+int main()
+{
+    std::mt19937 random(2015);
+    std::normal_distribution<double> noise(0.0, NOISE);
+    std::uniform_real_distribution<double> hold(0.5, 1.5);
+
+    ttmm::Body raw;
+    ttmm::Body filtered;
+    ttmm::JointFilter filter;
+    Classification rawPose, filteredPose;
+
+    double period = 1.0 / FRAME_RATE;
+    double time = std::uniform_real_distribution<double>(0.0, period)(random);
+    unsigned long long frame = 1;
+    double from = LINE - REST;   // the hand starts above the line
+    for (int change = 0; change < CHANGES; ++change)
+    {
+        // the hand crosses the line at a steady speed and rests on the other side
+        double moveStart = time;
+        double crossing = moveStart + MOVE / 2;
+        double end = moveStart + MOVE + hold(random);
+        double to = 2 * LINE - from;
+        rawPose.waiting = filteredPose.waiting = true;
+        for (; time < end; time += period, ++frame)
+        {
+            double progress = std::min(std::max((time - moveStart) / MOVE, 0.0), 1.0);
+            double y = from + (to - from) * progress + noise(random);
+            raw.setJoint(0.0f, static_cast<float>(y), JointType_HandLeft);
+            raw.setFrame(frame, at(time));
+            filter.apply(raw, filtered);
+            rawPose.update(raw.getJointPosition(JointType_HandLeft).y, time, to > LINE, crossing);
+            filteredPose.update(filtered.getJointPosition(JointType_HandLeft).y, time, to > LINE, crossing);
+        }
+        from = to;
+    }
+
+    double rawDelay = rawPose.delay / std::max(rawPose.detected, 1);
+    double filteredDelay = filteredPose.delay / std::max(filteredPose.detected, 1);
+    std::printf("%d changes of a hand resting %.0f px from the line with %.1f px of noise at %.0f Hz:\n", CHANGES, REST,
+                NOISE, FRAME_RATE);
+    std::printf("  raw hand:      %4d changes of the pose, new pose %5.1f ms after the crossing\n",
+                rawPose.changes, rawDelay * 1000);
+    std::printf("  filtered hand: %4d changes of the pose, new pose %5.1f ms after the crossing\n",
+                filteredPose.changes, filteredDelay * 1000);
+    check(rawPose.changes > CHANGES, "the raw hand flickers around the line");
+    check(filteredPose.changes < rawPose.changes, "the filter damps the flicker");
+    check(filteredPose.changes <= CHANGES * (1 + MAX_EXTRA_CHANGES), "the filtered hand hardly flickers");
+    check(filteredPose.detected >= CHANGES, "the filtered hand follows every change");
+    check(filteredDelay - rawDelay <= MAX_DELAY, "the filter detects the changes in time");
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,49 @@
+/***********************************************************************
+* Module:  JointProjectionBenchmark.cpp
+* Purpose: Time the projection of the joints of a frame
+***********************************************************************/
+
+#include <vector>
+
+#include "Benchmark.h"
+#include "JointProjection.h"
+
+namespace
+{
+const int BODIES = 6;                       // bodies the sensor tracks at most
+const int SUPPORTED_JOINTS = 11;            // joints of a body the KinectDevice projects
+const int ALL_JOINTS = 25;                  // joints of a body the sensor reports
+
+// times the projection of a batch of points, spread over the field of view between 1 and 4.5 meters
+double timeBatch(ttmm::JointProjection const &projection, int count)
+{
+    int padded = (count + ttmm::JointProjection::LANES - 1) / ttmm::JointProjection::LANES *
+                 ttmm::JointProjection::LANES;
+    std::vector<float> x(padded), y(padded), z(padded), screenX(padded), screenY(padded);
+    for (int i = 0; i < padded; ++i)
+    {
+        z[i] = 1.0f + 3.5f * i / padded;
+        x[i] = (i % 7 - 3) * 0.2f * z[i];
+        y[i] = (i % 5 - 2) * 0.2f * z[i];
+    }
+    return ttmm::benchmark::measure(1000000, [&](int) {
+        projection.project(x.data(), y.data(), z.data(), screenX.data(), screenY.data(), count);
+        ttmm::benchmark::keep(screenX[0] + screenY[count - 1]);
+    });
+}
+}
+
+int main()
+{
+    ttmm::JointProjection projection;
+    projection.setIntrinsics(365.456f, 365.456f, 254.878f, 205.395f, 0.0905474f, -0.26819f, 0.0950862f,
+                             768.0f / 512.0f, 689.0f / 424.0f);
+
+    // the supported joints and the floor of each body, and all joints and the floor of each body
+    int frame = BODIES * (SUPPORTED_JOINTS + 1);
+    int full = BODIES * (ALL_JOINTS + 1);
+    std::printf("JointProjection, one batch per frame:\n");
+    std::printf("  %3d points  %8.1f ns\n", frame, timeBatch(projection, frame));
+    std::printf("  %3d points  %8.1f ns\n", full, timeBatch(projection, full));
+    return 0;
+}
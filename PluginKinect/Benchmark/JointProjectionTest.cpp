@@ -0,0 +1,143 @@
+/***********************************************************************
+* Module:  JointProjectionTest.cpp
+* Purpose: Compare JointProjection with a projection point by point, as the coordinate mapper does it
+***********************************************************************/
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "JointProjection.h"
+
+namespace
+{
+// intrinsics of a depth camera of the Kinect v2, the screen of the KinectDevice
+const double FOCAL_X = 365.456;
+const double FOCAL_Y = 365.456;
+const double PRINCIPAL_X = 254.878;
+const double PRINCIPAL_Y = 205.395;
+const double K2 = 0.0905474;
+const double K4 = -0.26819;
+const double K6 = 0.0950862;
+const double SCALE_X = 768.0 / 512.0;
+const double SCALE_Y = 689.0 / 424.0;
+
+const double MAX_ERROR = 0.001; // largest difference to the reference in pixels of the screen
+
+struct Point
+{
+    double x;
+    double y;
+    double z;
+};
+
+// the reference: one point at a time in double, distorted and mapped to the depth image, then scaled
+void referenceProject(Point const &p, double &screenX, double &screenY)
+{
+    double nx = p.x / p.z;
+    double ny = p.y / p.z;
+    double r2 = nx * nx + ny * ny;
+    double factor = 1.0 + K2 * r2 + K4 * r2 * r2 + K6 * r2 * r2 * r2;
+    double depthX = FOCAL_X * nx * factor + PRINCIPAL_X;
+    double depthY = PRINCIPAL_Y - FOCAL_Y * ny * factor;
+    screenX = depthX * SCALE_X;
+    screenY = depthY * SCALE_Y;
+}
+
+// reads one joint per line, x y z in meters, lines starting with # are skipped
+bool readJoints(std::string const &filename, std::vector<Point> &joints)
+{
+    std::ifstream in(filename);
+    std::string line;
+    while (std::getline(in, line))
+    {
+        if (line.empty() || line[0] == '#')
+        {
+            continue;
+        }
+        std::istringstream fields(line);
+        Point p;
+        if (fields >> p.x >> p.y >> p.z)
+        {
+            joints.push_back(p);
+        }
+    }
+    return !joints.empty();
+}
+
+int failures = 0;
+
+void check(bool condition, char const *what)
+{
+    if (!condition)
+    {
+        std::printf("FAILED: %s\n", what);
+        ++failures;
+    }
+}
+
+// projects the first count joints in one batch and returns the largest difference to the reference
+double largestError(ttmm::JointProjection const &projection, std::vector<Point> const &joints, int count)
+{
+    int padded = (count + ttmm::JointProjection::LANES - 1) / ttmm::JointProjection::LANES *
+                 ttmm::JointProjection::LANES;
+    // the padding has a depth of 1, the screen arrays hold a guard behind it
+    std::vector<float> x(padded, 0.0f), y(padded, 0.0f), z(padded, 1.0f);
+    std::vector<float> screenX(padded + 1, -1.0f), screenY(padded + 1, -1.0f);
+    for (int i = 0; i < count; ++i)
+    {
+        x[i] = static_cast<float>(joints[i].x);
+        y[i] = static_cast<float>(joints[i].y);
+        z[i] = static_cast<float>(joints[i].z);
+    }
+    projection.project(x.data(), y.data(), z.data(), screenX.data(), screenY.data(), count);
+    check(screenX[padded] == -1.0f && screenY[padded] == -1.0f, "nothing is written behind the padding");
+
+    double largest = 0;
+    for (int i = 0; i < count; ++i)
+    {
+        double expectedX, expectedY;
+        referenceProject(joints[i], expectedX, expectedY);
+        largest = std::max(largest, std::fabs(screenX[i] - expectedX));
+        largest = std::max(largest, std::fabs(screenY[i] - expectedY));
+    }
+    return largest;
+}
+}
+
+int main(int argc, char **argv)
+{
+    std::vector<Point> joints;
+    if (argc < 2 || !readJoints(argv[1], joints))
+    {
+        std::printf("usage: JointProjectionTest <joints file>\n");
+        return 2;
+    }
+
+    ttmm::JointProjection projection;
+    check(!projection.isValid(), "a new projection has no intrinsics");
+    check(!projection.setIntrinsics(0, 0, 0, 0, 0, 0, 0, 1, 1), "focal lengths of 0 are refused");
+    check(!projection.isValid(), "refused intrinsics are not used");
+    check(projection.setIntrinsics(static_cast<float>(FOCAL_X), static_cast<float>(FOCAL_Y),
+                                   static_cast<float>(PRINCIPAL_X), static_cast<float>(PRINCIPAL_Y),
+                                   static_cast<float>(K2), static_cast<float>(K4), static_cast<float>(K6),
+                                   static_cast<float>(SCALE_X), static_cast<float>(SCALE_Y)),
+          "the intrinsics of the depth camera are taken");
+    check(projection.isValid(), "the projection is valid after setIntrinsics");
+
+    // all joints in one batch, and batches that end within a block of LANES
+    int count = static_cast<int>(joints.size());
+    double largest = largestError(projection, joints, count);
+    for (int partial = 1; partial <= ttmm::JointProjection::LANES; ++partial)
+    {
+        largest = std::max(largest, largestError(projection, joints, partial));
+    }
+    std::printf("%d joints, largest difference to the reference %.6f px\n", count, largest);
+    check(largest <= MAX_ERROR, "the joints are within MAX_ERROR of the reference");
+
+    return failures == 0 ? 0 : 1;
+}
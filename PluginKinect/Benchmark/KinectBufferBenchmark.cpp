@@ -0,0 +1,176 @@
+/***********************************************************************
+* Module:  KinectBufferBenchmark.cpp
+* Purpose: Check the stomp and arm pose tracked by KinectBuffer::push against the former search and time both
+***********************************************************************/
+
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include "Types.h"
+#include "Benchmark.h"
+#include "KinectBuffer.h"
+
+namespace
+{
+const int EVENTS = 20000; // random events pushed for the check
+
+int failures = 0;
+
+void check(bool condition, char const *what)
+{
+    if (!condition)
+    {
+        std::printf("FAILED: %s\n", what);
+        ++failures;
+    }
+}
+
+bool lifted(ttmm::PoseType type)
+{
+    return ttmm::bothFeetUp(type) || ttmm::rightFootUp(type) || ttmm::leftFootUp(type);
+}
+
+// the former KinectBuffer::getLatestEvent: a reversed copy of all events and a nested search
+ttmm::PoseEvent const *formerLatestEvent(ttmm::KinectBuffer const &buffer, std::vector<ttmm::PoseEvent> &data)
+{
+    if (!buffer.isEmpty())
+    {
+        buffer.getReverseCopyOfAll(data);
+        for (size_t i = 0; i < data.size(); ++i)
+        {
+            if (data[i].bodyPart == ttmm::BodyPart::FOOTS && ttmm::bothFeetDown(data[i].type))
+            {
+                for (size_t j = i + 1; j < data.size(); ++j)
+                {
+                    if (lifted(data[j].type))
+                    {
+                        return &data[i];
+                    }
+                }
+            }
+        }
+    }
+    return nullptr;
+}
+
+// the former KinectBuffer::getLatestHandDirection: a reversed copy of all events and a search for the arms
+ttmm::PoseType formerHandDirection(ttmm::KinectBuffer const &buffer, std::vector<ttmm::PoseEvent> &data)
+{
+    if (!buffer.isEmpty())
+    {
+        buffer.getReverseCopyOfAll(data);
+        for (size_t i = 0; i < data.size(); ++i)
+        {
+            if (data[i].bodyPart == ttmm::BodyPart::ARMS)
+            {
+                return data[i].type;
+            }
+        }
+    }
+    return (ttmm::PoseType::BOTTOM_LEFT | ttmm::PoseType::BOTTOM_RIGHT);
+}
+
+// the former search without the copy, only foot events count as a lifted foot like in the tracking
+ttmm::PoseEvent const *expectedLatestEvent(ttmm::KinectBuffer const &buffer)
+{
+    for (size_t i = 0; i < buffer.currentSize(); ++i)
+    {
+        ttmm::PoseEvent const &event = buffer.getEvent(i);
+        if (event.bodyPart == ttmm::BodyPart::FOOTS && ttmm::bothFeetDown(event.type))
+        {
+            for (size_t j = i + 1; j < buffer.currentSize(); ++j)
+            {
+                if (buffer.getEvent(j).bodyPart == ttmm::BodyPart::FOOTS && lifted(buffer.getEvent(j).type))
+                {
+                    return &event;
+                }
+            }
+        }
+    }
+    return nullptr;
+}
+
+// a foot or an arm pose, each foot up or down and each arm at the top, middle or bottom
+ttmm::PoseEvent randomEvent(std::mt19937 &random)
+{
+    static const ttmm::PoseType LEFT[] = { ttmm::PoseType::TOP_LEFT, ttmm::PoseType::MIDDLE_LEFT,
+                                           ttmm::PoseType::BOTTOM_LEFT };
+    static const ttmm::PoseType RIGHT[] = { ttmm::PoseType::TOP_RIGHT, ttmm::PoseType::MIDDLE_RIGHT,
+                                            ttmm::PoseType::BOTTOM_RIGHT };
+    std::uniform_int_distribution<int> part(0, 2);
+    std::uniform_int_distribution<int> foot(0, 199);
+    if (part(random) == 0)
+    {
+        return ttmm::PoseEvent(LEFT[part(random)] | RIGHT[part(random)], ttmm::BodyPart::ARMS, 0);
+    }
+    // mostly both feet down, a foot is lifted so rarely that the buffer is now and then without a stomp
+    int feet = foot(random);
+    return ttmm::PoseEvent(LEFT[(feet == 0 || feet == 2) ? 0 : 2] | RIGHT[(feet == 1 || feet == 2) ? 0 : 2],
+                           ttmm::BodyPart::FOOTS, 0);
+}
+
+void checkTracking()
+{
+    std::mt19937 random(2015);
+    ttmm::KinectBuffer buffer;
+    std::vector<ttmm::PoseEvent> data;
+    int mismatches = 0, stomps = 0;
+    for (int i = 0; i < EVENTS; ++i)
+    {
+        buffer.push(randomEvent(random));
+        ttmm::PoseEvent const *expected = expectedLatestEvent(buffer);
+        mismatches += (buffer.getLatestEvent() != expected) ? 1 : 0;
+        mismatches += (buffer.getLatestHandDirection() != formerHandDirection(buffer, data)) ? 1 : 0;
+        stomps += (expected != nullptr) ? 1 : 0;
+    }
+    std::printf("%d random events, %d with a stomp in the buffer: %d mismatches\n", EVENTS, stomps, mismatches);
+    check(stomps > 0 && stomps < EVENTS, "the events have stomps in the buffer and without");
+    check(mismatches == 0, "the tracked stomp and arm pose are those of the former search");
+}
+
+void time(char const *name, ttmm::KinectBuffer const &buffer)
+{
+    std::vector<ttmm::PoseEvent> data;
+    double formerEvent = ttmm::benchmark::measure(10000, [&](int) {
+        ttmm::PoseEvent const *event = formerLatestEvent(buffer, data);
+        ttmm::benchmark::keep(event != nullptr ? 1.0f : 0.0f);
+    });
+    double formerArms = ttmm::benchmark::measure(10000, [&](int) {
+        ttmm::benchmark::keep(static_cast<float>(formerHandDirection(buffer, data)));
+    });
+    double trackedEvent = ttmm::benchmark::measure(1000000, [&](int) {
+        ttmm::PoseEvent const *event = buffer.getLatestEvent();
+        ttmm::benchmark::keep(event != nullptr ? 1.0f : 0.0f);
+    });
+    double trackedArms = ttmm::benchmark::measure(1000000, [&](int) {
+        ttmm::benchmark::keep(static_cast<float>(buffer.getLatestHandDirection()));
+    });
+    std::printf("  %-34s %10.1f ns %10.1f ns %10.1f ns %10.1f ns\n", name, formerEvent, trackedEvent, formerArms,
+                trackedArms);
+}
+}
+
+int main()
+{
+    checkTracking();
+
+    std::printf("One query on a full buffer of %d events:\n", static_cast<int>(ttmm::BufferSize));
+    std::printf("  %-34s %13s %13s %13s %13s\n", "", "stomp before", "stomp now", "arms before", "arms now");
+    ttmm::KinectBuffer arms;
+    ttmm::KinectBuffer alternating;
+    for (size_t i = 0; i < ttmm::BufferSize; ++i)
+    {
+        arms.push(ttmm::PoseEvent(ttmm::PoseType::TOP_LEFT | ttmm::PoseType::TOP_RIGHT, ttmm::BodyPart::ARMS, 0));
+        // both feet down and the arms at the bottom, no foot was lifted: every stomp is searched to the end
+        alternating.push(((i % 2) == 0)
+                             ? ttmm::PoseEvent(ttmm::PoseType::BOTTOM_LEFT | ttmm::PoseType::BOTTOM_RIGHT,
+                                               ttmm::BodyPart::FOOTS, 0)
+                             : ttmm::PoseEvent(ttmm::PoseType::BOTTOM_LEFT | ttmm::PoseType::BOTTOM_RIGHT,
+                                               ttmm::BodyPart::ARMS, 0));
+    }
+    time("arm poses", arms);
+    time("feet down and arm poses alternating", alternating);
+
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,66 @@
+/***********************************************************************
+* Module:  PoseClassifierBenchmark.cpp
+* Purpose: Time the classification of the arms with growing tables of templates
+***********************************************************************/
+
+#include <algorithm>
+#include <cstdlib>
+#include <vector>
+
+#include "Benchmark.h"
+#include "PoseClassifier.h"
+
+namespace
+{
+const int FRAMES = 4096; // frames of features, classified one after the other
+
+// a feature between -1 and 1, from a fixed sequence so every run classifies the same frames
+float randomFeature()
+{
+    return static_cast<float>(std::rand()) / RAND_MAX * 2.0f - 1.0f;
+}
+
+// times one frame with the given number of templates, the nine default ones or random ones
+double timeClassify(int templates)
+{
+    std::srand(1);
+    ttmm::PoseClassifier classifier;
+    if (templates != 9)
+    {
+        classifier.clear();
+        for (int t = 0; t < templates; ++t)
+        {
+            float const features[ttmm::PoseClassifier::FEATURES] = {randomFeature(), randomFeature(),
+                                                                     randomFeature(), randomFeature()};
+            classifier.addTemplate(ttmm::PoseType::TOP_LEFT, features, 0.1f);
+        }
+    }
+
+    std::vector<float> frames(FRAMES * ttmm::PoseClassifier::FEATURES);
+    for (float &feature : frames)
+    {
+        feature = randomFeature();
+    }
+
+    std::vector<float> distances;
+    int current = -1;
+    int iterations = std::max(1000, 20000000 / templates);
+    return ttmm::benchmark::measure(iterations, [&](int i) {
+        float const *frame = &frames[(i % FRAMES) * ttmm::PoseClassifier::FEATURES];
+        float const features[ttmm::PoseClassifier::FEATURES] = {frame[0], frame[1], frame[2], frame[3]};
+        current = classifier.classify(features, current, 0.05f, distances);
+        ttmm::benchmark::keep(static_cast<float>(current));
+    });
+}
+}
+
+int main()
+{
+    std::printf("PoseClassifier, one frame:\n");
+    for (int templates : {9, 64, 1024, 16384})
+    {
+        double time = timeClassify(templates);
+        std::printf("  %5d templates  %10.1f ns\n", templates, time);
+    }
+    return 0;
+}
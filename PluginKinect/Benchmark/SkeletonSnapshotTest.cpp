@@ -0,0 +1,104 @@
+/***********************************************************************
+* Module:  SkeletonSnapshotTest.cpp
+* Purpose: Publish frames to a SkeletonSnapshot from one thread while another spins on it, and check that
+*          every frame taken is whole and newer than the one before
+***********************************************************************/
+
+#include <atomic>
+#include <cstdio>
+#include <thread>
+
+#include "SkeletonSnapshot.h"
+
+namespace
+{
+const unsigned long long FRAMES = 3000000; // frames published
+
+int failures = 0;
+
+void check(bool condition, char const *what)
+{
+    if (!condition)
+    {
+        std::printf("FAILED: %s\n", what);
+        ++failures;
+    }
+}
+
+// every value of a frame is derived from its number, so a frame mixed from two is noticed
+float mark(unsigned long long frameNumber, int skeleton)
+{
+    return static_cast<float>((frameNumber & 0xFFFFF) * 8 + skeleton);
+}
+
+int count(unsigned long long frameNumber)
+{
+    return static_cast<int>(frameNumber % (ttmm::SkeletonSnapshot::MAX_SKELETONS + 1));
+}
+}
+
+int main()
+{
+    ttmm::SkeletonSnapshot snapshot;
+    std::atomic<bool> done(false);
+
+    // the device thread: fill the back buffer completely, then publish it
+    std::thread writer([&]() {
+        for (unsigned long long number = 1; number <= FRAMES; ++number)
+        {
+            ttmm::SkeletonSnapshot::Frame &frame = snapshot.back();
+            frame.frameNumber = number;
+            frame.count = count(number);
+            for (int s = 0; s < frame.count; ++s)
+            {
+                ttmm::SkeletonSnapshot::Skeleton &skeleton = frame.skeletons[s];
+                for (int j = 0; j < JointType_Count; ++j)
+                {
+                    skeleton.x[j] = mark(number, s);
+                    skeleton.y[j] = -mark(number, s);
+                }
+                skeleton.floor = D2D1::Point2F(mark(number, s), 0.0f);
+            }
+            snapshot.publish();
+        }
+        done.store(true);
+    });
+
+    // the display: spin on the snapshot and check every frame it takes
+    unsigned long long taken = 0, last = 0;
+    int torn = 0, outOfOrder = 0;
+    bool finished = false;
+    while (!finished)
+    {
+        finished = done.load();
+        if (!snapshot.update())
+        {
+            continue;
+        }
+        ttmm::SkeletonSnapshot::Frame const &frame = snapshot.front();
+        taken++;
+        outOfOrder += (frame.frameNumber <= last) ? 1 : 0;
+        last = frame.frameNumber;
+        bool whole = frame.count == count(frame.frameNumber);
+        for (int s = 0; s < frame.count && whole; ++s)
+        {
+            ttmm::SkeletonSnapshot::Skeleton const &skeleton = frame.skeletons[s];
+            float expected = mark(frame.frameNumber, s);
+            for (int j = 0; j < JointType_Count; ++j)
+            {
+                whole = whole && skeleton.x[j] == expected && skeleton.y[j] == -expected;
+            }
+            whole = whole && skeleton.floor.x == expected;
+        }
+        torn += whole ? 0 : 1;
+    }
+    writer.join();
+
+    std::printf("%llu frames published, %llu taken: %d torn, %d out of order, the last taken was %llu\n", FRAMES,
+                taken, torn, outOfOrder, last);
+    check(taken > 0, "the display takes frames");
+    check(torn == 0, "every frame taken is whole");
+    check(outOfOrder == 0, "every frame taken is newer than the one before");
+    check(last == FRAMES, "the display takes the last frame published");
+    return failures == 0 ? 0 : 1;
+}
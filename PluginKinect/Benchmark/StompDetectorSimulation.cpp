@@ -0,0 +1,170 @@
+/***********************************************************************
+* Module:  StompDetectorSimulation.cpp
+* Purpose: Feed the StompDetector with the noisy frames of a stomping foot and compare its moment of contact
+*          with the time of the frame in which the foot is classified as on the ground
+***********************************************************************/
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include "StompDetector.h"
+
+namespace
+{
+const double FRAME_RATE = 30.0;      // frames of the Kinect per second
+const double NOISE = 1.5;            // standard deviation of the height of the foot in pixels
+const float GROUND = 400.0f;         // height of the floor in pixels, downwards
+const int TOLERANCE = 30;            // distance to the floor where a foot is still on the ground, as in KinectMusician
+const double LANDING = 0.015;        // seconds the foot takes to stop once it touches the floor
+const int STOMPS = 2000;             // stomps simulated
+
+// largest mean error of the detected contact in seconds and largest share of stomps missed, the noise within the
+// tolerance looks like a deceleration now and then, so the contact is found a frame early
+const double MAX_ERROR = 0.025;
+const double MAX_MISSED = 0.02;
+
+int failures = 0;
+
+void check(bool condition, char const *what)
+{
+    if (!condition)
+    {
+        std::printf("FAILED: %s\n", what);
+        ++failures;
+    }
+}
+
+ttmm::Timestamp at(double seconds)
+{
+    return ttmm::Timestamp(std::chrono::duration_cast<ttmm::Duration>(std::chrono::duration<double>(seconds)));
+}
+
+double seconds(ttmm::Timestamp time)
+{
+    return std::chrono::duration<double>(time.time_since_epoch()).count();
+}
+
+// one stomp: the foot rests, rises, falls at a steady speed, lands and rests again
+struct Stomp
+{
+    double start;    // the foot starts to rise
+    double rise;     // seconds until it is up
+    double lift;     // pixels above the floor
+    double hold;     // seconds it stays up
+    double speed;    // speed of the fall in pixels per second
+    double contact;  // the foot comes to rest on the floor
+
+    double fallStart() const { return start + rise + hold; }
+
+    // the height above the floor at a moment
+    double height(double time) const
+    {
+        if (time < start || time >= contact)
+        {
+            return 0.0;
+        }
+        if (time < start + rise)
+        {
+            return lift * (time - start) / rise;
+        }
+        if (time < fallStart())
+        {
+            return lift;
+        }
+        // the speed drops linearly to zero during the landing
+        double landed = contact - time;
+        if (landed < LANDING)
+        {
+            return speed * landed * landed / (2 * LANDING);
+        }
+        return speed * (landed - LANDING / 2);
+    }
+};
+}
+
+int main()
+{
+    std::mt19937 random(2015);
+    std::normal_distribution<double> noise(0.0, NOISE);
+    std::uniform_real_distribution<double> lift(50.0, 120.0);
+    std::uniform_real_distribution<double> speed(300.0, 900.0);
+    std::uniform_real_distribution<double> pause(0.4, 0.8);
+
+    std::vector<Stomp> stomps;
+    double time = 0.5;
+    for (int i = 0; i < STOMPS; ++i)
+    {
+        Stomp stomp;
+        stomp.start = time;
+        stomp.rise = 0.2;
+        stomp.lift = lift(random);
+        stomp.hold = 0.1;
+        stomp.speed = speed(random);
+        stomp.contact = stomp.fallStart() + stomp.lift / stomp.speed + LANDING / 2;
+        stomps.push_back(stomp);
+        time = stomp.contact + pause(random);
+    }
+
+    // the frames start at a random phase to the stomps
+    ttmm::StompDetector detector;
+    double period = 1.0 / FRAME_RATE;
+    size_t next = 0;             // the stomp the foot makes next
+    bool classified = false;     // the foot was on the ground in the previous frame
+    bool detected = false;       // the detector fired for the current stomp
+    double frameError = 0.0, contactError = 0.0, contactBias = 0.0;
+    int frames = 0, contacts = 0, falseContacts = 0;
+    for (double frame = std::uniform_real_distribution<double>(0.0, period)(random); frame < time; frame += period)
+    {
+        while (next < stomps.size() && frame >= stomps[next].contact + 0.2)
+        {
+            next++;
+            detected = false;
+        }
+        Stomp const *stomp = (next < stomps.size()) ? &stomps[next] : nullptr;
+        double height = (stomp != nullptr) ? stomp->height(frame) : 0.0;
+        float y = static_cast<float>(GROUND - height + noise(random));
+
+        // before: the pose of the foot was classified in the frame where it is within the tolerance
+        bool down = y >= GROUND - TOLERANCE;
+        if (down && !classified && stomp != nullptr && frame > stomp->fallStart())
+        {
+            frameError += std::fabs(frame - stomp->contact);
+            frames++;
+        }
+        classified = down;
+
+        if (detector.update(at(frame), y, GROUND, TOLERANCE))
+        {
+            if (stomp != nullptr && !detected && frame > stomp->fallStart())
+            {
+                double error = seconds(detector.getContact()) - stomp->contact;
+                contactError += std::fabs(error);
+                contactBias += error;
+                contacts++;
+                detected = true;
+            }
+            else
+            {
+                falseContacts++;
+            }
+        }
+    }
+
+    double missed = 1.0 - double(contacts) / STOMPS;
+    frameError /= std::max(frames, 1);
+    contactError /= std::max(contacts, 1);
+    contactBias /= std::max(contacts, 1);
+    std::printf("%d stomps at %.0f Hz with %.1f px of noise, falls of 50-120 px at 300-900 px/s, %.0f ms landing:\n",
+                STOMPS, FRAME_RATE, NOISE, LANDING * 1000);
+    std::printf("  frame of the classified pose:    mean error %5.1f ms\n", frameError * 1000);
+    std::printf("  moment of contact, interpolated: mean error %5.1f ms (%+.1f ms), %.1f%% missed, %d false\n",
+                contactError * 1000, contactBias * 1000, missed * 100, falseContacts);
+    check(contactError <= MAX_ERROR, "the interpolated contact is close to the moment the foot lands");
+    check(contactError < frameError / 2, "the interpolated contact is closer than the frame of the classified pose");
+    check(missed <= MAX_MISSED, "the detector finds the stomps");
+    check(falseContacts == 0, "the detector does not fire while the foot rests");
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,189 @@
+/***********************************************************************
+* Module:  TempoFollowerSimulation.cpp
+* Purpose: Feed the TempoFollower with the jittered beats of a simulated musician and check how fast it follows
+***********************************************************************/
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include "TempoFollower.h"
+
+namespace
+{
+const double METRONOME_BPM = 120.0;
+const double CHANGED_BPM = 100.0;     // the musician changes to this tempo
+const double CHANGE_TIME = 30.0;      // seconds until the change
+const double END_TIME = 90.0;         // seconds simulated
+const double MEASURED = 30.0;         // the estimate is measured over the last seconds
+const double PHASE_MEASURED = 10.0;   // the phase is measured over the last seconds before the change
+const double LATE = 0.03;             // the musician plays this many seconds after the beat
+const double TOLERANCE = 2.0;         // the estimate follows the change once it is this close, in bpm
+
+const int RUNS = 200;                 // runs per scenario, each with its own jitter
+
+struct Scenario
+{
+    double jitter;                    // standard deviation of the events around the beat in seconds
+    double strays;                    // probability of an event between two beats
+    double minFollowed;               // share of the runs which have to end within TOLERANCE of the tempo
+    int maxLag;                       // median of the events after the change until the estimate is within TOLERANCE
+    double maxDeviation;              // largest median standard deviation of the estimate over the last MEASURED seconds
+};
+
+// with stray events the estimate may end at a faster tempo, so not every run follows the change
+const Scenario SCENARIOS[] = {
+    { 0.02, 0.0, 0.98, 10, 1.0 },
+    { 0.04, 0.1, 0.80, 15, 1.5 },
+    { 0.06, 0.2, 0.45, 25, 2.5 },
+};
+
+// the outcome of one run
+struct Run
+{
+    int lag;                          // events after the change until the estimate is within TOLERANCE, -1 if never
+    double mean;                      // mean of the estimate over the last MEASURED seconds
+    double deviation;                 // standard deviation of the estimate over the last MEASURED seconds
+    double phase;                     // mean phase over the last PHASE_MEASURED seconds before the change
+};
+
+int failures = 0;
+
+void check(bool condition, char const *what)
+{
+    if (!condition)
+    {
+        std::printf("FAILED: %s\n", what);
+        ++failures;
+    }
+}
+
+// the events of the musician: a beat at the tempo of the metronome, then at CHANGED_BPM, and some strays
+std::vector<double> playMusician(Scenario const &scenario, std::mt19937 &random)
+{
+    std::normal_distribution<double> jitter(0.0, scenario.jitter);
+    std::uniform_real_distribution<double> uniform(0.0, 1.0);
+    std::vector<double> events;
+    double beat = 0.0;
+    while (beat < END_TIME)
+    {
+        double period = 60.0 / (beat < CHANGE_TIME ? METRONOME_BPM : CHANGED_BPM);
+        events.push_back(beat + LATE + jitter(random));
+        if (uniform(random) < scenario.strays)
+        {
+            events.push_back(beat + LATE + period * uniform(random));
+        }
+        beat += period;
+    }
+    std::sort(events.begin(), events.end());
+    return events;
+}
+
+Run play(Scenario const &scenario, std::mt19937 &random)
+{
+    std::vector<double> events = playMusician(scenario, random);
+
+    ttmm::TempoFollower follower;
+    double metronomePeriod = 60.0 / METRONOME_BPM;
+    double click = 0.0;
+    Run run = { -1, 0.0, 0.0, 0.0 };
+    int eventsAfterChange = 0;
+    int phases = 0;
+    double sum = 0.0, sumOfSquares = 0.0;
+    int measured = 0;
+    for (double time : events)
+    {
+        // the clicks of the metronome up to the event
+        for (; click <= time; click += metronomePeriod)
+        {
+            follower.addBeat(click, METRONOME_BPM);
+        }
+        follower.addHit(time);
+        if (time < CHANGE_TIME)
+        {
+            if (time >= CHANGE_TIME - PHASE_MEASURED && follower.hasEstimate())
+            {
+                run.phase += follower.getPhase();
+                phases++;
+            }
+            continue;
+        }
+        eventsAfterChange++;
+        double tempo = follower.getTempo();
+        if (run.lag < 0 && follower.hasEstimate() && std::fabs(tempo - CHANGED_BPM) < TOLERANCE)
+        {
+            run.lag = eventsAfterChange;
+        }
+        if (time >= END_TIME - MEASURED)
+        {
+            sum += tempo;
+            sumOfSquares += tempo * tempo;
+            measured++;
+        }
+    }
+    run.mean = sum / measured;
+    run.deviation = std::sqrt(std::max(sumOfSquares / measured - run.mean * run.mean, 0.0));
+    run.phase = (phases > 0) ? run.phase / phases : 0.0;
+    return run;
+}
+
+template <class T>
+T median(std::vector<T> values)
+{
+    std::nth_element(values.begin(), values.begin() + values.size() / 2, values.end());
+    return values[values.size() / 2];
+}
+
+void simulate(Scenario const &scenario, unsigned seed)
+{
+    std::mt19937 random(seed);
+    std::vector<int> lags;
+    std::vector<double> deviations, phases;
+    int followed = 0;
+    int faster = 0;
+    for (int i = 0; i < RUNS; i++)
+    {
+        Run run = play(scenario, random);
+        phases.push_back(run.phase);
+        if (std::fabs(run.mean - CHANGED_BPM) < TOLERANCE)
+        {
+            followed++;
+            lags.push_back(run.lag);
+            deviations.push_back(run.deviation);
+        }
+        else if (run.mean > CHANGED_BPM)
+        {
+            // stray events between the beats were taken for beats, mostly the estimate ends near twice the tempo
+            faster++;
+        }
+    }
+    double share = double(followed) / RUNS;
+    int lag = lags.empty() ? -1 : median(lags);
+    double deviation = deviations.empty() ? 0.0 : median(deviations);
+    double phase = median(phases);
+    std::printf("jitter %2.0f ms, %2.0f%% strays: %5.1f%% followed (%4.1f%% too fast), "
+                "lag %2d events, +- %.2f bpm, phase %.3f beats\n",
+                scenario.jitter * 1000, scenario.strays * 100, share * 100, 100.0 * faster / RUNS, lag, deviation,
+                phase);
+    check(share >= scenario.minFollowed, "the estimate ends at the tempo of the musician");
+    check(lag > 0 && lag <= scenario.maxLag, "the estimate follows the change of the tempo in time");
+    check(deviation <= scenario.maxDeviation, "the estimate stays steady");
+    check(std::fabs(phase - LATE * METRONOME_BPM / 60.0) < 0.03, "the phase is the lateness of the musician");
+}
+}
+
+int main()
+{
+    std::printf("%d runs per scenario, the musician changes from %.0f to %.0f bpm after %.0f s.\n"
+                "Medians over the runs which end within %.0f bpm: lag until the estimate is within %.0f bpm, "
+                "deviation of the estimate over the last %.0f s.\n",
+                RUNS, METRONOME_BPM, CHANGED_BPM, CHANGE_TIME, TOLERANCE, TOLERANCE, MEASURED);
+    unsigned seed = 2015;
+    for (Scenario const &scenario : SCENARIOS)
+    {
+        simulate(scenario, seed++);
+    }
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,19 @@
+/**
+* @file Types.h
+* @brief The clock of TTMM/Source/Types.h without JUCE, which the benchmarks do not build
+*/
+
+#ifndef TYPES_H
+#define TYPES_H
+
+#include <chrono>
+
+namespace ttmm {
+
+using Clock = std::chrono::high_resolution_clock;
+using Timestamp = Clock::time_point;
+using Duration = Clock::duration;
+
+}
+
+#endif
@@ -0,0 +1,21 @@
+/**
+* @file d2d1.h
+* @brief The point of Direct2D the benchmarks need, so they build without the Windows SDK
+*/
+
+#pragma once
+
+struct D2D1_POINT_2F
+{
+    float x;
+    float y;
+};
+
+namespace D2D1
+{
+inline D2D1_POINT_2F Point2F(float x = 0.0f, float y = 0.0f)
+{
+    D2D1_POINT_2F point = {x, y};
+    return point;
+}
+}
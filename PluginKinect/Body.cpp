@@ -7,52 +7,42 @@
 #include "Body.h"
 #include <algorithm>
 
-// constructor for Body, creates bodyData with empty joint-positions
+static_assert(JointType_Count <= ttmm::Body::JOINT_STRIDE, "A JointType has no place in the coordinate arrays");
+
+// constructor for Body, all joint positions are 0
 ttmm::Body::Body()
 {
-
-    for (JointType const &t : supportedTypes)
-    {
-        bodyData[t] = D2D1_POINT_2F();
-    }
+    std::fill(x, x + JOINT_STRIDE, 0.0f);
+    std::fill(y, y + JOINT_STRIDE, 0.0f);
+    std::fill(z, z + JOINT_STRIDE, 0.0f);
 }
 
-// destructor for Body, cleans up joint map
-ttmm::Body::~Body() { bodyData.clear(); }
+ttmm::Body::~Body() {}
 
-// find map entry for type, set position to new position
+// set the position of a joint
 void ttmm::Body::setJoint(float x, float y, JointType type)
 {
-    D2D1_POINT_2F position = D2D1::Point2F(x, y);
-    bodyData.find(type)->second = position;
+    this->x[type] = x;
+    this->y[type] = y;
 }
 
-// find map entry for type & return it
-D2D1_POINT_2F ttmm::Body::getJointPosition(JointType type)
+// set the position and depth of a joint
+void ttmm::Body::setJoint(float x, float y, float z, JointType type)
 {
-    D2D1_POINT_2F position = bodyData.find(type)->second;
-    return position;
-}
-
-// checks if a given joint type is supported by KinectMusician
-bool ttmm::Body::isSupported(JointType t)
-{
-    if (std::find(supportedTypes.begin(), supportedTypes.end(), t) !=
-        supportedTypes.end())
-        return true;
-    else
-        return false;
+    this->x[type] = x;
+    this->y[type] = y;
+    this->z[type] = z;
 }
 
 // writes all joints (type & position) to logfile
 void ttmm::Body::printDebugInfo()
 {
-    std::map<JointType, D2D1_POINT_2F>::iterator p;
-
-    for (p = bodyData.begin(); p != bodyData.end(); ++p)
+    for (int type = 0; type < JointType_Count; ++type)
     {
-        JointType type = p->first;
-        D2D1_POINT_2F position = p->second;
+        if (!isSupported(static_cast<JointType>(type)))
+        {
+            continue;
+        }
         bool noType = false;
 
         switch (type)
@@ -79,7 +69,7 @@ void ttmm::Body::printDebugInfo()
 
         if (!noType)
         {
-            ttmm::logfileKinect->write("JointPosition: " + std::to_string(position.x) + "," + std::to_string(position.y));
+            ttmm::logfileKinect->write("JointPosition: " + std::to_string(x[type]) + "," + std::to_string(y[type]));
         }
     }
-}
\ No newline at end of file
+}
@@ -1,28 +1,20 @@
 /**
 * @file Body.h
 * @author FH-Minden Musikinformatik 2015, group Kinect (Tine, Isabell)
-* @brief Defines Body-Data for KinectMusician. Contains map of JointTypes with
-*positions
+* @brief Defines Body-Data for KinectMusician. Contains the positions of the
+*joints, indexed by JointType
 *
 */
 
 #pragma once
 
-#include <map>
-#include <vector>
+#include <cstdint>
 
 #include "FileWriter.h"
+#include "Types.h"
 #include "d2d1.h"
 #include "Kinect.h"
 
-/**
-* Static vector with supported JointTypes for creating KinectMusician bodies.
-*/
-static const std::vector<JointType> supportedTypes{
-    JointType_HandLeft, JointType_HandRight, JointType_SpineShoulder, JointType_SpineBase, 
-	JointType_KneeLeft, JointType_KneeRight, JointType_FootLeft, JointType_FootRight, JointType_Head, 
-	JointType_ElbowLeft, JointType_ElbowRight };
-
 namespace ttmm
 {
 
@@ -30,13 +22,30 @@ namespace ttmm
 * @class Body
 * @brief Defines Body-Data for KinectMusician.
 *
+* The positions are stored as one array per coordinate, indexed by JointType
+* (structure of arrays), so a joint is found without a search and a feature
+* can be computed for all joints in one loop the compiler vectorizes.
+* Only the joints in @code SUPPORTED_JOINTS are written by the KinectDevice,
+* the others stay 0.
+*
 * @see KinectMusician
 */
 class Body
 {
   public:
+    static const int JOINT_STRIDE = 28; ///<length of a coordinate array, JointType_Count rounded up to 4 floats
+
+    /**
+  * Bitmask of the JointTypes used by KinectMusician bodies, bit i stands for JointType i
+  */
+    static const uint32_t SUPPORTED_JOINTS =
+        (1u << JointType_HandLeft) | (1u << JointType_HandRight) | (1u << JointType_SpineShoulder) |
+        (1u << JointType_SpineBase) | (1u << JointType_KneeLeft) | (1u << JointType_KneeRight) |
+        (1u << JointType_FootLeft) | (1u << JointType_FootRight) | (1u << JointType_Head) |
+        (1u << JointType_ElbowLeft) | (1u << JointType_ElbowRight);
+
     /**
-  * Constructor: Create a Body
+  * Constructor: Create a Body, all joints are at 0
   */
     Body();
     /**
@@ -44,7 +53,7 @@ class Body
   */
     ~Body();
     /**
-  * Find map entry for type, set position to new position
+  * Set the position of a joint
   *
   * @param x X-Position of joint, a float value
   * @param y Y-Position of joint, a float value
@@ -52,12 +61,63 @@ class Body
   */
     void setJoint(float x, float y, JointType type);
     /**
-  * find map entry for type & return it
+  * Set the position of a joint including its depth
+  *
+  * @param x X-Position of joint, a float value
+  * @param y Y-Position of joint, a float value
+  * @param z distance of the joint from the sensor in meters
+  * @param type the JointType
+  */
+    void setJoint(float x, float y, float z, JointType type);
+    /**
+  * Return the position of a joint
   *
   * @param type the JointType
   * @return the position of the joint
   */
-    D2D1_POINT_2F getJointPosition(JointType type);
+    D2D1_POINT_2F getJointPosition(JointType type) const
+    {
+        return D2D1::Point2F(x[type], y[type]);
+    }
+    /**
+  * @return the X-Positions of all joints, indexed by JointType
+  */
+    float const *getX() const { return x; }
+    /**
+  * @return the Y-Positions of all joints, indexed by JointType
+  */
+    float const *getY() const { return y; }
+    /**
+  * @return the depths of all joints, indexed by JointType
+  */
+    float const *getZ() const { return z; }
+    /**
+  * @return the X-Positions of all joints for writing, indexed by JointType
+  */
+    float *getX() { return x; }
+    /**
+  * @return the Y-Positions of all joints for writing, indexed by JointType
+  */
+    float *getY() { return y; }
+    /**
+  * Set the frame the joints were taken from
+  *
+  * @param number the number of the frame, counted by the KinectDevice
+  * @param time the time the sensor took the frame
+  */
+    void setFrame(unsigned long long number, Timestamp time)
+    {
+        frameNumber = number;
+        frameTime = time;
+    }
+    /**
+  * @return the number of the frame the joints were taken from
+  */
+    unsigned long long getFrameNumber() const { return frameNumber; }
+    /**
+  * @return the time the sensor took the frame
+  */
+    Timestamp getFrameTime() const { return frameTime; }
     /**
   * Writes all joints of Body (JointType & position) to logfile
   */
@@ -68,10 +128,16 @@ class Body
   * @param type the JointType
   * @return a boolean value (true, if type is supported)
   */
-    static bool isSupported(JointType type);
+    static bool isSupported(JointType type)
+    {
+        return type >= 0 && type < JointType_Count && ((SUPPORTED_JOINTS >> type) & 1u) != 0;
+    }
 
   private:
-    std::map<JointType, D2D1_POINT_2F>
-        bodyData; ///<the map for joint types and positions
+    float x[JOINT_STRIDE]; ///<X-Positions of the joints
+    float y[JOINT_STRIDE]; ///<Y-Positions of the joints
+    float z[JOINT_STRIDE]; ///<depths of the joints
+    unsigned long long frameNumber = 0; ///<number of the frame the joints were taken from
+    Timestamp frameTime; ///<time the sensor took the frame
 };
-}
\ No newline at end of file
+}
@@ -0,0 +1,92 @@
+/***********************************************************************
+* Module:  ttmm::BodyFeatures.cpp
+* Purpose: Implementation of the class BodyFeatures
+***********************************************************************/
+
+#include "BodyFeatures.h"
+
+#include <algorithm>
+#include <cmath>
+
+static_assert(ttmm::PoseClassifier::FEATURES <= ttmm::BodyFeatures::FEATURES,
+              "the arm features are the first features of a body");
+
+namespace
+{
+// writes (joint - origin) * scale for all slots
+void relative(float const *__restrict joint, float const *__restrict origin, float const *__restrict scale,
+              float *__restrict out)
+{
+    for (int s = 0; s < ttmm::BodyFeatures::SLOTS; ++s)
+    {
+        out[s] = (joint[s] - origin[s]) * scale[s];
+    }
+}
+}
+
+void ttmm::BodyFeatures::clear()
+{
+    std::fill(&x[0][0], &x[0][0] + POINTS * SLOTS, 0.0f);
+    std::fill(&y[0][0], &y[0][0] + POINTS * SLOTS, 0.0f);
+    std::fill(torso, torso + SLOTS, 0.0f);
+}
+
+void ttmm::BodyFeatures::gather(int slot, Body const &body)
+{
+    static const JointType joints[POINTS] = {JointType_SpineShoulder, JointType_SpineBase, JointType_HandLeft,
+                                             JointType_HandRight,     JointType_ElbowLeft, JointType_ElbowRight,
+                                             JointType_FootLeft,      JointType_FootRight, JointType_Head};
+    for (int p = 0; p < POINTS; ++p)
+    {
+        x[p][slot] = body.getX()[joints[p]];
+        y[p][slot] = body.getY()[joints[p]];
+    }
+}
+
+void ttmm::BodyFeatures::compute()
+{
+    // 1 / max(torso, 1) without a branch, the empty slots get features that are never read
+    float scale[SLOTS];
+    for (int s = 0; s < SLOTS; ++s)
+    {
+        float dx = x[BASE][s] - x[SHOULDER][s];
+        float dy = y[BASE][s] - y[SHOULDER][s];
+        torso[s] = std::sqrt(dx * dx + dy * dy);
+        scale[s] = 2.0f / (torso[s] + 1.0f + std::fabs(torso[s] - 1.0f));
+    }
+
+    relative(x[HAND_LEFT], x[SHOULDER], scale, features[0]);
+    relative(y[HAND_LEFT], y[SHOULDER], scale, features[1]);
+    relative(x[HAND_RIGHT], x[SHOULDER], scale, features[2]);
+    relative(y[HAND_RIGHT], y[SHOULDER], scale, features[3]);
+    relative(y[FOOT_LEFT], y[BASE], scale, features[4]);
+    relative(y[FOOT_RIGHT], y[BASE], scale, features[5]);
+    relative(x[ELBOW_RIGHT], x[ELBOW_LEFT], scale, features[6]);
+    relative(x[HEAD], x[BASE], scale, features[7]);
+}
+
+float ttmm::BodyFeatures::getArmFeatures(int slot, float (&arms)[PoseClassifier::FEATURES]) const
+{
+    if (torso[slot] < 1.0f)
+    {
+        return 0;
+    }
+    for (int f = 0; f < PoseClassifier::FEATURES; ++f)
+    {
+        arms[f] = features[f][slot];
+    }
+    return torso[slot];
+}
+
+bool ttmm::BodyFeatures::getGestureFeatures(int slot, float (&gesture)[GestureRecognizer::FEATURES]) const
+{
+    if (torso[slot] < 1.0f)
+    {
+        return false;
+    }
+    for (int f = 0; f < GestureRecognizer::FEATURES; ++f)
+    {
+        gesture[f] = features[f][slot];
+    }
+    return true;
+}
@@ -0,0 +1,99 @@
+/**
+* @file BodyFeatures.h
+* @author FH-Minden Musikinformatik 2015, KinectPlugin (Tine, Philipp, Isabell)
+* @brief Computes the pose features of all bodies of a frame in one pass
+*/
+
+#pragma once
+
+#include "Body.h"
+#include "GestureRecognizer.h"
+#include "PoseClassifier.h"
+
+namespace ttmm
+{
+
+/**
+	* @class BodyFeatures
+	* @brief The features of the smoothed bodies of all musicians of a frame.
+	*
+	* The joints the features need are gathered from every body into one array per joint and
+	* coordinate with one value per slot (structure of arrays), the features are then computed
+	* for all slots at once in loops of fixed length the compiler vectorizes. So one dancer costs
+	* as much as six.
+	*
+	* All features are relative to the torso: the hands to the spine shoulder, the feet and the
+	* head to the spine base, divided by the length of the torso. The first PoseClassifier::FEATURES
+	* features are the hands, as PoseClassifier expects them, all of them are the features of the
+	* GestureRecognizer.
+	*
+	* @see KinectDevice, KinectMusician
+	*/
+class BodyFeatures
+{
+  public:
+    static const int SLOTS = 8;                              ///<bodies of a batch, KinectDevice::MAX_BODIES rounded up to 4
+    static const int FEATURES = GestureRecognizer::FEATURES; ///<features of a body
+
+    /**
+		* Constructor: Create a BodyFeatures without bodies
+		*/
+    BodyFeatures() { clear(); }
+
+    /**
+		* Remove all bodies, called before the bodies of a new frame are gathered
+		*/
+    void clear();
+
+    /**
+		* Copy the joints of a body to a slot
+		*
+		* @param slot the slot of the body, below SLOTS
+		* @param body the body
+		*/
+    void gather(int slot, Body const &body);
+
+    /**
+		* Compute the features of all slots
+		*/
+    void compute();
+
+    /**
+		* Get the features of the arms of a slot
+		*
+		* @param slot the slot
+		* @param[out] features receives the features
+		* @return the length of the torso in pixels, 0 if the slot has no torso and no features
+		*/
+    float getArmFeatures(int slot, float (&features)[PoseClassifier::FEATURES]) const;
+
+    /**
+		* Get the features of a slot for the gestures
+		*
+		* @param slot the slot
+		* @param[out] features receives the features
+		* @return false if the slot has no torso and no features
+		*/
+    bool getGestureFeatures(int slot, float (&features)[GestureRecognizer::FEATURES]) const;
+
+  private:
+    enum Point ///<the joints the features are computed from
+    {
+        SHOULDER,
+        BASE,
+        HAND_LEFT,
+        HAND_RIGHT,
+        ELBOW_LEFT,
+        ELBOW_RIGHT,
+        FOOT_LEFT,
+        FOOT_RIGHT,
+        HEAD,
+        POINTS
+    };
+
+    float x[POINTS][SLOTS];          ///<X-Positions of the joints, one value per slot
+    float y[POINTS][SLOTS];          ///<Y-Positions of the joints, one value per slot
+    float torso[SLOTS];              ///<length of the torso of each slot, below 1 for none
+    float features[FEATURES][SLOTS]; ///<the features, one value per slot
+};
+}
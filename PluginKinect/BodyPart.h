@@ -8,11 +8,13 @@
 namespace ttmm
 {
 /**
-	* Enum type for part of the body, including arms and foots
+	* Enum type for part of the body, including arms and foots.
+	* GESTURE marks a recognized movement of the whole body.
 	*/
 enum class BodyPart
 {
     ARMS,
-    FOOTS
+    FOOTS,
+    GESTURE
 };
 }
\ No newline at end of file
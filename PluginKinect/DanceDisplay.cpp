@@ -1,27 +1,30 @@
 #include "DanceDisplay.h"
 
-namespace ttmm 
+namespace ttmm
 {
 	/**
 	* Constructor for DanceDisplay
 	*/
 	DanceDisplay::DanceDisplay(KinectInputPluginProcessor& p) : Component(), proc(p)
 	{
+		startTimerHz(REFRESH_RATE);
 	}
 
 	void DanceDisplay::paint(Graphics& g)
 	{
-		if (proc.isConnected())
-		{
-			// set the font size and draw text to the screen
-			g.setColour(Colours::black);
-			g.fillRect(g.getClipBounds());
+		// clear the area to repaint
+		g.setColour(Colours::black);
+		g.fillRect(g.getClipBounds());
 
-			//  draw musicians
-			bool thereIsSomeone = drawMusicians(g);
+		if (connected)
+		{
+			//  draw musicians from the cached paths
+			g.setColour(Colours::lightgreen);
+			g.fillPath(bones);
+			g.fillPath(joints);
 
 			// draw floor (only if there are musicians)
-			if (thereIsSomeone)
+			if (hasFloor)
 			{
 				drawFloor(g);
 			}
@@ -29,104 +32,147 @@ namespace ttmm
 		else
 		{
 			// set the font size and draw text to the screen
-			g.setColour(Colours::black);
-			g.fillRect(g.getClipBounds());
 			g.setColour(Colours::white);
 			g.setFont(15.0f);
-			g.drawText("not connected", g.getClipBounds().getCentreX() - 50, g.getClipBounds().getCentreY() - 15, 100, 30, Justification::centred, true);
+			g.drawText("not connected", getLocalBounds().getCentreX() - 50, getLocalBounds().getCentreY() - 15, 100, 30, Justification::centred, true);
 		}
 	}
 
+	void DanceDisplay::resized()
+	{
+		// the paths are in canvas space, so they change with the size
+		buildPaths();
+		drawnArea = getDrawnArea();
+		repaint();
+	}
+
 	/**
-	* Function draws floor line and foot tolerance range to canvas
+	* Function takes the newest skeletons of the device and repaints the area they changed
 	*/
-	void DanceDisplay::drawFloor(Graphics& g)
+	void DanceDisplay::timerCallback()
 	{
-		// get position of floor and tolerance in CameraSpace coordinates
-		D2D1_POINT_2F floorPosition = proc.getFloorPosition();
-		D2D1_POINT_2F floorWithTolerance;
-		floorWithTolerance.x = floorPosition.x;
-		floorWithTolerance.y = floorPosition.y - proc.getParam(KinectInputPluginProcessor::ParameterType::FOOT_TOL);
+		bool open = proc.isConnected();
+		if (open != connected)
+		{
+			connected = open;
+			buildPaths();
+			drawnArea = getDrawnArea();
+			repaint();
+			return;
+		}
+		if (!connected || !proc.getSkeletons().update())
+		{
+			return;
+		}
 
-		// calculate y position (using canvas coordinates) of floor and tolerance range 
-		int yPos = transformToCanvasSpace(floorPosition, g.getClipBounds()).y;
-		int yPosTol = transformToCanvasSpace(floorWithTolerance, g.getClipBounds()).y;
+		juce::Path oldBones;
+		juce::Path oldJoints;
+		oldBones.swapWithPath(bones);
+		oldJoints.swapWithPath(joints);
+		bool hadFloor = hasFloor;
+		float oldFloorY = floorY;
+		float oldToleranceY = toleranceY;
+		buildPaths();
 
-		// draw floor line and tolerance range
-		g.setColour(Colours::aquamarine);
-		g.drawHorizontalLine(yPos, g.getClipBounds().getBottomLeft().getX(), g.getClipBounds().getBottomRight().getX());
-		g.setOpacity(0.3);
-		g.fillRect(juce::Rectangle<int>(g.getClipBounds().getBottomLeft().getX(), yPosTol,
-										g.getClipBounds().getWidth(), g.getClipBounds().getHeight() - yPosTol));
-		g.setOpacity(1.0);
+		// nothing moved, nothing to paint
+		if (bones == oldBones && joints == oldJoints && hasFloor == hadFloor && floorY == oldFloorY &&
+			toleranceY == oldToleranceY)
+		{
+			return;
+		}
+		juce::Rectangle<int> area = getDrawnArea();
+		repaint(drawnArea.getUnion(area));
+		drawnArea = area;
 	}
 
 	/**
-	* Function draws musicians to canvas, body joints will be displayed with circles,
-	* bones are displayed as lines
+	* Function builds the bones, joints and floor of the newest skeletons in canvas space,
+	* body joints will be displayed with circles, bones are displayed as lines
 	*/
-	bool DanceDisplay::drawMusicians(Graphics& g)
+	void DanceDisplay::buildPaths()
 	{
-		bool result = false;
+		bones.clear();
+		joints.clear();
+		hasFloor = false;
 
-		// paint all musicians joints to canvas
-		for (KinectMusician m : proc.getMusicians())
+		SkeletonSnapshot::Frame const& frame = proc.getSkeletons().front();
+		juce::Rectangle<int> canvas = getLocalBounds();
+		for (int i = 0; i < frame.count; i++)
 		{
-			Body* b = m.getBody();
-			if (b == nullptr)
+			SkeletonSnapshot::Skeleton const& s = frame.skeletons[i];
+			D2D1_POINT_2F p[JointType_Count];
+			for (int j = 0; j < JointType_Count; j++)
 			{
-				continue;
+				p[j] = transformToCanvasSpace(D2D1::Point2F(s.x[j], s.y[j]), canvas);
 			}
-			else
+
+			// bones from head to neck to hip, the legs from the hip and the arms from the neck
+			static const JointType boneList[][2] = {
+				{ JointType_Head, JointType_SpineShoulder }, { JointType_SpineShoulder, JointType_SpineBase },
+				{ JointType_SpineBase, JointType_KneeLeft }, { JointType_KneeLeft, JointType_FootLeft },
+				{ JointType_SpineBase, JointType_KneeRight }, { JointType_KneeRight, JointType_FootRight },
+				{ JointType_SpineShoulder, JointType_ElbowLeft }, { JointType_ElbowLeft, JointType_HandLeft },
+				{ JointType_SpineShoulder, JointType_ElbowRight }, { JointType_ElbowRight, JointType_HandRight } };
+			for (auto const& bone : boneList)
+			{
+				D2D1_POINT_2F from = p[bone[0]];
+				D2D1_POINT_2F to = p[bone[1]];
+				bones.addLineSegment(juce::Line<float>(from.x, from.y, to.x, to.y), 1.0f);
+			}
+
+			// head and other joints
+			static const JointType jointList[] = {
+				JointType_SpineShoulder, JointType_SpineBase, JointType_KneeLeft, JointType_KneeRight,
+				JointType_FootLeft, JointType_FootRight, JointType_HandLeft, JointType_HandRight,
+				JointType_ElbowLeft, JointType_ElbowRight };
+			D2D1_POINT_2F head = p[JointType_Head];
+			joints.addEllipse(head.x - (HEAD_SIZE / 2), head.y - (HEAD_SIZE / 2), HEAD_SIZE, HEAD_SIZE);
+			for (JointType type : jointList)
 			{
-				result = true;
-				g.setColour(Colours::lightgreen);
-
-				// draw bone from head to neck
-				D2D1_POINT_2F head = transformToCanvasSpace(b->getJointPosition(JointType::JointType_Head), g.getClipBounds());
-				//logger.write("Head Pos = " + std::to_string(head.x) + "/" + std::to_string(head.y));
-				D2D1_POINT_2F neck = transformToCanvasSpace(b->getJointPosition(JointType::JointType_SpineShoulder), g.getClipBounds());
-				//logger.write("Neck Pos = " + std::to_string(neck.x) + "/" + std::to_string(neck.y));
-				g.drawLine(juce::Line<float>(head.x, head.y, neck.x, neck.y));
-				// draw bone from neck to hip
-				D2D1_POINT_2F hip = transformToCanvasSpace(b->getJointPosition(JointType::JointType_SpineBase), g.getClipBounds());
-				g.drawLine(juce::Line<float>(neck.x, neck.y, hip.x, hip.y));
-				// draw bones for left leg
-				D2D1_POINT_2F lKnee = transformToCanvasSpace(b->getJointPosition(JointType::JointType_KneeLeft), g.getClipBounds());
-				D2D1_POINT_2F lFoot = transformToCanvasSpace(b->getJointPosition(JointType::JointType_FootLeft), g.getClipBounds());
-				g.drawLine(juce::Line<float>(hip.x, hip.y, lKnee.x, lKnee.y));
-				g.drawLine(juce::Line<float>(lKnee.x, lKnee.y, lFoot.x, lFoot.y));
-				// draw bones for right leg
-				D2D1_POINT_2F rKnee = transformToCanvasSpace(b->getJointPosition(JointType::JointType_KneeRight), g.getClipBounds());
-				D2D1_POINT_2F rFoot = transformToCanvasSpace(b->getJointPosition(JointType::JointType_FootRight), g.getClipBounds());
-				g.drawLine(juce::Line<float>(hip.x, hip.y, rKnee.x, rKnee.y));
-				g.drawLine(juce::Line<float>(rKnee.x, rKnee.y, rFoot.x, rFoot.y));
-				// draw bones for left arm
-				D2D1_POINT_2F lElbow = transformToCanvasSpace(b->getJointPosition(JointType::JointType_ElbowLeft), g.getClipBounds());
-				D2D1_POINT_2F lHand = transformToCanvasSpace(b->getJointPosition(JointType::JointType_HandLeft), g.getClipBounds());
-				g.drawLine(juce::Line<float>(neck.x, neck.y, lElbow.x, lElbow.y));
-				g.drawLine(juce::Line<float>(lElbow.x, lElbow.y, lHand.x, lHand.y));
-				// draw bones for right arm
-				D2D1_POINT_2F rElbow = transformToCanvasSpace(b->getJointPosition(JointType::JointType_ElbowRight), g.getClipBounds());
-				D2D1_POINT_2F rHand = transformToCanvasSpace(b->getJointPosition(JointType::JointType_HandRight), g.getClipBounds());
-				g.drawLine(juce::Line<float>(neck.x, neck.y, rElbow.x, rElbow.y));
-				g.drawLine(juce::Line<float>(rElbow.x, rElbow.y, rHand.x, rHand.y));
-
-				// draw head and other joints
-				g.fillEllipse(head.x - (HEAD_SIZE / 2), head.y - (HEAD_SIZE / 2), HEAD_SIZE, HEAD_SIZE);		//<head
-				g.fillEllipse(neck.x - (JOINT_SIZE / 2), neck.y - (JOINT_SIZE / 2), JOINT_SIZE, JOINT_SIZE);	//<neck
-				g.fillEllipse(hip.x - (JOINT_SIZE / 2), hip.y - (JOINT_SIZE / 2), JOINT_SIZE, JOINT_SIZE);		//<hip
-				g.fillEllipse(lKnee.x - (JOINT_SIZE / 2), lKnee.y - (JOINT_SIZE / 2), JOINT_SIZE, JOINT_SIZE);	//<left knee
-				g.fillEllipse(rKnee.x - (JOINT_SIZE / 2), rKnee.y - (JOINT_SIZE / 2), JOINT_SIZE, JOINT_SIZE);	//<right knee
-				g.fillEllipse(lFoot.x - (JOINT_SIZE / 2), lFoot.y - (JOINT_SIZE / 2), JOINT_SIZE, JOINT_SIZE);	//<left foot
-				g.fillEllipse(rFoot.x - (JOINT_SIZE / 2), rFoot.y - (JOINT_SIZE / 2), JOINT_SIZE, JOINT_SIZE);	//<right foot
-				g.fillEllipse(lHand.x - (JOINT_SIZE / 2), lHand.y - (JOINT_SIZE / 2), JOINT_SIZE, JOINT_SIZE);	//<left hand
-				g.fillEllipse(rHand.x - (JOINT_SIZE / 2), rHand.y - (JOINT_SIZE / 2), JOINT_SIZE, JOINT_SIZE);	//<right hand
-				g.fillEllipse(lElbow.x - (JOINT_SIZE / 2), lElbow.y - (JOINT_SIZE / 2), JOINT_SIZE, JOINT_SIZE);//<left elbow
-				g.fillEllipse(rElbow.x - (JOINT_SIZE / 2), rElbow.y - (JOINT_SIZE / 2), JOINT_SIZE, JOINT_SIZE);//<right elbow
+				joints.addEllipse(p[type].x - (JOINT_SIZE / 2), p[type].y - (JOINT_SIZE / 2), JOINT_SIZE, JOINT_SIZE);
 			}
 		}
-		return result;
+
+		if (frame.count > 0)
+		{
+			// get position of floor and tolerance in CameraSpace coordinates
+			D2D1_POINT_2F floorPosition = frame.skeletons[0].floor;
+			D2D1_POINT_2F floorWithTolerance;
+			floorWithTolerance.x = floorPosition.x;
+			floorWithTolerance.y = floorPosition.y - proc.getParam(KinectInputPluginProcessor::ParameterType::FOOT_TOL);
+
+			// calculate y position (using canvas coordinates) of floor and tolerance range
+			hasFloor = true;
+			floorY = transformToCanvasSpace(floorPosition, canvas).y;
+			toleranceY = transformToCanvasSpace(floorWithTolerance, canvas).y;
+		}
+	}
+
+	/**
+	* Function returns the area of the canvas covered by the paths and the floor
+	*/
+	juce::Rectangle<int> DanceDisplay::getDrawnArea() const
+	{
+		juce::Rectangle<int> area = bones.getBounds().getUnion(joints.getBounds()).getSmallestIntegerContainer().expanded(1);
+		if (hasFloor)
+		{
+			int top = static_cast<int>(std::floor(std::min(floorY, toleranceY))) - 1;
+			area = area.getUnion(juce::Rectangle<int>(0, top, getWidth(), getHeight() - top));
+		}
+		return area;
+	}
+
+	/**
+	* Function draws floor line and foot tolerance range to canvas
+	*/
+	void DanceDisplay::drawFloor(Graphics& g)
+	{
+		// draw floor line and tolerance range
+		g.setColour(Colours::aquamarine);
+		g.drawHorizontalLine(static_cast<int>(floorY), 0.0f, static_cast<float>(getWidth()));
+		g.setOpacity(0.3);
+		g.fillRect(juce::Rectangle<float>(0.0f, toleranceY, static_cast<float>(getWidth()), getHeight() - toleranceY));
+		g.setOpacity(1.0);
 	}
 
 	D2D1_POINT_2F DanceDisplay::transformToCanvasSpace(D2D1_POINT_2F pointCamSpace, juce::Rectangle<int> canvas)
@@ -3,19 +3,39 @@
 
 namespace ttmm
 {
-	class DanceDisplay : public juce::Component
+	/**
+	* Draws the skeletons of the KinectDevice and the floor.
+	*
+	* A timer on the message thread takes the newest SkeletonSnapshot of the device at REFRESH_RATE.
+	* The bones and joints are built into paths only when a new frame arrived, and only the area the
+	* old and the new paths cover is repainted. So paint() just fills the cached paths, and the display
+	* costs nothing while nobody moves.
+	*/
+	class DanceDisplay : public juce::Component, private juce::Timer
 	{
 	public:
 		DanceDisplay(KinectInputPluginProcessor &);
 		void paint(Graphics&) override;
-		
+		void resized() override;
+
 	private:
 		KinectInputPluginProcessor& proc;
+		bool connected = false;					//<whether the device was open at the last timer callback
+		juce::Path bones;						//<the bones of all skeletons in canvas space
+		juce::Path joints;						//<the joints and heads of all skeletons in canvas space
+		bool hasFloor = false;					//<whether there is someone to draw the floor below
+		float floorY = 0;						//<y of the floor line in canvas space
+		float toleranceY = 0;					//<y of the top of the foot tolerance range in canvas space
+		juce::Rectangle<int> drawnArea;			//<the area the paths and the floor cover
+
+		void timerCallback() override;
+		void buildPaths();
+		juce::Rectangle<int> getDrawnArea() const;
 		void drawFloor(Graphics& g);
-		bool drawMusicians(Graphics& g);
 		D2D1_POINT_2F transformToCanvasSpace(D2D1_POINT_2F pointCamSpace, juce::Rectangle<int> canvas);
 
 		const float JOINT_SIZE = 10.0;
 		const float HEAD_SIZE = 20.0;
+		static const int REFRESH_RATE = 60;		//<timer callbacks per second
 	};
 }
\ No newline at end of file
@@ -0,0 +1,118 @@
+/***********************************************************************
+* Module:  ttmm::GestureLibrary.cpp
+* Purpose: Implementation of the class GestureLibrary
+***********************************************************************/
+
+#include "GestureLibrary.h"
+
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+
+const double ttmm::GestureLibrary::BAND = 0.1;
+
+namespace
+{
+const float NO_BOUND = 1.0e6f; // envelope of the padding, never exceeded
+}
+
+bool ttmm::GestureLibrary::addTemplate(std::string const &name, PoseType type, std::vector<float> const &frames,
+                                       float threshold)
+{
+    int length = static_cast<int>(frames.size() / FEATURES);
+    if (length == 0 || length > WINDOW || frames.size() % FEATURES != 0)
+    {
+        return false;
+    }
+
+    Template gesture;
+    gesture.name = name;
+    gesture.type = type;
+    gesture.length = length;
+    gesture.band = std::max(1, static_cast<int>(length * BAND));
+    gesture.threshold = threshold * length;
+    gesture.stride = padded(length);
+    gesture.frames.assign(FEATURES * gesture.stride, 0.0f);
+    gesture.upper.assign(FEATURES * gesture.stride, NO_BOUND);
+    gesture.lower.assign(FEATURES * gesture.stride, -NO_BOUND);
+
+    for (int f = 0; f < FEATURES; ++f)
+    {
+        float *column = &gesture.frames[f * gesture.stride];
+        for (int i = 0; i < length; ++i)
+        {
+            column[i] = frames[i * FEATURES + f];
+        }
+        // the envelope holds every value the band allows at a frame
+        for (int i = 0; i < length; ++i)
+        {
+            int first = std::max(0, i - gesture.band);
+            int last = std::min(length, i + gesture.band + 1);
+            gesture.upper[f * gesture.stride + i] = *std::max_element(column + first, column + last);
+            gesture.lower[f * gesture.stride + i] = *std::min_element(column + first, column + last);
+        }
+    }
+    templates.push_back(gesture);
+    longest = std::max(longest, length);
+    return true;
+}
+
+// a template starts with "gesture <name> <PoseType> <threshold>", has one line per frame and ends with "end"
+int ttmm::GestureLibrary::load(std::string const &filename)
+{
+    std::ifstream in(filename);
+    if (!in.is_open())
+    {
+        return 0;
+    }
+
+    int added = 0;
+    bool reading = false;
+    std::string name;
+    PoseType type;
+    float threshold = 0;
+    std::vector<float> frames;
+    std::string line;
+    while (std::getline(in, line))
+    {
+        line.erase(line.find_last_not_of(" \t\r") + 1);
+        if (line.empty() || line[0] == '#')
+        {
+            continue;
+        }
+
+        std::istringstream fields(line);
+        std::string word;
+        fields >> word;
+        if (word == "gesture")
+        {
+            std::string typeName;
+            fields >> name >> typeName >> threshold;
+            reading = !fields.fail() && parsePoseType(typeName, type) && threshold > 0;
+            frames.clear();
+        }
+        else if (word == "end")
+        {
+            if (reading && addTemplate(name, type, frames, threshold))
+            {
+                ++added;
+            }
+            else
+            {
+                ttmm::logger.write("GestureLibrary: skipping a gesture in " + filename);
+            }
+            reading = false;
+        }
+        else if (reading)
+        {
+            std::istringstream values(line);
+            float value;
+            for (int f = 0; f < FEATURES && values >> value; ++f)
+            {
+                frames.push_back(value);
+            }
+        }
+    }
+    ttmm::logger.write("GestureLibrary: " + std::to_string(added) + " gestures loaded from " + filename);
+    return added;
+}
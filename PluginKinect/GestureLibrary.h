@@ -0,0 +1,114 @@
+/**
+* @file GestureLibrary.h
+* @author FH-Minden Musikinformatik 2015, KinectPlugin (Tine, Philipp, Isabell)
+* @brief The recorded gestures the GestureRecognizer searches for
+*/
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "Body.h"
+#include "PoseType.h"
+
+namespace ttmm
+{
+
+/**
+	* @class GestureLibrary
+	* @brief The templates of the recorded gestures (arm swings, turns, jumps, ...).
+	*
+	* Every template keeps its frames one column per feature, padded to LANES, and the envelope of
+	* the frames within its Sakoe-Chiba band, which the GestureRecognizer needs for LB_Keogh.
+	*
+	* The library is read from a text file: a line
+	* @code gesture <name> <PoseType> <threshold>
+	* starts a template, each following line holds the FEATURES values of one frame and a line
+	* @code end
+	* closes it. The threshold is the mean squared distance per frame a window may have.
+	*
+	* The KinectDevice loads the library once, before its thread starts. From then on it is only
+	* read, the GestureRecognizers of all musicians share it.
+	*
+	* @see GestureRecognizer, KinectDevice
+	*/
+class GestureLibrary
+{
+  public:
+    static const int FEATURES = 8;   ///<features of a frame: hands x and y, feet height, elbow spread, lean
+    static const int WINDOW = 128;   ///<number of frames kept, the longest template
+    static const int LANES = 4;      ///<templates and windows are padded to a multiple of this many frames
+    static const double BAND;        ///<width of the Sakoe-Chiba band relative to the length of a template
+
+    struct Template
+    {
+        std::string name;                 ///<name of the gesture
+        PoseType type;                    ///<the pose the gesture stands for
+        int length;                       ///<number of frames
+        int band;                         ///<half width of the Sakoe-Chiba band in frames
+        float threshold;                  ///<largest DTW distance of a window, over all frames
+        int stride;                       ///<length padded to LANES, the distance between two features
+        std::vector<float> frames;        ///<features of the frames, one column of stride values per feature
+        std::vector<float> upper;         ///<upper envelope of the frames within the band, like frames
+        std::vector<float> lower;         ///<lower envelope of the frames within the band, like frames
+    };
+
+    /**
+		* @param frames a number of frames
+		* @return the number rounded up to whole blocks of LANES
+		*/
+    static int padded(int frames) { return (frames + LANES - 1) / LANES * LANES; }
+
+    /**
+		* Add a template
+		*
+		* @param name the name of the gesture
+		* @param type the pose the gesture stands for
+		* @param frames the features of the frames of the gesture, FEATURES values per frame
+		* @param threshold the mean squared distance per frame a window may have
+		* @return false if the template is empty or longer than WINDOW
+		*/
+    bool addTemplate(std::string const &name, PoseType type, std::vector<float> const &frames, float threshold);
+
+    /**
+		* Add the templates of a library file
+		*
+		* @param filename the library
+		* @return the number of templates added
+		*/
+    int load(std::string const &filename);
+
+    /**
+		* @return the number of templates
+		*/
+    size_t size() const { return templates.size(); }
+
+    /**
+		* @param index the index of a template
+		* @return the template
+		*/
+    Template const &get(int index) const { return templates[index]; }
+
+    /**
+		* @param index the index of a template
+		* @return the pose the gesture stands for
+		*/
+    PoseType getType(int index) const { return templates[index].type; }
+
+    /**
+		* @param index the index of a template
+		* @return the name of the gesture
+		*/
+    std::string const &getName(int index) const { return templates[index].name; }
+
+    /**
+		* @return the length of the longest template, 0 without templates
+		*/
+    int getLongest() const { return longest; }
+
+  private:
+    std::vector<Template> templates;  ///<the library
+    int longest = 0;                  ///<length of the longest template
+};
+}
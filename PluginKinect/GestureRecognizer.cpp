@@ -0,0 +1,215 @@
+/***********************************************************************
+* Module:  ttmm::GestureRecognizer.cpp
+* Purpose: Implementation of the class GestureRecognizer
+***********************************************************************/
+
+#include "GestureRecognizer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <limits>
+
+namespace
+{
+const float FAR_AWAY = std::numeric_limits<float>::max(); // accumulated cost outside the band
+
+// adds the squared difference of one feature to the costs of the frames [first, last) of a template.
+// first and last are multiples of LANES, the inner loop of fixed length is vectorized
+void addSquaredDifference(float const *__restrict column, float value, float *__restrict costs, int first, int last)
+{
+    for (int block = first; block < last; block += ttmm::GestureRecognizer::LANES)
+    {
+        for (int lane = 0; lane < ttmm::GestureRecognizer::LANES; ++lane)
+        {
+            float difference = column[block + lane] - value;
+            costs[block + lane] += difference * difference;
+        }
+    }
+}
+
+// adds the squared distance of one feature of a window to the envelope of a template, one sum per lane.
+// max(x, 0) is written as (x + |x|) / 2, so there are no branches
+void addEnvelopeDistance(float const *__restrict window, float const *__restrict upper, float const *__restrict lower,
+                         float *__restrict sums, int frames)
+{
+    for (int block = 0; block < frames; block += ttmm::GestureRecognizer::LANES)
+    {
+        for (int lane = 0; lane < ttmm::GestureRecognizer::LANES; ++lane)
+        {
+            float above = window[block + lane] - upper[block + lane];
+            float below = lower[block + lane] - window[block + lane];
+            above = 0.5f * (above + std::fabs(above));
+            below = 0.5f * (below + std::fabs(below));
+            sums[lane] += above * above + below * below;
+        }
+    }
+}
+}
+
+ttmm::GestureRecognizer::GestureRecognizer(GestureLibrary const *library) : library(library)
+{
+    if (library != nullptr)
+    {
+        longest = library->getLongest();
+        quietUntil.assign(library->size(), 0);
+    }
+    windowStride = GestureLibrary::padded(longest) + LANES;
+    window.assign(FEATURES * windowStride, 0.0f);
+    costs.resize(GestureLibrary::padded(longest));
+    previous.resize(longest + 1);
+    current.resize(longest + 1);
+}
+
+bool ttmm::GestureRecognizer::saveTemplate(std::string const &filename, std::string const &name, PoseType type,
+                                           float threshold, int length) const
+{
+    if (length <= 0 || length > WINDOW || static_cast<unsigned long long>(length) > pushed)
+    {
+        return false;
+    }
+    std::ofstream out(filename, std::ios::out | std::ios_base::app);
+    if (!out.is_open())
+    {
+        return false;
+    }
+
+    out << "gesture " << name << " " << poseTypeName(type) << " " << threshold << std::endl;
+    for (unsigned long long frame = pushed - length; frame < pushed; ++frame)
+    {
+        float const *features = &ring[(frame % WINDOW) * FEATURES];
+        for (int f = 0; f < FEATURES; ++f)
+        {
+            out << (f == 0 ? "" : " ") << features[f];
+        }
+        out << std::endl;
+    }
+    out << "end" << std::endl;
+    return true;
+}
+
+int ttmm::GestureRecognizer::update(float const (&features)[FEATURES])
+{
+    std::copy(features, features + FEATURES, &ring[(pushed % WINDOW) * FEATURES]);
+    ++pushed;
+    if (library == nullptr || library->size() == 0)
+    {
+        return -1;
+    }
+    gatherWindow();
+
+    int best = -1;
+    float bestRatio = 0;
+    for (size_t t = 0; t < library->size(); ++t)
+    {
+        GestureLibrary::Template const &gesture = library->get(static_cast<int>(t));
+        if (pushed < static_cast<unsigned long long>(gesture.length) || pushed < quietUntil[t])
+        {
+            continue;
+        }
+        if (lowerBound(gesture, gesture.threshold) > gesture.threshold)
+        {
+            ++pruned;
+            continue;
+        }
+        float distance = warp(gesture, gesture.threshold);
+        if (distance > gesture.threshold)
+        {
+            continue;
+        }
+
+        // the templates differ in length and threshold, the one nearest relative to its threshold wins
+        float ratio = distance / gesture.threshold;
+        if (best < 0 || ratio < bestRatio)
+        {
+            best = static_cast<int>(t);
+            bestRatio = ratio;
+        }
+    }
+
+    if (best >= 0)
+    {
+        quietUntil[best] = pushed + library->get(best).length;
+    }
+    return best;
+}
+
+void ttmm::GestureRecognizer::gatherWindow()
+{
+    // the newest frame is at the end of every column, missing frames at the start stay as they are
+    int frames = static_cast<int>(std::min<unsigned long long>(pushed, longest));
+    for (int k = 0; k < frames; ++k)
+    {
+        float const *features = &ring[((pushed - frames + k) % WINDOW) * FEATURES];
+        for (int f = 0; f < FEATURES; ++f)
+        {
+            window[f * windowStride + longest - frames + k] = features[f];
+        }
+    }
+}
+
+float ttmm::GestureRecognizer::lowerBound(GestureLibrary::Template const &gesture, float limit) const
+{
+    float sums[LANES] = {0};
+    float sum = 0;
+    int start = longest - gesture.length;
+    for (int f = 0; f < FEATURES; ++f)
+    {
+        addEnvelopeDistance(&window[f * windowStride + start], &gesture.upper[f * gesture.stride],
+                            &gesture.lower[f * gesture.stride], sums, gesture.stride);
+        sum = sums[0] + sums[1] + sums[2] + sums[3];
+        if (sum > limit)
+        {
+            break;
+        }
+    }
+    return sum;
+}
+
+float ttmm::GestureRecognizer::warp(GestureLibrary::Template const &gesture, float limit)
+{
+    int length = gesture.length;
+    int start = longest - length;
+
+    // previous[j + 1] holds the cost of the path to frame j of the template, previous[0] is the start
+    std::fill(previous.begin(), previous.begin() + length + 1, FAR_AWAY);
+    previous[0] = 0;
+    for (int i = 0; i < length; ++i)
+    {
+        int first = std::max(0, i - gesture.band);
+        int last = std::min(length - 1, i + gesture.band);
+
+        // the distances of this frame of the window to the frames of the template within the band
+        int blockFirst = first / LANES * LANES;
+        int blockLast = GestureLibrary::padded(last + 1);
+        std::fill(costs.begin() + blockFirst, costs.begin() + blockLast, 0.0f);
+        for (int f = 0; f < FEATURES; ++f)
+        {
+            addSquaredDifference(&gesture.frames[f * gesture.stride], window[f * windowStride + start + i],
+                                 costs.data(), blockFirst, blockLast);
+        }
+
+        current[first] = FAR_AWAY;
+        float rowMinimum = FAR_AWAY;
+        for (int j = first; j <= last; ++j)
+        {
+            float before = std::min(std::min(previous[j], previous[j + 1]), current[j]);
+            current[j + 1] = before == FAR_AWAY ? FAR_AWAY : costs[j] + before;
+            rowMinimum = std::min(rowMinimum, current[j + 1]);
+        }
+        if (last + 2 <= length)
+        {
+            current[last + 2] = FAR_AWAY;
+        }
+
+        // every path through this row costs more already
+        if (rowMinimum > limit)
+        {
+            ++abandoned;
+            return rowMinimum;
+        }
+        std::swap(previous, current);
+    }
+    ++compared;
+    return previous[length];
+}
@@ -0,0 +1,129 @@
+/**
+* @file GestureRecognizer.h
+* @author FH-Minden Musikinformatik 2015, KinectPlugin (Tine, Philipp, Isabell)
+* @brief Recognizes recorded movements in the stream of bodies by dynamic time warping
+*/
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "Body.h"
+#include "GestureLibrary.h"
+#include "PoseType.h"
+
+namespace ttmm
+{
+
+/**
+	* @class GestureRecognizer
+	* @brief Searches the last frames of a body for recorded gestures (arm swings, turns, jumps, ...).
+	*
+	* Every frame is reduced to a feature vector, which is kept in a ring of the last WINDOW frames.
+	* With every new frame, the last frames are compared to every template of a GestureLibrary by
+	* dynamic time warping (DTW) within a Sakoe-Chiba band: a template of length m is compared to the
+	* window of the last m frames.
+	*
+	* This is not a full subsequence DTW, whose match may start at any of the last frames. The window
+	* ends with the newest frame and has the length of the template, so a gesture is found in the frame
+	* it ends, and it may be faster or slower than the template only as far as the band allows. In
+	* return there is one DTW of at most m times the band cells per template and frame, and the window
+	* is aligned with the envelope of the template, which LB_Keogh needs.
+	*
+	* Most windows are far from most templates, so before the DTW the lower bound LB_Keogh is
+	* computed from the envelope of the template, which needs only one pass. The DTW is only run if
+	* the bound is below the threshold of the template, and it is abandoned as soon as a whole row of
+	* the cost matrix is above it. The distances between two frames are computed over the features
+	* in loops of fixed length the compiler vectorizes.
+	*
+	* The library is shared and only read, the recognizer keeps the frames of one body and the state
+	* of its search. A template can be recorded from the last frames with saveTemplate().
+	*
+	* @see KinectMusician, GestureLibrary, BodyFeatures
+	*/
+class GestureRecognizer
+{
+  public:
+    static const int FEATURES = GestureLibrary::FEATURES; ///<features of a frame
+    static const int WINDOW = GestureLibrary::WINDOW;     ///<number of frames kept, the longest template
+    static const int LANES = GestureLibrary::LANES;       ///<windows are padded to a multiple of this many frames
+
+    /**
+		* Constructor: Create a GestureRecognizer for the templates of a library
+		*
+		* @param library the templates, not changed while the recognizer lives, nullptr for none
+		*/
+    explicit GestureRecognizer(GestureLibrary const *library = nullptr);
+
+    /**
+		* Append the last frames as a template to a library file
+		*
+		* @param filename the library
+		* @param name the name of the gesture
+		* @param type the pose the gesture stands for
+		* @param threshold the mean squared distance per frame a window may have
+		* @param length the number of frames of the gesture
+		* @return true if the template was written
+		*/
+    bool saveTemplate(std::string const &filename, std::string const &name, PoseType type, float threshold,
+                      int length) const;
+
+    /**
+		* Forget the frames, e.g. when the body was lost
+		*/
+    void reset() { pushed = 0; }
+
+    /**
+		* Take the features of a new frame and search the last frames for the gestures.
+		* A gesture is not found again until it had time to be repeated.
+		*
+		* @param features the features of the frame
+		* @return the index of the best template of the library found, -1 if none
+		*/
+    int update(float const (&features)[FEATURES]);
+
+    unsigned long long getPruned() const { return pruned; }        ///<windows skipped by LB_Keogh
+    unsigned long long getAbandoned() const { return abandoned; }  ///<DTWs abandoned early
+    unsigned long long getCompared() const { return compared; }    ///<DTWs computed to the end
+
+  private:
+    /**
+		* Copy the last frames of the ring to the window, one column per feature, oldest first
+		*/
+    void gatherWindow();
+
+    /**
+		* LB_Keogh of the last frames, abandoned above the limit
+		*
+		* @param gesture the template
+		* @param limit the largest distance of interest
+		* @return the lower bound of the DTW distance, or a value above the limit
+		*/
+    float lowerBound(GestureLibrary::Template const &gesture, float limit) const;
+
+    /**
+		* DTW of the last frames within the band, abandoned above the limit
+		*
+		* @param gesture the template
+		* @param limit the largest distance of interest
+		* @return the DTW distance, or a value above the limit
+		*/
+    float warp(GestureLibrary::Template const &gesture, float limit);
+
+    GestureLibrary const *library;    ///<the templates, shared with the other recognizers
+    std::vector<unsigned long long> quietUntil; ///<a template is not searched until this many frames were pushed
+    float ring[WINDOW * FEATURES];    ///<the features of the last frames
+    unsigned long long pushed = 0;    ///<number of frames pushed
+    int longest = 0;                  ///<length of the longest template
+    int windowStride = 0;             ///<distance between two features in the window
+    std::vector<float> window;        ///<the last frames of the current search, one column per feature
+    std::vector<float> costs;         ///<distances of a row of the cost matrix
+    std::vector<float> previous;      ///<accumulated costs of the previous row
+    std::vector<float> current;       ///<accumulated costs of the current row
+
+    unsigned long long pruned = 0;    ///<windows skipped by LB_Keogh
+    unsigned long long abandoned = 0; ///<DTWs abandoned early
+    unsigned long long compared = 0;  ///<DTWs computed to the end
+};
+}
@@ -0,0 +1,87 @@
+/***********************************************************************
+* Module:  ttmm::JointFilter.cpp
+* Purpose: Implementation of the class JointFilter
+***********************************************************************/
+
+#include "JointFilter.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+const double ttmm::JointFilter::MAX_FRAME_INTERVAL = 0.2;
+const double ttmm::JointFilter::DEFAULT_HORIZON = 0.033;
+
+void ttmm::JointFilter::setWeights(float smoothing, float correction, float jitterRadius, float maxDeviation)
+{
+    this->smoothing = std::min(std::max(smoothing, 0.0f), 1.0f);
+    this->correction = std::min(std::max(correction, 0.0f), 1.0f);
+    this->jitterRadius = std::max(jitterRadius, 0.001f);
+    this->maxDeviation = std::max(maxDeviation, 0.0f);
+}
+
+bool ttmm::JointFilter::apply(Body const &raw, Body &filtered)
+{
+    // frames the KinectDevice did not number are passed through
+    if (raw.getFrameNumber() == 0)
+    {
+        filtered = raw;
+        return true;
+    }
+    if (started && raw.getFrameNumber() == lastFrame)
+    {
+        return false;
+    }
+
+    double interval = std::chrono::duration<double>(raw.getFrameTime() - lastTime).count();
+    filtered = raw;
+    if (!started || interval <= 0 || interval > MAX_FRAME_INTERVAL)
+    {
+        // start again at the raw joints, standing still
+        std::copy(raw.getX(), raw.getX() + Body::JOINT_STRIDE, smoothedX);
+        std::copy(raw.getY(), raw.getY() + Body::JOINT_STRIDE, smoothedY);
+        std::fill(trendX, trendX + Body::JOINT_STRIDE, 0.0f);
+        std::fill(trendY, trendY + Body::JOINT_STRIDE, 0.0f);
+        started = true;
+    }
+    else
+    {
+        filterCoordinate(raw.getX(), smoothedX, trendX, filtered.getX(), static_cast<float>(interval));
+        filterCoordinate(raw.getY(), smoothedY, trendY, filtered.getY(), static_cast<float>(interval));
+    }
+    lastFrame = raw.getFrameNumber();
+    lastTime = raw.getFrameTime();
+    return true;
+}
+
+void ttmm::JointFilter::filterCoordinate(float const *__restrict raw, float *__restrict smoothed,
+                                         float *__restrict trend, float *__restrict out, float dt) const
+{
+    // the weights are copied to locals and the arrays are restrict, so nothing aliases
+    float const a = smoothing;
+    float const keep = 1.0f - smoothing;
+    float const b = correction;
+    float const keepTrend = 1.0f - correction;
+    float const radius = jitterRadius;
+    float const ahead = horizon;
+    float const deviationLimit = maxDeviation;
+    float const perSecond = 1.0f / dt;
+
+    // no branches in the loop, so it is vectorized over all joints:
+    // min(x, 1) is written as (x + 1 - |x - 1|) / 2 and the clamp to +-m as (|e + m| - |e - m|) / 2
+    for (int i = 0; i < Body::JOINT_STRIDE; ++i)
+    {
+        // damp small steps, they are jitter
+        float step = raw[i] - smoothed[i];
+        float ratio = std::fabs(step) / radius;
+        float weight = 0.5f * (ratio + 1.0f - std::fabs(ratio - 1.0f));
+        float damped = smoothed[i] + step * weight;
+
+        float position = a * damped + keep * (smoothed[i] + trend[i] * dt);
+        trend[i] = b * (position - smoothed[i]) * perSecond + keepTrend * trend[i];
+        smoothed[i] = position;
+
+        float deviation = position + trend[i] * ahead - raw[i];
+        out[i] = raw[i] + 0.5f * (std::fabs(deviation + deviationLimit) - std::fabs(deviation - deviationLimit));
+    }
+}
@@ -0,0 +1,102 @@
+/**
+* @file JointFilter.h
+* @author FH-Minden Musikinformatik 2015, KinectPlugin (Tine, Philipp, Isabell)
+* @brief Smooths the joints of a Body and predicts them a short time ahead
+*/
+
+#pragma once
+
+#include "Body.h"
+
+namespace ttmm
+{
+
+/**
+	* @class JointFilter
+	* @brief Double exponential smoothing of all joints of a Body with a prediction along the trend.
+	*
+	* Every coordinate of every joint keeps a smoothed position and a trend (Holt's method):
+	* @code smoothed = a * raw + (1 - a) * (smoothed + trend * dt)
+	* @code trend = b * (smoothed - previous) / dt + (1 - b) * trend
+	* Steps smaller than the jitter radius are damped before, so a joint that stands still does not
+	* flicker around a tolerance. The result is the smoothed position moved along the trend by the
+	* prediction horizon, which makes up for a part of the latency of the sensor and of the smoothing.
+	* It never leaves the raw position by more than the maximum deviation, so a sudden stop does
+	* not overshoot far.
+	*
+	* The joints are processed as whole coordinate arrays of the Body without branches, so the
+	* compiler vectorizes the loops. Only new frames change the state, the same frame may be filtered
+	* more than once.
+	*
+	* @see Body, KinectMusician
+	*/
+class JointFilter
+{
+  public:
+    static const double MAX_FRAME_INTERVAL; //<A longer gap in seconds between two frames starts again
+    static const double DEFAULT_HORIZON;    //<Prediction horizon in seconds until another one is set
+
+    /**
+		* Set the prediction horizon.
+		*
+		* @param seconds how far the joints are predicted, 0 to only smooth them
+		*/
+    void setPredictionHorizon(double seconds) { horizon = static_cast<float>(seconds); }
+
+    /**
+		* @return the prediction horizon in seconds
+		*/
+    double getPredictionHorizon() const { return horizon; }
+
+    /**
+		* Set the weights of the filter.
+		*
+		* @param smoothing weight of a new position, 1 takes the raw positions
+		* @param correction weight of a new trend
+		* @param jitterRadius steps up to this many pixels are damped
+		* @param maxDeviation the result stays within this many pixels of the raw position
+		*/
+    void setWeights(float smoothing, float correction, float jitterRadius, float maxDeviation);
+
+    /**
+		* Forget the joints, e.g. when the body was lost
+		*/
+    void reset() { started = false; }
+
+    /**
+		* Filter the joints of a new frame.
+		*
+		* @param raw the body as the KinectDevice wrote it
+		* @param[out] filtered receives the smoothed and predicted joints, another Body than raw
+		* @return true if the frame was new
+		*/
+    bool apply(Body const &raw, Body &filtered);
+
+  private:
+    /**
+		* Filter one coordinate of all joints
+		*
+		* @param raw the raw coordinates
+		* @param smoothed the smoothed coordinates, updated
+		* @param trend the trend of the coordinates per second, updated
+		* @param out receives the predicted coordinates
+		* @param dt seconds since the last frame
+		*/
+    void filterCoordinate(float const *__restrict raw, float *__restrict smoothed, float *__restrict trend,
+                          float *__restrict out, float dt) const;
+
+    float smoothing = 0.5f;     //<Weight of a new position
+    float correction = 0.3f;    //<Weight of a new trend
+    float jitterRadius = 4.0f;  //<Steps up to this many pixels are damped
+    float maxDeviation = 25.0f; //<The result stays within this many pixels of the raw position
+    float horizon = static_cast<float>(DEFAULT_HORIZON); //<Prediction horizon in seconds
+
+    bool started = false;                  //<Whether the state holds a frame
+    unsigned long long lastFrame = 0;      //<Number of the last frame filtered
+    Timestamp lastTime;                    //<Time of the last frame filtered
+    float smoothedX[Body::JOINT_STRIDE];   //<Smoothed X-Positions
+    float smoothedY[Body::JOINT_STRIDE];   //<Smoothed Y-Positions
+    float trendX[Body::JOINT_STRIDE];      //<Trend of the X-Positions in pixels per second
+    float trendY[Body::JOINT_STRIDE];      //<Trend of the Y-Positions in pixels per second
+};
+}
@@ -0,0 +1,64 @@
+/***********************************************************************
+* Module:  ttmm::JointProjection.cpp
+* Purpose: Implementation of the class JointProjection
+***********************************************************************/
+
+#include "JointProjection.h"
+
+namespace
+{
+// the kernel, all pointers are restrict and the coefficients are locals, so nothing aliases
+void projectBlocks(float const *__restrict x, float const *__restrict y, float const *__restrict z,
+                   float *__restrict screenX, float *__restrict screenY, int count, float const (&m)[2][3],
+                   float const (&k)[3])
+{
+    float const m00 = m[0][0], m01 = m[0][1], m02 = m[0][2];
+    float const m10 = m[1][0], m11 = m[1][1], m12 = m[1][2];
+    float const k2 = k[0], k4 = k[1], k6 = k[2];
+
+    for (int block = 0; block < count; block += ttmm::JointProjection::LANES)
+    {
+        for (int lane = 0; lane < ttmm::JointProjection::LANES; ++lane)
+        {
+            int i = block + lane;
+            float inverse = 1.0f / z[i];
+            float nx = x[i] * inverse;
+            float ny = y[i] * inverse;
+            float r2 = nx * nx + ny * ny;
+            float factor = 1.0f + r2 * (k2 + r2 * (k4 + r2 * k6));
+            nx *= factor;
+            ny *= factor;
+            screenX[i] = m00 * nx + m01 * ny + m02;
+            screenY[i] = m10 * nx + m11 * ny + m12;
+        }
+    }
+}
+}
+
+bool ttmm::JointProjection::setIntrinsics(float focalX, float focalY, float principalX, float principalY, float k2,
+                                          float k4, float k6, float scaleX, float scaleY)
+{
+    if (!(focalX > 0 && focalY > 0))
+    {
+        return false;
+    }
+
+    // the depth image has y downwards, camera space upwards
+    matrix[0][0] = scaleX * focalX;
+    matrix[0][1] = 0;
+    matrix[0][2] = scaleX * principalX;
+    matrix[1][0] = 0;
+    matrix[1][1] = -scaleY * focalY;
+    matrix[1][2] = scaleY * principalY;
+    distortion[0] = k2;
+    distortion[1] = k4;
+    distortion[2] = k6;
+    valid = true;
+    return true;
+}
+
+void ttmm::JointProjection::project(float const *x, float const *y, float const *z, float *screenX, float *screenY,
+                                    int count) const
+{
+    projectBlocks(x, y, z, screenX, screenY, count, matrix, distortion);
+}
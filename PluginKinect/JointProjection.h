@@ -0,0 +1,72 @@
+/**
+* @file JointProjection.h
+* @author FH-Minden Musikinformatik 2015, KinectPlugin (Tine, Philipp, Isabell)
+* @brief Projects points from camera space to the screen in batches
+*/
+
+#pragma once
+
+namespace ttmm
+{
+
+/**
+	* @class JointProjection
+	* @brief Projects many points from the camera space of the sensor to the screen at once.
+	*
+	* The projection of the depth camera is a pinhole with radial distortion: a point is divided by its
+	* depth, distorted by 1 + k2 r^2 + k4 r^4 + k6 r^6 and mapped to the screen by a 2x3 matrix, which
+	* holds the focal lengths and the principal point of the depth camera scaled to the screen.
+	* The matrix is computed once from the intrinsics, so a frame needs no call of the coordinate mapper.
+	*
+	* The points are given as one array per coordinate. The loop has no branches and works on blocks
+	* of LANES points the compiler vectorizes, the arrays are read and written up to count rounded up to
+	* LANES. The class uses no Kinect types, so it runs anywhere, e.g. on recorded skeletons.
+	*
+	* @see KinectDevice
+	*/
+class JointProjection
+{
+  public:
+    static const int LANES = 4; ///<the points are projected in blocks of this many
+
+    /**
+		* Set the intrinsics of the depth camera and the size of the screen
+		*
+		* @param focalX the focal length in x in pixels of the depth image
+		* @param focalY the focal length in y in pixels of the depth image
+		* @param principalX the x of the principal point in pixels of the depth image
+		* @param principalY the y of the principal point in pixels of the depth image
+		* @param k2 the radial distortion of second order
+		* @param k4 the radial distortion of fourth order
+		* @param k6 the radial distortion of sixth order
+		* @param scaleX the width of the screen divided by the width of the depth image
+		* @param scaleY the height of the screen divided by the height of the depth image
+		* @return false if the focal lengths are not positive, the projection stays unchanged then
+		*/
+    bool setIntrinsics(float focalX, float focalY, float principalX, float principalY, float k2, float k4, float k6,
+                       float scaleX, float scaleY);
+
+    /**
+		* @return whether intrinsics were set
+		*/
+    bool isValid() const { return valid; }
+
+    /**
+		* Project points from camera space (x to the left of the sensor, y up, z away from it, in meters)
+		* to the screen (x to the right, y down, in pixels).
+		*
+		* @param x the x of the points
+		* @param y the y of the points
+		* @param z the depth of the points, not 0, also in the padding
+		* @param[out] screenX receives the x on the screen
+		* @param[out] screenY receives the y on the screen
+		* @param count the number of points, the arrays hold it rounded up to LANES
+		*/
+    void project(float const *x, float const *y, float const *z, float *screenX, float *screenY, int count) const;
+
+  private:
+    float matrix[2][3] = {{0}};  ///<maps the distorted, normalized point (x, y, 1) to the screen
+    float distortion[3] = {0};   ///<k2, k4 and k6
+    bool valid = false;          ///<whether intrinsics were set
+};
+}
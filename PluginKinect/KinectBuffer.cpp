@@ -7,54 +7,57 @@
 #include "KinectBuffer.h"
 #include "FileWriter.h"
 
-// iterates backwards through buffer and searches last event with BodyPart = Arms
-ttmm::PoseType ttmm::KinectBuffer::getLatestHandDirection() const
+// adds an event and remembers it, if it is a stomp or an arm pose
+ttmm::PoseEvent &ttmm::KinectBuffer::push(PoseEvent const &data)
 {
-    if (!isEmpty())
-    {
-        std::vector<PoseEvent> data;
-        getReverseCopyOfAll(data);
+    PoseEvent &result = RingBuffer<PoseEvent, BufferSize>::push(data);
+    size_t index = (insertPosition + BufferSize - 1) % BufferSize;
+    unsigned long long sequence = pushed++;
 
-        // iterate backwards through pose history
-        for (size_t i = 0; i < data.size(); ++i)
+    if (data.bodyPart == BodyPart::ARMS)
+    {
+        hasArmPose = true;
+        armPose = data.type;
+        armSequence = sequence;
+    }
+    else if (data.bodyPart == BodyPart::FOOTS)
+    {
+        if (bothFeetDown(data.type))
         {
-            // only look at arm poses
-            if (data.at(i).bodyPart == BodyPart::ARMS)
+            // a stomp needs a lifted foot before, which is still in the buffer
+            if (hasLift && isInBuffer(liftSequence))
             {
-                return data.at(i).type;
+                hasStomp = true;
+                stompIndex = index;
+                stompLiftSequence = liftSequence;
             }
         }
+        else if (bothFeetUp(data.type) || rightFootUp(data.type) || leftFootUp(data.type))
+        {
+            hasLift = true;
+            liftSequence = sequence;
+        }
+    }
+    return result;
+}
+
+// returns the last arm pose still in the buffer
+ttmm::PoseType ttmm::KinectBuffer::getLatestHandDirection() const
+{
+    if (hasArmPose && isInBuffer(armSequence))
+    {
+        return armPose;
     }
     return (PoseType::BOTTOM_LEFT | PoseType::BOTTOM_RIGHT);
 }
 
-// iterates backwards through buffer and searches last event, where the musician
-// stomped his feet
+// returns the last stomp still in the buffer
 ttmm::PoseEvent const *ttmm::KinectBuffer::getLatestEvent() const
 {
-    if (!isEmpty())
+    // like the former search, the lifted foot has to be in the buffer as well
+    if (hasStomp && isInBuffer(stompLiftSequence))
     {
-        getReverseCopyOfAll(data);
-
-        // iterate backwards through pose history
-        for (size_t i = 0; i < data.size(); ++i)
-        {
-            // only look at foot poses
-            if (data[i].bodyPart == BodyPart::FOOTS)
-            {
-                if (bothFeetDown(data[i].type))
-                {
-                    // and in some pose before at least one foot was not on the floor
-                    for (int j = i + 1; j < data.size(); ++j)
-                    {
-                        if (bothFeetUp(data[j].type) || rightFootUp(data[j].type) || leftFootUp(data[j].type))
-                        {
-                            return &data[i];
-                        }
-                    }
-                }
-            }
-        }
+        return &buffer[stompIndex];
     }
     return nullptr;
-}
\ No newline at end of file
+}
@@ -22,26 +22,56 @@ using Buffer = RingBuffer<PoseEvent, BufferSize>;
 * @brief Extends super-class Buffer, overrides function getLatestEvent() and
 * adds defines special kinect function getLatestHandDirection()
 *
+* The latest stomp and the latest arm pose are tracked while the events are
+* pushed, so both queries take constant time. As before, an event is only
+* found while it is still in the buffer.
+*
 * @see Buffer
 */
 class KinectBuffer : public Buffer
 {
-    mutable std::vector<PoseEvent> data;
-
   public:
     /**
-  * iterates backwards through buffer and searches last event, where the
-  *musician stomped his feet
+  * Adds an event to the buffer and updates the latest stomp and arm pose.
+  *
+  * @param data the event
+  * @return a ref like @code RingBuffer::push
+  */
+    PoseEvent &push(PoseEvent const &data);
+    /**
+  * Returns the last event, where the musician stomped their feet
   *
   * @return the last PoseEvent (a stomp, both feet are on the ground after at
-  *least one foot was lifted up)
+  *least one foot was lifted up), nullptr if there is none in the buffer
   */
     PoseEvent const*getLatestEvent() const override final;
     /**
-  * iterates backwards through buffer and searches last event with BodyPart = Arms
+  * Returns the direction of the last event with BodyPart = Arms
   *
   * @return direction of both arms (e.g. upper left, upper right,...)
   */
     PoseType getLatestHandDirection() const;
+
+  private:
+    /**
+  * checks if an event is still in the buffer
+  *
+  * @param sequence the number of events pushed before the event
+  * @return true if the event was not overwritten yet
+  */
+    bool isInBuffer(unsigned long long sequence) const
+    {
+        return pushed - sequence <= BufferSize;
+    }
+
+    unsigned long long pushed = 0;      ///<number of events pushed so far
+    bool hasStomp = false;              ///<whether a stomp was pushed
+    size_t stompIndex = 0;              ///<position of the latest stomp in the buffer
+    unsigned long long stompLiftSequence = 0; ///<number of events pushed before the lifted foot of the latest stomp
+    bool hasLift = false;               ///<whether a foot was lifted
+    unsigned long long liftSequence = 0; ///<number of events pushed before the latest lifted foot
+    bool hasArmPose = false;            ///<whether an arm pose was pushed
+    PoseType armPose;                   ///<type of the latest arm pose
+    unsigned long long armSequence = 0; ///<number of events pushed before the latest arm pose
 };
-}
\ No newline at end of file
+}
@@ -4,18 +4,52 @@
 * Purpose: Implementation of the class KinectDevice
 ***********************************************************************/
 
+#include <algorithm>
+#include <cmath>
 #include <string>
 #include "KinectDevice.h"
 #include <Windows.h>
 
+static_assert(ttmm::KinectDevice::MAX_BODIES <= ttmm::BodyFeatures::SLOTS, "every body needs a slot of the features");
+
+const double ttmm::KinectDevice::MATCH_DISTANCE = 0.5;
+const double ttmm::KinectDevice::FLOOR_EPSILON = 0.01;
+const char *const ttmm::KinectDevice::POSE_FILE = "poses.txt";
+const char *const ttmm::KinectDevice::GESTURE_FILE = "gestures.txt";
+const double ttmm::KinectDevice::RECORD_THRESHOLD = 0.05;
+
 // Constructor, creates musicianBodies, calls initSensor() and creates thread for run()
 ttmm::KinectDevice::KinectDevice(std::vector<KinectMusician> &musicians)
     : musicians(musicians)
+    , deviceHandle(nullptr)
+    , bodyReader(nullptr)
+    , coordinateMapper(nullptr)
+    , stopDevice(false)
+    , framesProcessed(0)
+    , framesDropped(0)
+    , processingTime(0)
+    , maxProcessingTime(0)
+    , latencyAboveMinimum(0)
+    , totalLatencyAboveMinimum(0)
+    , predictionHorizon(static_cast<float>(JointFilter::DEFAULT_HORIZON))
+    , recordType(PoseType::TOP_LEFT)
+    , recordRequested(false)
+    , gesturesRecorded(0)
 {
     for (auto &body : musicianBodies)
     {
         body = nullptr;
     }
+    trackingIds.fill(0);
+    lastSeen.fill(0);
+    spinePositions.fill(CameraSpacePoint{0, 0, 0});
+    floor2D.fill(D2D1::Point2F(0, 0));
+    floorMapped.fill(false);
+    // the musicians are never moved while the editor reads them
+    musicians.reserve(MAX_BODIES);
+    // the default templates stay if there is no configuration
+    (void)poses.load(POSE_FILE);
+    (void)gestures.load(GESTURE_FILE);
 
     // try to start sensor; success if deviceHandle is not nullptr
     (void)initSensor();
@@ -74,7 +108,10 @@ void ttmm::KinectDevice::startup(LPCTSTR applicationPath)
 ttmm::KinectDevice::~KinectDevice()
 {
     stopDevice = true;
-    deviceThread.join();
+    if (deviceThread.joinable())
+    {
+        deviceThread.join();
+    }
 
     if (deviceThread.joinable())
     {
@@ -82,7 +119,25 @@ ttmm::KinectDevice::~KinectDevice()
             "Kinect thread still running but it shouldn't. That's weird.");
     }
 
+    ttmm::logger.write("Frames: " + std::to_string(getFramesProcessed()) + " processed, " +
+                       std::to_string(getFramesDropped()) + " dropped, processing at most " +
+                       std::to_string(getMaxProcessingTime()) + " ms, mean latency above minimum " +
+                       std::to_string(getMeanLatencyAboveMinimum()) + " ms");
+
+    // how much of the search for the gestures LB_Keogh and the early abandoning saved
+    for (size_t i = 0; i < musicians.size(); i++)
+    {
+        GestureRecognizer const &search = musicians.at(i).getGestures();
+        ttmm::logger.write("Gestures of slot " + std::to_string(i) + ": " + std::to_string(search.getPruned()) +
+                           " windows pruned by LB_Keogh, " + std::to_string(search.getAbandoned()) +
+                           " DTWs abandoned, " + std::to_string(search.getCompared()) + " DTWs computed to the end");
+    }
+
     // close reader & mapper
+    if (bodyReader && frameEvent != 0)
+    {
+        bodyReader->UnsubscribeFrameArrived(frameEvent);
+    }
     safeRelease(bodyReader);
     safeRelease(coordinateMapper);
 
@@ -107,15 +162,18 @@ void ttmm::KinectDevice::run()
 {
     while (!stopDevice)
     {
-		// read latest frame from camera, process body and floor, map coordinates
-        update();
+		// wait for the next frame from camera, process body and floor, map coordinates
+        if (!update())
+        {
+            continue;
+        }
 
-		// push all musicians and floordata to musicians vector
-        for (size_t i = 0; i < musicianBodies.size(); i++)
+		// every slot with a body gets a musician, the slots are taken from the first on
+        for (size_t i = 0; i < musicianBodies.size() && musicianBodies[i] != nullptr; i++)
         {
             if (musicians.size() <= i)									//<check if there is already a musician for this body, if there is none...
             {
-                musicians.push_back(KinectMusician(musicianBodies[i])); //<...create new kinectmusician for body
+                musicians.push_back(KinectMusician(musicianBodies[i], &poses, &gestures)); //<...create new kinectmusician for body
 				logger.write("A new KinectMusician was created at slot" + std::to_string(i));
 			}
             else if (!musicians.at(i).hasBody())						//<else if there is already a musician and he has a body..
@@ -123,12 +181,159 @@ void ttmm::KinectDevice::run()
                 musicians.at(i).setBody(musicianBodies[i]);				//<...change his bodydata
 				//logger.write("BodyData for KinectMusician at slot " + std::to_string(i) + " was changed");
             }
-            musicians.at(i).pushEvent(floor2D);
         }
+
+        // smooth the new frames of all musicians and compute their features in one pass
+        // the horizon of the GUI is read once per frame, the filters are only used by this thread
+        double horizon = predictionHorizon.load();
+        features.clear();
+        for (size_t i = 0; i < musicians.size(); i++)
+        {
+            musicians.at(i).setPredictionHorizon(horizon);
+            if (musicians.at(i).filterPose())
+            {
+                features.gather(static_cast<int>(i), musicians.at(i).getPose());
+            }
+        }
+        features.compute();
+
+        // push the floor below each musician
+        for (size_t i = 0; i < musicians.size(); i++)
+        {
+            musicians.at(i).setFeatures(features, static_cast<int>(i));
+            musicians.at(i).pushEvent(floor2D[i]);
+        }
+        publishSkeletons();
+        countFrame();
+        saveRequestedGesture();
     }
 	open = false;
 }
 
+// asks the thread to save the last frames of the first musician, the name may not contain spaces in the file
+void ttmm::KinectDevice::recordGesture(std::string const &name, PoseType type)
+{
+    {
+        std::lock_guard<std::mutex> lock(recordMutex);
+        recordName = name;
+        std::replace(recordName.begin(), recordName.end(), ' ', '_');
+        recordType = type;
+    }
+    recordRequested = true;
+}
+
+// saves the last frames of the first musician with a body, the loaded library stays as it is
+void ttmm::KinectDevice::saveRequestedGesture()
+{
+    if (!recordRequested.exchange(false))
+    {
+        return;
+    }
+    std::string name;
+    PoseType type;
+    {
+        std::lock_guard<std::mutex> lock(recordMutex);
+        name = recordName;
+        type = recordType;
+    }
+
+    for (auto &musician : musicians)
+    {
+        if (!musician.hasBody())
+        {
+            continue;
+        }
+        if (musician.getGestures().saveTemplate(GESTURE_FILE, name, type, static_cast<float>(RECORD_THRESHOLD),
+                                                RECORD_FRAMES))
+        {
+            ++gesturesRecorded;
+            ttmm::logger.write("Gesture " + name + " saved to " + GESTURE_FILE +
+                               ", it is searched for from the next start");
+        }
+        else
+        {
+            ttmm::logger.write("## Error: gesture " + name + " not saved, it needs " + std::to_string(RECORD_FRAMES) +
+                               " frames of the musician and a writable " + GESTURE_FILE);
+        }
+        return;
+    }
+    ttmm::logger.write("## Error: there is no musician to record the gesture " + name + " from");
+}
+
+// waits for the next frame of the sensor, at most FRAME_WAIT_MS
+IBodyFrame *ttmm::KinectDevice::waitForFrame()
+{
+    IBodyFrame *frame = nullptr;
+    if (frameEvent != 0)
+    {
+        if (WaitForSingleObject(reinterpret_cast<HANDLE>(frameEvent), FRAME_WAIT_MS) != WAIT_OBJECT_0)
+        {
+            return nullptr;
+        }
+        IBodyFrameArrivedEventArgs *arrived = nullptr;
+        IBodyFrameReference *reference = nullptr;
+        if (SUCCEEDED(bodyReader->GetFrameArrivedEventData(frameEvent, &arrived)) &&
+            SUCCEEDED(arrived->get_FrameReference(&reference)) && FAILED(reference->AcquireFrame(&frame)))
+        {
+            frame = nullptr;
+        }
+        safeRelease(reference);
+        safeRelease(arrived);
+        return frame;
+    }
+
+    // without the event the sensor is asked when the next frame is due, and a little later again until it is there
+    // the timestamps count from the start of the plugin, so the wait is a duration
+    Timestamp now = TimeInfo::timeInfo().now();
+    if (nextPoll > now)
+    {
+        std::this_thread::sleep_for(nextPoll - now);
+    }
+    Duration framePeriod = std::chrono::duration_cast<Duration>(std::chrono::seconds(1)) / FRAME_RATE;
+    if (FAILED(bodyReader->AcquireLatestFrame(&frame)))
+    {
+        nextPoll = TimeInfo::timeInfo().now() + framePeriod / 10;
+        return nullptr;
+    }
+    nextPoll = TimeInfo::timeInfo().now() + framePeriod - framePeriod / 10;
+    return frame;
+}
+
+// updates the counters after the events of a frame were pushed
+void ttmm::KinectDevice::countFrame()
+{
+    Timestamp pushed = TimeInfo::timeInfo().now();
+    long long processing = std::chrono::duration_cast<std::chrono::microseconds>(pushed - frameArrival).count();
+    // the frame time holds the smallest delay observed, so this is the latency above it
+    long long age = std::chrono::duration_cast<std::chrono::microseconds>(pushed - frameTime).count();
+    processingTime = processing;
+    maxProcessingTime = std::max(maxProcessingTime.load(), processing);
+    latencyAboveMinimum = age;
+    totalLatencyAboveMinimum += age;
+    ++framesProcessed;
+}
+
+// publishes the joints of the bodies tracked in the current frame, a lost body is not drawn
+void ttmm::KinectDevice::publishSkeletons()
+{
+    static_assert(MAX_BODIES <= SkeletonSnapshot::MAX_SKELETONS, "every slot fits into the snapshot");
+    SkeletonSnapshot::Frame &frame = skeletons.back();
+    frame.frameNumber = frameCount;
+    frame.count = 0;
+    for (int s = 0; s < MAX_BODIES; ++s)
+    {
+        if (musicianBodies[s] == nullptr || lastSeen[s] != frameCount)
+        {
+            continue;
+        }
+        SkeletonSnapshot::Skeleton &skeleton = frame.skeletons[frame.count++];
+        std::copy(musicianBodies[s]->getX(), musicianBodies[s]->getX() + JointType_Count, skeleton.x);
+        std::copy(musicianBodies[s]->getY(), musicianBodies[s]->getY() + JointType_Count, skeleton.y);
+        skeleton.floor = floor2D[s];
+    }
+    skeletons.publish();
+}
+
 // opens kinect sensor, bodyreader and coordinatemapper
 HRESULT ttmm::KinectDevice::initSensor()
 {
@@ -176,6 +381,11 @@ HRESULT ttmm::KinectDevice::initSensor()
 		{
 			ttmm::logger.write("get_BodyReader SUCCEEDED, Result: " +
 				std::to_string(result));
+			if (FAILED(bodyReader->SubscribeFrameArrived(&frameEvent)))
+			{
+				ttmm::logger.write("SubscribeFrameArrived FAILED, polling the sensor");
+				frameEvent = 0;
+			}
 		}
         safeRelease(bodyFrameSource);
     }
@@ -190,115 +400,329 @@ HRESULT ttmm::KinectDevice::initSensor()
     return result;
 }
 
-// gets current body-frame from camera and calls processBody() function, is
+// waits for the next body-frame from camera and calls processBody() function, is
 // called periodically by run()
-void ttmm::KinectDevice::update()
+bool ttmm::KinectDevice::update()
 {
     if (!bodyReader)
     {
-        return;
+        return false;
     }
-    IBodyFrame *frame = NULL;
-    if (SUCCEEDED(bodyReader->AcquireLatestFrame(&frame)))
+    IBodyFrame *frame = waitForFrame();
+    if (frame == nullptr)
     {
-		open = true;
-        IBody *bodies[BODY_COUNT] = {0};
-        if (SUCCEEDED(frame->GetAndRefreshBodyData(_countof(bodies), bodies)))
-        {
-            processBody(BODY_COUNT, bodies);
-        }
-        frame->get_FloorClipPlane(&floor3D);
-        mapFloorTo2D();
+        return false;
+    }
 
-        for (int i = 0; i < _countof(bodies); ++i)
+    // every frame is processed once, the frames the sensor took in between were dropped
+    INT64 relativeTime = 0;
+    bool timed = SUCCEEDED(frame->get_RelativeTime(&relativeTime));
+    if (timed && relativeTime == lastRelativeTime)
+    {
+        safeRelease(frame);
+        return false;
+    }
+    if (timed && lastRelativeTime != 0)
+    {
+        INT64 period = 10000000 / FRAME_RATE;
+        INT64 frames = (relativeTime - lastRelativeTime + period / 2) / period;
+        if (frames > 1)
         {
-            safeRelease(bodies[i]);
+            framesDropped += static_cast<unsigned long long>(frames - 1);
         }
-	}
+    }
+    if (timed)
+    {
+        lastRelativeTime = relativeTime;
+    }
+
+    open = true;
+    frameArrival = TimeInfo::timeInfo().now();
+    frameCount++;
+    frameTime = timed ? toFrameTime(relativeTime) : frameArrival;
+    IBody *bodies[BODY_COUNT] = {0};
+    Vector4 plane = {0};
+    if (SUCCEEDED(frame->get_FloorClipPlane(&plane)))
+    {
+        setFloorPlane(plane);
+    }
+    if (SUCCEEDED(frame->GetAndRefreshBodyData(_countof(bodies), bodies)))
+    {
+        processBody(BODY_COUNT, bodies);
+    }
+
+    for (int i = 0; i < _countof(bodies); ++i)
+    {
+        safeRelease(bodies[i]);
+    }
     safeRelease(frame);
+    return true;
 }
 
 // iterate through all bodies (generated by kinect sensor)
-// and put their joint positions into KinectMusicians' bodies
+// and put their joint positions into the bodies of their slots
 void ttmm::KinectDevice::processBody(int bodyCount, IBody **bodies)
 {
+    TIMED_BLOCK("KinectDevice::processBody")
+
+    if (!coordinateMapper)
+    {
+        return;
+    }
+
+    // collect the tracked bodies, the sensor does not keep their order
+    int count = 0;
+    UINT64 ids[MAX_BODIES];
+    CameraSpacePoint spines[MAX_BODIES];
+    Joint joints[MAX_BODIES][JointType_Count];
+    for (int i = 0; i < bodyCount && count < MAX_BODIES; ++i)
+    {
+        IBody *currentBody = bodies[i];
+        BOOLEAN tracked = false;
+        if (currentBody && SUCCEEDED(currentBody->get_IsTracked(&tracked)) && tracked &&
+            SUCCEEDED(currentBody->get_TrackingId(&ids[count])) &&
+            SUCCEEDED(currentBody->GetJoints(JointType_Count, joints[count])))
+        {
+            spines[count] = joints[count][JointType_SpineMid].Position;
+            ++count;
+        }
+    }
+
+    int slots[MAX_BODIES];
+    assignSlots(count, ids, spines, slots);
+
+    // the supported joints of all bodies and the floors to be mapped again, projected in one batch
+    int points = 0;
+    int floorPoints[MAX_BODIES];
+    for (int k = 0; k < count; ++k)
+    {
+        for (int j = 0; j < JointType_Count; ++j)
+        {
+            if (Body::isSupported(joints[k][j].JointType))
+            {
+                pointX[points] = joints[k][j].Position.X;
+                pointY[points] = joints[k][j].Position.Y;
+                pointZ[points] = joints[k][j].Position.Z;
+                ++points;
+            }
+        }
+        CameraSpacePoint floorPoint;
+        floorPoints[k] = -1;
+        if (floorBelow(slots[k], floorPoint))
+        {
+            floorPoints[k] = points;
+            pointX[points] = floorPoint.X;
+            pointY[points] = floorPoint.Y;
+            pointZ[points] = floorPoint.Z;
+            ++points;
+        }
+    }
+    for (int i = points; i % JointProjection::LANES != 0; ++i)
+    {
+        pointX[i] = 0;
+        pointY[i] = 0;
+        pointZ[i] = 1;
+    }
+    projectPoints(points);
+
+    int point = 0;
+    for (int k = 0; k < count; ++k)
+    {
+        // check if the slot has a body, if it has none, create new body
+        Body *b = musicianBodies[slots[k]];
+        if (b == nullptr)
+        {
+            musicianBodies[slots[k]] = new Body();
+            b = musicianBodies[slots[k]];
+        }
+
+        // store the positions of the supported joints in the body of the slot
+        b->setFrame(frameCount, frameTime);
+        for (int j = 0; j < JointType_Count; ++j)
+        {
+            if (Body::isSupported(joints[k][j].JointType))
+            {
+                b->setJoint(screenX[point], screenY[point], joints[k][j].Position.Z, joints[k][j].JointType);
+                ++point;
+            }
+        }
+        if (floorPoints[k] >= 0)
+        {
+            floor2D[slots[k]] = D2D1::Point2F(screenX[point], screenY[point]);
+            ++point;
+        }
+    }
+}
+
+// finds the slot of every tracked body, by tracking id and else by the nearest spine
+void ttmm::KinectDevice::assignSlots(int count, UINT64 const *ids, CameraSpacePoint const *spines, int *slots)
+{
+    std::array<bool, MAX_BODIES> taken;
+    taken.fill(false);
 
-    if (coordinateMapper)
+    // a known tracking id keeps its slot
+    for (int k = 0; k < count; ++k)
     {
-        for (int i = 0; i < bodyCount && i < MAX_BODIES; ++i)
+        slots[k] = -1;
+        for (int s = 0; s < MAX_BODIES; ++s)
         {
-            IBody *currentBody = bodies[i];
-            if (currentBody)
+            if (!taken[s] && lastSeen[s] != 0 && trackingIds[s] == ids[k])
             {
-                BOOLEAN tracked = false;
-                HRESULT result = currentBody->get_IsTracked(&tracked);
-                if (SUCCEEDED(result) && tracked)
-                {
+                slots[k] = s;
+                taken[s] = true;
+                break;
+            }
+        }
+    }
 
-                    // set detectedBodyIndex to first body we found
-                    // after this body ignore all other bodies
-                    //if (detectedBodyIndex != -1)
-                    //{
-                    //    if (i != detectedBodyIndex)
-                    //    {
-                    //        continue;
-                    //    }
-                    //}
-                    //detectedBodyIndex = i;
-
-                    // check if musician has a body
-                    // if he has none, create new body
-                    Body *b = musicianBodies[i];
-                    if (b == nullptr)
-                    {
-                        musicianBodies[i] = new Body();
-                        b = musicianBodies[i];
-                    }
-
-                    // get joints from current body and store their positions in musicians
-                    // body (if joint type is supported)
-                    Joint joints[JointType_Count];
-                    if (SUCCEEDED(currentBody->GetJoints(_countof(joints), joints)))
-                    {
-                        for (int j = 0; j < _countof(joints); ++j)
-                        {
-                            if (Body::isSupported(joints[j].JointType))
-                            {
-                                D2D1_POINT_2F jointPoint = mapPoint(joints[j]);
-                                b->setJoint(jointPoint.x, jointPoint.y, joints[j].JointType);
-                            }
-                            // check foot position for floor calculation
-                            if (joints[j].JointType == JointType::JointType_SpineMid)
-                            {
-                                footX = joints[j].Position.X;
-                                footZ = joints[j].Position.Z;
-                            }
-                        }
-                    }
+    // a new id gets the slot of a lost body near it, the nearest pair first
+    for (;;)
+    {
+        int nearestBody = -1;
+        int nearestSlot = -1;
+        float nearest = static_cast<float>(MATCH_DISTANCE * MATCH_DISTANCE);
+        for (int k = 0; k < count; ++k)
+        {
+            for (int s = 0; s < MAX_BODIES && slots[k] < 0; ++s)
+            {
+                if (taken[s] || lastSeen[s] == 0)
+                {
+                    continue;
+                }
+                float dx = spines[k].X - spinePositions[s].X;
+                float dy = spines[k].Y - spinePositions[s].Y;
+                float dz = spines[k].Z - spinePositions[s].Z;
+                float distance = dx * dx + dy * dy + dz * dz;
+                if (distance < nearest)
+                {
+                    nearest = distance;
+                    nearestBody = k;
+                    nearestSlot = s;
                 }
             }
         }
+        if (nearestBody < 0)
+        {
+            break;
+        }
+        slots[nearestBody] = nearestSlot;
+        taken[nearestSlot] = true;
+    }
+
+    // the others get an unused slot or the one lost for the longest time, there are as many slots as bodies
+    for (int k = 0; k < count; ++k)
+    {
+        if (slots[k] >= 0)
+        {
+            continue;
+        }
+        int oldest = -1;
+        for (int s = 0; s < MAX_BODIES; ++s)
+        {
+            if (!taken[s] && (oldest < 0 || lastSeen[s] < lastSeen[oldest]))
+            {
+                oldest = s;
+            }
+        }
+        if (lastSeen[oldest] != 0)
+        {
+            ttmm::logger.write("KinectDevice: slot " + std::to_string(oldest) + " was given to another body");
+        }
+        slots[k] = oldest;
+        taken[oldest] = true;
+    }
+
+    for (int k = 0; k < count; ++k)
+    {
+        trackingIds[slots[k]] = ids[k];
+        spinePositions[slots[k]] = spines[k];
+        lastSeen[slots[k]] = frameCount;
     }
 }
 
-// maps a joint from CameraSpace to DepthSpace and then to 2D / ScreenPosition
-D2D1_POINT_2F ttmm::KinectDevice::mapPoint(Joint joint)
+// maps the sensor time of a frame to the clock of the plugins
+ttmm::Timestamp ttmm::KinectDevice::toFrameTime(INT64 relativeTime)
 {
-    DepthSpacePoint depthPoint = {0};
-    coordinateMapper->MapCameraPointToDepthSpace(joint.Position, &depthPoint);
+    Timestamp sensorTime(std::chrono::duration_cast<Duration>(std::chrono::nanoseconds(relativeTime * 100)));
+    Duration offset = TimeInfo::timeInfo().now() - sensorTime;
+
+    // allows a drift of 0.3 ms per second at 30 frames per second
+    Duration relaxation = std::chrono::duration_cast<Duration>(std::chrono::microseconds(10));
+    clockOffset = hasClockOffset ? std::min(clockOffset + relaxation, offset) : offset;
+    hasClockOffset = true;
+    return sensorTime + clockOffset;
+}
+
+// maps the points of a frame from CameraSpace to 2D / ScreenPosition
+void ttmm::KinectDevice::projectPoints(int count)
+{
+    // the sensor knows the intrinsics as soon as it sends frames
+    if (!projection.isValid())
+    {
+        CameraIntrinsics intrinsics = {0};
+        if (SUCCEEDED(coordinateMapper->GetDepthCameraIntrinsics(&intrinsics)) &&
+            projection.setIntrinsics(intrinsics.FocalLengthX, intrinsics.FocalLengthY, intrinsics.PrincipalPointX,
+                                     intrinsics.PrincipalPointY, intrinsics.RadialDistortionSecondOrder,
+                                     intrinsics.RadialDistortionFourthOrder, intrinsics.RadialDistortionSixthOrder,
+                                     static_cast<float>(SCREEN_WIDTH) / DEPTH_WIDTH,
+                                     static_cast<float>(SCREEN_HEIGHT) / DEPTH_HEIGHT))
+        {
+            ttmm::logger.write("KinectDevice: projecting the joints with the intrinsics of the depth camera");
+        }
+    }
+    if (projection.isValid())
+    {
+        projection.project(pointX, pointY, pointZ, screenX, screenY, count);
+        return;
+    }
 
-    int width = 768;
-    int height = 689;
-    float screenPointX = static_cast<float>(depthPoint.X * width) / 512;
-    float screenPointY = static_cast<float>(depthPoint.Y * height) / 424;
+    // Depth space is the term used to describe a 2D location on the depth image.
+    // Think of this as a row / column location of a pixel where x is the column and y is the row.
+    // So x = 0, y = 0 corresponds to the top left corner of the image and x = 511, y = 423
+    // (width - 1, height - 1) is the bottom right corner of the image.
+    CameraSpacePoint cameraPoints[MAX_POINTS];
+    DepthSpacePoint depthPoints[MAX_POINTS] = {0};
+    for (int i = 0; i < count; ++i)
+    {
+        cameraPoints[i] = CameraSpacePoint{pointX[i], pointY[i], pointZ[i]};
+    }
+    if (count > 0)
+    {
+        coordinateMapper->MapCameraPointsToDepthSpace(count, cameraPoints, count, depthPoints);
+    }
+    for (int i = 0; i < count; ++i)
+    {
+        screenX[i] = depthPoints[i].X * SCREEN_WIDTH / DEPTH_WIDTH;
+        screenY[i] = depthPoints[i].Y * SCREEN_HEIGHT / DEPTH_HEIGHT;
+    }
+}
 
-    return D2D1::Point2F(screenPointX, screenPointY);
+// takes the floor plane of a frame, a frame without a floor keeps the last one
+void ttmm::KinectDevice::setFloorPlane(Vector4 const &plane)
+{
+    if (std::fabs(plane.y) < FLOOR_EPSILON)
+    {
+        return;
+    }
+    if (hasFloor && std::fabs(plane.x - floor3D.x) < FLOOR_EPSILON && std::fabs(plane.y - floor3D.y) < FLOOR_EPSILON &&
+        std::fabs(plane.z - floor3D.z) < FLOOR_EPSILON && std::fabs(plane.w - floor3D.w) < FLOOR_EPSILON)
+    {
+        return;
+    }
+    floor3D = plane;
+    hasFloor = true;
+    floorMapped.fill(false);
 }
 
-// maps floor coordinates to 2D coordinates by using the general plan equation
-void ttmm::KinectDevice::mapFloorTo2D()
+// finds the point of the floor below the spine of a slot, if its floor has to be mapped again
+bool ttmm::KinectDevice::floorBelow(int slot, CameraSpacePoint &floorPoint)
 {
-    DepthSpacePoint depthPoint = {0};
+    CameraSpacePoint const &spine = spinePositions[slot];
+    if (!hasFloor || (floorMapped[slot] && std::fabs(spine.X - floorSpines[slot].X) < FLOOR_EPSILON &&
+                      std::fabs(spine.Z - floorSpines[slot].Z) < FLOOR_EPSILON))
+    {
+        return false;
+    }
 
     // The general plane equation for floor is:
     // Ax + By + Cz + D = 0   where:
@@ -306,19 +730,9 @@ void ttmm::KinectDevice::mapFloorTo2D()
     //			B = vFloorClipPlane.y
     //			C = vFloorClipPlane.z
     //			D = vFloorClipPlane.w
-    float y =
-        (-(floor3D.x * footX) - (floor3D.z * footZ) - floor3D.w) / floor3D.y;
-    CameraSpacePoint floorPoint{footX, y, footZ};
-    coordinateMapper->MapCameraPointToDepthSpace(floorPoint, &depthPoint);
-
-	// Depth space is the term used to describe a 2D location on the depth image. 
-	// Think of this as a row / column location of a pixel where x is the column and y is the row.
-	// So x = 0, y = 0 corresponds to the top left corner of the image and x = 511, y = 423 
-	// (width - 1, height - 1) is the bottom right corner of the image.
-    int width = 768;
-    int height = 689;
-    float screenPointX = static_cast<float>(depthPoint.X * width) / 512;
-    float screenPointY = static_cast<float>(depthPoint.Y * height) / 424;
-
-    floor2D = D2D1::Point2F(screenPointX, screenPointY);
-}
\ No newline at end of file
+    float y = (-(floor3D.x * spine.X) - (floor3D.z * spine.Z) - floor3D.w) / floor3D.y;
+    floorPoint = CameraSpacePoint{spine.X, y, spine.Z};
+    floorSpines[slot] = spine;
+    floorMapped[slot] = true;
+    return true;
+}
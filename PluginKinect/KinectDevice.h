@@ -9,6 +9,9 @@
 #pragma once
 
 #include <array>
+#include <atomic>
+#include <mutex>
+#include <string>
 #include <thread>
 
 #include "Device.h"
@@ -17,6 +20,9 @@
 #include "d2d1.h"
 #include "Body.h"
 #include "PoseEvent.h"
+#include "BodyFeatures.h"
+#include "JointProjection.h"
+#include "SkeletonSnapshot.h"
 
 /**
 * @brief template function for safely releasing kinect interface objects
@@ -41,6 +47,28 @@ namespace ttmm
 *(initializing,
 * updating, closing), getting & mapping camera data
 *
+* Every tracked body keeps its slot, and so its KinectMusician, as long as it is tracked: the bodies
+* of a frame are matched to the slots by the tracking id of the sensor. A body with a new id takes the
+* slot of the nearest lost body if its spine is within MATCH_DISTANCE, which happens when the sensor
+* loses a child for a moment, otherwise an unused slot or the one lost for the longest time.
+*
+* The joints of all bodies of a frame are projected to the screen in one batch by a JointProjection,
+* made from the intrinsics of the depth camera. Until the sensor knows them, the batch is mapped by
+* the coordinate mapper in one call. The floor below a body is only mapped again when the floor plane
+* or the spine moved by more than FLOOR_EPSILON.
+*
+* The pose templates and the gestures are loaded once, before the thread starts, and the musicians
+* only read them. A gesture recorded from the GUI is appended to GESTURE_FILE by the thread and is
+* searched for from the next start of the device on.
+*
+* The thread of the device waits for the frames: on the frame arrived event of the reader, or, if it
+* can not be subscribed, by polling the sensor when the next frame of FRAME_RATE is due. Every frame
+* is processed once and only a new frame is pushed to the musicians. The counters tell how many frames
+* were processed and dropped, how long a frame took and how old its events were.
+*
+* After the events of a frame the joints of the bodies tracked in it are published to a
+* SkeletonSnapshot, the display draws from there and never touches the bodies of the thread.
+*
 * @see Device
 */
 class KinectDevice : public Device<PoseEvent>
@@ -58,12 +86,22 @@ class KinectDevice : public Device<PoseEvent>
     ~KinectDevice();
 
     using DataType = Device<PoseEvent>::DataType;
-    static const int MAX_BODIES = 1; ///<static value for the maximum amount of measured bodies
+    static const int MAX_BODIES = BODY_COUNT; ///<static value for the maximum amount of measured bodies
+    static const double MATCH_DISTANCE;        ///<largest distance in meters a lost body may have moved to get its slot back
+    static const double FLOOR_EPSILON;         ///<smaller changes of the floor plane and moves of a spine in meters keep the floor
+
+    static const int FRAME_RATE = 30;          ///<frames per second of the sensor
+    static const char *const POSE_FILE;        ///<configuration file of the pose templates of the arms
+    static const char *const GESTURE_FILE;     ///<library of the recorded gestures
+    static const int RECORD_FRAMES = 2 * FRAME_RATE; ///<number of frames of a recorded gesture
+    static const double RECORD_THRESHOLD;      ///<mean squared distance per frame of a recorded gesture
 
     /**
-  * gets current frame from camera and calls processBody() function, is called periodically by run()
+  * waits for the next frame from camera and calls processBody() function, is called periodically by run()
+  *
+  * @return true if a new frame was processed
   */
-    void update();
+    bool update();
     /**
   * checks if device is open or closed
   * 
@@ -77,26 +115,143 @@ class KinectDevice : public Device<PoseEvent>
 		return false;
 	}
 
+	/**
+	* @return the floor below the first musician in 2D
+	*/
 	D2D1_POINT_2F getFloor2D() {
-		return floor2D;
+		return floor2D[0];
+	}
+
+	/**
+	* Set how far ahead in seconds the musicians predict the joints, can be called from any thread.
+	* The device thread hands it to the musicians with the next frame.
+	*/
+	void setPredictionHorizon(double seconds) { predictionHorizon = static_cast<float>(seconds); }
+
+	/**
+	* @return how far ahead in seconds the musicians predict the joints
+	*/
+	double getPredictionHorizon() const { return predictionHorizon.load(); }
+
+	/**
+	* Save the last RECORD_FRAMES frames of the first musician with a body as a gesture, can be called
+	* from any thread. The device thread appends it to GESTURE_FILE after the next frame.
+	*
+	* @param name the name of the gesture, spaces are replaced by _
+	* @param type the pose the gesture stands for
+	*/
+	void recordGesture(std::string const &name, PoseType type);
+
+	/**
+	* @return the number of gestures saved since the device started
+	*/
+	int getGesturesRecorded() const { return gesturesRecorded.load(); }
+
+	/**
+	* @return the skeletons of the newest frame, to be read by the display only
+	*/
+	SkeletonSnapshot &getSkeletons() { return skeletons; }
+
+	/**
+	* @return the number of frames processed
+	*/
+	unsigned long long getFramesProcessed() const { return framesProcessed.load(); }
+
+	/**
+	* @return the number of frames the sensor took but were never processed
+	*/
+	unsigned long long getFramesDropped() const { return framesDropped.load(); }
+
+	/**
+	* @return the time in ms from the arrival of the last frame until its events were pushed
+	*/
+	double getProcessingTime() const { return processingTime.load() / 1000.0; }
+
+	/**
+	* @return the longest time in ms from the arrival of a frame until its events were pushed
+	*/
+	double getMaxProcessingTime() const { return maxProcessingTime.load() / 1000.0; }
+
+	/**
+	* The sensor time of a frame is mapped to our clock with the smallest delay observed so far, see
+	* toFrameTime. The absolute latency of the sensor is not known, only how much longer a frame took
+	* than the fastest one.
+	*
+	* @return the time in ms from the sensor taking the last frame until its events were pushed,
+	* above the minimum latency
+	*/
+	double getLatencyAboveMinimum() const { return latencyAboveMinimum.load() / 1000.0; }
+
+	/**
+	* @return the mean of getLatencyAboveMinimum over all frames in ms
+	*/
+	double getMeanLatencyAboveMinimum() const
+	{
+		unsigned long long frames = framesProcessed.load();
+		return frames == 0 ? 0 : totalLatencyAboveMinimum.load() / 1000.0 / frames;
 	}
 
   private:
+    static const int DEPTH_WIDTH = 512;   ///<width of the depth image
+    static const int DEPTH_HEIGHT = 424;  ///<height of the depth image
+    static const int SCREEN_WIDTH = 768;  ///<width of the screen the joints are mapped to
+    static const int SCREEN_HEIGHT = 689; ///<height of the screen the joints are mapped to
+    static const int MAX_POINTS = (MAX_BODIES * (JointType_Count + 1) + JointProjection::LANES - 1) /
+                                  JointProjection::LANES * JointProjection::LANES; ///<all joints and floors of a frame, padded
+    static const int FRAME_WAIT_MS = 100; ///<longest wait for a frame, then the thread checks whether to stop
+
 	void startup(LPCTSTR applicationPath);
     std::vector<KinectMusician> &musicians;        ///<a reference to a vector of KinectMusicians
     IKinectSensor *deviceHandle;                   ///<a pointer to kinect sensor interface
     IBodyFrameReader *bodyReader;                  ///<a pointer to kinects bodyframereader interface
     ICoordinateMapper *coordinateMapper;           ///<a pointer to kinects coordinatemapper interface
     std::array<Body *, MAX_BODIES> musicianBodies; ///<an array which stores bodies for musicians
-    int detectedBodyIndex = -1;                    ///<helper variable for body detection
+    std::array<UINT64, MAX_BODIES> trackingIds;    ///<tracking id of the body of each slot, 0 for none
+    std::array<CameraSpacePoint, MAX_BODIES> spinePositions; ///<last position of the spine of each slot
+    std::array<unsigned long long, MAX_BODIES> lastSeen;     ///<number of the last frame of each slot, 0 if never used
+    BodyFeatures features;                         ///<the features of the poses of all musicians of a frame
+    PoseClassifier poses;                          ///<the templates of the arms, loaded once and shared by the musicians
+    GestureLibrary gestures;                       ///<the recorded gestures, loaded once and shared by the musicians
+    SkeletonSnapshot skeletons;                    ///<the tracked skeletons of the last frame for the display
     std::thread deviceThread;                      ///<thread where update routine will be executed
-    bool stopDevice = false;                       ///<is set to true, when the application shall be closed
+    std::atomic<bool> stopDevice;                  ///<is set to true, when the application shall be closed
+    WAITABLE_HANDLE frameEvent = 0;                ///<signaled when the reader has a new frame, 0 if the sensor is polled
+    Timestamp nextPoll;                            ///<when the sensor is polled next, without frameEvent
 	bool open = false;							   ///<is set to true, when kinect is started
 
-    Vector4 floor3D;       ///<floor plane represented by a 4-dimensional vector (x,y,z,w)
-    D2D1_POINT_2F floor2D; ///<floor coordinates in 2D (x,y)
-    float footX;           ///<X-value of current foot position, used to calculate floor2D
-    float footZ;           ///<Z-value of current foot position, used to calculate floor2D
+    Vector4 floor3D;                                ///<floor plane represented by a 4-dimensional vector (x,y,z,w)
+    bool hasFloor = false;                          ///<whether the sensor found a floor plane yet
+    std::array<D2D1_POINT_2F, MAX_BODIES> floor2D;  ///<floor coordinates in 2D (x,y) below the spine of each slot
+    std::array<CameraSpacePoint, MAX_BODIES> floorSpines; ///<position of the spine the floor of each slot was mapped below
+    std::array<bool, MAX_BODIES> floorMapped;       ///<whether floor2D of a slot belongs to floor3D
+
+    JointProjection projection;  ///<projects camera space to the screen, once the intrinsics are known
+    float pointX[MAX_POINTS];    ///<X-values in camera space of the points of a frame
+    float pointY[MAX_POINTS];    ///<Y-values in camera space of the points of a frame
+    float pointZ[MAX_POINTS];    ///<Z-values in camera space of the points of a frame
+    float screenX[MAX_POINTS];   ///<X-values on the screen of the points of a frame
+    float screenY[MAX_POINTS];   ///<Y-values on the screen of the points of a frame
+
+    unsigned long long frameCount = 0; ///<number of frames acquired so far
+    Timestamp frameTime;               ///<time the sensor took the current frame
+    bool hasClockOffset = false;       ///<whether clockOffset was measured
+    Duration clockOffset;              ///<smallest delay between the sensor time of a frame and its arrival
+    INT64 lastRelativeTime = 0;        ///<sensor time of the last frame processed, 0 for none
+    Timestamp frameArrival;            ///<time the current frame was acquired
+
+    std::atomic<unsigned long long> framesProcessed; ///<frames processed so far
+    std::atomic<unsigned long long> framesDropped;   ///<frames the sensor took but were never processed
+    std::atomic<long long> processingTime;           ///<microseconds from the arrival of the last frame until its events were pushed
+    std::atomic<long long> maxProcessingTime;        ///<longest processingTime so far
+    std::atomic<long long> latencyAboveMinimum;      ///<microseconds from the sensor taking the last frame until its events were pushed, above the minimum
+    std::atomic<long long> totalLatencyAboveMinimum; ///<sum of latencyAboveMinimum of all frames
+    std::atomic<float> predictionHorizon;            ///<how far ahead in seconds the musicians predict the joints
+
+    std::mutex recordMutex;                          ///<guards recordName and recordType
+    std::string recordName;                          ///<name of the gesture to record
+    PoseType recordType;                             ///<pose the gesture to record stands for
+    std::atomic<bool> recordRequested;               ///<set by recordGesture(), cleared by the thread when it saves
+    std::atomic<int> gesturesRecorded;               ///<gestures saved so far
 
     /**
   * yet not implemented
@@ -108,6 +263,24 @@ class KinectDevice : public Device<PoseEvent>
   */
     void run();
     /**
+  * waits for the next frame of the sensor, at most FRAME_WAIT_MS
+  *
+  * @return the frame, nullptr if there was none
+  */
+    IBodyFrame *waitForFrame();
+    /**
+  * updates the counters after the events of a frame were pushed
+  */
+    void countFrame();
+    /**
+  * saves the gesture asked for by recordGesture(), if there is one
+  */
+    void saveRequestedGesture();
+    /**
+  * publishes the joints of the bodies tracked in the current frame to skeletons
+  */
+    void publishSkeletons();
+    /**
   * opens kinect sensor, bodyreader and coordinatemapper
   *
   * @return the result of this initialization process
@@ -122,15 +295,45 @@ class KinectDevice : public Device<PoseEvent>
   */
     void processBody(int bodyCount, IBody **bodies);
     /**
-  * maps a joint from CameraSpace to DepthSpace and then to 2D / ScreenPosition
+  * finds the slot of every tracked body of a frame, by tracking id and else by the nearest spine
   *
-  * @param joint the joint to be mapped
-  * @return the 2D position of this joint in screenspace
+  * @param count the amount of tracked bodies
+  * @param ids the tracking ids of the bodies
+  * @param spines the positions of the spines of the bodies
+  * @param[out] slots receives the slot of each body
   */
-    D2D1_POINT_2F mapPoint(Joint joint);
+    void assignSlots(int count, UINT64 const *ids, CameraSpacePoint const *spines, int *slots);
     /**
-  * maps floor coordinates to 2D coordinates by using the general plan equation
+  * maps the points of a frame from CameraSpace to 2D / ScreenPosition, by the projection
+  * if the intrinsics of the depth camera are known and else by the coordinatemapper
+  *
+  * @param count the amount of points, the padding up to JointProjection::LANES has to be set
+  */
+    void projectPoints(int count);
+    /**
+  * maps the time the sensor took a frame to the clock of the plugins.
+  * The frame with the smallest delay gives the offset, which is relaxed a little with every
+  * frame to follow the drift between the clocks. Unlike the time of arrival, the result
+  * keeps the regular spacing of the frames.
+  *
+  * @param relativeTime the time of the frame in 100 ns since the sensor started
+  * @return the time of the frame
+  */
+    Timestamp toFrameTime(INT64 relativeTime);
+    /**
+  * takes the floor plane of a frame, if it changed by more than FLOOR_EPSILON
+  *
+  * @param plane the floor plane of the frame, 0 if the sensor found no floor
+  */
+    void setFloorPlane(Vector4 const &plane);
+    /**
+  * finds the point of the floor below the spine of a slot by using the general plane equation,
+  * if the floor of the slot has to be mapped again
+  *
+  * @param slot the slot
+  * @param[out] floorPoint receives the point of the floor
+  * @return true if the floor of the slot has to be mapped
   */
-    void mapFloorTo2D();
+    bool floorBelow(int slot, CameraSpacePoint &floorPoint);
 };
 }
@@ -7,8 +7,11 @@
 #ifndef KINECT_INPUT_PLUGIN_PROCESSOR
 #define KINECT_INPUT_PLUGIN_PROCESSOR
 
+#include <algorithm>
 #include <vector>
 #include <chrono>
+#include <cstdlib>
+#include <cmath>
 
 #include "DeviceInputPluginProcessor.h"
 
@@ -39,7 +42,7 @@ public:
 		* Defaultconstructor: Create a new KinectInputPluginProcessor
 		*/
     KinectInputPluginProcessor()
-        : DeviceInputPluginProcessor<KinectDevice, KinectMusician, BUFFER_SIZE>("Kinect", device, 1)
+        : DeviceInputPluginProcessor<KinectDevice, KinectMusician, BUFFER_SIZE>("Kinect", device, 2)
         , device(musicians)
     {
     }
@@ -48,7 +51,8 @@ public:
 	{
 		FOOT_TOL,
 		HAND_TOL,
-		MATCH_TOL
+		MATCH_TOL,
+		PREDICTION_MS
 	};
 
 	void updateParam(ParameterType type, int paramValue)
@@ -68,6 +72,10 @@ public:
 		case (ParameterType::MATCH_TOL) :
 			matchTolerance = paramValue;
 			break;
+		case (ParameterType::PREDICTION_MS) :
+			// the device thread hands it to the musicians, their filters are in use there
+			device.setPredictionHorizon(paramValue / 1000.0);
+			break;
 		}
 	}
 
@@ -79,6 +87,32 @@ public:
 		return device.getFloor2D();
 	}
 
+	SkeletonSnapshot& getSkeletons() {
+		return device.getSkeletons();
+	}
+
+	/**
+	* Save the last frames of the first musician as a gesture, the device thread writes it
+	* @see KinectDevice::recordGesture
+	*/
+	void recordGesture(std::string const& name, PoseType type) {
+		device.recordGesture(name, type);
+	}
+
+	int getGesturesRecorded() const {
+		return device.getGesturesRecorded();
+	}
+
+	/**
+	* The counters of the device, see KinectDevice, the times are in ms
+	*/
+	unsigned long long getFramesProcessed() const { return device.getFramesProcessed(); }
+	unsigned long long getFramesDropped() const { return device.getFramesDropped(); }
+	double getProcessingTime() const { return device.getProcessingTime(); }
+	double getMaxProcessingTime() const { return device.getMaxProcessingTime(); }
+	double getLatencyAboveMinimum() const { return device.getLatencyAboveMinimum(); }
+	double getMeanLatencyAboveMinimum() const { return device.getMeanLatencyAboveMinimum(); }
+
 	int getParam(ParameterType type)
 	{
 		int tol = 0;
@@ -97,6 +131,9 @@ public:
 		case (ParameterType::MATCH_TOL) :
 			return matchTolerance;
 			break;
+		case (ParameterType::PREDICTION_MS) :
+			tol = static_cast<int>(std::round(device.getPredictionHorizon() * 1000.0));
+			break;
 		}
 		return tol;
 	}
@@ -119,6 +156,9 @@ protected:
         case 0: 
             parameter = { 20, 40, 40, "Feet Tolerance", "Stamp sensibility" };
             break;
+        case 1:
+            parameter = { 0, 100, 33, "Prediction", "Look ahead of the poses in ms" };
+            break;
         }
     }
     void setCustomGuiParameter(size_t index, int value) override {
@@ -127,11 +167,32 @@ protected:
             for (auto& m : musicians) {
                 m.setFootTolerance(value);
             }
+            break;
+        case 1:
+            updateParam(ParameterType::PREDICTION_MS, value);
+            break;
         default:
             break;
         }
     }
     bool canSend() { return true; }
+
+    /**
+		* Record a pose as note: the feet from 36, the arms from 60 on, plus the PoseType.
+		* The distance of the event gives the velocity. A gesture is recorded from 96 on, plus its index.
+		*/
+    bool captureNote(PoseEvent const& event, int& note, int& velocity) const override
+    {
+        if (event.bodyPart == BodyPart::GESTURE)
+        {
+            note = std::min(96 + event.value, 127);
+            velocity = 100;
+            return true;
+        }
+        note = (event.bodyPart == BodyPart::FOOTS ? 36 : 60) + static_cast<int>(event.type);
+        velocity = std::abs(event.value);
+        return true;
+    }
 	
 	juce::AudioProcessorEditor* createEditor() override; //<create custom UI for drum plugin
 	bool hasEditor() const override { return true; } 
@@ -160,6 +221,8 @@ private:
 		 * @param musi Saves the information of m
 		 */
     void calculateCustomValues(KinectMusician& m, IPCSongInfo::IPCMusician* musi) override final;
+
+    TIMER_REGISTER("TimerKinect")
 };
 }
 
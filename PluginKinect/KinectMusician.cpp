@@ -1,11 +1,23 @@
 #include "KinectMusician.h"
 
-ttmm::KinectMusician::KinectMusician(Body *b) : bodyData(b) {}
+#include <sstream>
+
+ttmm::KinectMusician::KinectMusician(Body *b, PoseClassifier const *poses, GestureLibrary const *gestureLibrary)
+    : bodyData(b), poseClassifier(poses), gestureLibrary(gestureLibrary), gestures(gestureLibrary)
+{
+}
 
 void ttmm::KinectMusician::createNewEventsToAdd(D2D1_POINT_2F const &ground, std::vector<ttmm::PoseEvent> &events)
 {
+    TIMED_BLOCK("KinectMusician::createNewEventsToAdd")
     if (bodyData)
     {
+        // the poses are classified on the smoothed joints, the stomps on the raw feet
+        if (newPose)
+        {
+            checkGestures(events);
+            newPose = false;
+        }
         checkHands(events);
         checkFoots(ground, events);
     }
@@ -13,9 +25,24 @@ void ttmm::KinectMusician::createNewEventsToAdd(D2D1_POINT_2F const &ground, std
 
 void ttmm::KinectMusician::setBody(Body *b) { bodyData = b; }
 
+bool ttmm::KinectMusician::filterPose()
+{
+    newPose = bodyData != nullptr && jointFilter.apply(*bodyData, pose);
+    return newPose;
+}
+
+void ttmm::KinectMusician::setFeatures(BodyFeatures const &batch, int slot)
+{
+    if (newPose)
+    {
+        torso = batch.getArmFeatures(slot, armFeatures);
+        hasGestureFeatures = batch.getGestureFeatures(slot, gestureFeatures);
+    }
+}
+
 /**
- * Calculate the handpositions.
- * Valid positions are:
+ * Calculate the handpositions by the nearest pose template.
+ * The default templates give:
  * TOP_LEFT
  * TOP_RIGHT
  * TOP_LEFT | TOP_RIGHT = TOP_MIDDLE
@@ -28,156 +55,107 @@ void ttmm::KinectMusician::setBody(Body *b) { bodyData = b; }
  */
 void ttmm::KinectMusician::checkHands(std::vector<ttmm::PoseEvent> &events)
 {
-    D2D1_POINT_2F handLeft = bodyData->getJointPosition(JointType_HandLeft);
-    D2D1_POINT_2F handRight = bodyData->getJointPosition(JointType_HandRight);
-    D2D1_POINT_2F spineShoulder =
-        bodyData->getJointPosition(JointType_SpineShoulder);
+    if (torso <= 0 || poseClassifier == nullptr)
+    {
+        return;
+    }
+
+    // the hand tolerance in pixels is the hysteresis between two templates
+    armsTemplate = poseClassifier->classify(armFeatures, armsTemplate, handTolerance / torso, poseDistances);
+    if (armsTemplate < 0)
+    {
+        return;
+    }
+
+    PoseType type = poseClassifier->getType(armsTemplate);
+    if (poseChanged(type, BodyPart::ARMS))
+    {
+        D2D1_POINT_2F handLeft = pose.getJointPosition(JointType_HandLeft);
+        D2D1_POINT_2F handRight = pose.getJointPosition(JointType_HandRight);
+        D2D1_POINT_2F spineShoulder = pose.getJointPosition(JointType_SpineShoulder);
+        int handsValue = static_cast<int>(std::round((handLeft.y + handRight.y) / 2.0 - spineShoulder.y));
 
-    int handsValue = static_cast<int>(std::round((handLeft.y + handRight.y) / 2.0 - spineShoulder.y));
+        std::ostringstream name;
+        name << type;
+        ttmm::logger.write("createNewEventsToAdd: " + name.str() + ", ARMS, " + std::to_string(handsValue));
+        events.emplace_back(type, BodyPart::ARMS, handsValue);
+        lastArmsPose = type;
+    }
+}
 
-    //For all poses above the shoulder
-	if ((handLeft.y < (spineShoulder.y - handTolerance)) && (handRight.y < (spineShoulder.y - handTolerance)))
+/**
+ * Search the last frames for a gesture, the event carries the index of the gesture.
+ * After a gap, e.g. when the body was lost or another child took its place, the search starts again.
+ */
+void ttmm::KinectMusician::checkGestures(std::vector<ttmm::PoseEvent> &events)
+{
+    if (!hasGestureFeatures)
     {
-        Direction d = getHandDirection(handLeft, handRight, spineShoulder);
-        switch (d)
-        {
-        case ttmm::KinectMusician::LEFT:
-            if (poseChanged(PoseType::TOP_LEFT, BodyPart::ARMS))
-            {
-                ttmm::logger.write("createNewEventsToAdd: TOP_LEFT, ARMS, " + std::to_string(handsValue));
-                events.emplace_back(PoseType::TOP_LEFT, BodyPart::ARMS, handsValue);
-                lastArmsPose = PoseType::TOP_LEFT;
-            }
-			else 
-            {
-				//ttmm::logfileKinect->write("Pose did not change: TOP_RIGHT, ARMS, " + std::to_string(handsValue));
-				// \todo: change value of pose
-            }
-            break;
-        case ttmm::KinectMusician::RIGHT:
-            if (poseChanged(PoseType::TOP_RIGHT, BodyPart::ARMS))
-            {
-                ttmm::logger.write("createNewEventsToAdd: TOP_RIGHT, ARMS, " + std::to_string(handsValue));
-                events.emplace_back(PoseType::TOP_RIGHT, BodyPart::ARMS, handsValue);
-                lastArmsPose = PoseType::TOP_RIGHT;
-            }
-            else
-            {
-                //ttmm::logfileKinect->write("Pose did not change: TOP_RIGHT, ARMS, " + std::to_string(handsValue));
-                // \todo: change value of pose
-            }
-            break;
-        case ttmm::KinectMusician::MIDDLE:
-            if (poseChanged(PoseType::TOP_LEFT | PoseType::TOP_RIGHT, BodyPart::ARMS))
-            {
-                ttmm::logger.write("createNewEventsToAdd: TOP_MIDDLE, ARMS, " + std::to_string(handsValue));
-                events.emplace_back(PoseType::TOP_LEFT | PoseType::TOP_RIGHT, BodyPart::ARMS, handsValue);
-                lastArmsPose = PoseType::TOP_LEFT | PoseType::TOP_RIGHT;
-            }
-            else
-            {
-                //ttmm::logfileKinect->write("Pose did not change: TOP_MIDDLE, ARMS, " + std::to_string(handsValue));
-                // \todo: change value of pose
-            }
-            break;
-        }
+        return;
     }
-    //Shoulder height
-    else if (((handLeft.y >= (spineShoulder.y - 10)) && (handLeft.y <= (spineShoulder.y + 10))) && ((handRight.y >= (spineShoulder.y - 10)) && (handRight.y <= (spineShoulder.y + 10))))
+    if (std::chrono::duration<double>(pose.getFrameTime() - gestureTime).count() > JointFilter::MAX_FRAME_INTERVAL)
     {
-        Direction d = getHandDirection(handLeft, handRight, spineShoulder);
-        switch (d)
-        {
-        case ttmm::KinectMusician::LEFT:
-            if (poseChanged(PoseType::MIDDLE_LEFT, BodyPart::ARMS))
-            {
-                ttmm::logger.write("createNewEventsToAdd: MIDDLE_LEFT, ARMS, " + std::to_string(handsValue));
-                events.emplace_back(PoseType::MIDDLE_LEFT, BodyPart::ARMS, handsValue);
-                lastArmsPose = PoseType::MIDDLE_LEFT;
-            }
-            else
-            {
-                //ttmm::logfileKinect->write("Pose did not change: MIDDLE_LEFT, ARMS, " + std::to_string(handsValue));
-                // \todo: change value of pose
-            }
-            break;
-        case ttmm::KinectMusician::RIGHT:
-            if (poseChanged(PoseType::MIDDLE_RIGHT, BodyPart::ARMS))
-            {
-                ttmm::logger.write("createNewEventsToAdd: MIDDLE_RIGHT, ARMS, " + std::to_string(handsValue));
-                events.emplace_back(PoseType::MIDDLE_RIGHT, BodyPart::ARMS, handsValue);
-                lastArmsPose = PoseType::MIDDLE_RIGHT;
-            }
-            else
-            {
-                // ttmm::logfileKinect->write("Pose did not change: MIDDLE_RIGHT, ARMS, " + std::to_string(handsValue));
-                // \todo: change value of pose
-            }
-            break;
-        case ttmm::KinectMusician::MIDDLE:
-            if (poseChanged(PoseType::MIDDLE_LEFT | PoseType::MIDDLE_RIGHT, BodyPart::ARMS))
-            {
-                ttmm::logger.write("createNewEventsToAdd: MIDDLE_MIDDLE, ARMS, " + std::to_string(handsValue));
-                events.emplace_back(PoseType::MIDDLE_LEFT | PoseType::MIDDLE_RIGHT, BodyPart::ARMS, handsValue);
-                lastArmsPose = PoseType::MIDDLE_LEFT | PoseType::MIDDLE_RIGHT;
-            }
-            else
-            {
-                //ttmm::logfileKinect->write("Pose did not change: MIDDLE_MIDDLE, ARMS, " + std::to_string(handsValue));
-                // \todo: change value of pose
-            }
-            break;
-        }
+        gestures.reset();
     }
-    //For all poses below the shoulder
-    else if ((handLeft.y > (spineShoulder.y + 10)) && (handRight.y > (spineShoulder.y + 10)))
+    gestureTime = pose.getFrameTime();
+    int gesture = gestures.update(gestureFeatures);
+    if (gesture >= 0)
     {
-        Direction d = getHandDirection(handLeft, handRight, spineShoulder);
-        switch (d)
-        {
-        case ttmm::KinectMusician::LEFT:
-            if (poseChanged(PoseType::BOTTOM_LEFT, BodyPart::ARMS))
-            {
-                ttmm::logger.write("createNewEventsToAdd: BOTTOM_LEFT, ARMS, " + std::to_string(handsValue));
-                events.emplace_back(PoseType::BOTTOM_LEFT, BodyPart::ARMS, handsValue);
-                lastArmsPose = PoseType::BOTTOM_LEFT;
-            }
-            else
-            {
-                //ttmm::logfileKinect->write("Pose did not change: BOTTOM_LEFT, ARMS, " + std::to_string(handsValue));
-                // \todo: change value of pose
-            }
-            break;
-        case ttmm::KinectMusician::RIGHT:
-            if (poseChanged(PoseType::BOTTOM_RIGHT, BodyPart::ARMS))
-            {
-                ttmm::logger.write("createNewEventsToAdd: BOTTOM_RIGHT, ARMS, " + std::to_string(handsValue));
-                events.emplace_back(PoseType::BOTTOM_RIGHT, BodyPart::ARMS, handsValue);
-                lastArmsPose = PoseType::BOTTOM_RIGHT;
-            }
-            else
-            {
-                //ttmm::logfileKinect->write("Pose did not change: BOTTOM_RIGHT, ARMS, " + std::to_string(handsValue));
-                // \todo: change value of pose
-            }
-            break;
-        case ttmm::KinectMusician::MIDDLE:
-            if (poseChanged(PoseType::BOTTOM_LEFT | PoseType::BOTTOM_RIGHT, BodyPart::ARMS))
-            {
-                ttmm::logger.write("createNewEventsToAdd: BOTTOM_MIDDLE, ARMS, " + std::to_string(handsValue));
-                events.emplace_back(PoseType::BOTTOM_LEFT | PoseType::BOTTOM_RIGHT, BodyPart::ARMS, handsValue);
-                lastArmsPose = PoseType::BOTTOM_LEFT | PoseType::BOTTOM_RIGHT;
-            }
-            else
-            {
-                //ttmm::logfileKinect->write("Pose did not change: BOTTOM_MIDDLE, ARMS, " + std::to_string(handsValue));
-                // \todo: change value of pose
-            }
-            break;
-        }
+        ttmm::logger.write("createNewEventsToAdd: " + gestureLibrary->getName(gesture) + ", GESTURE, " +
+                           std::to_string(gesture));
+        events.emplace_back(gestureLibrary->getType(gesture), BodyPart::GESTURE, gesture);
     }
 }
 
+/**
+ * Detect the moment a foot hits the ground from the movement of both feet.
+ * Only new frames are given to the detectors, the same frame may be pushed more than once.
+ */
+bool ttmm::KinectMusician::checkStomp(D2D1_POINT_2F const &ground, std::vector<ttmm::PoseEvent> &events)
+{
+    if (bodyData->getFrameNumber() == 0 || bodyData->getFrameNumber() == lastFrame)
+    {
+        return false;
+    }
+    lastFrame = bodyData->getFrameNumber();
+
+    float leftFoot = bodyData->getJointPosition(JointType_FootLeft).y;
+    float rightFoot = bodyData->getJointPosition(JointType_FootRight).y;
+    bool leftContact = leftStomp.update(bodyData->getFrameTime(), leftFoot, ground.y, footTolerance);
+    bool rightContact = rightStomp.update(bodyData->getFrameTime(), rightFoot, ground.y, footTolerance);
+
+    bool leftDown = leftContact || leftFoot >= ground.y - footTolerance;
+    bool rightDown = rightContact || rightFoot >= ground.y - footTolerance;
+    if (!(leftContact || rightContact) || !leftDown || !rightDown ||
+        !poseChanged(PoseType::BOTTOM_LEFT | PoseType::BOTTOM_RIGHT, BodyPart::FOOTS))
+    {
+        return false;
+    }
+
+    int differenzInHeight = static_cast<int>(std::round(leftFoot)) - static_cast<int>(std::round(rightFoot));
+    PoseEvent stomp(PoseType::BOTTOM_LEFT | PoseType::BOTTOM_RIGHT, BodyPart::FOOTS, differenzInHeight);
+    if (leftContact && rightContact)
+    {
+        stomp.timestamp = std::max(leftStomp.getContact(), rightStomp.getContact());
+    }
+    else
+    {
+        stomp.timestamp = leftContact ? leftStomp.getContact() : rightStomp.getContact();
+    }
+    // the history has to stay in order
+    if (!getHistory().isEmpty())
+    {
+        stomp.timestamp = std::max(stomp.timestamp, getHistory().getEvent(0).timestamp);
+    }
+
+    ttmm::logger.write("createNewEventsToAdd: STOMP, FEET, " + std::to_string(differenzInHeight));
+    // before the poses of the hands, which are taken now
+    events.insert(events.begin(), stomp);
+    lastFeetPose = PoseType::BOTTOM_LEFT | PoseType::BOTTOM_RIGHT;
+    lastFootHeight = 0;
+    return true;
+}
+
 /**
  * Calculate the foot Position
  * Valid PoseTypes are:
@@ -188,11 +166,20 @@ void ttmm::KinectMusician::checkHands(std::vector<ttmm::PoseEvent> &events)
  */
 void ttmm::KinectMusician::checkFoots(D2D1_POINT_2F const &ground, std::vector<ttmm::PoseEvent> &events)
 {
-    int leftFootValue = static_cast<int>(std::round(bodyData->getJointPosition(JointType_FootLeft).y));
-    int rightFootValue = static_cast<int>(std::round(bodyData->getJointPosition(JointType_FootRight).y));
+    // a foot is on the ground as soon as the raw foot is, the smoothing only delays lifting it
+    int leftFootValue = static_cast<int>(std::round(std::max(pose.getJointPosition(JointType_FootLeft).y,
+                                                             bodyData->getJointPosition(JointType_FootLeft).y)));
+    int rightFootValue = static_cast<int>(std::round(std::max(pose.getJointPosition(JointType_FootRight).y,
+                                                              bodyData->getJointPosition(JointType_FootRight).y)));
     int differenzInHeight = leftFootValue - rightFootValue;
     //ttmm::logger.write("Checking feet for ", leftFootValue, rightFootValue, ground.y);
 
+    //A foot hit the ground, the classification below would see it one frame later at the earliest
+    if (checkStomp(ground, events))
+    {
+        return;
+    }
+
     //Both feet on the ground
     if ((leftFootValue >= (ground.y - footTolerance)) &&
         (rightFootValue >= (ground.y - footTolerance)))
@@ -267,23 +254,6 @@ void ttmm::KinectMusician::checkFoots(D2D1_POINT_2F const &ground, std::vector<t
     }
 }
 
-ttmm::KinectMusician::Direction ttmm::KinectMusician::getHandDirection(D2D1_POINT_2F const &left, D2D1_POINT_2F const &right, D2D1_POINT_2F const &spineShoulder)
-{
-	if (left.x < (spineShoulder.x - handTolerance) && right.x < (spineShoulder.x - handTolerance))
-    {
-        return Direction::LEFT;
-    }
-	else if ((left.x >= (spineShoulder.x - handTolerance) && (left.x <= (spineShoulder.x + handTolerance))) && (right.x >= (spineShoulder.x - handTolerance) && (right.x <= (spineShoulder.x + handTolerance))))
-    {
-        return Direction::MIDDLE;
-    }
-	else if ((left.x >(spineShoulder.x + handTolerance)) && (right.x >(spineShoulder.x + handTolerance)))
-    {
-        return Direction::RIGHT;
-    }
-    return Direction::NOTHING;
-}
-
 bool ttmm::KinectMusician::poseChanged(ttmm::PoseType type, ttmm::BodyPart part)
 {
     if (part == BodyPart::ARMS)
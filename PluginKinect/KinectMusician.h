@@ -11,6 +11,11 @@
 #include "PoseEvent.h"
 #include "Musician.h"
 #include "KinectBuffer.h"
+#include "StompDetector.h"
+#include "JointFilter.h"
+#include "PoseClassifier.h"
+#include "GestureRecognizer.h"
+#include "BodyFeatures.h"
 
 namespace ttmm
 {
@@ -31,8 +36,10 @@ class KinectMusician : public Musician<D2D1_POINT_2F, KinectBuffer>
     /*
   * Constructor: Create a KinectMusician
   * @param b Set the body information of the child
+  * @param poses The templates of the poses of the arms, shared by all musicians
+  * @param gestureLibrary The recorded gestures, shared by all musicians
   */
-    KinectMusician(Body *b);
+    KinectMusician(Body *b, PoseClassifier const *poses, GestureLibrary const *gestureLibrary);
 
     /*
    * Destructor
@@ -79,19 +86,62 @@ class KinectMusician : public Musician<D2D1_POINT_2F, KinectBuffer>
 	void setHandTolerance(int tolerance) {
 		handTolerance = tolerance;
 	}
+	/**
+	Set how far ahead in seconds the joints are predicted for the pose detection.
+	*/
+	void setPredictionHorizon(double seconds) {
+		jointFilter.setPredictionHorizon(seconds);
+	}
+
+	/**
+	Get how far ahead in seconds the joints are predicted for the pose detection.
+	*/
+	double getPredictionHorizon() const
+	{
+		return jointFilter.getPredictionHorizon();
+	}
 	Body* getBody() {
 		return bodyData;
 	}
 
+    /**
+  * Smoothes the joints of a new frame into the pose, called once per loop of the KinectDevice.
+  * @return true if there was a new frame, its features are expected from setFeatures()
+  */
+    bool filterPose();
+
+    /**
+  * The smoothed and predicted joints the poses are detected on
+  */
+    Body const &getPose() const { return pose; }
+
+    /**
+  * The search for the gestures in the last frames, e.g. to save them as a gesture
+  */
+    GestureRecognizer const &getGestures() const { return gestures; }
+
+    /**
+  * Takes the features of the new pose from the features of all musicians.
+  * @param batch The features of the frame
+  * @param slot The slot of this musician in the batch
+  */
+    void setFeatures(BodyFeatures const &batch, int slot);
+
   private:
     Body *bodyData = nullptr; //<Saves the body information of the child
-    enum Direction
-    {
-        LEFT,
-        RIGHT,
-        MIDDLE,
-        NOTHING
-    }; //<auxiliary enum to check the hand position
+    Body pose;                //<The smoothed and predicted joints of bodyData, used to detect the poses
+    JointFilter jointFilter;  //<Smoothes bodyData into pose
+    PoseClassifier const *poseClassifier = nullptr; //<Templates of the poses of the arms, owned by the device
+    std::vector<float> poseDistances; //<Distances of pose to the templates of the arms, reused
+    int armsTemplate = -1;         //<Index of the template of the arms in the last frame, -1 for none
+    GestureLibrary const *gestureLibrary = nullptr; //<Recorded gestures, owned by the device
+    GestureRecognizer gestures;    //<Searches the last frames for the gestures of gestureLibrary
+    bool newPose = false;          //<Whether pose holds a frame the gestures have not seen
+    float torso = 0;               //<Length of the torso of pose, 0 if it has no features
+    float armFeatures[PoseClassifier::FEATURES];       //<Features of the arms of pose
+    bool hasGestureFeatures = false;                   //<Whether gestureFeatures belong to pose
+    float gestureFeatures[GestureRecognizer::FEATURES]; //<Features of pose for the gestures
+    Timestamp gestureTime;         //<Time of the last frame given to the gestures
 
     /**
   * Calculates the current foot and arm position of the child and stores this in events.
@@ -101,7 +151,7 @@ class KinectMusician : public Musician<D2D1_POINT_2F, KinectBuffer>
     void createNewEventsToAdd(D2D1_POINT_2F const &ground, std::vector<PoseEvent> &events) override final;
 
     int footTolerance = 30; //<Indicates the tolerance with which a foot is still on the ground.
-	int handTolerance = 10; //<Indicates the tolerance with which a hand is still in middle position.
+	int handTolerance = 10; //<Indicates how many pixels another pose of the hands has to be nearer than the current one.
 
     /**
   * Calculated from the current body data the positions of the hands.
@@ -115,12 +165,18 @@ class KinectMusician : public Musician<D2D1_POINT_2F, KinectBuffer>
   */
     void checkFoots(D2D1_POINT_2F const &ground, std::vector<ttmm::PoseEvent> &events);
     /**
-  * Calculates whether the hands are left, center or right from the midsection.
-  * @param left 2D point left hand
-  * @param right 2D point right Hand
-  * @param spineShoulder 2D point of the spine shoulder
+  * Searches the last frames for the recorded gestures, called once per frame.
+  * @param events Specifies the ring buffer in which the poses are stored
+  */
+    void checkGestures(std::vector<ttmm::PoseEvent> &events);
+    /**
+  * Follows the feet in every new frame and adds a stomp as soon as a foot hits the ground
+  * while the other one stands. The event carries the interpolated moment of contact.
+  * @param ground Specified the ground on which the child standing
+  * @param events Specifies the ring buffer in which the poses are stored
+  * @return true if a stomp was added
   */
-    Direction getHandDirection(D2D1_POINT_2F const &left, D2D1_POINT_2F const &right, D2D1_POINT_2F const &spineShoulder);
+    bool checkStomp(D2D1_POINT_2F const &ground, std::vector<ttmm::PoseEvent> &events);
 
     /**
    * Return true, when the type is not the last lastArmPose or lastFeetPose (depended on part)
@@ -136,5 +192,8 @@ class KinectMusician : public Musician<D2D1_POINT_2F, KinectBuffer>
     PoseType lastFeetPose;	//<Saves the last feet pose to quickly access it
 	int lastFootHeight;		//<Saves the last foot height to quickly access it
 	int maxFootHeight = 0;	//<Saves the highest foot height the musician has reached during runtime
+	StompDetector leftStomp;		//<Detects the contacts of the left foot
+	StompDetector rightStomp;		//<Detects the contacts of the right foot
+	unsigned long long lastFrame = 0;	//<Number of the last frame given to the detectors
 };
 }
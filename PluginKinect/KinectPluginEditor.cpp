@@ -10,7 +10,6 @@ namespace ttmm {
 		: AudioProcessorEditor(&p), processor(p)
 	{
 		logger.write("Plugin Window opened");
-		opened = true;
 		// set window size
 		setSize(WIN_WIDTH, WIN_HEIGHT);
 
@@ -29,6 +28,13 @@ namespace ttmm {
 		lblFootTol = new Label("lblFootTol", "Foot Tolerance");
 		lblHandTol = new Label("lblHandTol", "Hand Tolerance");
 		lblMatchTol = new Label("lblMatchTol", "Matching Tolerance");
+		txtGestureName = new TextEditor("txtGestureName", 0);
+		txtGestureType = new TextEditor("txtGestureType", 0);
+		lblGestureName = new Label("lblGestureName", "Gesture Name");
+		lblGestureType = new Label("lblGestureType", "Gesture Pose");
+		lblRecord = new Label("lblRecord", "");
+		lblFrames = new Label("lblFrames", "");
+		btnRecord = new TextButton("Record Gesture", "Click to save the last two seconds of the first musician as a gesture");
 
 		// set gui objects' parameters (size, position, listener,..)
 		int width = ((WIN_WIDTH - (canvasSize + (PADDING * 2))) - (PADDING * 2)) / 2;
@@ -39,6 +45,13 @@ namespace ttmm {
 		lblFootTol->setSize(width, height);
 		lblHandTol->setSize(width, height);
 		lblMatchTol->setSize(width, height);
+		txtGestureName->setSize(width, height);
+		txtGestureType->setSize(width, height);
+		lblGestureName->setSize(width, height);
+		lblGestureType->setSize(width, height);
+		btnRecord->setSize(width, height);
+		lblRecord->setSize(width, height * 2);
+		lblFrames->setSize(width * 2, height * 3);
 		int xposLbl = (WIN_WIDTH - (canvasSize + (PADDING * 2))) + PADDING;
 		int xposTxt = xposLbl + width;
 		txtFootTol->setTopLeftPosition(xposTxt, PADDING + 20);
@@ -47,12 +60,21 @@ namespace ttmm {
 		lblFootTol->setTopLeftPosition(xposLbl, PADDING + 20);
 		lblHandTol->setTopLeftPosition(xposLbl, PADDING + 50);
 		lblMatchTol->setTopLeftPosition(xposLbl, PADDING + 80);
+		txtGestureName->setTopLeftPosition(xposTxt, PADDING + 130);
+		txtGestureType->setTopLeftPosition(xposTxt, PADDING + 160);
+		lblGestureName->setTopLeftPosition(xposLbl, PADDING + 130);
+		lblGestureType->setTopLeftPosition(xposLbl, PADDING + 160);
+		btnRecord->setTopLeftPosition(xposLbl, PADDING + 190);
+		lblRecord->setTopLeftPosition(xposTxt, PADDING + 190);
+		lblFrames->setTopLeftPosition(xposLbl, PADDING + 240);
 		txtFootTol->addListener(this);
+		btnRecord->addListener(this);
 
 		// fill with debug infos:
 		txtFootTol->setText(juce::String(processor.getParam(KinectInputPluginProcessor::ParameterType::FOOT_TOL)), false);
 		txtHandTol->setText(juce::String(processor.getParam(KinectInputPluginProcessor::ParameterType::HAND_TOL)), false);
 		txtMatchTol->setText(juce::String(processor.getParam(KinectInputPluginProcessor::ParameterType::MATCH_TOL)), false);
+		txtGestureType->setText("TOP_LEFT|TOP_RIGHT", false);
 
 		// add gui components to editor
 		addAndMakeVisible(txtFootTol);
@@ -61,27 +83,26 @@ namespace ttmm {
 		addAndMakeVisible(lblFootTol);
 		addAndMakeVisible(lblHandTol);
 		addAndMakeVisible(lblMatchTol);
+		addAndMakeVisible(txtGestureName);
+		addAndMakeVisible(txtGestureType);
+		addAndMakeVisible(lblGestureName);
+		addAndMakeVisible(lblGestureType);
+		addAndMakeVisible(btnRecord);
+		addAndMakeVisible(lblRecord);
+		addAndMakeVisible(lblFrames);
 		addAndMakeVisible(display);
 
-		// start thread for asynchronous repainting
-		repaintThread = std::thread(&KinectPluginEditor::repaint, this);
-		if (!repaintThread.joinable())
-		{
-			ttmm::logger.write("Failed to start the Repaint Thread");
-		}
+		timerCallback();
+		startTimer(FRAMES_INTERVAL);
 	}
 
 	KinectPluginEditor::~KinectPluginEditor() 
 	{
 		ttmm::logger.write("Closing Plugin Window");
-		opened = false;
-		repaintThread.join();
+		stopTimer();
 
-		if (repaintThread.joinable())
-		{
-			ttmm::logger.write(
-				"Repaint thread still running but it shouldn't. That's weird.");
-		}
+		// the components were created with new, deleting the display also stops its timer
+		deleteAllChildren();
 	}
 
 	void KinectPluginEditor::textEditorTextChanged(TextEditor& e)
@@ -106,6 +127,36 @@ namespace ttmm {
 		}
 	}
 
+	void KinectPluginEditor::buttonClicked(Button* button)
+	{
+		if (button != btnRecord)
+		{
+			return;
+		}
+		std::string name = txtGestureName->getText().trim().toStdString();
+		PoseType type;
+		if (name.empty() || !parsePoseType(txtGestureType->getText().trim().toStdString(), type))
+		{
+			lblRecord->setText("Needs a name and a pose", dontSendNotification);
+			return;
+		}
+		//the device thread saves the frames, the gesture is searched for from the next start of the plugin
+		processor.recordGesture(name, type);
+		lblRecord->setText("Saving " + juce::String(name) + ", used from the next start", dontSendNotification);
+	}
+
+	void KinectPluginEditor::timerCallback()
+	{
+		//the counters are atomics of the device, reading them does not disturb its thread
+		juce::String frames = "Frames: " + juce::String(static_cast<juce::int64>(processor.getFramesProcessed())) +
+			" processed, " + juce::String(static_cast<juce::int64>(processor.getFramesDropped())) + " dropped\n";
+		frames += "Processing: " + juce::String(processor.getProcessingTime(), 2) + " ms (max " +
+			juce::String(processor.getMaxProcessingTime(), 2) + " ms)\n";
+		frames += "Latency above minimum: " + juce::String(processor.getLatencyAboveMinimum(), 2) + " ms (mean " +
+			juce::String(processor.getMeanLatencyAboveMinimum(), 2) + " ms)";
+		lblFrames->setText(frames, dontSendNotification);
+	}
+
 	void KinectPluginEditor::paint(Graphics& g)
 	{
 		//// fill the whole window white
@@ -1,11 +1,10 @@
 #pragma once
 
 #include "DanceDisplay.h"
-#include <thread>
 
 namespace ttmm 
 {
-	class KinectPluginEditor : public juce::AudioProcessorEditor , private juce::TextEditor::Listener
+	class KinectPluginEditor : public juce::AudioProcessorEditor , private juce::TextEditor::Listener, public Button::Listener, private juce::Timer
 	{
 		public:
 			KinectPluginEditor(KinectInputPluginProcessor &);
@@ -13,35 +12,33 @@ namespace ttmm
 
 			void paint(Graphics&) override;
 			void textEditorTextChanged(juce::TextEditor&) override;
+			void buttonClicked(Button* button) override; //<save the last frames as a gesture with btnRecord
+			void timerCallback() override; //<show the counters of the device in lblFrames
 
 		private:
 			const int WIN_WIDTH = 1000;
 			const int WIN_HEIGHT = 500;
 			const int PADDING = 10;
+			const int FRAMES_INTERVAL = 1000; //<milliseconds between two updates of lblFrames
 
 			KinectInputPluginProcessor& processor;
 
 			juce::TextEditor* txtFootTol;
 			juce::TextEditor* txtHandTol;
 			juce::TextEditor* txtMatchTol;
-			std::thread repaintThread;
+			juce::TextEditor* txtGestureName;	//<name of the gesture to record
+			juce::TextEditor* txtGestureType;	//<pose the gesture to record stands for, e.g. TOP_LEFT|TOP_RIGHT
 
 			Label* lblFootTol;
 			Label* lblHandTol;
 			Label* lblMatchTol;
+			Label* lblGestureName;
+			Label* lblGestureType;
+			Label* lblRecord;					//<tells what happened to the last recording
+			Label* lblFrames;					//<frames processed and dropped, processing time and latency above the minimum
+			TextButton* btnRecord;
 
-			DanceDisplay* display;
-			bool opened = false;
-
-			void repaint() {
-				while (opened)
-				{
-					if (display != nullptr)
-					{
-						display->repaint();
-					}
-				}
-			}
+			DanceDisplay* display;			//<draws the skeletons on its own timer
 
 			JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(KinectPluginEditor)
 	};
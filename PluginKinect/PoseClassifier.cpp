@@ -0,0 +1,148 @@
+/***********************************************************************
+* Module:  ttmm::PoseClassifier.cpp
+* Purpose: Implementation of the class PoseClassifier
+***********************************************************************/
+
+#include "PoseClassifier.h"
+
+#include <cmath>
+#include <fstream>
+#include <sstream>
+
+namespace
+{
+// adds the squared difference of one feature to the distances of all templates.
+// count is a multiple of LANES, the inner loop of fixed length is vectorized
+void addSquaredDifference(float const *__restrict column, float value, float *__restrict distances, size_t count)
+{
+    for (size_t block = 0; block < count; block += ttmm::PoseClassifier::LANES)
+    {
+        for (int lane = 0; lane < ttmm::PoseClassifier::LANES; ++lane)
+        {
+            float difference = column[block + lane] - value;
+            distances[block + lane] += difference * difference;
+        }
+    }
+}
+}
+
+// constructor, creates the nine poses the arms had before the templates
+ttmm::PoseClassifier::PoseClassifier()
+{
+    static const float columnsX[] = {-0.6f, 0.0f, 0.6f};
+    static const float rowsY[] = {-0.8f, 0.0f, 0.8f};
+    static const PoseType left[] = {PoseType::TOP_LEFT, PoseType::MIDDLE_LEFT, PoseType::BOTTOM_LEFT};
+    static const PoseType right[] = {PoseType::TOP_RIGHT, PoseType::MIDDLE_RIGHT, PoseType::BOTTOM_RIGHT};
+
+    for (int row = 0; row < 3; ++row)
+    {
+        for (int column = 0; column < 3; ++column)
+        {
+            float const features[FEATURES] = {columnsX[column], rowsY[row], columnsX[column], rowsY[row]};
+            // both hands to the left give the left pose of the row, both in the middle give both
+            PoseType type = column == 0 ? left[row] : column == 2 ? right[row] : left[row] | right[row];
+            addTemplate(type, features, 0.4f);
+        }
+    }
+}
+
+void ttmm::PoseClassifier::clear()
+{
+    types.clear();
+    for (auto &column : columns)
+    {
+        column.clear();
+    }
+    squaredRadii.clear();
+}
+
+void ttmm::PoseClassifier::addTemplate(PoseType type, float const (&features)[FEATURES], float radius)
+{
+    types.push_back(type);
+    size_t index = types.size() - 1;
+
+    // the columns are padded to whole blocks, the padding has a negative radius and is never found
+    size_t padded = (types.size() + LANES - 1) / LANES * LANES;
+    for (int f = 0; f < FEATURES; ++f)
+    {
+        columns[f].resize(padded, 0.0f);
+        columns[f][index] = features[f];
+    }
+    squaredRadii.resize(padded, -1.0f);
+    squaredRadii[index] = radius * radius;
+}
+
+// reads one template per line: type, x and y of the left hand, x and y of the right hand, radius
+bool ttmm::PoseClassifier::load(std::string const &filename)
+{
+    std::ifstream in(filename);
+    if (!in.is_open())
+    {
+        return false;
+    }
+
+    PoseClassifier loaded;
+    loaded.clear();
+    std::string line;
+    int number = 0;
+    while (std::getline(in, line))
+    {
+        ++number;
+        line.erase(line.find_last_not_of(" \t\r") + 1);
+        if (line.empty() || line[0] == '#')
+        {
+            continue;
+        }
+
+        std::istringstream fields(line);
+        std::string name;
+        PoseType type;
+        float features[FEATURES];
+        float radius;
+        fields >> name >> features[0] >> features[1] >> features[2] >> features[3] >> radius;
+        if (fields.fail() || !ttmm::parsePoseType(name, type) || radius <= 0)
+        {
+            ttmm::logger.write("PoseClassifier: skipping line " + std::to_string(number) + " of " + filename);
+            continue;
+        }
+        loaded.addTemplate(type, features, radius);
+    }
+
+    if (loaded.size() == 0)
+    {
+        ttmm::logger.write("PoseClassifier: no templates in " + filename);
+        return false;
+    }
+    ttmm::logger.write("PoseClassifier: " + std::to_string(loaded.size()) + " templates loaded from " + filename);
+    *this = loaded;
+    return true;
+}
+
+int ttmm::PoseClassifier::classify(float const (&features)[FEATURES], int current, float hysteresis,
+                                   std::vector<float> &distances) const
+{
+    size_t count = types.size();
+    distances.assign(squaredRadii.size(), 0.0f);
+    for (int f = 0; f < FEATURES; ++f)
+    {
+        addSquaredDifference(columns[f].data(), features[f], distances.data(), distances.size());
+    }
+
+    int best = -1;
+    for (size_t t = 0; t < count; ++t)
+    {
+        if (distances[t] <= squaredRadii[t] && (best < 0 || distances[t] < distances[best]))
+        {
+            best = static_cast<int>(t);
+        }
+    }
+
+    // stay with the current template unless another one is clearly nearer
+    if (best >= 0 && current >= 0 && static_cast<size_t>(current) < count && best != current &&
+        distances[current] <= squaredRadii[current] &&
+        std::sqrt(distances[best]) + hysteresis >= std::sqrt(distances[current]))
+    {
+        best = current;
+    }
+    return best;
+}
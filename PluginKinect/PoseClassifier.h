@@ -0,0 +1,106 @@
+/**
+* @file PoseClassifier.h
+* @author FH-Minden Musikinformatik 2015, KinectPlugin (Tine, Philipp, Isabell)
+* @brief Classifies the pose of the arms by the nearest of a table of templates
+*/
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "Body.h"
+#include "PoseType.h"
+
+namespace ttmm
+{
+
+/**
+	* @class PoseClassifier
+	* @brief Finds the pose template nearest to the arms of a Body.
+	*
+	* The features of a frame are the positions of both hands relative to the spine shoulder,
+	* divided by the length of the torso, so they do not depend on the size of the child or its
+	* distance to the sensor: x grows to the right, y downwards, 1 is the length of the torso.
+	* A template is a point in this feature space with a radius. The frame gets the pose of the
+	* nearest template if it lies within the radius of that template, otherwise no pose.
+	*
+	* The templates are stored as one column per feature, the distances to all templates are
+	* computed in loops without branches the compiler vectorizes. More poses only make the
+	* table longer, they add no branches.
+	*
+	* The KinectDevice loads the templates once, the musicians share them and only classify, each with
+	* its own distances.
+	*
+	* Without a configuration the nine poses of the arms are used (top, middle and bottom, each
+	* left, middle and right). A configuration file replaces them, one template per line:
+	* @code TOP_LEFT|TOP_RIGHT  0.0 -0.8  0.0 -0.8  0.4
+	* The pose type (names of PoseType joined by |), the x and y of the left hand, the x and y of
+	* the right hand and the radius. Empty lines and lines starting with # are skipped.
+	*
+	* @see KinectMusician, PoseType, BodyFeatures
+	*/
+class PoseClassifier
+{
+  public:
+    static const int FEATURES = 4; ///<number of features of a frame: left hand x, y, right hand x, y
+    static const int LANES = 4;    ///<the columns are padded to a multiple of this many floats
+
+    /**
+		* Constructor: Create a PoseClassifier with the nine default poses of the arms
+		*/
+    PoseClassifier();
+
+    /**
+		* Remove all templates
+		*/
+    void clear();
+
+    /**
+		* Add a template
+		*
+		* @param type the pose of the template
+		* @param features the features of the template
+		* @param radius the largest distance of a frame that still gets this pose
+		*/
+    void addTemplate(PoseType type, float const (&features)[FEATURES], float radius);
+
+    /**
+		* Replace the templates by the ones of a configuration file.
+		* The templates are kept if the file can not be read or holds no template.
+		*
+		* @param filename the configuration file
+		* @return true if templates were loaded
+		*/
+    bool load(std::string const &filename);
+
+    /**
+		* @return the number of templates
+		*/
+    size_t size() const { return types.size(); }
+
+    /**
+		* @param index the index of a template
+		* @return the pose of the template
+		*/
+    PoseType getType(int index) const { return types[index]; }
+
+    /**
+		* Find the template of a frame.
+		* The current template is kept unless another one is nearer by more than the hysteresis.
+		*
+		* @param features the features of the frame
+		* @param current the index of the template of the previous frame, -1 for none
+		* @param hysteresis the distance another template has to be nearer than the current one
+		* @param distances receives the squared distances to the templates, reused between the frames
+		* @return the index of the template, -1 if the frame is not within the radius of any template
+		*/
+    int classify(float const (&features)[FEATURES], int current, float hysteresis,
+                 std::vector<float> &distances) const;
+
+  private:
+    std::vector<PoseType> types;            ///<poses of the templates
+    std::vector<float> columns[FEATURES];   ///<features of the templates, one column per feature, padded
+    std::vector<float> squaredRadii;        ///<squared radii of the templates, padded
+};
+}
@@ -29,7 +29,8 @@ struct PoseEvent : public BufferData
 		* @param t Specifies the type of pose
 		* @param p Specifies if the position t is an event of the hands or feet
 		* @param v Bodypart "feet": how far away they are from the ground. <br />
-		Bodypart "hands": how far away there are from the spine shoulder.
+		Bodypart "hands": how far away there are from the spine shoulder. <br />
+		Bodypart "gesture": the index of the gesture.
 		*/
     PoseEvent(PoseType t, BodyPart p, int v) : type(t), bodyPart(p), value(v) {}
     PoseType type;     //<Specifies the type of pose
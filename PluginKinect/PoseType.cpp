@@ -1,5 +1,12 @@
 #include "PoseType.h"
 
+#include <sstream>
+
+namespace
+{
+const char *const POSE_NAMES[] = {"TOP_LEFT", "TOP_RIGHT", "MIDDLE_LEFT", "MIDDLE_RIGHT", "BOTTOM_LEFT", "BOTTOM_RIGHT"};
+}
+
 std::ostream &ttmm::operator<<(std::ostream &os, ttmm::PoseType const &pt)
 {
 
@@ -70,4 +77,42 @@ bool ttmm::bothFeetDown(ttmm::PoseType const &pose)
 bool ttmm::bothFeetUp(ttmm::PoseType const &pose)
 {
     return leftFootUp(pose) && rightFootUp(pose);
+}
+
+bool ttmm::parsePoseType(std::string const &text, ttmm::PoseType &pose)
+{
+    int bits = 0;
+    std::istringstream parts(text);
+    std::string part;
+    while (std::getline(parts, part, '|'))
+    {
+        int bit = -1;
+        for (int i = 0; i < 6; ++i)
+        {
+            if (part == POSE_NAMES[i])
+            {
+                bit = i;
+            }
+        }
+        if (bit < 0)
+        {
+            return false;
+        }
+        bits |= 1 << bit;
+    }
+    pose = static_cast<PoseType>(bits);
+    return bits != 0;
+}
+
+std::string ttmm::poseTypeName(ttmm::PoseType const &pose)
+{
+    std::string name;
+    for (int i = 0; i < 6; ++i)
+    {
+        if ((static_cast<int>(pose) >> i) & 1)
+        {
+            name += (name.empty() ? "" : "|") + std::string(POSE_NAMES[i]);
+        }
+    }
+    return name;
 }
\ No newline at end of file
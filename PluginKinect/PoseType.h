@@ -7,6 +7,7 @@
 #if !defined(__DancePlugin_PoseType_h)
 #define __DancePlugin_PoseType_h
 #include <iostream>
+#include <string>
 
 namespace ttmm
 {
@@ -69,5 +70,22 @@ bool rightFootDown(PoseType const &pose);
 bool bothFeetDown(PoseType const &pose);
 
 bool bothFeetUp(PoseType const &pose);
+
+/**
+	* Read a PoseType from the names of its bits joined by |, e.g. TOP_LEFT|TOP_RIGHT
+	*
+	* @param text the names
+	* @param[out] pose receives the PoseType
+	* @return false if a name is unknown or there is none
+	*/
+bool parsePoseType(std::string const &text, PoseType &pose);
+
+/**
+	* Write a PoseType as the names of its bits joined by |, as read by parsePoseType
+	*
+	* @param pose the PoseType
+	* @return the names
+	*/
+std::string poseTypeName(PoseType const &pose);
 }
 #endif
\ No newline at end of file
@@ -0,0 +1,26 @@
+/***********************************************************************
+* Module:  ttmm::SkeletonSnapshot.cpp
+* Purpose: Implementation of the class SkeletonSnapshot
+***********************************************************************/
+
+#include "SkeletonSnapshot.h"
+
+ttmm::SkeletonSnapshot::SkeletonSnapshot() : middle(2)
+{
+}
+
+void ttmm::SkeletonSnapshot::publish()
+{
+    // release the filled buffer, the writer goes on with the one the reader left in the middle
+    backIndex = middle.exchange(backIndex + FRESH, std::memory_order_acq_rel) % FRESH;
+}
+
+bool ttmm::SkeletonSnapshot::update()
+{
+    if (middle.load(std::memory_order_relaxed) < FRESH)
+    {
+        return false;
+    }
+    frontIndex = middle.exchange(frontIndex, std::memory_order_acq_rel) % FRESH;
+    return true;
+}
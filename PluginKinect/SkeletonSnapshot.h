@@ -0,0 +1,90 @@
+/**
+* @file SkeletonSnapshot.h
+* @author FH-Minden Musikinformatik 2015, KinectPlugin (Tine, Philipp, Isabell)
+* @brief Hands the skeletons of a frame from the device thread to the display
+*/
+
+#pragma once
+
+#include <atomic>
+
+#include "d2d1.h"
+#include "Kinect.h"
+
+namespace ttmm
+{
+
+/**
+	* @class SkeletonSnapshot
+	* @brief The screen positions of the tracked skeletons of the newest frame, triple buffered.
+	*
+	* The device thread fills the back buffer and publishes it once per frame, the display takes the
+	* newest published buffer as its front buffer. The third buffer lies in between and is swapped by
+	* one atomic exchange on each side, so neither side waits and the display never sees a buffer the
+	* device is still writing. Frames the display did not take are overwritten.
+	*
+	* There is exactly one writer and one reader.
+	*
+	* @see KinectDevice, DanceDisplay
+	*/
+class SkeletonSnapshot
+{
+  public:
+    static const int MAX_SKELETONS = BODY_COUNT; ///<skeletons of a frame
+
+    /**
+		* The joints of one skeleton on the screen of the KinectDevice, indexed by JointType
+		*/
+    struct Skeleton
+    {
+        float x[JointType_Count]; ///<X-Positions of the joints
+        float y[JointType_Count]; ///<Y-Positions of the joints
+        D2D1_POINT_2F floor;      ///<the floor below the spine
+    };
+
+    /**
+		* The skeletons of one frame
+		*/
+    struct Frame
+    {
+        unsigned long long frameNumber = 0; ///<number of the frame of the device, 0 for none
+        int count = 0;                      ///<number of skeletons
+        Skeleton skeletons[MAX_SKELETONS];  ///<the first count are tracked in this frame
+    };
+
+    /**
+		* Constructor: Create a SkeletonSnapshot without frames
+		*/
+    SkeletonSnapshot();
+
+    /**
+		* The buffer the writer fills next, only for the device thread
+		*/
+    Frame &back() { return buffers[backIndex]; }
+
+    /**
+		* Make the back buffer the newest frame, only for the device thread
+		*/
+    void publish();
+
+    /**
+		* Take the newest frame as front buffer, only for the display
+		*
+		* @return true if a frame was published since the last call
+		*/
+    bool update();
+
+    /**
+		* The frame taken by the last update(), only for the display
+		*/
+    Frame const &front() const { return buffers[frontIndex]; }
+
+  private:
+    static const int FRESH = 4; ///<marks the middle buffer as not yet taken, added to its index
+
+    Frame buffers[3];        ///<back, middle and front buffer
+    int backIndex = 0;       ///<buffer the writer fills
+    int frontIndex = 1;      ///<buffer the reader shows
+    std::atomic<int> middle; ///<buffer in between, plus FRESH if it holds a new frame
+};
+}
@@ -0,0 +1,61 @@
+/***********************************************************************
+* Module:  ttmm::StompDetector.cpp
+* Purpose: Implementation of the class StompDetector
+***********************************************************************/
+
+#include "StompDetector.h"
+#include "TimeTools.h"
+
+#include <algorithm>
+
+const double ttmm::StompDetector::MIN_FALL_SPEED = 150.0;
+const double ttmm::StompDetector::MIN_DECELERATION = 3000.0;
+const double ttmm::StompDetector::MAX_FRAME_INTERVAL = 0.2;
+
+void ttmm::StompDetector::reset()
+{
+    frames = 0;
+    velocity = 0;
+    lifted = false;
+}
+
+bool ttmm::StompDetector::update(Timestamp time, float height, float ground, int tolerance)
+{
+    double interval = std::chrono::duration<double>(time - lastTime).count();
+    if (frames > 0 && (interval <= 0 || interval > MAX_FRAME_INTERVAL))
+    {
+        // the same frame again or frames were lost, the velocity is not known
+        if (interval <= 0)
+        {
+            return false;
+        }
+        frames = 0;
+    }
+
+    bool stomp = false;
+    if (height < ground - tolerance)
+    {
+        lifted = true;
+    }
+    if (frames > 0)
+    {
+        double newVelocity = (height - lastHeight) / interval;
+        double deceleration = (velocity - newVelocity) / interval;
+
+        // the foot fell fast, stopped abruptly and is on the ground now
+        if (frames > 1 && lifted && velocity >= MIN_FALL_SPEED && deceleration >= MIN_DECELERATION
+            && height >= ground - tolerance)
+        {
+            // the foot kept its speed until it reached the height where it rests now
+            double fall = std::min(std::max((height - lastHeight) / velocity, 0.0), interval);
+            contact = timeAfter(lastTime, fall);
+            lifted = false;
+            stomp = true;
+        }
+        velocity = newVelocity;
+    }
+    frames = std::min(frames + 1, 2);
+    lastTime = time;
+    lastHeight = height;
+    return stomp;
+}
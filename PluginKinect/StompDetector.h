@@ -0,0 +1,74 @@
+/**
+* @file StompDetector.h
+* @author FH-Minden Musikinformatik 2015, KinectPlugin (Tine, Philipp, Isabell)
+* @brief Detects the moment a foot hits the ground from its vertical movement
+*/
+
+#pragma once
+
+#include "Types.h"
+
+namespace ttmm
+{
+
+/**
+	* @class StompDetector
+	* @brief Follows the height of one foot frame by frame and detects the moment it hits the ground.
+	*
+	* A falling foot stops abruptly at the ground: the velocity downwards is high in one frame and
+	* nearly zero in the next. The detector fires on this deceleration as soon as the first frame at
+	* the ground arrives, it does not wait until the pose of both feet is classified. The moment of
+	* contact is interpolated between the two frames: the foot keeps its velocity until it reaches the
+	* height where it rests, so the time is finer than the 33 ms between the frames.
+	* After a stomp the foot has to be lifted above the tolerance before the next one is detected.
+	* Heights are screen coordinates like the joints of a Body, they grow downwards.
+	*
+	* @see KinectMusician
+	*/
+class StompDetector
+{
+  public:
+    static const double MIN_FALL_SPEED;     //<Speed downwards in pixels per second before the contact
+    static const double MIN_DECELERATION;   //<Deceleration in pixels per second^2 at the contact
+    static const double MAX_FRAME_INTERVAL; //<A longer gap in seconds between two frames starts again
+
+    /**
+		* Forget the foot, e.g. when the body was lost
+		*/
+    void reset();
+
+    /**
+		* Take the height of the foot in a new frame.
+		*
+		* @param time the time the frame was taken
+		* @param height the height of the foot
+		* @param ground the height of the floor
+		* @param tolerance the distance to the floor where a foot is still on the ground
+		* @return true if the foot hit the ground in this frame
+		*/
+    bool update(Timestamp time, float height, float ground, int tolerance);
+
+    /**
+		* @return the interpolated moment of the last contact
+		*/
+    Timestamp getContact() const { return contact; }
+
+    /**
+		* @return the velocity downwards in pixels per second in the last frame
+		*/
+    double getVelocity() const { return velocity; }
+
+    /**
+		* @return true if the foot is on the ground or has not been lifted since the last contact
+		*/
+    bool isDown() const { return !lifted; }
+
+  private:
+    int frames = 0;          //<Frames since the start, at most 2 are counted
+    Timestamp lastTime;      //<Time of the previous frame
+    float lastHeight = 0;    //<Height of the foot in the previous frame
+    double velocity = 0;     //<Velocity downwards in the previous frame
+    bool lifted = false;     //<Whether the foot was above the tolerance since the last contact
+    Timestamp contact;       //<Moment of the last contact
+};
+}
@@ -0,0 +1,149 @@
+/***********************************************************************
+* Module:  VariationEngineTest.cpp
+* Purpose: Render the generated accompaniment in blocks which start on the bars and check that every note ends
+***********************************************************************/
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <thread>
+
+#include "VariationEngine.h"
+
+namespace
+{
+const double SAMPLERATE = 44100;
+const double TICKS_PER_QUARTER = 960;
+const double TICKS_PER_BAR = 4 * TICKS_PER_QUARTER;
+const int BARS = 16;      // bars of the song
+const int RENDERED = 40;  // bars rendered, the song repeats
+const int PARTS = 2;      // a bar is rendered in this many blocks, all of them start and end on the bars
+
+int failures = 0;
+
+void check(bool condition, char const *what)
+{
+    if (!condition)
+    {
+        std::printf("FAILED: %s\n", what);
+        ++failures;
+    }
+}
+
+// a song in 4/4 at 120 bpm, every bar a stroke with a chord of three tones and eight notes
+ttmm::Song makeSong()
+{
+    ttmm::Track track(0, 0, 4, 4, 0, TICKS_PER_QUARTER);
+    for (int bar = 0; bar < BARS; bar++)
+    {
+        ttmm::Stroke stroke;
+        double start = bar * TICKS_PER_BAR;
+        static const int CHORD[3] = { 60, 64, 67 };
+        for (int tone = 0; tone < 3; tone++)
+        {
+            ttmm::Node node;
+            node.setNodeNumber(CHORD[tone] + (bar % 4) * 2);
+            node.setLength(90);
+            node.setTimestamp(start);
+            node.setDelta(TICKS_PER_BAR - 40);
+            stroke.setNodeOfTone(node);
+        }
+        stroke.setStart(start);
+        stroke.setEnd(start + TICKS_PER_BAR - 40);
+        for (int quaver = 0; quaver < 8; quaver++)
+        {
+            ttmm::Node node;
+            node.setNodeNumber(60 + quaver);
+            node.setLength(80);
+            node.setTimestamp(start + quaver * TICKS_PER_QUARTER / 2);
+            node.setDelta(TICKS_PER_QUARTER / 2 - 80);
+            stroke.addNode(node);
+        }
+        track.editChannel(1, bar, stroke);
+    }
+    track.setEnd(BARS * TICKS_PER_BAR);
+
+    ttmm::TempoMap tempoMap(TICKS_PER_QUARTER);
+    tempoMap.addTempo(0, 0.5);
+    tempoMap.finalize();
+    ttmm::Song song(120);
+    song.setTempoMap(tempoMap);
+    song.addTrack(track);
+    return song;
+}
+}
+
+int main()
+{
+    ttmm::Song song = makeSong();
+    ttmm::PlaybackSchedule schedule;
+    schedule.prepare(song, SAMPLERATE);
+    check(schedule.getBarCount() == BARS, "the schedule has a bar per bar of the song");
+
+    ttmm::IPCSongInfo_IPCMusician musician;
+    musician.set_accuracy(20);
+    ttmm::VariationEngine engine;
+    engine.setEnabled(true);
+    engine.start(schedule, 0, musician);
+
+    // the notes sounding on the channel of the engine and the bar they were turned on in
+    int sounding[128];
+    std::fill(sounding, sounding + 128, -1);
+    int ons = 0, offs = 0, doubleOns = 0, strayOffs = 0, unended = 0;
+    int block = 0;
+    for (int bar = 0; bar < RENDERED; bar++)
+    {
+        int64_t start = (bar / BARS) * schedule.getLength() + schedule.getBarStart(bar % BARS);
+        int64_t end = (bar / BARS) * schedule.getLength() + schedule.getBarEnd(bar % BARS);
+        for (int part = 0; part < PARTS; part++, block++)
+        {
+            int64_t first = start + (end - start) * part / PARTS;
+            int64_t last = start + (end - start) * (part + 1) / PARTS;
+            ttmm::PlaybackBlock playback = ttmm::PlaybackBlock::atOriginalTempo(first, int(last - first));
+            juce::MidiBuffer midiBuffer;
+            engine.render(playback, midiBuffer);
+
+            juce::MidiBuffer::Iterator events(midiBuffer);
+            juce::MidiMessage message;
+            int position;
+            while (events.getNextEvent(message, position))
+            {
+                if (message.getChannel() != ttmm::VariationEngine::CHANNEL)
+                {
+                    continue;
+                }
+                int nodeNumber = message.getNoteNumber();
+                if (message.isNoteOn())
+                {
+                    ons++;
+                    doubleOns += (sounding[nodeNumber] >= 0) ? 1 : 0;
+                    sounding[nodeNumber] = bar;
+                }
+                else if (message.isNoteOff())
+                {
+                    offs++;
+                    strayOffs += (sounding[nodeNumber] < 0) ? 1 : 0;
+                    sounding[nodeNumber] = -1;
+                }
+            }
+            // a generated note ends in its bar, at the latest in the block which starts at the next bar
+            for (int nodeNumber = 0; nodeNumber < 128; nodeNumber++)
+            {
+                unended += (sounding[nodeNumber] >= 0 && sounding[nodeNumber] < bar) ? 1 : 0;
+            }
+            // the background thread generates the next bars meanwhile
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        }
+    }
+    engine.stop();
+
+    std::printf("%d bars in %d blocks: %d note ons, %d note offs, %d late bars\n", RENDERED, block, ons, offs,
+                engine.getLateBars());
+    check(ons > RENDERED, "the engine plays notes");
+    check(doubleOns == 0, "no note is turned on while it sounds");
+    check(strayOffs == 0, "every note off ends a sounding note");
+    check(unended == 0, "every note on has its note off in the block which starts at the next bar");
+    check(engine.getLateBars() == 0, "the bars are generated before they are rendered");
+
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,55 @@
+/**
+* @file DataExchange.pb.h
+* @brief The message of a musician generated by protobuf, without protobuf, so the tests build without it
+*/
+
+#pragma once
+
+#include <cstdint>
+
+namespace ttmm
+{
+
+enum IPCSongInfo_IPCMusician_Tune
+{
+    IPCSongInfo_IPCMusician_Tune_NONE = 0,
+    IPCSongInfo_IPCMusician_Tune_LEFT_UP = 1,
+    IPCSongInfo_IPCMusician_Tune_MIDDLE_UP = 2,
+    IPCSongInfo_IPCMusician_Tune_RIGHT_UP = 3,
+    IPCSongInfo_IPCMusician_Tune_LEFT_DOWN = 4,
+    IPCSongInfo_IPCMusician_Tune_MIDDLE_DOWN = 5,
+    IPCSongInfo_IPCMusician_Tune_RIGHT_DOWN = 6
+};
+
+class IPCSongInfo_IPCMusician
+{
+  public:
+    typedef IPCSongInfo_IPCMusician_Tune Tune;
+
+    int32_t accuracy() const { return accuracy_; }
+    void set_accuracy(int32_t value) { accuracy_ = value; }
+    Tune tune() const { return tune_; }
+    void set_tune(Tune value) { tune_ = value; }
+    int32_t volumech1() const { return volumech1_; }
+    void set_volumech1(int32_t value) { volumech1_ = value; }
+    int32_t volumech2() const { return volumech2_; }
+    void set_volumech2(int32_t value) { volumech2_ = value; }
+    int32_t volumech3() const { return volumech3_; }
+    void set_volumech3(int32_t value) { volumech3_ = value; }
+    bool has_tempo() const { return hasTempo_; }
+    float tempo() const { return tempo_; }
+    void set_tempo(float value) { tempo_ = value; hasTempo_ = true; }
+    float phase() const { return phase_; }
+    void set_phase(float value) { phase_ = value; }
+
+  private:
+    int32_t accuracy_ = 0;
+    Tune tune_ = IPCSongInfo_IPCMusician_Tune_MIDDLE_UP;
+    int32_t volumech1_ = 100;
+    int32_t volumech2_ = 100;
+    int32_t volumech3_ = 100;
+    bool hasTempo_ = false;
+    float tempo_ = 0.0f;
+    float phase_ = 0.0f;
+};
+}
@@ -0,0 +1,6 @@
+/**
+* @file juce_audio_formats.h
+* @brief Empty, the tests only need juce_core and juce_audio_basics
+*/
+
+#pragma once
@@ -67,11 +67,13 @@ void Channel::editStroke(int index, Stroke& stroke)
 {
     for (int i = 0; i < stroke.getAftertouchCount(); i++)
     {
-        this->strokes[index].addAftertouch(stroke.getAftertouch(i));
+        Aftertouch aftertouch = stroke.getAftertouch(i);
+        this->strokes[index].addAftertouch(aftertouch);
     }
     for (int i = 0; i < stroke.getNodeCount(); i++)
     {
-        this->strokes[index].addNode(stroke.getNode(i));
+        Node node = stroke.getNode(i);
+        this->strokes[index].addNode(node);
     }
     for (size_t i = 0; i < stroke.getNodeOfTone().size(); i++)
     {
@@ -55,10 +55,6 @@ void Node::setDelta(double delta)
     this->delta = delta;
 }
 
-void Node::setStartQuarter(vector<double> startQuarter)
-{
-    this->startQuarter = startQuarter;
-}
 void Node::setDurationQuarter(double durQuarter)
 {
     this->durQuarter = durQuarter;
@@ -102,10 +98,6 @@ double Node::getDelta()
     return this->delta;
 }
 
-vector<double> Node::getStartQuarter()
-{
-    return this->startQuarter;
-}
 double Node::getDurationQuarter()
 {
     return this->durQuarter;
@@ -113,18 +113,6 @@ public:
 		* @return the duration of a node event
 		*/
     double getDelta();
-    /**
-		* Change the timestamp of each quarter after dividing
-		*
-		* @param startQuarter a vector integer argument
-		*/
-    void setStartQuarter(vector<double> startQuarter);
-    /**
-		* Get the timestamp when the quarter notes begin
-		*
-		* @return the timestamp of the quarter notes
-		*/
-    vector<double> getStartQuarter();
     /**
 		* Change the duration of a quarter note after dividing
 		*
@@ -165,7 +153,6 @@ private:
     double delta; ///<a duration od a note from on to off
     //=========================================================================================
     NoteType nodeType = ttmm::NoteType::Quarter; ///<by default, type od a note is quarter note
-    vector<double> startQuarter; ///<separate starttime of haft/whole note to quarter notes
     double durQuarter; ///<duration of a quarter note after dividing
 };
 }
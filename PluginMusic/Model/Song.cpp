@@ -37,11 +37,11 @@ void Song::readAllTracks()
 
     for (int i = 0; i < nrTracks; i++)
     {
-        ff << "Track: " << (i + 1) << "\t Duration: " << this->tracks[i].getDurationOfTrack() << "(s) "
+        ff << "Track: " << (i + 1) << "\t Duration: " << this->tracks[i].getDurationOfTrack() << "(ticks) "
            << "\t Key: " << this->tracks[i].getKeySignature() << " Minor(1)/Major(0): " << this->tracks[i].getMinorOrMajor()
            << "\t Type: " << this->tracks[i].getNumerator() << "/" << this->tracks[i].getDenominator()
            //<< "\t Tick length: " << this->tracks[i].getTicklength()
-           << "\t Seconds per Quarter note: " << this->tracks[i].getSecondPerQuarter() << " (s)"
+           << "\t Ticks per Quarter note: " << this->tracks[i].getTicksPerQuarter()
            << std::endl;
         //return number of channels
         int nrChannels = this->tracks[i].getNumberofChannels();
@@ -78,25 +78,8 @@ void Song::readAllTracks()
                        << " velocity: " << unsigned(node.getLength())
                        << std::endl;
 
-                    if (node.getNoteType() == 1)
-                    {
-                        ff << "Quarter note to quarter notes: "
-                           << node.getStartQuarter()[0]
-                           << " " << node.getDurationQuarter() << std::endl;
-                    }
-                    if (node.getNoteType() == 2)
-                    {
-                        ff << "Divide the half note to quarter notes: "
-                           << node.getStartQuarter()[0] << " " << node.getStartQuarter()[1]
-                           << " " << node.getDurationQuarter() << std::endl;
-                    }
-                    else if (node.getNoteType() == 4)
-                    {
-                        ff << "Divide the whole note to quarter notes: "
-                           << node.getStartQuarter()[0] << " " << node.getStartQuarter()[1]
-                           << " " << node.getStartQuarter()[2] << " " << node.getStartQuarter()[3]
-                           << " " << node.getDurationQuarter() << std::endl;
-                    }
+                    ff << "Note type (quarters): " << node.getNoteType()
+                       << " duration of a quarter: " << node.getDurationQuarter() << std::endl;
                 }
                 /*
 				for (int i = 0; i < stroke.getAftertouchCount(); i++)
@@ -124,7 +107,6 @@ void Song::generateTrack(int index)
     }
     //return endtime of track
     double endTimeofTrack = this->tracks[index].getEnd();
-    double durationNote = this->tracks[index].getSecondPerQuarter();
     //return number of channels
     int nrChannels = this->tracks[index].getNumberofChannels();
     //return the list of channel number
@@ -153,13 +135,6 @@ void Song::generateTrack(int index)
             {
                 Node node = stroke.getNode(i);
                 node.setTimestamp(node.getTimestamp() + endTimeofTrack);
-                //reset start time of the quarter notes
-                vector<double> starts;
-                for (int i = 0; i < node.getNoteType(); i++)
-                {
-                    starts.push_back(node.getTimestamp() + double(i) * (durationNote));
-                }
-                node.setStartQuarter(starts);
                 //add note
                 tempStroke.addNode(node);
             }
@@ -289,3 +264,13 @@ short Song::getBpm()
 {
     return this->bpm;
 }
+
+void Song::setTempoMap(TempoMap const& tempoMap)
+{
+    this->tempoMap = tempoMap;
+}
+
+TempoMap const& Song::getTempoMap()
+{
+    return this->tempoMap;
+}
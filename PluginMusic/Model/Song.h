@@ -9,6 +9,7 @@
 
 #include <vector>
 #include "Track.h"
+#include "TempoMap.h"
 #include "../../TTMM/JuceLibraryCode/JuceHeader.h"
 #include <fstream>
 #include <string>
@@ -79,6 +80,18 @@ public:
 		* @return a short value (e.g 120 beats per minute)
 		*/
     short getBpm();
+    /**
+		* Change the tempo map of the song
+		*
+		* @param tempoMap all tempo and time signature changes of the song
+		*/
+    void setTempoMap(TempoMap const& tempoMap);
+    /**
+		* Get the tempo map to convert the ticks of the song to seconds and samples
+		*
+		* @return a reference to the tempo map
+		*/
+    TempoMap const& getTempoMap();
     /**
 		* Read all of tracks in song to a data
 		* 
@@ -102,7 +115,8 @@ public:
 	*/
 private:
     vector<Track> tracks; ///<a list of stroke
-    short bpm; ///<a beats per minute value
+    short bpm; ///<a beats per minute value at the start of the song
+    TempoMap tempoMap; ///<tempo and time signature changes of the song
 };
 }
 
@@ -0,0 +1,137 @@
+#include "SongSchedule.h"
+
+using namespace ttmm;
+
+namespace
+{
+ScheduledNode toScheduledNode(Node& node)
+{
+    ScheduledNode scheduled = {};
+    scheduled.timestamp = node.getTimestamp();
+    scheduled.delta = node.getDelta();
+    scheduled.durationQuarter = node.getDurationQuarter();
+    scheduled.nodeNumber = node.getNodeNumber();
+    scheduled.velocity = node.getLength();
+    scheduled.noteType = uint8_t(node.getNoteType());
+    return scheduled;
+}
+
+Node toNode(ScheduledNode const& scheduled)
+{
+    Node node;
+    node.setNodeNumber(scheduled.nodeNumber);
+    node.setLength(scheduled.velocity);
+    node.setTimestamp(scheduled.timestamp);
+    node.setDelta(scheduled.delta);
+    node.setDurationQuarter(scheduled.durationQuarter);
+    node.setNoteType(NoteType(scheduled.noteType));
+    return node;
+}
+}
+
+void SongSchedule::compile(Song& song)
+{
+    this->clear();
+    this->bpm = song.getBpm();
+    TempoMap const& tempoMap = song.getTempoMap();
+    this->ticksPerQuarter = tempoMap.getTicksPerQuarter();
+    this->tempos = tempoMap.getTempoChanges();
+    this->signatures = tempoMap.getTimeSignatureChanges();
+    for (int t = 0; t < song.getNumberofTracks(); t++)
+    {
+        Track* track = song.getTrackp(t);
+        ScheduledTrack scheduledTrack = {};
+        scheduledTrack.keySignature = track->getKeySignature();
+        scheduledTrack.minorOrMajor = track->getMinorOrMajor();
+        scheduledTrack.numerator = track->getNumerator();
+        scheduledTrack.denominator = track->getDenominator();
+        scheduledTrack.ticklength = track->getTicklength();
+        scheduledTrack.ticksPerQuarter = track->getTicksPerQuarter();
+        scheduledTrack.start = track->getStart();
+        scheduledTrack.end = track->getEnd();
+        scheduledTrack.originalNumbersOfStroke = track->getOriginalNumbersOfStroke();
+        scheduledTrack.firstStroke = int32_t(this->strokes.size());
+        for (int channelNr : track->getChannelNumbers())
+        {
+            Channel* channel = track->getChannelp(channelNr);
+            for (int index : channel->getStrokeNumbers())
+            {
+                Stroke* stroke = channel->getStrokep(index);
+                ScheduledStroke scheduledStroke = {};
+                scheduledStroke.channel = channelNr;
+                scheduledStroke.index = index;
+                scheduledStroke.start = stroke->getStart();
+                scheduledStroke.end = stroke->getEnd();
+                scheduledStroke.firstNode = int32_t(this->nodes.size());
+                for (auto& nodeOfTone : stroke->getNodeOfTone())
+                {
+                    this->nodes.push_back(toScheduledNode(nodeOfTone));
+                    scheduledStroke.toneCount++;
+                }
+                for (auto& node : stroke->getNodes())
+                {
+                    this->nodes.push_back(toScheduledNode(node));
+                    scheduledStroke.nodeCount++;
+                }
+                this->strokes.push_back(scheduledStroke);
+            }
+        }
+        scheduledTrack.strokeCount = int32_t(this->strokes.size()) - scheduledTrack.firstStroke;
+        this->tracks.push_back(scheduledTrack);
+    }
+}
+
+void SongSchedule::restore(Song& song) const
+{
+    song.addBPM(this->bpm);
+    TempoMap tempoMap(this->ticksPerQuarter);
+    for (auto const& change : this->tempos)
+    {
+        tempoMap.addTempo(change.tick, change.secondsPerQuarter);
+    }
+    for (auto const& change : this->signatures)
+    {
+        tempoMap.addTimeSignature(change.tick, change.numerator, change.denominator);
+    }
+    tempoMap.finalize();
+    song.setTempoMap(tempoMap);
+    for (auto const& scheduledTrack : this->tracks)
+    {
+        Track track(scheduledTrack.keySignature, scheduledTrack.minorOrMajor,
+            scheduledTrack.numerator, scheduledTrack.denominator,
+            scheduledTrack.ticklength, scheduledTrack.ticksPerQuarter);
+        track.setStart(scheduledTrack.start);
+        track.setEnd(scheduledTrack.end);
+        track.setOriginalNumbersOfStroke(scheduledTrack.originalNumbersOfStroke);
+        for (int s = 0; s < scheduledTrack.strokeCount; s++)
+        {
+            ScheduledStroke const& scheduledStroke = this->strokes[scheduledTrack.firstStroke + s];
+            Stroke stroke;
+            stroke.setStart(scheduledStroke.start);
+            stroke.setEnd(scheduledStroke.end);
+            int n = scheduledStroke.firstNode;
+            for (int i = 0; i < scheduledStroke.toneCount; i++, n++)
+            {
+                stroke.setNodeOfTone(toNode(this->nodes[n]));
+            }
+            for (int i = 0; i < scheduledStroke.nodeCount; i++, n++)
+            {
+                Node node = toNode(this->nodes[n]);
+                stroke.addNode(node);
+            }
+            track.editChannel(scheduledStroke.channel, scheduledStroke.index, stroke);
+        }
+        song.addTrack(track);
+    }
+}
+
+void SongSchedule::clear()
+{
+    this->bpm = 0;
+    this->ticksPerQuarter = 0;
+    this->tempos.clear();
+    this->signatures.clear();
+    this->tracks.clear();
+    this->strokes.clear();
+    this->nodes.clear();
+}
@@ -0,0 +1,105 @@
+/**
+* @file SongSchedule.cpp
+* @author FH-Minden Musikinformatik 2015, Musicgroup (Marcel, Patrick, Scott)
+* @brief Flat, pointer free representation of a compiled Song
+*
+*/
+#ifndef TTMM_SONG_SCHEDULE_H
+#define TTMM_SONG_SCHEDULE_H
+
+#include <vector>
+#include <cstdint>
+#include "Song.h"
+
+namespace ttmm
+{
+using std::vector;
+
+/**
+	* @struct ScheduledTrack
+	* @brief Signature infos of a track and the range of its strokes in SongSchedule::strokes
+	*/
+struct ScheduledTrack
+{
+    int32_t keySignature; ///<a key value (-7 to +7, 0 is C)
+    int32_t minorOrMajor; ///<0 is major, 1 is minor
+    int32_t numerator; ///<a numerator value
+    int32_t denominator; ///<a denominator value
+    double ticklength; ///<tick length of the tempo meta event
+    double ticksPerQuarter; ///<number of ticks for each quarter node
+    double start; ///<tick position of the first event
+    double end; ///<tick position of the end event
+    int32_t originalNumbersOfStroke; ///<number of strokes before generating
+    int32_t firstStroke; ///<index of the first stroke of this track
+    int32_t strokeCount; ///<number of strokes of this track
+    int32_t reserved; ///<keeps the struct 8 byte aligned
+};
+
+/**
+	* @struct ScheduledStroke
+	* @brief A stroke (Tonart) of a channel; its tone and nodes are stored consecutively in SongSchedule::nodes
+	*/
+struct ScheduledStroke
+{
+    int32_t channel; ///<channel number of the stroke
+    int32_t index; ///<stroke index inside the channel
+    double start; ///<start tick of stroke
+    double end; ///<end tick of stroke
+    int32_t firstNode; ///<index of the first node of tone
+    int32_t toneCount; ///<number of nodes of tone, followed by the nodes
+    int32_t nodeCount; ///<number of node events
+    int32_t reserved; ///<keeps the struct 8 byte aligned
+};
+
+/**
+	* @struct ScheduledNode
+	* @brief A node event of a stroke
+	*/
+struct ScheduledNode
+{
+    double timestamp; ///<a tick position of a note
+    double delta; ///<a duration of a note from on to off in ticks
+    double durationQuarter; ///<duration of a quarter note after dividing in ticks
+    int32_t nodeNumber; ///<a node number value (0-127)
+    uint8_t velocity; ///<a velocity of a note (0-127)
+    uint8_t noteType; ///<Quarter, Haft or Whole
+    uint8_t reserved[2]; ///<keeps the struct 8 byte aligned
+};
+
+/**
+	* @class SongSchedule
+	* @brief Flat, pointer free representation of a compiled Song.
+	*		  All members are plain arrays, so the schedule can be written to and mapped from a file as a whole.
+	*
+	* @see Song, SongCache
+	*/
+class SongSchedule
+{
+public:
+    /**
+		* Flatten all tracks of a song into this schedule
+		*
+		* @param song a reference to the compiled song
+		*/
+    void compile(Song& song);
+    /**
+		* Rebuild the Song structure from this schedule
+		*
+		* @param song a reference to an empty song object
+		*/
+    void restore(Song& song) const;
+    /**
+		* Remove all entries of the schedule
+		*/
+    void clear();
+
+    short bpm = 0; ///<a beats per minute value
+    double ticksPerQuarter = 0; ///<resolution of the tempo map
+    vector<TempoChange> tempos; ///<tempo changes of the song
+    vector<TimeSignatureChange> signatures; ///<time signature changes of the song
+    vector<ScheduledTrack> tracks; ///<all tracks of the song
+    vector<ScheduledStroke> strokes; ///<strokes of all tracks, grouped by track
+    vector<ScheduledNode> nodes; ///<nodes of tone and nodes of all strokes, grouped by stroke
+};
+}
+#endif
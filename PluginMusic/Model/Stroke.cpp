@@ -194,6 +194,27 @@ void Stroke::setStrokeType(StrokeType strokeType)
     this->strokeType = strokeType;
 }
 
+int Stroke::transpose(int nodeNumber, int terzNodeNumber, StrokeType strokeType)
+{
+    //subdominante = -7, dominante = +7
+    if (strokeType == StrokeType::Dominante || strokeType == StrokeType::MollParallelDominante)
+    {
+        nodeNumber += 7;
+        terzNodeNumber += 7;
+    }
+    else if (strokeType == StrokeType::Subdominante || strokeType == StrokeType::MollParallelSubdominante)
+    {
+        nodeNumber -= 7;
+        terzNodeNumber -= 7;
+    }
+    //moll: the terz becomes a small terz (-4), all other nodes -3
+    if (strokeType == StrokeType::MollParallelTonika || strokeType == StrokeType::MollParallelDominante || strokeType == StrokeType::MollParallelSubdominante)
+    {
+        nodeNumber -= (terzNodeNumber % 12 == nodeNumber % 12) ? 4 : 3;
+    }
+    return nodeNumber;
+}
+
 double Stroke::getStart()
 {
     return this->startStroke;
@@ -7,6 +7,7 @@
 #ifndef TTMM_STROKE_H
 #define TTMM_STROKE_H
 
+#include <cstddef>
 #include <vector>
 #include <map>
 #include "Node.h"
@@ -114,6 +115,16 @@ public:
 		* @param strokeType StrokeType the Stroke is transposed to
 		*/
     void setStrokeType(StrokeType strokeType);
+    /**
+		* Transpose a node of a Tonika stroke to a StrokeType.
+		* Unlike setStrokeType the result does not depend on the previous StrokeType.
+		*
+		* @param nodeNumber node number in the Tonika stroke
+		* @param terzNodeNumber node number of the terz of the tone (the second node of tone) in the Tonika stroke
+		* @param strokeType StrokeType the node is transposed to
+		* @return the transposed node number
+		*/
+    static int transpose(int nodeNumber, int terzNodeNumber, StrokeType strokeType);
     /**
 		* Get the timestamp of the first event in Stroke
 		*
@@ -0,0 +1,159 @@
+#include "TempoMap.h"
+
+#include <algorithm>
+
+using namespace ttmm;
+
+namespace
+{
+const double DEFAULT_SECONDS_PER_QUARTER = 0.5; //120 bpm, the default of a midi file
+
+//find the last entry with key(entry) <= value, or the first entry if there is none
+template <typename T, typename Key>
+T const& lastAtOrBefore(vector<T> const& entries, double value, Key key)
+{
+    auto it = std::upper_bound(entries.begin(), entries.end(), value,
+        [&key](double v, T const& entry) { return v < key(entry); });
+    return it == entries.begin() ? *it : *(it - 1);
+}
+
+//sort the changes by tick, of several changes at the same tick the last added one wins
+template <typename T>
+void sortAndMerge(vector<T>& changes)
+{
+    std::stable_sort(changes.begin(), changes.end(),
+        [](T const& a, T const& b) { return a.tick < b.tick; });
+    vector<T> merged;
+    for (auto const& change : changes)
+    {
+        if (!merged.empty() && merged.back().tick == change.tick)
+        {
+            merged.back() = change;
+        }
+        else
+        {
+            merged.push_back(change);
+        }
+    }
+    changes.swap(merged);
+}
+}
+
+TempoMap::TempoMap(double ticksPerQuarter)
+    : ticksPerQuarter(ticksPerQuarter)
+{
+    this->finalize();
+}
+
+double TempoMap::getTicksPerQuarter() const
+{
+    return this->ticksPerQuarter;
+}
+
+void TempoMap::addTempo(double tick, double secondsPerQuarter)
+{
+    TempoChange change = { tick, secondsPerQuarter, 0 };
+    this->tempos.push_back(change);
+}
+
+void TempoMap::addTimeSignature(double tick, int numerator, int denominator)
+{
+    TimeSignatureChange change = { tick, numerator, denominator, 0 };
+    this->signatures.push_back(change);
+}
+
+void TempoMap::finalize()
+{
+    sortAndMerge(this->tempos);
+    sortAndMerge(this->signatures);
+    if (this->tempos.empty() || this->tempos.front().tick > 0)
+    {
+        TempoChange change = { 0, DEFAULT_SECONDS_PER_QUARTER, 0 };
+        this->tempos.insert(this->tempos.begin(), change);
+    }
+    if (this->signatures.empty() || this->signatures.front().tick > 0)
+    {
+        TimeSignatureChange change = { 0, 4, 4, 0 };
+        this->signatures.insert(this->signatures.begin(), change);
+    }
+    //the first change is the origin, every further change continues the previous one
+    this->tempos[0].seconds = this->tempos[0].tick * this->tempos[0].secondsPerQuarter / this->ticksPerQuarter;
+    for (size_t i = 1; i < this->tempos.size(); i++)
+    {
+        TempoChange const& previous = this->tempos[i - 1];
+        this->tempos[i].seconds = previous.seconds
+            + (this->tempos[i].tick - previous.tick) * previous.secondsPerQuarter / this->ticksPerQuarter;
+    }
+    this->signatures[0].bar = this->signatures[0].tick / this->ticksPerBar(this->signatures[0]);
+    for (size_t i = 1; i < this->signatures.size(); i++)
+    {
+        TimeSignatureChange const& previous = this->signatures[i - 1];
+        this->signatures[i].bar = previous.bar
+            + (this->signatures[i].tick - previous.tick) / this->ticksPerBar(previous);
+    }
+}
+
+TempoChange const& TempoMap::tempoAtTick(double tick) const
+{
+    return lastAtOrBefore(this->tempos, tick, [](TempoChange const& c) { return c.tick; });
+}
+
+double TempoMap::tickToSeconds(double tick) const
+{
+    TempoChange const& change = this->tempoAtTick(tick);
+    return change.seconds + (tick - change.tick) * change.secondsPerQuarter / this->ticksPerQuarter;
+}
+
+double TempoMap::secondsToTick(double seconds) const
+{
+    TempoChange const& change = lastAtOrBefore(this->tempos, seconds, [](TempoChange const& c) { return c.seconds; });
+    return change.tick + (seconds - change.seconds) * this->ticksPerQuarter / change.secondsPerQuarter;
+}
+
+double TempoMap::tickToSamples(double tick, double samplerate) const
+{
+    return this->tickToSeconds(tick) * samplerate;
+}
+
+double TempoMap::samplesToTick(double samples, double samplerate) const
+{
+    return this->secondsToTick(samples / samplerate);
+}
+
+double TempoMap::ticksPerBar(TimeSignatureChange const& signature) const
+{
+    return this->ticksPerQuarter * 4.0 * double(signature.numerator) / double(signature.denominator);
+}
+
+double TempoMap::tickToBar(double tick) const
+{
+    TimeSignatureChange const& signature = this->getTimeSignature(tick);
+    return signature.bar + (tick - signature.tick) / this->ticksPerBar(signature);
+}
+
+double TempoMap::barToTick(double bar) const
+{
+    TimeSignatureChange const& signature = lastAtOrBefore(this->signatures, bar,
+        [](TimeSignatureChange const& c) { return c.bar; });
+    return signature.tick + (bar - signature.bar) * this->ticksPerBar(signature);
+}
+
+double TempoMap::getBpm(double tick) const
+{
+    return 60.0 / this->tempoAtTick(tick).secondsPerQuarter;
+}
+
+TimeSignatureChange const& TempoMap::getTimeSignature(double tick) const
+{
+    return lastAtOrBefore(this->signatures, tick, [](TimeSignatureChange const& c) { return c.tick; });
+}
+
+vector<TempoChange> const& TempoMap::getTempoChanges() const
+{
+    return this->tempos;
+}
+
+vector<TimeSignatureChange> const& TempoMap::getTimeSignatureChanges() const
+{
+    return this->signatures;
+}
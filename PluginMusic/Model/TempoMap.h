@@ -0,0 +1,175 @@
+/**
+* @file TempoMap.cpp
+* @author FH-Minden Musikinformatik 2015, Musicgroup (Marcel, Patrick, Scott)
+* @brief Piecewise linear conversion between midi ticks, seconds and samples
+*
+*/
+#ifndef TTMM_TEMPO_MAP_H
+#define TTMM_TEMPO_MAP_H
+
+#include <vector>
+#include <cstdint>
+
+namespace ttmm
+{
+using std::vector;
+
+/**
+	* @struct TempoChange
+	* @brief A set-tempo meta event and the time in seconds it starts at
+	*/
+struct TempoChange
+{
+    double tick; ///<position of the tempo change in ticks
+    double secondsPerQuarter; ///<new tempo of the song
+    double seconds; ///<position of the tempo change in seconds, calculated by TempoMap::finalize
+};
+
+/**
+	* @struct TimeSignatureChange
+	* @brief A time-signature meta event and the bar it starts at
+	*/
+struct TimeSignatureChange
+{
+    double tick; ///<position of the time signature in ticks
+    int32_t numerator; ///<a numerator value
+    int32_t denominator; ///<a denominator value
+    double bar; ///<position of the time signature in bars, calculated by TempoMap::finalize
+};
+
+/**
+	* @class TempoMap
+	* @brief Keeps all tempo and time signature changes of a song.
+	*		  Schedules are stored in ticks, the tempo map converts them to seconds and samples
+	*		  by a binary search over the changes, so a tempo change never touches a node.
+	*		  Before the first and after the last change the neighbouring tempo is continued.
+	*
+	* @see Song, MidiReader
+	*/
+class TempoMap
+{
+public:
+    /**
+		* Constructor: create a TempoMap with 120 bpm and 4/4, the defaults of a midi file
+		*
+		* @param ticksPerQuarter resolution of the midi file
+		*/
+    TempoMap(double ticksPerQuarter = 960);
+    /**
+		* Get the resolution of the tempo map
+		*
+		* @return number of ticks of a quarter note
+		*/
+    double getTicksPerQuarter() const;
+    /**
+		* Add a set-tempo meta event, call finalize when all changes are added
+		*
+		* @param tick position of the tempo change
+		* @param secondsPerQuarter the new tempo
+		*/
+    void addTempo(double tick, double secondsPerQuarter);
+    /**
+		* Add a time-signature meta event, call finalize when all changes are added
+		*
+		* @param tick position of the time signature
+		* @param numerator a numerator value
+		* @param denominator a denominator value
+		*/
+    void addTimeSignature(double tick, int numerator, int denominator);
+    /**
+		* Sort the changes and calculate their positions in seconds and bars
+		*/
+    void finalize();
+    /**
+		* Convert a position in ticks to seconds
+		*
+		* @param tick a position in ticks
+		* @return the position in seconds
+		*/
+    double tickToSeconds(double tick) const;
+    /**
+		* Convert a position in seconds to ticks
+		*
+		* @param seconds a position in seconds
+		* @return the position in ticks
+		*/
+    double secondsToTick(double seconds) const;
+    /**
+		* Convert a position in ticks to samples
+		*
+		* @param tick a position in ticks
+		* @param samplerate samplerate of host
+		* @return the position in samples
+		*/
+    double tickToSamples(double tick, double samplerate) const;
+    /**
+		* Convert a position in samples to ticks
+		*
+		* @param samples a position in samples
+		* @param samplerate samplerate of host
+		* @return the position in ticks
+		*/
+    double samplesToTick(double samples, double samplerate) const;
+    /**
+		* Convert a position in ticks to bars
+		*
+		* @param tick a position in ticks
+		* @return the position in bars, the first bar starts at 0
+		*/
+    double tickToBar(double tick) const;
+    /**
+		* Convert a position in bars to ticks
+		*
+		* @param bar a position in bars, the first bar starts at 0
+		* @return the position in ticks
+		*/
+    double barToTick(double bar) const;
+    /**
+		* Get the tempo at a position
+		*
+		* @param tick a position in ticks
+		* @return beats per minute at the position
+		*/
+    double getBpm(double tick) const;
+    /**
+		* Get the time signature at a position
+		*
+		* @param tick a position in ticks
+		* @return the time signature change in effect at the position
+		*/
+    TimeSignatureChange const& getTimeSignature(double tick) const;
+    /**
+		* Get all tempo changes, sorted by tick
+		*
+		* @return a list of tempo changes
+		*/
+    vector<TempoChange> const& getTempoChanges() const;
+    /**
+		* Get all time signature changes, sorted by tick
+		*
+		* @return a list of time signature changes
+		*/
+    vector<TimeSignatureChange> const& getTimeSignatureChanges() const;
+
+private:
+    /**
+		* Get the number of ticks of a bar in a time signature
+		*
+		* @param signature a time signature
+		* @return ticks per bar
+		*/
+    double ticksPerBar(TimeSignatureChange const& signature) const;
+    /**
+		* Get the tempo change in effect at a position
+		*
+		* @param tick a position in ticks
+		* @return the last change before the position or the first change
+		*/
+    TempoChange const& tempoAtTick(double tick) const;
+
+    double ticksPerQuarter; ///<resolution of the song
+    vector<TempoChange> tempos; ///<tempo changes sorted by tick, never empty after finalize
+    vector<TimeSignatureChange> signatures; ///<time signature changes sorted by tick, never empty after finalize
+};
+}
+#endif
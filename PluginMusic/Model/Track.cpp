@@ -2,14 +2,14 @@
 
 using namespace ttmm;
 
-Track::Track(int ks, int mm, int numerator, int denominator, double tl, double spqn)
+Track::Track(int ks, int mm, int numerator, int denominator, double tl, double tpqn)
 {
     this->KeySignature = ks;
     this->minorOrmajor = mm;
     this->numerator = numerator;
     this->denominator = denominator;
     this->ticklength = tl;
-    this->secondperquarter = spqn;
+    this->ticksperquarter = tpqn;
     this->channels.clear();
 }
 
@@ -79,14 +79,14 @@ void Track::setTicklength(double tl)
     this->ticklength = tl;
 }
 
-double Track::getSecondPerQuarter()
+double Track::getTicksPerQuarter()
 {
-    return this->secondperquarter;
+    return this->ticksperquarter;
 }
 
-void Track::setSecondPerQuarter(double spqn)
+void Track::setTicksPerQuarter(double tpqn)
 {
-    this->secondperquarter = spqn;
+    this->ticksperquarter = tpqn;
 }
 
 int Track::getNumerator()
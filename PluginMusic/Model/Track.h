@@ -31,9 +31,9 @@ public:
 		* @param numerator a numerator argument
 		* @param denominator a denominator argument
 		* @param tl tick length of note
-		* @param spqn second per quarter note
+		* @param tpqn ticks per quarter note
 		*/
-    Track(int ks, int mm, int numerator, int denominator, double tl, double spqn);
+    Track(int ks, int mm, int numerator, int denominator, double tl, double tpqn);
     /**
 		* Destructor
 		*/
@@ -51,17 +51,17 @@ public:
 		*/
     void setTicklength(double tl);
     /**
-		* Get the SecondPerQuarter of the track
+		* Get the TicksPerQuarter of the track
 		*					
-		* @return the double value of SecondPerQuarter
+		* @return the double value of TicksPerQuarter
 		*/
-    double getSecondPerQuarter();
+    double getTicksPerQuarter();
     /**
-		* Change the SecondPerQuarter of a track
+		* Change the TicksPerQuarter of a track
 		*
-		* @param spqn a double argument					
+		* @param tpqn a double argument					
 		*/
-    void setSecondPerQuarter(double spqn);
+    void setTicksPerQuarter(double tpqn);
     /**
 		* Get the numerator of the track
 		* 
@@ -175,31 +175,31 @@ public:
     /**
 		* Get the timestamp of the first event in Track
 		* 
-		* @return a timestamp value (tick per frame)
+		* @return a timestamp value (ticks)
 		*/
     double getStart();
     /**
 		* Change the timestamp of the first event in Track
 		*
-		* @param startTrack a timestamp value (tick per frame)
+		* @param startTrack a timestamp value (ticks)
 		*/
     void setStart(double startTrack);
     /**
 		* Get the timestamp of the last event in Track
 		*
-		* @return a timestamp value (tick per frame)
+		* @return a timestamp value (ticks)
 		*/
     double getEnd();
     /**
 		* Change the timestamp of the last event in Track
 		*
-		* @param endTrack a timestamp value (tick per frame)
+		* @param endTrack a timestamp value (ticks)
 		*/
     void setEnd(double endTrack);
     /**
 		* Get the duration of a track
 		*
-		* @return duration of a track with a integer value
+		* @return duration of a track in ticks
 		*/
     double getDurationOfTrack();
 
@@ -215,7 +215,7 @@ private:
     int numerator; ///<a numerator value
     int denominator; ///<a denominator value
     double ticklength;
-    double secondperquarter; ///<number of seconds for each quarter node
+    double ticksperquarter; ///<number of ticks for each quarter node, seconds follow from the TempoMap of the Song
 
     std::map<int, Channel> channels; ///<a map object of (channel number, node/aftertouch events)
     double startTrack = 0; ///<time position of the first event
@@ -2,18 +2,42 @@
 #include "TimeTools.h"
 #include "MusicPluginEditor.h"
 
+#include <algorithm>
+#include <limits>
+
 using namespace ttmm;
 
+const double DynamicComposition::START_TIME = -5;
+const double DynamicComposition::FOLLOW_SMOOTHING = 0.3;
+const double DynamicComposition::FOLLOW_PHASE_GAIN = 0.2;
+const double DynamicComposition::FOLLOW_PHASE_AVERAGING = 0.05;
+const double DynamicComposition::MAX_PHASE_CORRECTION = 0.05;
+
 //constructor for this plugin
 ttmm::DynamicComposition::DynamicComposition()
     : GeneralPluginProcessor("Dynamic Composition", 0)
     , connection{ this, true }
+    , library(MidiReader::getSongFolder())
+    , songBpm(0)
+    , barCount(0)
+    , seekBar(-1)
+    , loopBars(-1)
+    , tempoFollowing(false)
 {
+    //track i records channel i + 1
+    for (int channel = 1; channel <= 16; channel++)
+    {
+        this->recorder.addTrack("Kanal " + std::to_string(channel));
+    }
 }
 
 //destructor for this plugin
 ttmm::DynamicComposition::~DynamicComposition()
 {
+    //the threads use the playing song, it is deleted last
+    this->renderer.stop();
+    this->loader.stop();
+    delete this->playing;
 	// Disconnecting would be obvious and shouldn't do harm - but this causes a memory leak.
 	// The connection is closed anyway in the destructor of IPCConnection.
 	// connection.disconnect();
@@ -29,8 +53,16 @@ void ttmm::DynamicComposition::processAudioAndMidiSignals(
     //call this for each block to merge IPC musicians to local musician
     //then get this result for updating the notes
     this->mergeMusicians();
+    if (this->playing == nullptr)
+    {
+        return;
+    }
+    this->renderer.setMusician(this->songInfo.musician().Get(0));
+    this->followTempo(this->playing->schedule);
 
     TIMED_BLOCK("processAudioAndMidiSignals")
+    //the recording counts from the time zero shared with the input plugins
+    double blockTime = TimeInfo::timeInfo().ns(TimeInfo::timeInfo().now()) / 1000000000.0;
     /*======================================================================================*/
     //
     //	Iterate through the events with a timeStamp within this processBlock i.e.
@@ -45,19 +77,68 @@ void ttmm::DynamicComposition::processAudioAndMidiSignals(
     /*======================================================================================*/
     //get Buffersize of block from Audiobuffer
     auto numSamples = audioBuffer.samples;
-    //set number of second for each block
-    double numSecondsInThisBlock = (double)numSamples / this->samplerate;
+    //a jump requested by the GUI takes effect at the start of this block
+    PlaybackSchedule const* schedule = &this->playing->schedule;
+    int bar = this->seekBar.exchange(-1);
+    if (bar >= 0 && bar < schedule->getBarCount())
+    {
+        this->seekTo(schedule->getBarStart(bar), midiMessages, 0);
+    }
+    //the transport advances in samples, scaled by the tempo rate chosen in the GUI;
+    //at the end of a loop or at a change of the song the block is split and the second part starts at the new position
+    int done = 0;
+    while (done < numSamples)
+    {
+        int64_t songChange = this->getSongChange(this->transport.getPositionInSamples());
+        if (this->transport.getPositionInSamples() >= songChange)
+        {
+            this->changeSongNow(midiMessages, done);
+            schedule = &this->playing->schedule;
+        }
+        int64_t loopEnd = std::numeric_limits<int64_t>::max();
+        int64_t loop = this->loopBars.load();
+        if (loop >= 0)
+        {
+            int firstBar = int(loop >> 32);
+            int lastBar = int(loop & 0xFFFFFFFF);
+            if (firstBar <= lastBar && lastBar < schedule->getBarCount())
+            {
+                loopEnd = schedule->getBarEnd(lastBar);
+                if (this->transport.getPositionInSamples() >= loopEnd)
+                {
+                    this->seekTo(schedule->getBarStart(firstBar), midiMessages, done);
+                }
+            }
+            else
+            {
+                //the loop was set for a song with more bars, unless the GUI set a new one meanwhile it ends
+                this->loopBars.compare_exchange_strong(loop, -1);
+            }
+        }
+        int64_t end = std::min(loopEnd, this->getSongChange(this->transport.getPositionInSamples()));
+        PlaybackBlock block = this->transport.nextBlock(numSamples - done, done, end);
+        //the events were rendered ahead by the background thread, only copy them
+        this->renderer.render(block, midiMessages);
+        this->metronome.render(*schedule, block, midiMessages);
+        done += block.numSamples;
+    }
     /*======================================================================================*/
-    auto lol = this->song.getTrackp(0);
 #ifdef DEBUG
-    ttmm::logfileMusic->write("New Playtime: ", this->playTime);
+    ttmm::logfileMusic->write("New Playtime: ", this->transport.getPositionInSeconds());
     /*======================================================================================*/
     ttmm::logfileMusic->write(std::to_string(this->songInfo.musician().Get(0).accuracy()));
     ttmm::logfileMusic->write(std::to_string(this->songInfo.musician().Get(0).tune()));
 #endif
     /*======================================================================================*/
-    mHandler.processTrackToNewMidiBuffer(lol, midiMessages,
-        playTime, numSecondsInThisBlock, numSamples, this->songInfo.musician().Get(0));
+#ifdef DEBUG
+    ttmm::logfileMusic->write("Lookahead underruns: ", this->renderer.getUnderruns());
+    ttmm::logfileMusic->write("Late variation bars: ", this->renderer.getLateVariationBars());
+    ttmm::logfileMusic->write("Dropped log notes: ", this->noteLog.getDropped());
+    if (schedule->getStream() != nullptr)
+    {
+        ttmm::logfileMusic->write("Missed song pages: ", schedule->getStream()->getMisses());
+    }
+#endif
 
     if (midiMessages.getNumEvents() > 0)
     {
@@ -65,11 +146,18 @@ void ttmm::DynamicComposition::processAudioAndMidiSignals(
         //ttmm::logfileMusic->write("Number of events in Buffer: ", midiMessages.getNumEvents());
         MidiMessage m;
         int sampleposition;
+        //the editor shows the notes, they are only queued here and never block the audio thread
+        bool logNotes = (this->getActiveEditor() != nullptr);
         for (MidiBuffer::Iterator i(midiMessages); i.getNextEvent(m, sampleposition);)
         {
+            this->recorder.record(m.getChannel() - 1, blockTime + sampleposition / this->samplerate, m);
             if (m.isNoteOn())
             {
-				((MusicPluginEditor*)this->getActiveEditor())->addContent("Spiele Note auf Channel: " + std::to_string(m.getChannel()) + " mit Wert: " + std::to_string(m.getNoteNumber()));
+                if (logNotes)
+                {
+                    NoteLogEntry entry = { int64_t(m.getTimeStamp()), uint8_t(m.getChannel()), uint8_t(m.getNoteNumber()), m.getVelocity() };
+                    this->noteLog.push(entry);
+                }
                 //ttmm::logfileMusic->write("Note On: ", m.getChannel(), m.getNoteNumber(), unsigned(m.getVelocity()), m.getTimeStamp(), sampleposition);
             }
             else if (m.isNoteOff())
@@ -85,6 +173,10 @@ void ttmm::DynamicComposition::mergeMusicians()
 {
     IPCSongInfo_IPCMusician m;
     auto local = this->localmusician;
+    //the musicians play together, the song follows the average of their tempos
+    float tempoSum = 0;
+    float phaseSum = 0;
+    int tempoCount = 0;
     for (auto const& m : musiciansToMerge)
     {
         local->set_accuracy(m.accuracy());
@@ -107,11 +199,215 @@ void ttmm::DynamicComposition::mergeMusicians()
         {
             local->set_volumech3(m.volumech3());
         }
+        if (m.has_tempo() && m.tempo() > 0)
+        {
+            tempoSum += m.tempo();
+            phaseSum += m.phase();
+            tempoCount++;
+        }
         //todo channel 4
     }
+    if (tempoCount > 0)
+    {
+        local->set_tempo(tempoSum / tempoCount);
+        local->set_phase(phaseSum / tempoCount);
+        this->tempoReceived = true;
+    }
     musiciansToMerge.clear();
 }
 
+//the loader reads and compiles the song, the audio thread changes to it at the next bar
+void ttmm::DynamicComposition::changeSong(std::string songname)
+{
+    this->loader.request(songname);
+}
+
+void ttmm::DynamicComposition::setSetlist(std::vector<std::string> const& songnames)
+{
+    this->loader.setSetlist(songnames);
+}
+
+SongLibrary const& ttmm::DynamicComposition::getLibrary() const
+{
+    return this->library;
+}
+
+int64_t ttmm::DynamicComposition::getSongChange(int64_t position) const
+{
+    PlaybackSchedule const& schedule = this->playing->schedule;
+    int64_t length = schedule.getLength();
+    int64_t inTrack = (length > 0 && position > 0) ? position % length : 0;
+    if (this->loader.isReady(SongLoader::NEXT_BAR))
+    {
+        //during the count-in or without bars the song changes immediately
+        if (position < 0 || schedule.getBarCount() == 0)
+        {
+            return position;
+        }
+        return position - inTrack + schedule.getBarEnd(schedule.getBarAt(inTrack));
+    }
+    if (this->loader.isReady(SongLoader::END_OF_SONG))
+    {
+        return (length > 0) ? std::max(int64_t(0), position - inTrack) + length : position;
+    }
+    return std::numeric_limits<int64_t>::max();
+}
+
+void ttmm::DynamicComposition::changeSongNow(juce::MidiBuffer& midiBuffer, int position)
+{
+    LoadedSong* next = this->loader.take(SongLoader::NEXT_BAR);
+    if (next == nullptr)
+    {
+        next = this->loader.take(SongLoader::END_OF_SONG);
+    }
+    if (next == nullptr)
+    {
+        return;
+    }
+    //the old song is deleted by the loader, when the background thread of the renderer left it
+    LoadedSong* old = this->playing;
+    this->playing = next;
+    this->transport.seek(0);
+    uint32_t seek = this->renderer.setSchedule(next->schedule, next->handler, 0, midiBuffer, position);
+    this->metronome.seek(midiBuffer, position);
+    this->loader.retire(old, next, seek);
+    this->seekBar.store(-1);
+    this->loopBars.store(-1);
+    this->adoptSong();
+}
+
+void ttmm::DynamicComposition::adoptSong()
+{
+    this->songBpm.store(this->playing->song.getBpm());
+    this->barCount.store(this->playing->schedule.getBarCount());
+}
+
+//change the tempo without touching the song, the transport reads the rate once per block
+void ttmm::DynamicComposition::setTempoRate(double rate)
+{
+    this->transport.setRate(rate);
+}
+
+double ttmm::DynamicComposition::getTempoRate() const
+{
+    return this->transport.getRate();
+}
+
+//the metronome reads its settings once per block
+void ttmm::DynamicComposition::setMetronomeSubdivision(int subdivision)
+{
+    this->metronome.setSubdivision(subdivision);
+}
+
+int ttmm::DynamicComposition::getMetronomeSubdivision() const
+{
+    return this->metronome.getSubdivision();
+}
+
+void ttmm::DynamicComposition::setMetronomeAccents(bool accents)
+{
+    this->metronome.setAccents(accents);
+}
+
+bool ttmm::DynamicComposition::hasMetronomeAccents() const
+{
+    return this->metronome.hasAccents();
+}
+
+//the accompaniment is generated ahead, the windows already rendered are played unchanged
+void ttmm::DynamicComposition::setVariation(bool enabled)
+{
+    this->renderer.setVariation(enabled);
+}
+
+bool ttmm::DynamicComposition::hasVariation() const
+{
+    return this->renderer.hasVariation();
+}
+
+//the rate is adjusted by the audio thread with the next estimate of the musicians
+void ttmm::DynamicComposition::setTempoFollowing(bool enabled)
+{
+    this->tempoFollowing.store(enabled);
+}
+
+bool ttmm::DynamicComposition::isTempoFollowing() const
+{
+    return this->tempoFollowing.load();
+}
+
+//the rate which plays the beat at the position in the tempo of the musicians, corrected by their phase
+void ttmm::DynamicComposition::followTempo(PlaybackSchedule const& schedule)
+{
+    if (!this->tempoReceived)
+    {
+        return;
+    }
+    this->tempoReceived = false;
+    std::vector<int64_t> const& beats = schedule.getBeats();
+    int64_t length = schedule.getLength();
+    if (!this->tempoFollowing.load() || beats.size() < 2 || length <= 0)
+    {
+        return;
+    }
+    int64_t position = this->transport.getPositionInSamples();
+    int64_t inTrack = (position > 0) ? position % length : 0;
+    int beat = std::min(schedule.getBeatAt(inTrack), int(beats.size()) - 2);
+    double songTempo = 60.0 * this->samplerate / double(beats[beat + 1] - beats[beat]);
+    //the input plugins see the events later than the clicks, only a change of the phase is corrected
+    double phase = this->localmusician->phase();
+    this->usualPhase += (phase - this->usualPhase) * FOLLOW_PHASE_AVERAGING;
+    double correction = std::min(std::max(FOLLOW_PHASE_GAIN * (phase - this->usualPhase), -MAX_PHASE_CORRECTION), MAX_PHASE_CORRECTION);
+    double target = this->localmusician->tempo() / songTempo * (1.0 - correction);
+    double rate = this->transport.getRate();
+    this->transport.setRate(rate + (target - rate) * FOLLOW_SMOOTHING);
+}
+
+//the jump is done by the audio thread with the next block
+void ttmm::DynamicComposition::seekToBar(int bar)
+{
+    if (bar < 1 || bar > this->getBarCount())
+    {
+        ttmm::logfileMusic->write("invalid bar to jump to: ", bar);
+        return;
+    }
+    this->seekBar.store(bar - 1);
+}
+
+void ttmm::DynamicComposition::setLoop(int firstBar, int lastBar)
+{
+    if (firstBar < 1 || lastBar < firstBar || lastBar > this->getBarCount())
+    {
+        ttmm::logfileMusic->write("invalid loop, first bar: ", firstBar);
+        return;
+    }
+    this->loopBars.store((int64_t(firstBar - 1) << 32) | int64_t(lastBar - 1));
+    this->seekBar.store(firstBar - 1);
+}
+
+void ttmm::DynamicComposition::clearLoop()
+{
+    this->loopBars.store(-1);
+}
+
+int ttmm::DynamicComposition::getBarCount() const
+{
+    return this->barCount.load();
+}
+
+int ttmm::DynamicComposition::readNoteLog(NoteLogEntry* entries, int maxEntries)
+{
+    return this->noteLog.pop(entries, maxEntries);
+}
+
+//end the sounding notes, move the transport and continue rendering at the new position
+void ttmm::DynamicComposition::seekTo(int64_t sample, juce::MidiBuffer& midiBuffer, int position)
+{
+    this->transport.seek(sample);
+    this->renderer.seek(sample, midiBuffer, position);
+    this->metronome.seek(midiBuffer, position);
+}
+
 //this function is called by ipc connection, when a message has arrived
 void ttmm::DynamicComposition::receivedIPC(IPCSongInfo object)
 {
@@ -10,9 +10,19 @@
 #include "FileWriter.h"
 #include "GeneralPluginProcessor.h"
 #include "../Model/Song.h"
+#include "../Model/SongSchedule.h"
 #include "../src/MidiReader.h"
+#include "../src/LookaheadRenderer.h"
+#include "../src/Metronome.h"
+#include "../src/NoteLog.h"
 #include "../src/MidiHandler.h"
+#include "../src/PlaybackSchedule.h"
+#include "../src/Transport.h"
+#include "../src/SongCache.h"
+#include "../src/SongLoader.h"
+#include "../src/SongLibrary.h"
 #include "IPCConnection.h"
+#include "PerformanceRecorder.h"
 #include "TimeTools.h"
 
 namespace ttmm
@@ -47,19 +57,25 @@ public:
     void initializePlugin(Samplerate sampleRate) final override
     {
         this->samplerate = sampleRate;
-        // read Midifile to Songobj
-        songname = this->mReader.readToSong(this->song);
-        ttmm::logfileMusic->write("read mididata to Song structure");
-        //generate track
-        for (int i = 0; i < 4; i++)
+        //the background threads read the schedule, stop them before the song changes
+        this->renderer.stop();
+        this->loader.stop();
+        //the bars of the previous song are not valid any more
+        this->seekBar.store(-1);
+        this->loopBars.store(-1);
+        //the first selected song is loaded now, the others are played after it as a setlist
+        std::vector<std::string> songnames = MidiReader::readSelectedSongs();
+        delete this->playing;
+        this->playing = SongLoader::load(songnames.empty() ? std::string() : songnames[0], this->samplerate);
+        if (this->playing == nullptr)
         {
-            this->song.generateTrack(0);
+            //nothing is played until a song is chosen
+            this->playing = new LoadedSong();
+            this->playing->schedule.prepare(this->playing->song, this->samplerate);
         }
-        ttmm::logfileMusic->write("generated track 0th of Song");
-        // for test whether or not we have read Midifile to Songobj exactly
-        this->song.readAllTracks();
-        ttmm::logfileMusic->write("printed out the song structure");
-        ttmm::logfileMusic->write("Playtime of plugin music at: ", this->playTime);
+        this->adoptSong();
+        this->transport.prepare(this->samplerate, START_TIME);
+        ttmm::logfileMusic->write("Playtime of plugin music at: ", this->transport.getPositionInSeconds());
         //std::cout << "Samplerate: " << this->samplerate << std::endl;
 
         //fill the songinfo object with the default values
@@ -71,13 +87,27 @@ public:
         musician->set_volumech2(77);
         musician->set_volumech3(50);
         connection.createPipe(PIPE_NAME, 1000);
+        this->renderer.start(this->playing->schedule, this->transport.getPositionInSamples(), this->songInfo.musician().Get(0));
+        this->loader.start(this->samplerate, this->renderer, *this->playing);
+        this->library.startScan();
+        if (songnames.size() > 1)
+        {
+            this->loader.setSetlist(std::vector<std::string>(songnames.begin() + 1, songnames.end()));
+        }
 
         //save the playTime and system time of plugin music to a file, when pluginMusic starts
         std::ofstream fstartPluginMusic;
         fstartPluginMusic.open("bigbang.txt", std::ios::out);
         auto timebase = TimeInfo::timeInfo().realtimeInNanoseconds();
-        fstartPluginMusic << timebase << " " << this->playTime << std::endl;
+        fstartPluginMusic << timebase << " " << this->transport.getPositionInSeconds() << std::endl;
         fstartPluginMusic.close();
+
+        //the input plugins take the same time zero from bigbang.txt, so the recordings line up
+        TimeInfo::timeInfo().setTimeZeroFromSeconds(timebase / 1000000000.0 + std::abs(this->transport.getPositionInSeconds()));
+        if (!this->recorder.start(PerformanceRecorder::makeFile("Musik")))
+        {
+            ttmm::logfileMusic->write("## Error: Starting the recording failed!");
+        }
     }
     /**
 		* override the virtual function of the class Audio processeor
@@ -85,6 +115,9 @@ public:
 		*/
     void shutdown() final override
     {
+        this->renderer.stop();
+        this->loader.stop();
+        this->recorder.stop();
         // Disconnecting would be obvious and shouldn't do harm - but this causes a memory leak.
         // The connection is closed anyway in the destructor of IPCConnection.
         // connection.disconnect();
@@ -107,22 +140,185 @@ public:
 		* @param object a SongInfo object received through IPC
 		*/
     void receivedIPC(IPCSongInfo object) override final;
+    /**
+		* Load a song in the background, it replaces the current song at the next bar.
+		* Can be called from the GUI thread.
+		*
+		* @param songname the name of the song file in the Soundfiles folder
+		*/
+    void changeSong(std::string songname);
+    /**
+		* Set the songs which are played one after another when the current song ends,
+		* the next one is always preloaded. Can be called from the GUI thread.
+		*
+		* @param songnames the names of the song files in the Soundfiles folder
+		*/
+    void setSetlist(std::vector<std::string> const& songnames);
+    /**
+		* Get the index of the songs in the Soundfiles folder
+		*
+		* @return the library, it is scanned in the background when the plugin is initialized
+		*/
+    SongLibrary const& getLibrary() const;
 	String getSongName() {
-		return songname;
+		return loader.getPlayingName();
 	}
 	String getSongTempo() {
-		return std::to_string(song.getBpm());
+		return std::to_string(int(songBpm.load() * transport.getRate() + 0.5));
 	}
+    /**
+		* Change the playback tempo relative to the tempo of the song, can be called from the GUI thread
+		*
+		* @param rate 1.0 is the tempo of the song
+		*/
+    void setTempoRate(double rate);
+    /**
+		* Get the playback tempo relative to the tempo of the song
+		*
+		* @return 1.0 is the tempo of the song
+		*/
+    double getTempoRate() const;
+    /**
+		* Set the number of metronome clicks per beat, can be called from the GUI thread
+		*
+		* @param subdivision clicks per beat, 0 turns the metronome off
+		*/
+    void setMetronomeSubdivision(int subdivision);
+    /**
+		* Get the number of metronome clicks per beat
+		*
+		* @return clicks per beat, 0 if the metronome is off
+		*/
+    int getMetronomeSubdivision() const;
+    /**
+		* Turn the accent of the first beat of a bar on or off, can be called from the GUI thread
+		*
+		* @param accents true to accent the first beat of a bar
+		*/
+    void setMetronomeAccents(bool accents);
+    /**
+		* Check whether the metronome accents the first beat of a bar
+		*
+		* @return true if the accents are on
+		*/
+    bool hasMetronomeAccents() const;
+    /**
+		* Turn the accompaniment generated from the musician state on or off, can be called from the GUI thread
+		*
+		* @param enabled true to play the generated accompaniment on channel 6
+		*/
+    void setVariation(bool enabled);
+    /**
+		* Check whether the generated accompaniment is played
+		*
+		* @return true if it is played
+		*/
+    bool hasVariation() const;
+    /**
+		* Let the tempo of the song follow the tempo the musicians play in, can be called from the GUI thread.
+		* The input plugins estimate the tempo and phase of the musicians, the rate of the transport is
+		* adjusted with every estimate received.
+		*
+		* @param enabled true to follow the musicians
+		*/
+    void setTempoFollowing(bool enabled);
+    /**
+		* Check whether the tempo follows the musicians
+		*
+		* @return true if it follows
+		*/
+    bool isTempoFollowing() const;
+    /**
+		* Jump to the start of a bar with the next block, can be called from the GUI thread
+		*
+		* @param bar the bar, starting with 1
+		*/
+    void seekToBar(int bar);
+    /**
+		* Play a range of bars repeatedly and jump to its first bar, can be called from the GUI thread
+		*
+		* @param firstBar the first bar of the loop, starting with 1
+		* @param lastBar the last bar of the loop, it is played completely
+		*/
+    void setLoop(int firstBar, int lastBar);
+    /**
+		* Stop looping, the song continues after the last bar of the loop
+		*/
+    void clearLoop();
+    /**
+		* Get the number of bars of the played song
+		*
+		* @return the number of bars
+		*/
+    int getBarCount() const;
+    /**
+		* Take the notes played since the last call, called by the editor on the message thread
+		*
+		* @param entries an array to copy the notes to
+		* @param maxEntries the size of the array
+		* @return the number of copied notes
+		*/
+    int readNoteLog(NoteLogEntry* entries, int maxEntries);
 
 	juce::AudioProcessorEditor* createEditor() override; //<create custom UI for drum plugin
 	bool hasEditor() const override { return true; }
 
 private:
-    ttmm::MidiReader mReader; ///<a MidiReader object
-	String songname; ///<the name of the current song (filename)
-    ttmm::Song song = NULL; ///<a Song object
-    ttmm::MidiHandler mHandler; ///< a MidiHandler object
-    double playTime = -5; ///<calculate the playtime of host based on Samplenumber (Buffersize) and Samplerate (44100)
+    /**
+		* Jump to a position, called by the audio thread
+		*
+		* @param sample the new position in song samples
+		* @param midiBuffer a reference to the MidiBuffer of the block
+		* @param position the sample position of the jump inside the MidiBuffer
+		*/
+    void seekTo(int64_t sample, juce::MidiBuffer& midiBuffer, int position);
+    /**
+		* Get the song sample at which a loaded song replaces the playing one, called by the audio thread
+		*
+		* @param position the current position in song samples
+		* @return the next bar for a requested song, the end of the song for the next song of the setlist,
+		*		  the maximum if no song is ready
+		*/
+    int64_t getSongChange(int64_t position) const;
+    /**
+		* Replace the playing song by a loaded one, called by the audio thread at the position of getSongChange
+		*
+		* @param midiBuffer a reference to the MidiBuffer of the block
+		* @param position the sample position of the change inside the MidiBuffer
+		*/
+    void changeSongNow(juce::MidiBuffer& midiBuffer, int position);
+    /**
+		* Publish the tempo and the bars of the playing song for the GUI
+		*/
+    void adoptSong();
+    /**
+		* Adjust the rate of the transport to the tempo of the musicians, called by the audio thread
+		* after a new estimate was merged
+		*
+		* @param schedule the played schedule, the tempo of the song is taken from its beats
+		*/
+    void followTempo(PlaybackSchedule const& schedule);
+
+    static const double START_TIME; ///<the playback starts this many seconds before the song
+    static const double FOLLOW_SMOOTHING; ///<part of the difference to the tempo of the musicians the rate moves per estimate
+    static const double FOLLOW_PHASE_GAIN; ///<rate change per beat the musicians are behind their usual phase
+    static const double FOLLOW_PHASE_AVERAGING; ///<weight of a new phase in the usual phase, which contains the latency of the input
+    static const double MAX_PHASE_CORRECTION; ///<largest rate change by the phase
+    ttmm::LoadedSong* playing = nullptr; ///<the song and schedule played now, only changed by the audio thread
+    ttmm::SongLoader loader; ///<loads songs on a background thread
+    ttmm::SongLibrary library; ///<index of the songs in the Soundfiles folder
+    std::atomic<int> songBpm; ///<tempo of the playing song, read by the GUI
+    std::atomic<int> barCount; ///<number of bars of the playing song, read by the GUI
+    ttmm::Transport transport; ///<the playtime of host as a sample counter, advanced block by block
+    ttmm::LookaheadRenderer renderer; ///<renders the midi events of the next windows on a background thread
+    ttmm::Metronome metronome; ///<clicks on the beats of the playing song
+    ttmm::NoteLog noteLog; ///<the played notes, written by the audio thread while the editor is open
+    ttmm::PerformanceRecorder recorder; ///<writes the emitted midi messages to a file, one track per channel
+    std::atomic<int> seekBar; ///<bar (starting with 0) to jump to with the next block, -1 if none, written by the GUI
+    std::atomic<int64_t> loopBars; ///<first bar in the upper and last bar in the lower 32 bits, -1 if not looping
+    std::atomic<bool> tempoFollowing; ///<true if the rate follows the musicians, written by the GUI
+    bool tempoReceived = false; ///<a new estimate of the tempo was merged and not yet followed
+    double usualPhase = 0.0; ///<average phase of the musicians, their late events are not mistaken for lagging
     AudioBuffer wavdata; ///<store the data of wav sound for creating metronom
     std::vector<juce::MidiMessageSequence> buffers; ///<a list of midiSequences object
     ttmm::Samplerate samplerate; ///<samplerate of host
@@ -3,34 +3,48 @@
 namespace ttmm
 {
 	ListDisplay::ListDisplay()
+		: listData(CAPACITY), firstRow(0), rowCount(0)
 	{
-		listData = new std::vector<String>();
 	}
 
 	ListDisplay::~ListDisplay()
 	{
-		listData->clear();
-		listData->~vector();
 	}
 
 	int ListDisplay::getNumRows()
 	{
-		return listData->size();
+		return rowCount;
 	}
 
-	int ListDisplay::addRow(String msg)
+	int ListDisplay::addRow(NoteLogEntry const& entry)
 	{
-		listData->push_back(msg);
-		return listData->size();
+		if (rowCount < CAPACITY)
+		{
+			listData[(firstRow + rowCount) % CAPACITY] = entry;
+			rowCount++;
+		}
+		else
+		{
+			//the list is full, the new row replaces the oldest one
+			listData[firstRow] = entry;
+			firstRow = (firstRow + 1) % CAPACITY;
+		}
+		return rowCount;
 	}
 
 	void ListDisplay::paintListBoxItem(int rowNumber, Graphics& g, int width, int height, bool rowIsSelected)
 	{
+		if (rowNumber < 0 || rowNumber >= rowCount)
+		{
+			return;
+		}
 		if (rowIsSelected) {
 			g.fillAll(Colours::lightblue);
 		}
+		NoteLogEntry const& entry = listData[(firstRow + rowNumber) % CAPACITY];
 		g.setColour(Colours::black);
 		g.setFont(height * 0.7f);
-		g.drawText("Row Number " + String(rowNumber + 1), 5, 0, width, height, Justification::centredLeft, true);
+		g.drawText("Spiele Note auf Channel: " + String(int(entry.channel)) + " mit Wert: " + String(int(entry.nodeNumber)),
+			5, 0, width, height, Justification::centredLeft, true);
 	}
-}
\ No newline at end of file
+}
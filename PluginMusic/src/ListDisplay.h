@@ -2,17 +2,25 @@
 #include "DynamicComposition.h"
 
 namespace ttmm {
+	/**
+		* @class ListDisplay
+		* @brief Model of the note list of the editor. Only the last CAPACITY notes are kept in a ring,
+		*		  the ListBox asks for the visible rows only, so their text is built when they are painted.
+		*/
 	class ListDisplay : public juce::ListBoxModel
 	{
 	public:
+		static const int CAPACITY = 1000; //<rows kept, the oldest row is replaced by a new one
+
 		ListDisplay();
 		~ListDisplay();
 		int getNumRows() override;
 		void paintListBoxItem(int rowNr, Graphics& g, int width, int height, bool rowIsSelected) override;
-		int addRow(String msg);
+		int addRow(NoteLogEntry const& entry); //<add a row at the end, returns the number of rows
 
 	private:
-		std::vector<String>* listData;
+		std::vector<NoteLogEntry> listData; //<the ring of rows
+		int firstRow; //<index of the oldest row in listData
+		int rowCount; //<number of used rows
 	};
 }
-
@@ -0,0 +1,417 @@
+#include "LookaheadRenderer.h"
+#include "FileWriter.h"
+#include "TimeTools.h"
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+
+using namespace ttmm;
+
+namespace
+{
+//division rounding towards -infinity, the song starts with negative samples
+int64_t floorDiv(int64_t value, int64_t divisor)
+{
+    int64_t quotient = value / divisor;
+    return (value % divisor < 0) ? quotient - 1 : quotient;
+}
+}
+
+LookaheadRenderer::LookaheadRenderer()
+    : fifo(LOOKAHEAD_WINDOWS)
+    , ring(LOOKAHEAD_WINDOWS)
+    , local(COMMITTED_WINDOWS + 1)
+    , droppedEvents(0)
+    , tune(0)
+    , volume1(0)
+    , volume2(0)
+    , volume3(0)
+    , generation(0)
+    , restartWindow(0)
+    , seekSample(0)
+    , seekSchedule(nullptr)
+    , seekCount(0)
+    , seeksDone(0)
+    , stopRenderer(true)
+    , wakeUp(false)
+{
+}
+
+LookaheadRenderer::~LookaheadRenderer()
+{
+    this->stop();
+}
+
+void LookaheadRenderer::start(PlaybackSchedule const& schedule, int64_t startSample, IPCSongInfo_IPCMusician const& musician)
+{
+    this->stop();
+    this->worker.schedule = &schedule;
+    this->worker.handler.prepare(schedule);
+    this->worker.musician = musician;
+    this->fallback.schedule = &schedule;
+    this->fallback.handler.prepare(schedule);
+    this->fallback.musician = musician;
+    //the fallback renders on the audio thread, it must not grow its buffer there
+    this->worker.buffer.ensureSize(BUFFER_BYTES);
+    this->fallback.buffer.ensureSize(BUFFER_BYTES);
+    this->seekSchedule.store(&schedule);
+    this->tune.store(musician.tune());
+    this->volume1.store(musician.volumech1());
+    this->volume2.store(musician.volumech2());
+    this->volume3.store(musician.volumech3());
+    this->renderGeneration = this->generation.load();
+    this->renderSeekCount = this->seekCount.load();
+    this->seeksDone.store(this->renderSeekCount);
+    this->fifo.reset();
+    this->localHead = 0;
+    this->localCount = 0;
+    this->eventIndex = 0;
+    this->underruns = 0;
+    this->droppedEvents.store(0);
+    this->soundingNotes.reset();
+    this->fallbackEnd = 0;
+    this->nextWindow = floorDiv(startSample, WINDOW_SAMPLES);
+    this->nextRenderWindow = this->nextWindow;
+    this->committedEnd = this->nextWindow;
+    this->restartWindow.store(this->nextWindow);
+    this->variation.start(schedule, startSample, musician);
+    //fill the ring before the first block is played
+    while (this->renderNext())
+    {
+    }
+    this->stopRenderer.store(false);
+    this->renderThread = std::thread(&LookaheadRenderer::run, this);
+    if (!this->renderThread.joinable())
+    {
+        ttmm::logger.write("Failed to start the LookaheadRenderer thread");
+    }
+}
+
+void LookaheadRenderer::stop()
+{
+    this->stopRenderer.store(true);
+    this->wakeUp.store(true);
+    if (this->renderThread.joinable())
+    {
+        this->renderThread.join();
+    }
+    this->variation.stop();
+    //no schedule is used by a stopped background thread
+    this->seeksDone.store(this->seekCount.load());
+}
+
+void LookaheadRenderer::setMusician(IPCSongInfo_IPCMusician const& musician)
+{
+    //the accuracy is used for the bars generated next, nothing is rendered again
+    this->variation.setAccuracy(musician.accuracy());
+    if (musician.tune() == this->tune.load() && musician.volumech1() == this->volume1.load()
+        && musician.volumech2() == this->volume2.load() && musician.volumech3() == this->volume3.load())
+    {
+        return;
+    }
+    //the next windows are played too soon to render them again, keep them
+    int64_t expected = (this->localCount > 0) ? this->local[this->localHead].window : this->nextWindow;
+    this->committedEnd = expected + COMMITTED_WINDOWS;
+    while (this->fifo.getNumReady() > 0)
+    {
+        this->takeFromRing(this->committedEnd);
+    }
+    this->fallback.musician = musician;
+    //publish the new state, the background thread renders again from restartWindow
+    this->tune.store(musician.tune());
+    this->volume1.store(musician.volumech1());
+    this->volume2.store(musician.volumech2());
+    this->volume3.store(musician.volumech3());
+    this->restartWindow.store(this->committedEnd);
+    this->generation.fetch_add(1);
+    this->wakeUp.store(true);
+}
+
+void LookaheadRenderer::render(PlaybackBlock const& block, juce::MidiBuffer& midiBuffer)
+{
+    if (this->fallback.schedule == nullptr)
+    {
+        return;
+    }
+    while (this->nextWindow * WINDOW_SAMPLES < block.endSample)
+    {
+        while (this->localCount == 0)
+        {
+            if (!this->takeFromRing(std::numeric_limits<int64_t>::max()))
+            {
+                if (this->nextWindow < this->fallbackEnd)
+                {
+                    //after a seek the background thread may not have reached the new position yet
+                    this->renderWindow(this->fallback, this->generation.load(), this->nextWindow,
+                        this->local[this->localHead]);
+                    this->localCount = 1;
+                    break;
+                }
+                //the background thread is late, the windows of this block are lost
+                int64_t endWindow = floorDiv(block.endSample - 1, WINDOW_SAMPLES) + 1;
+                this->underruns += int(endWindow - this->nextWindow);
+                this->nextWindow = endWindow;
+                return;
+            }
+        }
+        MidiEventBatch const& batch = this->local[this->localHead];
+        int64_t windowStart = batch.window * WINDOW_SAMPLES;
+        while (this->eventIndex < batch.count)
+        {
+            MidiEventBatch::Event const& event = batch.events[this->eventIndex];
+            int64_t sample = windowStart + event.offset;
+            if (sample >= block.endSample)
+            {
+                //the rest of the window is played in the next block
+                return;
+            }
+            if (sample >= block.firstSample)
+            {
+                this->addEvent(midiBuffer, event.data, event.size, block.toSamplePosition(sample));
+            }
+            this->eventIndex++;
+        }
+        this->nextWindow = batch.window + 1;
+        this->localHead = (this->localHead + 1) % int(this->local.size());
+        this->localCount--;
+        this->eventIndex = 0;
+    }
+}
+
+uint32_t LookaheadRenderer::setSchedule(PlaybackSchedule const& schedule, MidiHandler& prepared, int64_t sample,
+    juce::MidiBuffer& midiBuffer, int position)
+{
+    this->fallback.schedule = &schedule;
+    this->fallback.handler.swap(prepared);
+    this->seekSchedule.store(&schedule);
+    return this->seek(sample, midiBuffer, position);
+}
+
+uint32_t LookaheadRenderer::seek(int64_t sample, juce::MidiBuffer& midiBuffer, int position)
+{
+    if (this->fallback.schedule == nullptr)
+    {
+        return this->seekCount.load();
+    }
+    //end the notes sounding at the old position
+    for (size_t i = 0; i < this->soundingNotes.size(); i++)
+    {
+        if (this->soundingNotes[i])
+        {
+            juce::uint8 noteOff[3] = { juce::uint8(0x80 | (i / 128)), juce::uint8(i % 128), 0 };
+            midiBuffer.addEvent(noteOff, 3, position);
+        }
+    }
+    this->soundingNotes.reset();
+    //forget the windows of the old position, the batches left in the ring are dropped by takeFromRing
+    this->localHead = 0;
+    this->localCount = 0;
+    this->eventIndex = 0;
+    this->nextWindow = floorDiv(sample, WINDOW_SAMPLES);
+    this->committedEnd = this->nextWindow;
+    this->fallbackEnd = this->nextWindow + LOOKAHEAD_WINDOWS;
+    //start the notes which should be sounding at the new position
+    this->fallback.handler.seek(*this->fallback.schedule, sample, this->fallback.musician);
+    this->fallback.buffer.clear();
+    this->fallback.handler.playSounding(*this->fallback.schedule, sample, this->fallback.buffer, position,
+        this->fallback.musician);
+    juce::MidiBuffer::Iterator it(this->fallback.buffer);
+    const juce::uint8* data;
+    int size;
+    int eventPosition;
+    while (it.getNextEvent(data, size, eventPosition))
+    {
+        this->addEvent(midiBuffer, data, size, eventPosition);
+    }
+    //the background thread continues at the new position
+    this->seekSample.store(sample);
+    uint32_t seek = this->seekCount.fetch_add(1) + 1;
+    this->generation.fetch_add(1);
+    this->wakeUp.store(true);
+    return seek;
+}
+
+bool LookaheadRenderer::hasReachedSeek(uint32_t seek) const
+{
+    //the counters may wrap around
+    return int32_t(this->seeksDone.load() - seek) >= 0;
+}
+
+void LookaheadRenderer::addEvent(juce::MidiBuffer& midiBuffer, const juce::uint8* data, int size, int position)
+{
+    midiBuffer.addEvent(data, size, position);
+    if (size < 3)
+    {
+        return;
+    }
+    size_t note = (data[0] & 0x0F) * 128 + (data[1] & 0x7F);
+    if ((data[0] & 0xF0) == 0x90 && data[2] > 0)
+    {
+        this->soundingNotes.set(note);
+    }
+    else if ((data[0] & 0xF0) == 0x80 || (data[0] & 0xF0) == 0x90)
+    {
+        this->soundingNotes.reset(note);
+    }
+}
+
+bool LookaheadRenderer::takeFromRing(int64_t before)
+{
+    if (this->fifo.getNumReady() == 0)
+    {
+        return false;
+    }
+    int start1, size1, start2, size2;
+    this->fifo.prepareToRead(1, start1, size1, start2, size2);
+    MidiEventBatch const& batch = this->ring[size1 > 0 ? start1 : start2];
+    uint32_t current = this->generation.load();
+    //batches of the previous state are still valid for the committed windows
+    bool valid = (batch.generation == current)
+        || (batch.generation + 1 == current && batch.window < this->committedEnd);
+    int64_t expected = this->nextWindow;
+    if (this->localCount > 0)
+    {
+        expected = this->local[(this->localHead + this->localCount - 1) % int(this->local.size())].window + 1;
+    }
+    if (valid && batch.window >= expected && batch.window < before && this->localCount < int(this->local.size()))
+    {
+        if (this->localCount == 0 && batch.window > this->nextWindow)
+        {
+            this->underruns += int(batch.window - this->nextWindow);
+            this->nextWindow = batch.window;
+        }
+        this->local[(this->localHead + this->localCount) % int(this->local.size())] = batch;
+        this->localCount++;
+        if (batch.generation == current)
+        {
+            //the background thread reached the position of the last seek
+            this->fallbackEnd = 0;
+        }
+    }
+    this->fifo.finishedRead(1);
+    this->wakeUp.store(true);
+    return true;
+}
+
+void LookaheadRenderer::run()
+{
+    while (!this->stopRenderer.load())
+    {
+        uint32_t current = this->generation.load();
+        if (current != this->renderGeneration)
+        {
+            this->renderGeneration = current;
+            this->worker.musician.set_tune(IPCSongInfo_IPCMusician_Tune(this->tune.load()));
+            this->worker.musician.set_volumech1(this->volume1.load());
+            this->worker.musician.set_volumech2(this->volume2.load());
+            this->worker.musician.set_volumech3(this->volume3.load());
+            uint32_t seeks = this->seekCount.load();
+            if (seeks != this->renderSeekCount)
+            {
+                //the audio thread jumped, continue rendering at its new position
+                this->renderSeekCount = seeks;
+                int64_t sample = this->seekSample.load();
+                PlaybackSchedule const* schedule = this->seekSchedule.load();
+                if (schedule != this->worker.schedule)
+                {
+                    this->worker.schedule = schedule;
+                    this->worker.handler.prepare(*schedule);
+                }
+                this->worker.handler.seek(*schedule, sample, this->worker.musician);
+                this->nextRenderWindow = floorDiv(sample, WINDOW_SAMPLES);
+                this->variation.restart(*schedule, sample, this->worker.musician);
+                //the schedule played before the seek is not used any more
+                this->seeksDone.store(seeks);
+            }
+            else
+            {
+                this->nextRenderWindow = std::min(this->nextRenderWindow, this->restartWindow.load());
+                this->variation.restart(*this->worker.schedule, this->nextRenderWindow * WINDOW_SAMPLES,
+                    this->worker.musician);
+            }
+        }
+        if (!this->renderNext())
+        {
+            //the ring is full, poll until the audio thread took a batch or the state changed
+            if (!this->wakeUp.exchange(false))
+            {
+                std::this_thread::sleep_for(std::chrono::milliseconds(WAKE_POLL_MS));
+            }
+        }
+    }
+}
+
+bool LookaheadRenderer::renderNext()
+{
+    if (this->fifo.getFreeSpace() == 0)
+    {
+        return false;
+    }
+    //the pages of a streamed schedule are mapped here, the audio thread would skip them
+    this->worker.schedule->prefetch(this->nextRenderWindow * WINDOW_SAMPLES, (this->nextRenderWindow + 1) * WINDOW_SAMPLES);
+    int start1, size1, start2, size2;
+    this->fifo.prepareToWrite(1, start1, size1, start2, size2);
+    this->renderWindow(this->worker, this->renderGeneration, this->nextRenderWindow,
+        this->ring[size1 > 0 ? start1 : start2]);
+    this->fifo.finishedWrite(1);
+    this->nextRenderWindow++;
+    return true;
+}
+
+void LookaheadRenderer::renderWindow(RenderState& state, uint32_t generation, int64_t window, MidiEventBatch& batch)
+{
+    TIMED_BLOCK("renderWindow")
+    state.buffer.clear();
+    PlaybackBlock block = PlaybackBlock::atOriginalTempo(window * WINDOW_SAMPLES, WINDOW_SAMPLES);
+    state.handler.processTrackToNewMidiBuffer(*state.schedule, block, state.buffer, state.musician);
+    if (&state == &this->worker)
+    {
+        //the audio thread renders without the generated accompaniment after a seek
+        this->variation.render(block, state.buffer);
+    }
+    batch.window = window;
+    batch.generation = generation;
+    batch.count = 0;
+    juce::MidiBuffer::Iterator it(state.buffer);
+    const juce::uint8* data;
+    int size;
+    int position;
+    while (it.getNextEvent(data, size, position))
+    {
+        if (batch.count == MidiEventBatch::MAX_EVENTS || size > 3)
+        {
+            this->droppedEvents++;
+            continue;
+        }
+        MidiEventBatch::Event& event = batch.events[batch.count++];
+        event.offset = position;
+        std::memcpy(event.data, data, size_t(size));
+        event.size = uint8_t(size);
+    }
+}
+
+int LookaheadRenderer::getUnderruns() const
+{
+    return this->underruns;
+}
+
+int LookaheadRenderer::getDroppedEvents() const
+{
+    return this->droppedEvents.load();
+}
+
+void LookaheadRenderer::setVariation(bool enabled)
+{
+    this->variation.setEnabled(enabled);
+}
+
+bool LookaheadRenderer::hasVariation() const
+{
+    return this->variation.isEnabled();
+}
+
+int LookaheadRenderer::getLateVariationBars() const
+{
+    return this->variation.getLateBars();
+}
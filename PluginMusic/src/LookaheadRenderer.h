@@ -0,0 +1,259 @@
+/**
+* @file LookaheadRenderer.cpp
+* @author FH-Minden Musikinformatik 2015, Musicgroup (Marcel, Patrick, Scott)
+* @brief Renders the upcoming midi events of the song on a background thread
+*
+*/
+#ifndef TTMM_LOOKAHEAD_RENDERER_H
+#define TTMM_LOOKAHEAD_RENDERER_H
+
+#include <thread>
+#include <atomic>
+#include <vector>
+#include <bitset>
+#include <cstdint>
+
+#include "MidiHandler.h"
+#include "PlaybackSchedule.h"
+#include "Transport.h"
+#include "VariationEngine.h"
+#include "../../TTMM/JuceLibraryCode/JuceHeader.h"
+#include "DataExchange.pb.h"
+
+namespace ttmm
+{
+/**
+	* @struct MidiEventBatch
+	* @brief The preformatted midi events of one window of song samples
+	*/
+struct MidiEventBatch
+{
+    static const int MAX_EVENTS = 128; ///<events of a window, further events are dropped
+
+    /**
+		* @struct Event
+		* @brief A short midi message and its offset inside the window
+		*/
+    struct Event
+    {
+        int32_t offset; ///<song samples after the start of the window
+        uint8_t data[3]; ///<the raw midi message
+        uint8_t size; ///<number of used bytes of data
+    };
+
+    int64_t window; ///<index of the window, it starts at song sample window * WINDOW_SAMPLES
+    uint32_t generation; ///<the musician state the window was rendered with
+    int32_t count; ///<number of events
+    Event events[MAX_EVENTS]; ///<events sorted by offset
+};
+
+/**
+	* @class LookaheadRenderer
+	* @brief Renders the midi events of the next windows of song samples on a background thread
+	*		  into a lock-free ring, the audio thread only copies the ready events into its MidiBuffer.
+	*		  The windows are measured in song samples, so the tempo rate of the transport does not affect them.
+	*		  When the musician state changes, all windows except the next COMMITTED_WINDOWS are rendered again.
+	*		  Because the events keep their position in the song, this does not add latency to the output.
+	*		  A seek ends the sounding notes, starts the notes which should be sounding at the new position and
+	*		  renders the first windows there on the audio thread, until the background thread caught up.
+	*		  A seek can switch to the schedule of another song the same way.
+	*		  The background thread adds the accompaniment of the VariationEngine to the windows it renders.
+	*		  The audio thread neither allocates nor locks: the buffers are reserved by start, and it wakes
+	*		  the background thread by a flag the thread polls every WAKE_POLL_MS while the ring is full.
+	*
+	* @see MidiHandler, PlaybackSchedule, Transport, VariationEngine
+	*/
+class LookaheadRenderer
+{
+public:
+    static const int WINDOW_SAMPLES = 1024; ///<song samples rendered as one batch
+    static const int LOOKAHEAD_WINDOWS = 16; ///<number of batches in the ring
+    static const int COMMITTED_WINDOWS = 2; ///<batches which are kept when the musician state changes
+    static const int WAKE_POLL_MS = 1; ///<interval the background thread checks for work while the ring is full
+    static const int BUFFER_BYTES = (16 * 128 + 4 * MidiEventBatch::MAX_EVENTS) * 16; ///<reserved for the events of a window and a seek
+
+    /**
+		* Constructor: create a stopped LookaheadRenderer
+		*/
+    LookaheadRenderer();
+    /**
+		* Destructor: stop the background thread
+		*/
+    ~LookaheadRenderer();
+    /**
+		* Start rendering, a running background thread is stopped before
+		*
+		* @param schedule the events to play, must not change until stop is called
+		* @param startSample the song sample the playback starts at
+		* @param musician the musician state the first windows are rendered with
+		*/
+    void start(PlaybackSchedule const& schedule, int64_t startSample, IPCSongInfo_IPCMusician const& musician);
+    /**
+		* Stop the background thread
+		*/
+    void stop();
+    /**
+		* Update the musician state, called by the audio thread.
+		* If tune or volumes changed, the windows after the committed ones are rendered again.
+		*
+		* @param musician the merged musician state
+		*/
+    void setMusician(IPCSongInfo_IPCMusician const& musician);
+    /**
+		* Copy the events of a block into a MidiBuffer, called by the audio thread
+		*
+		* @param block the song samples played in this block
+		* @param midiBuffer a reference to the MidiBuffer of the block
+		*/
+    void render(PlaybackBlock const& block, juce::MidiBuffer& midiBuffer);
+    /**
+		* Continue at another song sample, called by the audio thread before the block of the new position is rendered.
+		* The note offs of all sounding notes and the note ons of the notes sounding at the new position are
+		* added to the MidiBuffer.
+		*
+		* @param sample the new position in song samples
+		* @param midiBuffer a reference to the MidiBuffer of the block
+		* @param position the sample position of the note offs and note ons inside the MidiBuffer
+		* @return the number of the seek, see hasReachedSeek
+		*/
+    uint32_t seek(int64_t sample, juce::MidiBuffer& midiBuffer, int position);
+    /**
+		* Continue with the schedule of another song, called by the audio thread like seek.
+		* The handler of the audio thread is exchanged with a handler prepared for the schedule, preparing it here
+		* would allocate.
+		*
+		* @param schedule the events to play next, must not change until hasReachedSeek returns true for a later seek
+		* @param prepared a MidiHandler prepared for the schedule, holds the state of the previous schedule afterwards
+		* @param sample the position in song samples of the new schedule
+		* @param midiBuffer a reference to the MidiBuffer of the block
+		* @param position the sample position of the note offs and note ons inside the MidiBuffer
+		* @return the number of the seek, see hasReachedSeek
+		*/
+    uint32_t setSchedule(PlaybackSchedule const& schedule, MidiHandler& prepared, int64_t sample, juce::MidiBuffer& midiBuffer,
+        int position);
+    /**
+		* Check whether the background thread continued at a seek, so it does not use the schedule played before
+		*
+		* @param seek the number returned by seek or setSchedule
+		* @return true if the background thread reached the seek or is stopped
+		*/
+    bool hasReachedSeek(uint32_t seek) const;
+    /**
+		* Get the number of windows which were not rendered in time
+		*
+		* @return the number of missed windows since start
+		*/
+    int getUnderruns() const;
+    /**
+		* Get the number of events which did not fit into their batch
+		*
+		* @return the number of dropped events since start
+		*/
+    int getDroppedEvents() const;
+    /**
+		* Turn the generated accompaniment on or off, can be called from any thread.
+		* The windows already rendered are played unchanged.
+		*
+		* @param enabled true to play the accompaniment of the VariationEngine
+		*/
+    void setVariation(bool enabled);
+    /**
+		* Check whether the generated accompaniment is played
+		*
+		* @return true if it is played
+		*/
+    bool hasVariation() const;
+    /**
+		* Get the number of bars the VariationEngine did not generate in time
+		*
+		* @return the number of skipped bars since start
+		*/
+    int getLateVariationBars() const;
+
+private:
+    /**
+		* @struct RenderState
+		* @brief What a thread needs to render windows
+		*/
+    struct RenderState
+    {
+        PlaybackSchedule const* schedule = nullptr; ///<the events to play
+        MidiHandler handler; ///<renders the events and keeps the StrokeTypes
+        juce::MidiBuffer buffer; ///<events of the window being rendered
+        IPCSongInfo_IPCMusician musician; ///<the musician state the windows are rendered with
+    };
+
+    /**
+		* Loop of the background thread, renders windows until the ring is full
+		*/
+    void run();
+    /**
+		* Render the next window into the ring
+		*
+		* @return false if the ring is full
+		*/
+    bool renderNext();
+    /**
+		* Render one window into a batch
+		*
+		* @param state the render state of the calling thread
+		* @param generation the generation of the musician state
+		* @param window index of the window
+		* @param batch the batch to fill
+		*/
+    void renderWindow(RenderState& state, uint32_t generation, int64_t window, MidiEventBatch& batch);
+    /**
+		* Add a midi event to the MidiBuffer of the block and keep track of the sounding notes
+		*
+		* @param midiBuffer a reference to the MidiBuffer of the block
+		* @param data the raw midi message
+		* @param size number of bytes of data
+		* @param position the sample position inside the MidiBuffer
+		*/
+    void addEvent(juce::MidiBuffer& midiBuffer, const juce::uint8* data, int size, int position);
+    /**
+		* Take the next batch out of the ring, it is kept in the local queue if it is
+		* valid for the current musician state and the next expected window
+		*
+		* @param before only windows before this one are kept
+		* @return false if the ring is empty
+		*/
+    bool takeFromRing(int64_t before);
+
+    RenderState worker; ///<render state of the background thread
+    VariationEngine variation; ///<generates the accompaniment the background thread adds to its windows
+    int64_t nextRenderWindow = 0; ///<window rendered next by the background thread
+    uint32_t renderGeneration = 0; ///<generation of the musician state of the background thread
+    uint32_t renderSeekCount = 0; ///<number of seeks seen by the background thread
+
+    juce::AbstractFifo fifo; ///<indices of the lock-free ring, one writer and one reader
+    std::vector<MidiEventBatch> ring; ///<the rendered batches
+    std::vector<MidiEventBatch> local; ///<batches taken out of the ring by the audio thread
+    int localHead = 0; ///<index of the first batch in local
+    int localCount = 0; ///<number of batches in local
+    int eventIndex = 0; ///<next event of the first batch in local
+    int64_t nextWindow = 0; ///<window expected next by the audio thread
+    int64_t committedEnd = 0; ///<windows before this were rendered before the last change of the musician state
+    int underruns = 0; ///<windows which were not rendered in time
+    std::atomic<int> droppedEvents; ///<events which did not fit into their batch
+    std::bitset<16 * 128> soundingNotes; ///<notes of all channels which were turned on and not yet off
+    RenderState fallback; ///<render state of the audio thread, renders the windows after a seek
+    int64_t fallbackEnd = 0; ///<until this window the audio thread renders windows the background thread did not deliver
+
+    std::atomic<int> tune; ///<shared musician state, written by the audio thread
+    std::atomic<int> volume1; ///<shared musician state, written by the audio thread
+    std::atomic<int> volume2; ///<shared musician state, written by the audio thread
+    std::atomic<int> volume3; ///<shared musician state, written by the audio thread
+    std::atomic<uint32_t> generation; ///<incremented when the musician state changes
+    std::atomic<int64_t> restartWindow; ///<first window rendered again after a change of the musician state
+    std::atomic<int64_t> seekSample; ///<position of the last seek
+    std::atomic<PlaybackSchedule const*> seekSchedule; ///<schedule played since the last seek
+    std::atomic<uint32_t> seekCount; ///<incremented on a seek, before generation
+    std::atomic<uint32_t> seeksDone; ///<number of seeks the background thread continued at
+
+    std::thread renderThread; ///<the background thread
+    std::atomic<bool> stopRenderer; ///<is set to true, when the background thread shall end
+    std::atomic<bool> wakeUp; ///<set by the audio thread when there is work for the background thread
+};
+}
+#endif
@@ -0,0 +1,108 @@
+#include "Metronome.h"
+
+#include <algorithm>
+
+using namespace ttmm;
+
+Metronome::Metronome()
+    : subdivision(1)
+    , accents(true)
+{
+}
+
+void Metronome::setSubdivision(int subdivision)
+{
+    int maxSubdivision = MAX_SUBDIVISION;
+    this->subdivision.store(std::max(0, std::min(subdivision, maxSubdivision)));
+}
+
+int Metronome::getSubdivision() const
+{
+    return this->subdivision.load();
+}
+
+void Metronome::setAccents(bool accents)
+{
+    this->accents.store(accents);
+}
+
+bool Metronome::hasAccents() const
+{
+    return this->accents.load();
+}
+
+void Metronome::render(PlaybackSchedule const& schedule, PlaybackBlock const& block, juce::MidiBuffer& midiBuffer)
+{
+    int64_t length = schedule.getLength();
+    int subdivision = this->subdivision.load();
+    if (subdivision == 0 && this->sounding)
+    {
+        //the metronome was turned off during a click
+        this->addClick(block, block.firstSample, 0, midiBuffer);
+    }
+    if (length <= 0 || block.endSample <= 0 || subdivision == 0 || schedule.getBeats().empty())
+    {
+        return;
+    }
+    bool accents = this->accents.load();
+    //the song repeats after length samples, the last click of the previous repetition may end in this block
+    int64_t firstRepetition = std::max(int64_t(0), block.firstSample / length - 1);
+    int64_t lastRepetition = (block.endSample - 1) / length;
+    for (int64_t repetition = firstRepetition; repetition <= lastRepetition; repetition++)
+    {
+        this->renderRepetition(schedule, block, repetition * length, subdivision, accents, midiBuffer);
+    }
+}
+
+void Metronome::renderRepetition(PlaybackSchedule const& schedule, PlaybackBlock const& block, int64_t offset,
+    int subdivision, bool accents, juce::MidiBuffer& midiBuffer)
+{
+    auto const& beats = schedule.getBeats();
+    int64_t first = block.firstSample - offset;
+    int64_t end = block.endSample - offset;
+    if (end <= beats.front() || first >= schedule.getLength())
+    {
+        return;
+    }
+    //start with the beat before the block, its last click may end inside the block
+    int beat = std::max(0, schedule.getBeatAt(first) - 1);
+    for (; beat < int(beats.size()) && beats[beat] < end; beat++)
+    {
+        int64_t start = beats[beat];
+        int64_t beatLength = ((beat + 1 < int(beats.size())) ? beats[beat + 1] : schedule.getLength()) - start;
+        bool downbeat = accents && schedule.getBarStart(schedule.getBarAt(start)) == start;
+        for (int i = 0; i < subdivision; i++)
+        {
+            //the clicks divide the beat evenly and sound for half of their distance
+            int64_t on = start + beatLength * i / subdivision;
+            int64_t off = on + beatLength / (2 * subdivision);
+            if (block.contains(on + offset))
+            {
+                int velocity = (i > 0) ? SUBDIVISION_VELOCITY : (downbeat ? ACCENT_VELOCITY : BEAT_VELOCITY);
+                this->addClick(block, on + offset, velocity, midiBuffer);
+            }
+            if (block.contains(off + offset))
+            {
+                this->addClick(block, off + offset, 0, midiBuffer);
+            }
+        }
+    }
+}
+
+void Metronome::seek(juce::MidiBuffer& midiBuffer, int position)
+{
+    if (this->sounding)
+    {
+        juce::MidiMessage m = juce::MidiMessage::noteOn(CHANNEL, NODE, uint8(0));
+        midiBuffer.addEvent(m, position);
+        this->sounding = false;
+    }
+}
+
+void Metronome::addClick(PlaybackBlock const& block, int64_t sample, int velocity, juce::MidiBuffer& midiBuffer)
+{
+    juce::MidiMessage m = juce::MidiMessage::noteOn(CHANNEL, NODE, uint8(velocity));
+    m.setTimeStamp(double(sample));
+    midiBuffer.addEvent(m, block.toSamplePosition(sample));
+    this->sounding = (velocity > 0);
+}
@@ -0,0 +1,111 @@
+/**
+* @file Metronome.cpp
+* @author FH-Minden Musikinformatik 2015, Musicgroup (Marcel, Patrick, Scott)
+* @brief Generates the clicks of the metronome from the bars and beats of the song
+*
+*/
+#ifndef TTMM_METRONOME_H
+#define TTMM_METRONOME_H
+
+#include <atomic>
+#include <cstdint>
+
+#include "PlaybackSchedule.h"
+#include "Transport.h"
+#include "../../TTMM/JuceLibraryCode/JuceHeader.h"
+
+namespace ttmm
+{
+/**
+	* @class Metronome
+	* @brief Generates the clicks of the metronome for a block of song samples. Nothing is stored per click,
+	*		  the beats of the block are found in the beat index of the schedule, which follows the tempo map
+	*		  and the time signatures of the song. The first beat of a bar is accented and each beat can be
+	*		  divided into clicks of equal length. The clicks are played on channel 1 and end with a note on
+	*		  without velocity, like the metronome of the drum group expects.
+	*
+	* @see PlaybackSchedule, Transport
+	*/
+class Metronome
+{
+public:
+    static const int CHANNEL = 1; ///<midi channel of the clicks
+    static const int NODE = 61; ///<node number of the clicks
+    static const int ACCENT_VELOCITY = 127; ///<velocity of the first beat of a bar
+    static const int BEAT_VELOCITY = 100; ///<velocity of the other beats
+    static const int SUBDIVISION_VELOCITY = 60; ///<velocity of the clicks between the beats
+    static const int MAX_SUBDIVISION = 8; ///<most clicks per beat
+
+    /**
+		* Constructor: create a metronome which clicks once per beat with accents
+		*/
+    Metronome();
+    /**
+		* Set the number of clicks per beat, can be called from the GUI thread
+		*
+		* @param subdivision clicks per beat (1 to MAX_SUBDIVISION), 0 turns the metronome off
+		*/
+    void setSubdivision(int subdivision);
+    /**
+		* Get the number of clicks per beat
+		*
+		* @return clicks per beat, 0 if the metronome is off
+		*/
+    int getSubdivision() const;
+    /**
+		* Turn the accent of the first beat of a bar on or off, can be called from the GUI thread
+		*
+		* @param accents true to accent the first beat of a bar
+		*/
+    void setAccents(bool accents);
+    /**
+		* Check whether the first beat of a bar is accented
+		*
+		* @return true if the accents are on
+		*/
+    bool hasAccents() const;
+    /**
+		* Add the clicks of a block to the MidiBuffer, called by the audio thread
+		*
+		* @param schedule the schedule of the played song, its beats give the clicks
+		* @param block the song samples played in this block
+		* @param midiBuffer a reference to the MidiBuffer of the block
+		*/
+    void render(PlaybackSchedule const& schedule, PlaybackBlock const& block, juce::MidiBuffer& midiBuffer);
+    /**
+		* End a sounding click before the playback continues at another position, called by the audio thread
+		*
+		* @param midiBuffer a reference to the MidiBuffer of the block
+		* @param position the sample position of the note off inside the MidiBuffer
+		*/
+    void seek(juce::MidiBuffer& midiBuffer, int position);
+
+private:
+    /**
+		* Add the clicks of the beats of one repetition of the song
+		*
+		* @param schedule the schedule of the played song
+		* @param block the song samples played in this block
+		* @param offset the song sample at which the repetition starts
+		* @param subdivision clicks per beat
+		* @param accents true to accent the first beat of a bar
+		* @param midiBuffer a reference to the MidiBuffer of the block
+		*/
+    void renderRepetition(PlaybackSchedule const& schedule, PlaybackBlock const& block, int64_t offset,
+        int subdivision, bool accents, juce::MidiBuffer& midiBuffer);
+    /**
+		* Add a click or its end to the MidiBuffer
+		*
+		* @param block the song samples played in this block
+		* @param sample the song sample of the event
+		* @param velocity the velocity of the click, 0 ends it
+		* @param midiBuffer a reference to the MidiBuffer of the block
+		*/
+    void addClick(PlaybackBlock const& block, int64_t sample, int velocity, juce::MidiBuffer& midiBuffer);
+
+    std::atomic<int> subdivision; ///<clicks per beat, written by the GUI
+    std::atomic<bool> accents; ///<accent the first beat of a bar, written by the GUI
+    bool sounding = false; ///<a click was started and not yet ended, only used by the audio thread
+};
+}
+#endif
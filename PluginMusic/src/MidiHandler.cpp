@@ -1,18 +1,18 @@
 #include "MidiHandler.h"
 
+#include <algorithm>
+
 using namespace ttmm;
 
 MidiHandler::MidiHandler() {}
 
 MidiHandler::~MidiHandler() {}
 
-void MidiHandler::playNote(Tune tune, bool isOn, int key, Node note,
-    juce::MidiBuffer& midiBuffer, int channelNr,
-    double& playtime, int numSamples, int newVelocity,
-    double secondOfBlock)
+void MidiHandler::playNote(Tune tune, bool isOn, int key, int nodeNumber, int64_t sample,
+    juce::MidiBuffer& midiBuffer, int channelNr, int newVelocity)
 {
     juce::MidiMessage m;
-    int noteNr = note.getNodeNumber();
+    int noteNr = nodeNumber;
     switch (tune)
     {
     case Main:
@@ -37,208 +37,320 @@ void MidiHandler::playNote(Tune tune, bool isOn, int key, Node note,
     if (isOn)
     {
         m = juce::MidiMessage::noteOn(channelNr + 1, noteNr, (uint8)newVelocity);
-        m.setTimeStamp(note.getTimestamp());
-        midiBuffer.addEvent(m, static_cast<int>(((note.getTimestamp() - playtime) / secondOfBlock) * numSamples));
     }
     else
     {
         m = juce::MidiMessage::noteOff(channelNr + 1, noteNr, (uint8)0);
-        m.setTimeStamp(note.getTimestamp() + note.getDelta());
-        midiBuffer.addEvent(m, static_cast<int>((((note.getTimestamp() + note.getDelta()) - playtime) / secondOfBlock) * numSamples));
+    }
+    m.setTimeStamp(double(sample));
+    midiBuffer.addEvent(m, this->block.toSamplePosition(sample));
+}
+
+namespace
+{
+//the strokes of a streamed schedule are not in memory, the StrokeTypes of the sounding ones are kept in a ring
+size_t strokeTypeCount(PlaybackSchedule const& schedule)
+{
+    return (schedule.getStream() != nullptr) ? size_t(ScheduleStream::STROKE_SLOTS) : schedule.getStrokes().size();
+}
+}
+
+void MidiHandler::prepare(PlaybackSchedule const& schedule)
+{
+    //every stroke starts as Tonika
+    this->strokeTypes.assign(strokeTypeCount(schedule), StrokeType::Tonika);
+    //the cursors are placed by the first block
+    this->cursors.clear();
+    this->cursors.reserve(2 * schedule.getTracks().size());
+    this->cursorSchedule = nullptr;
+}
+
+void MidiHandler::swap(MidiHandler& other)
+{
+    this->strokeTypes.swap(other.strokeTypes);
+    this->cursors.swap(other.cursors);
+    std::swap(this->cursorSchedule, other.cursorSchedule);
+    std::swap(this->cursorEnd, other.cursorEnd);
+}
+
+bool MidiHandler::isPreparedFor(PlaybackSchedule const& schedule) const
+{
+    return this->strokeTypes.size() == strokeTypeCount(schedule);
+}
+
+StrokeType& MidiHandler::strokeTypeOf(int32_t stroke)
+{
+    return this->strokeTypes[size_t(stroke) % this->strokeTypes.size()];
+}
+
+bool MidiHandler::toStrokeType(IPCSongInfo_IPCMusician_Tune tune, StrokeType& strokeType)
+{
+    switch (tune)
+    {
+    case IPCSongInfo_IPCMusician_Tune::IPCSongInfo_IPCMusician_Tune_LEFT_UP:
+        strokeType = StrokeType::Subdominante;
+        return true;
+    case IPCSongInfo_IPCMusician_Tune::IPCSongInfo_IPCMusician_Tune_LEFT_DOWN:
+        strokeType = StrokeType::MollParallelSubdominante;
+        return true;
+    case IPCSongInfo_IPCMusician_Tune::IPCSongInfo_IPCMusician_Tune_MIDDLE_UP:
+        strokeType = StrokeType::Tonika;
+        return true;
+    case IPCSongInfo_IPCMusician_Tune::IPCSongInfo_IPCMusician_Tune_MIDDLE_DOWN:
+        strokeType = StrokeType::MollParallelTonika;
+        return true;
+    case IPCSongInfo_IPCMusician_Tune::IPCSongInfo_IPCMusician_Tune_RIGHT_UP:
+        strokeType = StrokeType::Dominante;
+        return true;
+    case IPCSongInfo_IPCMusician_Tune::IPCSongInfo_IPCMusician_Tune_RIGHT_DOWN:
+        strokeType = StrokeType::MollParallelDominante;
+        return true;
+    default:
+        return false;
     }
 }
 
 // Wird von zyklisch aufgerufener Methode processAudioAndMidiSignals verwendet 
-// und fgt alle Bestandteile eines TTMM-Tracks, die zeittechnisch im aktuellen 
+// und fgt alle Bestandteile aller TTMM-Tracks, die zeittechnisch im aktuellen 
 // Block liegen, in einen juce-Midibuffer ein, der dann von allen angeschlossenen 
 // Plugins blockweise ausgelesen und verarbeitet werden kann. 
 // Liest auerdem Musikanten Tonart aus und passt Musikstck an
 void MidiHandler::processTrackToNewMidiBuffer(
-    Track* track, juce::MidiBuffer& newMidiBuffer, double& playtime,
-    double secondEachBlock, int numSamples, IPCSongInfo_IPCMusician musician)
+    PlaybackSchedule const& schedule, PlaybackBlock const& block, juce::MidiBuffer& newMidiBuffer,
+    IPCSongInfo_IPCMusician musician)
 {
-    if (track == nullptr)
+    int64_t length = schedule.getLength();
+    if (length <= 0 || block.endSample <= 0 || !this->isPreparedFor(schedule))
     {
         return;
     }
+    this->block = block;
+    if (schedule.getStream() != nullptr)
+    {
+        schedule.getStream()->forEachEvent(block.firstSample, block.endSample, [&](StreamEvent const& event, int64_t sample)
+        {
+            this->playEvent(event.type, event.stroke, event.key, event.terz, event.nodeNumber, event.velocity,
+                sample, newMidiBuffer, musician);
+        });
+        return;
+    }
+    if (&schedule != this->cursorSchedule || block.firstSample != this->cursorEnd)
+    {
+        this->resetCursors(schedule, block.firstSample);
+    }
+    this->cursorEnd = block.endSample;
+    auto const& events = schedule.getEvents();
+    auto const& tracks = schedule.getTracks();
+    //take the earliest event of all tracks until the next one is after the block
+    while (!this->cursors.empty() && this->cursors.front().sample < block.endSample)
+    {
+        std::pop_heap(this->cursors.begin(), this->cursors.end(), isLater);
+        TrackCursor cursor = this->cursors.back();
+        this->cursors.pop_back();
+        PlaybackTrack const& track = tracks[cursor.track];
+        if (cursor.event == track.firstEvent)
+        {
+            //the next repetition of the track starts, its first events may overlap the last ones of this repetition
+            this->pushCursor(schedule, cursor.track, cursor.repetition + 1, track.firstEvent);
+        }
+        if (cursor.sample >= block.firstSample)
+        {
+            this->playEvent(schedule, events[cursor.event], cursor.sample, newMidiBuffer, musician);
+        }
+        if (cursor.event + 1 < track.firstEvent + track.eventCount)
+        {
+            this->pushCursor(schedule, cursor.track, cursor.repetition, cursor.event + 1);
+        }
+    }
+}
+
+bool MidiHandler::isLater(TrackCursor const& a, TrackCursor const& b)
+{
+    //events at the same sample are played in the order of repetition, track and event
+    if (a.sample != b.sample)
+    {
+        return a.sample > b.sample;
+    }
+    if (a.repetition != b.repetition)
+    {
+        return a.repetition > b.repetition;
+    }
+    if (a.track != b.track)
+    {
+        return a.track > b.track;
+    }
+    return a.event > b.event;
+}
+
+void MidiHandler::pushCursor(PlaybackSchedule const& schedule, int32_t track, int64_t repetition, int32_t event)
+{
+    TrackCursor cursor = { schedule.getEvents()[event].sample + repetition * schedule.getLength(), repetition, track, event };
+    this->cursors.push_back(cursor);
+    std::push_heap(this->cursors.begin(), this->cursors.end(), isLater);
+}
+
+void MidiHandler::resetCursors(PlaybackSchedule const& schedule, int64_t sample)
+{
+    this->cursors.clear();
+    this->cursorSchedule = &schedule;
+    int64_t length = schedule.getLength();
+    auto const& events = schedule.getEvents();
+    auto const& tracks = schedule.getTracks();
+    for (int32_t t = 0; t < int32_t(tracks.size()); t++)
+    {
+        PlaybackTrack const& track = tracks[t];
+        if (track.eventCount == 0)
+        {
+            continue;
+        }
+        auto first = events.begin() + track.firstEvent;
+        auto last = first + track.eventCount;
+        //the first repetition whose last event is not before the position
+        int64_t behind = sample - (last - 1)->sample;
+        int64_t repetition = (behind > 0) ? (behind + length - 1) / length : 0;
+        auto next = std::lower_bound(first, last, sample - repetition * length,
+            [](PlaybackEvent const& event, int64_t s) { return event.sample < s; });
+        this->pushCursor(schedule, t, repetition, int32_t(next - events.begin()));
+        if (next != first)
+        {
+            //the next repetition is started by the first event of this one otherwise
+            this->pushCursor(schedule, t, repetition + 1, track.firstEvent);
+        }
+    }
+}
+
+void MidiHandler::playEvent(PlaybackSchedule const& schedule, PlaybackEvent const& event, int64_t sample,
+    juce::MidiBuffer& midiBuffer, IPCSongInfo_IPCMusician const& musician)
+{
+    PlaybackStroke const& stroke = schedule.getStrokes()[event.stroke];
+    PlaybackNote const* tone = &schedule.getTones()[stroke.firstTone];
+    PlaybackNote const* note = tone;
+    if (event.type == PlaybackEvent::TONE_ON || event.type == PlaybackEvent::TONE_OFF)
+    {
+        note = &schedule.getTones()[event.index];
+    }
+    else if (event.type == PlaybackEvent::NOTE_ON || event.type == PlaybackEvent::NOTE_OFF)
+    {
+        note = &schedule.getNotes()[event.index];
+    }
+    int terz = stroke.toneCount > 1 ? tone[1].nodeNumber : tone[0].nodeNumber;
+    this->playEvent(event.type, event.stroke, tone[0].nodeNumber, terz, note->nodeNumber, note->velocity,
+        sample, midiBuffer, musician);
+}
+
+void MidiHandler::playEvent(int32_t type, int32_t stroke, int root, int terz, int nodeNumber, int velocity,
+    int64_t sample, juce::MidiBuffer& midiBuffer, IPCSongInfo_IPCMusician const& musician)
+{
+    // at the start of a new stroke, transpose if necessary
+    if (type == PlaybackEvent::STROKE_START)
+    {
+        this->toStrokeType(musician.tune(), this->strokeTypeOf(stroke));
+        return;
+    }
+    StrokeType strokeType = this->strokeTypeOf(stroke);
+    int key = Stroke::transpose(root, terz, strokeType);
+    int transposed = Stroke::transpose(nodeNumber, terz, strokeType);
     juce::MidiMessage m;
-    vector<int> nrChannels = track->getChannelNumbers();
-    for (int channelNr : nrChannels)
+    switch (type)
+    {
+    case PlaybackEvent::TONE_ON:
+    case PlaybackEvent::TONE_OFF:
     {
-        Channel* channel = track->getChannelp(channelNr);
-        // get stroke indexes
-        auto strokeIndexes = channel->getStrokeNumbers();
-        for (auto index : strokeIndexes)
+        // add Tone in channel 5
+        if (type == PlaybackEvent::TONE_ON)
         {
-            Stroke* stroke = channel->getStrokep(index);
-            // edit stroke type based on the input values
-            if (stroke->getStart() >= (playtime + secondEachBlock))
-            {
-                break;
-            }
-            Node nodeOfToneCheck = stroke->getNodeOfTone()[0];
-            if ((nodeOfToneCheck.getTimestamp() >= playtime) && (nodeOfToneCheck.getTimestamp() < (playtime + secondEachBlock)))
-            {
-                // at the start of a new stroke, transpose if necessary
-                if (musician.tune() == IPCSongInfo_IPCMusician_Tune::
-                                           IPCSongInfo_IPCMusician_Tune_LEFT_UP)
-                {
-                    stroke->setStrokeType(StrokeType::Subdominante);
-                }
-                else if (musician.tune() == IPCSongInfo_IPCMusician_Tune::
-                                                IPCSongInfo_IPCMusician_Tune_LEFT_DOWN)
-                {
-                    stroke->setStrokeType(StrokeType::MollParallelSubdominante);
-                }
-                else if (musician.tune() == IPCSongInfo_IPCMusician_Tune::
-                                                IPCSongInfo_IPCMusician_Tune_MIDDLE_UP)
-                {
-                    stroke->setStrokeType(StrokeType::Tonika);
-                }
-                else if (musician.tune() == IPCSongInfo_IPCMusician_Tune::
-                                                IPCSongInfo_IPCMusician_Tune_MIDDLE_DOWN)
-                {
-                    stroke->setStrokeType(StrokeType::MollParallelTonika);
-                }
-                else if (musician.tune() == IPCSongInfo_IPCMusician_Tune::
-                                                IPCSongInfo_IPCMusician_Tune_RIGHT_UP)
-                {
-                    stroke->setStrokeType(StrokeType::Dominante);
-                }
-                else if (musician.tune() == IPCSongInfo_IPCMusician_Tune::
-                                                IPCSongInfo_IPCMusician_Tune_RIGHT_DOWN)
-                {
-                    stroke->setStrokeType(StrokeType::MollParallelDominante);
-                }
-            }
-            // add Tone to MidiBuffer
-            for (auto& nodeOfTone : stroke->getNodeOfTone())
-            {
-                if (nodeOfTone.getTimestamp() >= (playtime + secondEachBlock))
-                {
-                    break;
-                }
-                if ((nodeOfTone.getTimestamp() >= playtime) && (nodeOfTone.getTimestamp() < (playtime + secondEachBlock)))
-                {
-                    // add nodeOn in channel 2
-                    m = juce::MidiMessage::noteOn(5, nodeOfTone.getNodeNumber(), (uint8)nodeOfTone.getLength());
-                    m.setTimeStamp(nodeOfTone.getTimestamp());
-                    newMidiBuffer.addEvent(m, static_cast<int>(((nodeOfTone.getTimestamp() - playtime) / secondEachBlock) * numSamples));
-                }
-                if (((nodeOfTone.getTimestamp() + nodeOfTone.getDelta()) >= playtime) && ((nodeOfTone.getTimestamp() + nodeOfTone.getDelta()) < (playtime + secondEachBlock)))
-                {
-                    // add nodeOff in channel 2
-                    m = juce::MidiMessage::noteOff(5, nodeOfTone.getNodeNumber(), (uint8)0);
-                    m.setTimeStamp(nodeOfTone.getTimestamp() + nodeOfTone.getDelta());
-                    newMidiBuffer.addEvent(juce::MidiMessage::noteOff(
-                                               5, nodeOfTone.getNodeNumber(), (uint8)0),
-                        static_cast<int>((((nodeOfTone.getTimestamp() + nodeOfTone.getDelta()) - playtime) / secondEachBlock) * numSamples));
-                    count++;
-                }
-            }
-            // add node On/Off, Metronom to MidiBuffer
-            for (auto& node : stroke->getNodes())
+            m = juce::MidiMessage::noteOn(5, transposed, (uint8)velocity);
+        }
+        else
+        {
+            m = juce::MidiMessage::noteOff(5, transposed, (uint8)0);
+        }
+        m.setTimeStamp(double(sample));
+        midiBuffer.addEvent(m, this->block.toSamplePosition(sample));
+        break;
+    }
+    case PlaybackEvent::NOTE_ON:
+    case PlaybackEvent::NOTE_OFF:
+    {
+        // add main sound in channel 2, 3, 4
+        bool isOn = (type == PlaybackEvent::NOTE_ON);
+        this->playNote(ttmm::Tune::Main, isOn, key, transposed, sample, midiBuffer, 1, musician.volumech1());
+        this->playNote(ttmm::Tune::FirstAccompany, isOn, key, transposed, sample, midiBuffer, 2, musician.volumech2());
+        this->playNote(ttmm::Tune::SecondAccompany, isOn, key, transposed, sample, midiBuffer, 3, musician.volumech3());
+        break;
+    }
+    default:
+        break;
+    }
+}
+
+void MidiHandler::seek(PlaybackSchedule const& schedule, int64_t sample, IPCSongInfo_IPCMusician musician)
+{
+    int64_t length = schedule.getLength();
+    if (length <= 0 || sample < 0 || !this->isPreparedFor(schedule))
+    {
+        return;
+    }
+    if (schedule.getStream() != nullptr)
+    {
+        schedule.getStream()->forEachSounding(sample, [&](StreamEvent const& event)
+        {
+            if (event.type == PlaybackEvent::STROKE_START)
             {
-                if (node.getTimestamp() >= (playtime + secondEachBlock))
-                {
-                    break;
-                }
-                // add main sound in channel 2, 3, 4
-                if ((node.getTimestamp() >= playtime) && (node.getTimestamp() < (playtime + secondEachBlock)))
-                {
-                    // add nodeOn in channel 2, 3, 4
-                    this->playNote(ttmm::Tune::Main, true,
-                        stroke->getNodeOfTone()[0].getNodeNumber(), node,
-                        newMidiBuffer, 1, playtime, numSamples,
-                        musician.volumech1(), secondEachBlock);
-                    this->playNote(ttmm::Tune::FirstAccompany, true,
-                        stroke->getNodeOfTone()[0].getNodeNumber(), node,
-                        newMidiBuffer, 2, playtime, numSamples,
-                        musician.volumech2(), secondEachBlock);
-                    this->playNote(ttmm::Tune::SecondAccompany, true,
-                        stroke->getNodeOfTone()[0].getNodeNumber(), node,
-                        newMidiBuffer, 3, playtime, numSamples,
-                        musician.volumech3(), secondEachBlock);
-                }
-                if (((node.getTimestamp() + node.getDelta()) >= playtime) && ((node.getTimestamp() + node.getDelta()) < (playtime + secondEachBlock)))
-                {
-                    // add nodeOff in channel 2, 3, 4
-                    this->playNote(ttmm::Tune::Main, false,
-                        stroke->getNodeOfTone()[0].getNodeNumber(), node,
-                        newMidiBuffer, 1, playtime, numSamples,
-                        musician.volumech1(), secondEachBlock);
-                    this->playNote(ttmm::Tune::FirstAccompany, false,
-                        stroke->getNodeOfTone()[0].getNodeNumber(), node,
-                        newMidiBuffer, 2, playtime, numSamples,
-                        musician.volumech2(), secondEachBlock);
-                    this->playNote(ttmm::Tune::SecondAccompany, false,
-                        stroke->getNodeOfTone()[0].getNodeNumber(), node,
-                        newMidiBuffer, 3, playtime, numSamples,
-                        musician.volumech3(), secondEachBlock);
-                }
-                // add metronom, tick for each quarter note
-                for (auto start : node.getStartQuarter())
-                {
-                    if ((start >= playtime) && (start < (playtime + secondEachBlock)))
-                    {
-                        // add note on metronom with nodenr = 61 in channel 1
-                        m = juce::MidiMessage::noteOn(1, 61, uint8(100));
-                        m.setTimeStamp(start);
-                        newMidiBuffer.addEvent(m, static_cast<int>(((start - playtime) / secondEachBlock) * numSamples));
-                    }
-                    if (((start + node.getDurationQuarter()) >= playtime) && ((start + node.getDurationQuarter()) < (playtime + secondEachBlock)))
-                    {
-                        // add note off metronom with nodenr = 61 in channel 1
-                        m = juce::MidiMessage::noteOn(1, 61, uint8(0));
-                        m.setTimeStamp(start + node.getDurationQuarter());
-                        newMidiBuffer.addEvent(m, static_cast<int>((((start + node.getDurationQuarter()) - playtime) / secondEachBlock) * numSamples));
-                    }
-                }
+                this->toStrokeType(musician.tune(), this->strokeTypeOf(event.stroke));
             }
-            // remove this stroke in channel when all noteOff of Tone is added to
-            // buffer save the time for the next time
-            if (count == 3)
+        });
+        return;
+    }
+    schedule.forEachSounding(sample % length, [&](PlaybackRef const& ref)
+    {
+        if (ref.kind == PlaybackRef::STROKE)
+        {
+            this->toStrokeType(musician.tune(), this->strokeTypeOf(ref.stroke));
+        }
+    });
+}
+
+void MidiHandler::playSounding(PlaybackSchedule const& schedule, int64_t sample, juce::MidiBuffer& midiBuffer,
+    int position, IPCSongInfo_IPCMusician musician)
+{
+    int64_t length = schedule.getLength();
+    if (length <= 0 || sample < 0 || !this->isPreparedFor(schedule))
+    {
+        return;
+    }
+    //a block of one sample, all note ons are placed at the given position
+    this->block = PlaybackBlock::atOriginalTempo(sample, 1);
+    this->block.offset = position;
+    int64_t inTrack = sample % length;
+    //notes starting exactly at the position are played by processTrackToNewMidiBuffer
+    if (schedule.getStream() != nullptr)
+    {
+        schedule.getStream()->forEachSounding(sample, [&](StreamEvent const& event)
+        {
+            if ((event.type == PlaybackEvent::TONE_ON || event.type == PlaybackEvent::NOTE_ON) && event.sample < inTrack)
             {
-                if (channel->getNumberofStrokes() <= track->getOriginalNumbersOfStroke())
-                {
-                    //add the new stroke to end of Track
-                    //return endtime of track
-                    double endTimeofTrack = track->getEnd();
-                    double durationNote = track->getSecondPerQuarter();
-                    //add new node of tone with the new timestamp
-                    Stroke tempStroke;
-                    size_t numberOfTone = stroke->getNodeOfTone().size();
-                    for (size_t i = 0; i < numberOfTone; i++)
-                    {
-                        Node nodeTone = stroke->getNodeOfTone()[i];
-                        nodeTone.setTimestamp(nodeTone.getTimestamp() + endTimeofTrack);
-                        tempStroke.setStart(nodeTone.getTimestamp());
-                        tempStroke.setEnd(nodeTone.getTimestamp() + nodeTone.getDelta());
-                        tempStroke.setNodeOfTone(nodeTone);
-                    }
-                    //add new node with the new timestamp
-                    auto numberOfNode = stroke->getNodeCount();
-                    for (int i = 0; i < numberOfNode; i++)
-                    {
-                        Node node = stroke->getNode(i);
-                        node.setTimestamp(node.getTimestamp() + endTimeofTrack);
-                        //reset start time of the quarter notes
-                        vector<double> starts;
-                        for (int i = 0; i < node.getNoteType(); i++)
-                        {
-                            starts.push_back(node.getTimestamp() + double(i) * (durationNote));
-                        }
-                        node.setStartQuarter(starts);
-                        //add note
-                        tempStroke.addNode(node);
-                    }
-                    channel->addStroke(channel->getNumberofStrokes() + index, tempStroke);
-                }
-                //remove the processed stroke
-                channel->removeStroke(index);
-                count = 0;
+                this->playEvent(event.type, event.stroke, event.key, event.terz, event.nodeNumber, event.velocity,
+                    sample, midiBuffer, musician);
             }
-        }
+        });
+        return;
     }
-    playtime += secondEachBlock;
+    auto const& strokes = schedule.getStrokes();
+    auto const& tones = schedule.getTones();
+    auto const& notes = schedule.getNotes();
+    schedule.forEachSounding(inTrack, [&](PlaybackRef const& ref)
+    {
+        if (ref.kind == PlaybackRef::STROKE || strokes[ref.stroke].toneCount == 0)
+        {
+            return;
+        }
+        PlaybackNote const& note = (ref.kind == PlaybackRef::TONE) ? tones[ref.index] : notes[ref.index];
+        if (note.on < inTrack)
+        {
+            PlaybackEvent event = { sample, (ref.kind == PlaybackRef::TONE) ? PlaybackEvent::TONE_ON : PlaybackEvent::NOTE_ON,
+                ref.stroke, ref.index };
+            this->playEvent(schedule, event, sample, midiBuffer, musician);
+        }
+    });
 }
@@ -12,6 +12,8 @@
 #include <chrono>
 
 #include "../Model/Song.h"
+#include "PlaybackSchedule.h"
+#include "Transport.h"
 #include "../../TTMM/JuceLibraryCode/JuceHeader.h"
 #include "DataExchange.pb.h"
 
@@ -61,41 +63,161 @@ public:
 		* @param tune which tune has to be played
 		* @param isOn Indicator whether noteOn or noteOff is executed
 		* @param key The key of the current stroke (Tonart)
-		* @param The note that has to be played
+		* @param nodeNumber The transposed note that has to be played
+		* @param sample The song sample of the event, inside the current block
 		* @param midiBuffer a reference to a MidiBuffer
 		* @param channelNr The channelnumber
-		* @param playtime a double value at the currenttime on host
-		* @param numSamples buffersize
 		* @param newVelocity the new value of Velocity for updating the volume of Node
-		* @param secondOfBlock nummer seconds of each block based on the buffernumber and samplerate
 		*/
-    void MidiHandler::playNote(Tune tune, bool isOn, int key, Node note, juce::MidiBuffer& midiBuffer,
-        int channelNr, double& playtime, int numSamples, int newVelocity, double secondOfBlock);
+    void playNote(Tune tune, bool isOn, int key, int nodeNumber, int64_t sample, juce::MidiBuffer& midiBuffer,
+        int channelNr, int newVelocity);
     /**
-		* Read a track in Song and update it to MidiBuffer for exchange with the another group
+		* Reset the StrokeTypes of all strokes of a schedule to Tonika, a streamed schedule uses a ring of
+		* ScheduleStream::STROKE_SLOTS StrokeTypes
+		*
+		* @param schedule the schedule that is played next
+		*/
+    void prepare(PlaybackSchedule const& schedule);
+    /**
+		* Exchange the StrokeTypes and the cursors with another handler. Nothing is allocated, so the audio thread
+		* can take over a handler which was prepared for the next schedule on another thread.
+		*
+		* @param other the handler to exchange the state with
+		*/
+    void swap(MidiHandler& other);
+    /**
+		* Read the events of all tracks played in this block and update them to MidiBuffer for exchange with the another group.
+		* Each track has a cursor on its next event, the cursors are merged by a heap ordered by the sample of that event,
+		* so a block only touches the tracks which play in it. Blocks which do not follow each other reposition the cursors.
+		* The pages of a streamed schedule hold the events of all tracks in order, they are read without cursors.
 		* 
-		* @param stroke a reference to a track in Song
+		* @param schedule the events of the tracks in samples
+		* @param block the song samples played in this block, given by the Transport
 		* @param newMidiBuffer a reference to a MidiBuffer
-		* @param playtime a double value at the currenttime on host
-		* @param secondEachBlock a double value about the number of seconds for a block (buffersize/samplerate, e.g: 2560 / 44100)
-		* @param numSamples buffersize
 		* @param musician a object of IPCSongInfo_IPCMusician
 		*/
-    void processTrackToNewMidiBuffer(Track* track, juce::MidiBuffer& newMidiBuffer,
-        double& playtime, double secondEachBlock, int numSamples, IPCSongInfo_IPCMusician musician);
+    void processTrackToNewMidiBuffer(PlaybackSchedule const& schedule, PlaybackBlock const& block,
+        juce::MidiBuffer& newMidiBuffer, IPCSongInfo_IPCMusician musician);
+    /**
+		* Continue playing at another position: the strokes covering the position take the StrokeType
+		* of the current tune, as if they had just started
+		*
+		* @param schedule the events of the track in samples
+		* @param sample the new position in song samples
+		* @param musician a object of IPCSongInfo_IPCMusician
+		*/
+    void seek(PlaybackSchedule const& schedule, int64_t sample, IPCSongInfo_IPCMusician musician);
+    /**
+		* Add the note ons of all notes which started before a position and are still sounding at it,
+		* call seek before
+		*
+		* @param schedule the events of the track in samples
+		* @param sample the position in song samples
+		* @param midiBuffer a reference to a MidiBuffer
+		* @param position the sample position of the note ons inside the MidiBuffer
+		* @param musician a object of IPCSongInfo_IPCMusician
+		*/
+    void playSounding(PlaybackSchedule const& schedule, int64_t sample, juce::MidiBuffer& midiBuffer,
+        int position, IPCSongInfo_IPCMusician musician);
+    /**
+		* Map the tune of a musician to a StrokeType
+		*
+		* @param tune the tune received through IPC
+		* @param strokeType is set if the tune selects a StrokeType
+		* @return false if the tune does not select a StrokeType (e.g. NONE)
+		*/
+    static bool toStrokeType(IPCSongInfo_IPCMusician_Tune tune, StrokeType& strokeType);
 
     /**
 	*
 	*/
 private:
-    bool isStartOfMetronom = false; //keep the status whether the startTime for metronom is determined
-    double startOfMetronom = 0; //keep value of the startTime of Metronom
-    double durationOfQuarter = 0;
+    /**
+		* Check whether prepare was called for a schedule like this one
+		*
+		* @param schedule the schedule to play
+		* @return true if there is a StrokeType for every stroke of the schedule
+		*/
+    bool isPreparedFor(PlaybackSchedule const& schedule) const;
+    /**
+		* Get the StrokeType of a stroke
+		*
+		* @param stroke index of the stroke in the schedule
+		* @return a reference to the StrokeType, strokes of a streamed schedule share it with every STROKE_SLOTS-th stroke
+		*/
+    StrokeType& strokeTypeOf(int32_t stroke);
+
+    /**
+		* @struct TrackCursor
+		* @brief The next event of one repetition of a track
+		*/
+    struct TrackCursor
+    {
+        int64_t sample; ///<song sample of the event, including the repetition
+        int64_t repetition; ///<the repetition of the song the event belongs to
+        int32_t track; ///<index of the track in PlaybackSchedule::getTracks
+        int32_t event; ///<index of the event in PlaybackSchedule::getEvents
+    };
+
+    /**
+		* Order of the cursor heap, the cursor with the earliest event is on top
+		*
+		* @param a a cursor
+		* @param b another cursor
+		* @return true if the event of a is played after the event of b
+		*/
+    static bool isLater(TrackCursor const& a, TrackCursor const& b);
+    /**
+		* Put a cursor on the heap
+		*
+		* @param schedule the events of the tracks in samples
+		* @param track index of the track
+		* @param repetition the repetition of the song
+		* @param event index of the next event of the track
+		*/
+    void pushCursor(PlaybackSchedule const& schedule, int32_t track, int64_t repetition, int32_t event);
+    /**
+		* Place the cursors of all tracks on their first event at or after a position
+		*
+		* @param schedule the events of the tracks in samples
+		* @param sample the song sample of the next block
+		*/
+    void resetCursors(PlaybackSchedule const& schedule, int64_t sample);
+    /**
+		* Add an event of a track to the MidiBuffer or choose the StrokeType of a starting stroke
+		*
+		* @param schedule the events of the tracks in samples
+		* @param event the event to play
+		* @param sample the song sample of the event
+		* @param midiBuffer a reference to a MidiBuffer
+		* @param musician a object of IPCSongInfo_IPCMusician
+		*/
+    void playEvent(PlaybackSchedule const& schedule, PlaybackEvent const& event, int64_t sample,
+        juce::MidiBuffer& midiBuffer, IPCSongInfo_IPCMusician const& musician);
+    /**
+		* Add an event to the MidiBuffer, transposed by the StrokeType of its stroke, or choose the StrokeType of a starting stroke
+		*
+		* @param type one of the constants of PlaybackEvent
+		* @param stroke index of the stroke in the schedule
+		* @param root node number of the first node of tone of the stroke
+		* @param terz node number of the second node of tone of the stroke
+		* @param nodeNumber node number of the node or node of tone
+		* @param velocity velocity of the node or node of tone
+		* @param sample the song sample of the event
+		* @param midiBuffer a reference to a MidiBuffer
+		* @param musician a object of IPCSongInfo_IPCMusician
+		*/
+    void playEvent(int32_t type, int32_t stroke, int root, int terz, int nodeNumber, int velocity, int64_t sample,
+        juce::MidiBuffer& midiBuffer, IPCSongInfo_IPCMusician const& musician);
+
+    PlaybackBlock block; ///<the song samples played in the current block
+    vector<StrokeType> strokeTypes; ///<the current StrokeType of each stroke of the schedule, see strokeTypeOf
+    vector<TrackCursor> cursors; ///<heap of the cursors of all tracks, see isLater
+    PlaybackSchedule const* cursorSchedule = nullptr; ///<the schedule the cursors refer to
+    int64_t cursorEnd = 0; ///<the cursors are placed for a block starting at this sample
 
     int sample2Notes = 0;
     double time2Notes = 0;
-
-    int count = 0; ///<keep the status whether noteOff of Tone is added to buffer
 };
 }
 #endif
\ No newline at end of file
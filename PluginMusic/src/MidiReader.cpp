@@ -17,12 +17,35 @@ MidiReader::MidiReader(string songname)
     this->songname = songname;
 }
 MidiReader::MidiReader()
+{
+    std::vector<string> songs = readSelectedSongs();
+    if (!songs.empty())
+    {
+        this->songname = songs[0];
+    }
+}
+
+//every line of selectedsong.sng names a song, the songs after the first one form a setlist
+std::vector<string> MidiReader::readSelectedSongs()
 {
     ifstream inFile;
     inFile.open(ExePath() + "\\selectedsong.sng");
-    std::stringstream strStream;
-    strStream << inFile.rdbuf();
-    this->songname = strStream.str();
+    std::vector<string> songs;
+    string line;
+    while (std::getline(inFile, line))
+    {
+        line.erase(line.find_last_not_of(" \t\r") + 1);
+        if (!line.empty())
+        {
+            songs.push_back(line);
+        }
+    }
+    return songs;
+}
+
+juce::File MidiReader::getSongFolder()
+{
+    return juce::File(songpath);
 }
 
 MidiReader::~MidiReader()
@@ -34,6 +57,11 @@ MidiReader::~MidiReader()
     }
 }
 
+juce::File MidiReader::getSongFile()
+{
+    return juce::File(songpath + this->songname);
+}
+
 //read our mididata to Song structur
 String MidiReader::readToSong(Song& tempSong)
 {
@@ -44,45 +72,47 @@ String MidiReader::readToSong(Song& tempSong)
         if (file)
         {
             delete file;
+            file = nullptr;
         }
     }
     else
     {
         fileMidi.readFrom(finput); // note the *
-        //tempSong.addBPM(fileMidi.getTimeFormat());
-        tempSong.addBPM(120);
-        fileMidi.convertTimestampTicksToSeconds();
+        //timestamps stay in ticks, the tempo map converts them to seconds
+        TempoMap tempoMap = readTempoMap(fileMidi);
+        tempSong.setTempoMap(tempoMap);
+        tempSong.addBPM(short(tempoMap.getBpm(0) + 0.5));
+        double ticksPerQuarter = tempoMap.getTicksPerQuarter();
+        this->start = startOffset * ticksPerQuarter;
         int tracks = fileMidi.getNumTracks();
         //ttmm::logfileMidiReader->write("No of Tracks: ", tracks);
         int kS = 0, mm = 0, nm = 0, dn = 0;
-        double ticklength, secondperqn; //second per quarternote based on musicfile
-        //second per quarternote based on BPM and Takttyp
-        double secondperqnFromBPM;
+        double ticklength = 0;
         juce::MidiMessageSequence const* seq;
         juce::MidiMessage tempMessage;
         if (tracks == 1) //type Midi = 0
         {
             seq = fileMidi.getTrack(0); //get all events of a Track
-            readSignatureInfos(seq, kS, mm, nm, dn, ticklength, secondperqn, fileMidi.getTimeFormat());
-            secondperqnFromBPM = (minuteToSeconds / double(120)) * (double(dn) / double(nm));
-            Track track(kS, mm, nm, dn, ticklength, secondperqnFromBPM);
+            readSignatureInfos(seq, kS, mm, nm, dn, ticklength, fileMidi.getTimeFormat());
+            Track track(kS, mm, nm, dn, ticklength, ticksPerQuarter);
             //ttmm::logfileMidiReader->write("reading file ...");
-            convertToTrack(*seq, track, secondperqn);
+            convertToTrack(*seq, track);
             //ttmm::logfileMidiReader->write("add track to song structure");
             tempSong.addTrack(track);
         }
         else //type Midi = 1
         {
             seq = fileMidi.getTrack(0); //get the Track[0]
-            //read the KeySignature, TimeSignatur, TempoSignatur to kS, mm, nm, dn, ticklength, secondperqn
-            readSignatureInfos(seq, kS, mm, nm, dn, ticklength, secondperqn, fileMidi.getTimeFormat()); //get configure informations of the Track[0]
-            secondperqnFromBPM = (minuteToSeconds / fileMidi.getTimeFormat()) * (double(dn) / double(nm));
+            //read the KeySignature, TimeSignatur, TempoSignatur to kS, mm, nm, dn, ticklength
+            readSignatureInfos(seq, kS, mm, nm, dn, ticklength, fileMidi.getTimeFormat()); //get configure informations of the Track[0]
             for (int i = 1; i < tracks; i++)
             {
                 //ttmm::logfileMidiReader->write("reading track ", i);
                 seq = fileMidi.getTrack(i); //get all events of each Track
-                Track track(kS, mm, nm, dn, ticklength, secondperqnFromBPM);
-                convertToTrack(*seq, track, secondperqn);
+                //the tracks are played together, each one starts at the beginning of the song
+                this->start = startOffset * ticksPerQuarter;
+                Track track(kS, mm, nm, dn, ticklength, ticksPerQuarter);
+                convertToTrack(*seq, track);
                 //ttmm::logfileMidiReader->write("add track to song structure");
                 tempSong.addTrack(track);
             }
@@ -94,11 +124,47 @@ String MidiReader::readToSong(Song& tempSong)
 	return songname;
 }
 
+//collect the set-tempo and time-signature meta events of all tracks
+TempoMap MidiReader::readTempoMap(juce::MidiFile const& midiFile)
+{
+    short timeFormat = midiFile.getTimeFormat();
+    if (timeFormat <= 0)
+    {
+        //SMPTE: the high byte is -frames per second, the low byte ticks per frame.
+        //The tempo is fixed, so pretend 120 bpm with the matching resolution.
+        double ticksPerSecond = double(-(timeFormat >> 8)) * double(timeFormat & 0xff);
+        return TempoMap(ticksPerSecond * 0.5);
+    }
+    TempoMap tempoMap(timeFormat);
+    juce::MidiMessageSequence events;
+    midiFile.findAllTempoEvents(events);
+    for (int i = 0; i < events.getNumEvents(); i++)
+    {
+        juce::MidiMessage const& m = events.getEventPointer(i)->message;
+        tempoMap.addTempo(m.getTimeStamp(), m.getTempoSecondsPerQuarterNote());
+    }
+    events.clear();
+    midiFile.findAllTimeSigEvents(events);
+    for (int i = 0; i < events.getNumEvents(); i++)
+    {
+        juce::MidiMessage const& m = events.getEventPointer(i)->message;
+        int numerator = 4, denominator = 4;
+        m.getTimeSignatureInfo(numerator, denominator);
+        tempoMap.addTimeSignature(m.getTimeStamp(), numerator, denominator);
+    }
+    tempoMap.finalize();
+    return tempoMap;
+}
+
 //convert Message events in a Track to Channel object
-void MidiReader::convertToTrack(juce::MidiMessageSequence const& seq, Track& track, double secondperqn)
+void MidiReader::convertToTrack(juce::MidiMessageSequence const& seq, Track& track)
 {
-    track.setStart(start - tolerantOfTone);
-    std::cout << "seconds per quarter from Musicfile: " << secondperqn << std::endl;
+    //all positions and durations are in ticks, the tolerances are given in quarters
+    double ticksPerQuarter = track.getTicksPerQuarter();
+    double toneTolerance = tolerantOfTone * ticksPerQuarter;
+    double noteTolerance = tolerantOfNote * ticksPerQuarter;
+    double durationTolerance = tolerantOfDuration * ticksPerQuarter;
+    track.setStart(start - toneTolerance);
     // for keeping state of the note On -> Off
     double** state = new double*[16];
     double** state2 = new double*[16];
@@ -137,8 +203,6 @@ void MidiReader::convertToTrack(juce::MidiMessageSequence const& seq, Track& tra
     //nodeNr keeps the NodeNr for node on/off events
     int nodeNr, nodeNr1, nodeNr2, nodeNr3;
     int velocity;
-    double secondperqnFromBPM = track.getSecondPerQuarter();
-    std::cout << "seconds per quarter from BPM: " << secondperqnFromBPM << std::endl;
     //this keeps the index for stroke
     //update it after a Tone (Tonart) is added
     int index = 0;
@@ -189,22 +253,22 @@ void MidiReader::convertToTrack(juce::MidiMessageSequence const& seq, Track& tra
                     }
                     //add start/end time of stroke
                     tempStroke.setStart(stateTone2[channelNr][nodeNr1]);
-                    tempStroke.setEnd(start - tolerantOfTone);
+                    tempStroke.setEnd(start - toneTolerance);
                     //add 3 nodeNr of Tone to Stroke for storing
                     node1ofTone.setTimestamp(stateTone2[channelNr][nodeNr1]);
-                    node1ofTone.setDelta(start - tolerantOfTone - stateTone2[channelNr][nodeNr1]);
+                    node1ofTone.setDelta(start - toneTolerance - stateTone2[channelNr][nodeNr1]);
                     node1ofTone.setNodeNumber(nodeNr1);
                     //add node to Stroke
                     tempStroke.setNodeOfTone(node1ofTone);
                     //
                     node2ofTone.setTimestamp(stateTone2[channelNr][nodeNr2]);
-                    node2ofTone.setDelta(start - tolerantOfTone - stateTone2[channelNr][nodeNr2]);
+                    node2ofTone.setDelta(start - toneTolerance - stateTone2[channelNr][nodeNr2]);
                     node2ofTone.setNodeNumber(nodeNr2);
                     //add node to Stroke
                     tempStroke.setNodeOfTone(node2ofTone);
                     //
                     node3ofTone.setTimestamp(stateTone2[channelNr][nodeNr3]);
-                    node3ofTone.setDelta(start - tolerantOfTone - stateTone2[channelNr][nodeNr3]);
+                    node3ofTone.setDelta(start - toneTolerance - stateTone2[channelNr][nodeNr3]);
                     node3ofTone.setNodeNumber(nodeNr3);
                     //add node to Stroke
                     tempStroke.setNodeOfTone(node3ofTone);
@@ -243,51 +307,33 @@ void MidiReader::convertToTrack(juce::MidiMessageSequence const& seq, Track& tra
                     double duration = m.getTimeStamp() - state[channelNr][nodeNr];
                     tempNode.setTimestamp(state2[channelNr][nodeNr]);
                     tempNode.setNodeNumber(nodeNr);
-                    //check type of note and divide to the quarter notes
-                    if ((duration >= (secondperqn - 0.1))
-                        && (duration <= (secondperqn + 0.1))) //is a quarter note
+                    //check type of note
+                    if ((duration >= (ticksPerQuarter - durationTolerance))
+                        && (duration <= (ticksPerQuarter + durationTolerance))) //is a quarter note
                     {
                         tempNode.setNoteType(ttmm::NoteType::Quarter);
-                        //add timestamp and duration of a quarter note
-                        vector<double> startQuarter;
-                        for (int i = 0; i < 1; i++)
-                        {
-                            startQuarter.push_back(state2[channelNr][nodeNr] + double(i) * (secondperqnFromBPM));
-                        }
-                        tempNode.setStartQuarter(startQuarter);
-                        tempNode.setDurationQuarter(secondperqnFromBPM - tolerantOfNote);
-                        tempNode.setDelta((double(1) * secondperqnFromBPM) - tolerantOfNote);
-                        start += secondperqnFromBPM;
+                        //add duration of a quarter note
+                        tempNode.setDurationQuarter(ticksPerQuarter - noteTolerance);
+                        tempNode.setDelta((double(1) * ticksPerQuarter) - noteTolerance);
+                        start += ticksPerQuarter;
                     }
-                    else if ((duration >= ((2 * secondperqn) - 0.1))
-                        && (duration <= ((2 * secondperqn) + 0.1))) //is a haft note?
+                    else if ((duration >= ((2 * ticksPerQuarter) - durationTolerance))
+                        && (duration <= ((2 * ticksPerQuarter) + durationTolerance))) //is a haft note?
                     {
                         tempNode.setNoteType(ttmm::NoteType::Haft);
-                        //divide the haft note to 2 quarter notes with the same duration
-                        vector<double> startQuarter;
-                        for (int i = 0; i < 2; i++)
-                        {
-                            startQuarter.push_back(state2[channelNr][nodeNr] + double(i) * (secondperqnFromBPM));
-                        }
-                        tempNode.setStartQuarter(startQuarter);
-                        tempNode.setDurationQuarter(secondperqnFromBPM - tolerantOfNote);
-                        tempNode.setDelta((double(2) * secondperqnFromBPM) - tolerantOfNote);
-                        start += double(2) * secondperqnFromBPM;
+                        //the haft note lasts 2 quarter notes
+                        tempNode.setDurationQuarter(ticksPerQuarter - noteTolerance);
+                        tempNode.setDelta((double(2) * ticksPerQuarter) - noteTolerance);
+                        start += double(2) * ticksPerQuarter;
                     }
-                    else if ((duration >= ((4 * secondperqn) - 0.1))
-                        && (duration <= ((4 * secondperqn) + 0.1))) //is a whole note
+                    else if ((duration >= ((4 * ticksPerQuarter) - durationTolerance))
+                        && (duration <= ((4 * ticksPerQuarter) + durationTolerance))) //is a whole note
                     {
                         tempNode.setNoteType(ttmm::NoteType::Whole);
-                        //divide the whole note to 4 quarter notes with the same duration
-                        vector<double> startQuarter;
-                        for (int i = 0; i < 4; i++)
-                        {
-                            startQuarter.push_back(state2[channelNr][nodeNr] + double(i) * (secondperqnFromBPM));
-                        }
-                        tempNode.setStartQuarter(startQuarter);
-                        tempNode.setDurationQuarter(secondperqnFromBPM - tolerantOfNote);
-                        tempNode.setDelta((double(4) * secondperqnFromBPM) - tolerantOfNote);
-                        start += double(4) * secondperqnFromBPM;
+                        //the whole note lasts 4 quarter notes
+                        tempNode.setDurationQuarter(ticksPerQuarter - noteTolerance);
+                        tempNode.setDelta((double(4) * ticksPerQuarter) - noteTolerance);
+                        start += double(4) * ticksPerQuarter;
                     }
                     //add node to Stroke
                     tempStroke.addNode(tempNode);
@@ -305,13 +351,13 @@ void MidiReader::convertToTrack(juce::MidiMessageSequence const& seq, Track& tra
                     //add 3 nodeNr of Tone to stateTone for tracking to 3 NoteOff of Tone
                     node1ofTone.setLength(m.getVelocity());
                     stateTone[channelNr][m.getNoteNumber()] = m.getTimeStamp();
-                    stateTone2[channelNr][m.getNoteNumber()] = start - tolerantOfTone;
+                    stateTone2[channelNr][m.getNoteNumber()] = start - toneTolerance;
                     node2ofTone.setLength(m2.getVelocity());
                     stateTone[channelNr][m2.getNoteNumber()] = m2.getTimeStamp();
-                    stateTone2[channelNr][m2.getNoteNumber()] = start - tolerantOfTone;
+                    stateTone2[channelNr][m2.getNoteNumber()] = start - toneTolerance;
                     node3ofTone.setLength(m3.getVelocity());
                     stateTone[channelNr][m3.getNoteNumber()] = m3.getTimeStamp();
-                    stateTone2[channelNr][m3.getNoteNumber()] = start - tolerantOfTone;
+                    stateTone2[channelNr][m3.getNoteNumber()] = start - toneTolerance;
                     //jump i and pass the three nodeNr of Tone"
                     i = i + 2;
                 }
@@ -345,23 +391,23 @@ void MidiReader::convertToTrack(juce::MidiMessageSequence const& seq, Track& tra
                 }
                 //add start/end time of stroke
                 tempStroke.setStart(stateTone2[channelNr][nodeNr1]);
-                tempStroke.setEnd(start - tolerantOfTone);
+                tempStroke.setEnd(start - toneTolerance);
                 //ttmm::logfileMidiReader->write(std::to_string(tempStroke.getStart()));
                 //add 3 nodeNr of Tone to Stroke for storing
                 node1ofTone.setTimestamp(stateTone2[channelNr][nodeNr1]);
-                node1ofTone.setDelta(start - tolerantOfTone - stateTone2[channelNr][nodeNr1]);
+                node1ofTone.setDelta(start - toneTolerance - stateTone2[channelNr][nodeNr1]);
                 node1ofTone.setNodeNumber(nodeNr1);
                 //add node to Stroke
                 tempStroke.setNodeOfTone(node1ofTone);
                 //
                 node2ofTone.setTimestamp(stateTone2[channelNr][nodeNr2]);
-                node2ofTone.setDelta(start - tolerantOfTone - stateTone2[channelNr][nodeNr2]);
+                node2ofTone.setDelta(start - toneTolerance - stateTone2[channelNr][nodeNr2]);
                 node2ofTone.setNodeNumber(nodeNr2);
                 //add node to Stroke
                 tempStroke.setNodeOfTone(node2ofTone);
                 //
                 node3ofTone.setTimestamp(stateTone2[channelNr][nodeNr3]);
-                node3ofTone.setDelta(start - tolerantOfTone - stateTone2[channelNr][nodeNr3]);
+                node3ofTone.setDelta(start - toneTolerance - stateTone2[channelNr][nodeNr3]);
                 node3ofTone.setNodeNumber(nodeNr3);
                 //add node to Stroke
                 tempStroke.setNodeOfTone(node3ofTone);
@@ -404,51 +450,33 @@ void MidiReader::convertToTrack(juce::MidiMessageSequence const& seq, Track& tra
                 tempNode.setTimestamp(state2[channelNr][nodeNr]);
                 tempNode.setNodeNumber(nodeNr);
 
-                //check type of note and divide to the quarter notes
-                if ((duration >= (secondperqn - 0.1))
-                    && (duration <= (secondperqn + 0.1))) //is a quarter note
+                //check type of note
+                if ((duration >= (ticksPerQuarter - durationTolerance))
+                    && (duration <= (ticksPerQuarter + durationTolerance))) //is a quarter note
                 {
                     tempNode.setNoteType(ttmm::NoteType::Quarter);
-                    //add timestamp and duration of a quarter note
-                    vector<double> startQuarter;
-                    for (int i = 0; i < 1; i++)
-                    {
-                        startQuarter.push_back(state2[channelNr][nodeNr] + double(i) * (secondperqnFromBPM));
-                    }
-                    tempNode.setStartQuarter(startQuarter);
-                    tempNode.setDurationQuarter(secondperqnFromBPM - tolerantOfNote);
-                    tempNode.setDelta(secondperqnFromBPM - tolerantOfNote);
-                    start += secondperqnFromBPM;
+                    //add duration of a quarter note
+                    tempNode.setDurationQuarter(ticksPerQuarter - noteTolerance);
+                    tempNode.setDelta(ticksPerQuarter - noteTolerance);
+                    start += ticksPerQuarter;
                 }
-                else if ((duration >= ((2 * secondperqn) - 0.1))
-                    && (duration <= ((2 * secondperqn) + 0.1))) //is a haft note?
+                else if ((duration >= ((2 * ticksPerQuarter) - durationTolerance))
+                    && (duration <= ((2 * ticksPerQuarter) + durationTolerance))) //is a haft note?
                 {
                     tempNode.setNoteType(ttmm::NoteType::Haft);
-                    //divide the haft note to 2 quarter notes with the same duration
-                    vector<double> startQuarter;
-                    for (int i = 0; i < 2; i++)
-                    {
-                        startQuarter.push_back(state2[channelNr][nodeNr] + double(i) * (secondperqnFromBPM));
-                    }
-                    tempNode.setStartQuarter(startQuarter);
-                    tempNode.setDurationQuarter(secondperqnFromBPM - tolerantOfNote);
-                    tempNode.setDelta((double(2) * secondperqnFromBPM) - tolerantOfNote);
-                    start += double(2) * secondperqnFromBPM;
+                    //the haft note lasts 2 quarter notes
+                    tempNode.setDurationQuarter(ticksPerQuarter - noteTolerance);
+                    tempNode.setDelta((double(2) * ticksPerQuarter) - noteTolerance);
+                    start += double(2) * ticksPerQuarter;
                 }
-                else if ((duration >= ((4 * secondperqn) - 0.1))
-                    && (duration <= ((4 * secondperqn) + 0.1))) //is a whole note
+                else if ((duration >= ((4 * ticksPerQuarter) - durationTolerance))
+                    && (duration <= ((4 * ticksPerQuarter) + durationTolerance))) //is a whole note
                 {
                     tempNode.setNoteType(ttmm::NoteType::Whole);
-                    //divide the whole note to 4 quarter notes with the same duration
-                    vector<double> startQuarter;
-                    for (int i = 0; i < 4; i++)
-                    {
-                        startQuarter.push_back(state2[channelNr][nodeNr] + double(i) * (secondperqnFromBPM));
-                    }
-                    tempNode.setStartQuarter(startQuarter);
-                    tempNode.setDurationQuarter(secondperqnFromBPM - tolerantOfNote);
-                    tempNode.setDelta((double(4) * secondperqnFromBPM) - tolerantOfNote);
-                    start += double(4) * secondperqnFromBPM;
+                    //the whole note lasts 4 quarter notes
+                    tempNode.setDurationQuarter(ticksPerQuarter - noteTolerance);
+                    tempNode.setDelta((double(4) * ticksPerQuarter) - noteTolerance);
+                    start += double(4) * ticksPerQuarter;
                 }
 
                 //add node to Stroke
@@ -461,7 +489,7 @@ void MidiReader::convertToTrack(juce::MidiMessageSequence const& seq, Track& tra
         }
     }
     //tempChannel = track.getChannel(channelNr);
-    track.setEnd(start - tolerantOfTone);
+    track.setEnd(start - toneTolerance);
     track.setOriginalNumbersOfStroke(index);
     //testing
     //ttmm::logfileMidiReader->write("Channel: ", (channelNr + 1), tempChannel.getStrokes().size());
@@ -481,7 +509,7 @@ void MidiReader::convertToTrack(juce::MidiMessageSequence const& seq, Track& tra
 
 void MidiReader::readSignatureInfos(juce::MidiMessageSequence const* seq,
     int& kS, int& mm, int& nm, int& dn,
-    double& ticklength, double& secondperqn, short const& timeformat)
+    double& ticklength, short const& timeformat)
 {
     juce::MidiMessage tempMessage;
     for (int event = 0; event < seq->getNumEvents(); event++)
@@ -510,8 +538,7 @@ void MidiReader::readSignatureInfos(juce::MidiMessageSequence const* seq,
         else if (tempMessage.isTempoMetaEvent())
         {
             ticklength = tempMessage.getTempoMetaEventTickLength(timeformat);
-            secondperqn = tempMessage.getTempoSecondsPerQuarterNote();
-            //ttmm::logfileMidiReader->write("Tempo Signature", ticklength, secondperqn);
+            //ttmm::logfileMidiReader->write("Tempo Signature", ticklength);
         }
     }
 }
\ No newline at end of file
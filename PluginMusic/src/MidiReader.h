@@ -13,6 +13,7 @@
 #include <Windows.h>
 #include <string>
 #include <sstream>
+#include <vector>
 
 #include "FileWriter.h"
 #include "../Model/Song.h"
@@ -51,6 +52,31 @@ public:
 		* @param song a reference to song object
 		*/
     String readToSong(Song& song);
+    /**
+		* Get the midi file of the selected song
+		*
+		* @return the file in the Soundfiles folder
+		*/
+    juce::File getSongFile();
+    /**
+		* Read the songs selected in selectedsong.sng, one song per line
+		*
+		* @return the names of the song files, the first one is played first
+		*/
+    static std::vector<string> readSelectedSongs();
+    /**
+		* Get the folder of the song files
+		*
+		* @return the Soundfiles folder
+		*/
+    static juce::File getSongFolder();
+    /**
+		* Build the tempo map from the set-tempo and time-signature meta events of all tracks
+		*
+		* @param midiFile a read midi file
+		* @return the tempo map of the midi file
+		*/
+    static TempoMap readTempoMap(juce::MidiFile const& midiFile);
 
     /**
 	*
@@ -58,10 +84,11 @@ public:
 private:
     juce::File* file = nullptr; ///<a file object
     string songname; ///<a name of a song file
-    double minuteToSeconds = 60;
-    double start = 0.001;
-    double tolerantOfTone = 0.001;
-    double tolerantOfNote = 0.01;
+    double start = 0; ///<running position in ticks while converting a track
+    double startOffset = 0.002; ///<offset of the first stroke in quarters
+    double tolerantOfTone = 0.002; ///<a tone starts this many quarters before its nodes
+    double tolerantOfNote = 0.02; ///<gap between two quarters of the metronom in quarters
+    double tolerantOfDuration = 0.2; ///<allowed deviation of a note length in quarters
     juce::MidiFile fileMidi; ///<a midifile object
     /**
 		* Read the KeySignature (tone), TimeSignature (StrokeType), TempoSignature and put into the references respectively
@@ -72,20 +99,18 @@ private:
 		* @param nm a reference to nominator
 		* @param dn a reference to denominator
 		* @param tl a reference to tick length of tempo meta event
-		* @param spqn a reference to seconds per quarternote of Musicfile
 		* @param timeformat a short const reference timeformat bit per minute 
 		*/
     void readSignatureInfos(juce::MidiMessageSequence const* seq,
         int& kS, int& mm, int& nm, int& dn,
-        double& tl, double& spqn, short const& timeformat);
+        double& tl, short const& timeformat);
     /**
 		* Convert the Midievents to the node/ aftertouch events in Channel and put into the Stroke-reference
 		* 
 		* @param seq a reference to MidiMessageSequence
-		* @param track a reference to track
-		* @param secondperqn seconds per quarter note based on Musicfile
+		* @param track a reference to track, the timestamps of its nodes are in ticks
 		*/
-    void convertToTrack(juce::MidiMessageSequence const& seq, Track& track, double secondperqn);
+    void convertToTrack(juce::MidiMessageSequence const& seq, Track& track);
 };
 }
 #endif
\ No newline at end of file
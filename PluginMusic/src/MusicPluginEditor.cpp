@@ -9,11 +9,21 @@ namespace ttmm {
 
 		txtSong = new TextEditor("txtSong", 0);
 		txtTempo = new TextEditor("txtTempo", 0);
+		txtFirstBar = new TextEditor("txtFirstBar", 0);
+		txtLastBar = new TextEditor("txtLastBar", 0);
 		lblSong = new Label("lblSong", "Song Name:");
 		lblTempo = new Label("lblTempo", "Song Tempo:");
+		lblBars = new Label("lblBars", "Takte:");
+		lblMetronome = new Label("lblMetronome", "Metronom:");
 		btnSong = new TextButton("ndern..", "Klicken um neues MIDI File auszuwhlen");
 		btnPlus = new TextButton("+", "Klicken um Tempo zu erhhen");
 		btnMinus = new TextButton("-", "Klicken um Tempo zu verringern");
+		btnJump = new TextButton("Springen", "Klicken um zum ersten Takt zu springen");
+		btnLoop = new TextButton("Schleife", "Klicken um die Takte wiederholt zu spielen");
+		boxMetronome = new ComboBox("boxMetronome");
+		btnAccent = new ToggleButton("Betonung");
+		btnVariation = new ToggleButton("Begleitung variieren");
+		btnFollow = new ToggleButton("Tempo folgen");
 		boxNotes = new ListBox();
 
 		lblSong->setSize(100, 20);
@@ -21,9 +31,10 @@ namespace ttmm {
 		txtSong->setSize(200, 20);
 		txtSong->setTopLeftPosition(150, 20);
 		txtSong->setText(processor.getSongName());
-		txtSong->setReadOnly(true);
+		txtSong->setTooltip("Teil des Namens eingeben um die Songs zu filtern");
 		btnSong->setSize(70, 20);
 		btnSong->setTopLeftPosition(360, 20);
+		btnSong->addListener(this);
 		
 		lblTempo->setSize(100, 20);
 		lblTempo->setTopLeftPosition(20, 50);
@@ -35,10 +46,62 @@ namespace ttmm {
 		btnMinus->setTopLeftPosition(360, 50);
 		btnPlus->setSize(30, 20);
 		btnPlus->setTopLeftPosition(400, 50);
+		btnMinus->addListener(this);
+		btnPlus->addListener(this);
 
-		boxNotes->setSize(WIN_WIDTH - 40, WIN_HEIGHT - 100);
-		boxNotes->setTopLeftPosition(20, 80);
-		boxNotes->setModel(new ListDisplay());
+		lblBars->setSize(100, 20);
+		lblBars->setTopLeftPosition(20, 80);
+		txtFirstBar->setSize(95, 20);
+		txtFirstBar->setTopLeftPosition(150, 80);
+		txtFirstBar->setInputRestrictions(4, "0123456789");
+		txtFirstBar->setText("1");
+		txtLastBar->setSize(95, 20);
+		txtLastBar->setTopLeftPosition(255, 80);
+		txtLastBar->setInputRestrictions(4, "0123456789");
+		txtLastBar->setText(String(processor.getBarCount()));
+		btnJump->setSize(60, 20);
+		btnJump->setTopLeftPosition(360, 80);
+		btnLoop->setSize(60, 20);
+		btnLoop->setTopLeftPosition(430, 80);
+		btnLoop->setClickingTogglesState(true);
+		btnJump->addListener(this);
+		btnLoop->addListener(this);
+
+		//the id of an entry is the number of clicks per beat + 1
+		lblMetronome->setSize(100, 20);
+		lblMetronome->setTopLeftPosition(20, 110);
+		boxMetronome->setSize(200, 20);
+		boxMetronome->setTopLeftPosition(150, 110);
+		boxMetronome->addItem("Aus", 1);
+		boxMetronome->addItem("Viertel", 2);
+		boxMetronome->addItem("Achtel", 3);
+		boxMetronome->addItem("Triolen", 4);
+		boxMetronome->addItem("Sechzehntel", 5);
+		boxMetronome->setSelectedId(processor.getMetronomeSubdivision() + 1, dontSendNotification);
+		boxMetronome->addListener(this);
+		btnAccent->setSize(100, 20);
+		btnAccent->setTopLeftPosition(360, 110);
+		btnAccent->setTooltip("Den ersten Schlag jedes Taktes betonen");
+		btnAccent->setToggleState(processor.hasMetronomeAccents(), dontSendNotification);
+		btnAccent->addListener(this);
+
+		//the accompaniment on channel 6 follows the accuracy, the tune and the volume of the musician
+		btnVariation->setSize(200, 20);
+		btnVariation->setTopLeftPosition(150, 140);
+		btnVariation->setTooltip("Die Begleitung aus dem Spiel des Musikers erzeugen");
+		btnVariation->setToggleState(processor.hasVariation(), dontSendNotification);
+		btnVariation->addListener(this);
+		//the input plugins estimate the tempo of the musicians, the song is played in it
+		btnFollow->setSize(120, 20);
+		btnFollow->setTopLeftPosition(360, 140);
+		btnFollow->setTooltip("Das Tempo des Songs an das Spiel der Musiker anpassen");
+		btnFollow->setToggleState(processor.isTempoFollowing(), dontSendNotification);
+		btnFollow->addListener(this);
+
+		boxNotes->setSize(WIN_WIDTH - 40, WIN_HEIGHT - 190);
+		boxNotes->setTopLeftPosition(20, 170);
+		noteRows = new ListDisplay();
+		boxNotes->setModel(noteRows);
 
 		addAndMakeVisible(txtSong);
 		addAndMakeVisible(lblSong);
@@ -47,7 +110,19 @@ namespace ttmm {
 		addAndMakeVisible(lblTempo);
 		addAndMakeVisible(btnPlus);
 		addAndMakeVisible(btnMinus);
+		addAndMakeVisible(lblBars);
+		addAndMakeVisible(txtFirstBar);
+		addAndMakeVisible(txtLastBar);
+		addAndMakeVisible(btnJump);
+		addAndMakeVisible(btnLoop);
+		addAndMakeVisible(lblMetronome);
+		addAndMakeVisible(boxMetronome);
+		addAndMakeVisible(btnAccent);
+		addAndMakeVisible(btnVariation);
+		addAndMakeVisible(btnFollow);
 		addAndMakeVisible(boxNotes);
+		//the audio thread queues the played notes, they are shown by the timer
+		startTimer(NOTES_INTERVAL);
 	}
 
 	void MusicPluginEditor::paint(Graphics& g)
@@ -56,19 +131,129 @@ namespace ttmm {
 		g.fillAll(Colours::white);
 	}
 
-	void MusicPluginEditor::addContent(String content)
+	void MusicPluginEditor::buttonClicked(Button* button)
 	{
-		if (this == nullptr)
+		//the new song is loaded in the background and played from the next bar
+		if (button == btnSong)
+		{
+			chooseSong();
+		}
+		//only the rate of the transport changes, the song itself stays untouched
+		else if (button == btnPlus)
+		{
+			processor.setTempoRate(processor.getTempoRate() + TEMPO_STEP);
+		}
+		else if (button == btnMinus)
+		{
+			processor.setTempoRate(processor.getTempoRate() - TEMPO_STEP);
+		}
+		//jumps and loops are done by the audio thread with the next block
+		else if (button == btnJump)
 		{
-			//ttmm::logfileMusic->write("editor fenster existiert nicht");
-			return;
+			processor.seekToBar(txtFirstBar->getText().getIntValue());
 		}
-		else
+		else if (button == btnLoop)
 		{
-			//ttmm::logfileMusic->write("editor fenster ist offen, schreibe eintrag in liste");
-			int nr = ((ListDisplay*)boxNotes->getModel())->addRow(content);
-			boxNotes->scrollToEnsureRowIsOnscreen(nr);
+			if (btnLoop->getToggleState())
+			{
+				processor.setLoop(txtFirstBar->getText().getIntValue(), txtLastBar->getText().getIntValue());
+			}
+			else
+			{
+				processor.clearLoop();
+			}
+		}
+		else if (button == btnAccent)
+		{
+			processor.setMetronomeAccents(btnAccent->getToggleState());
+		}
+		else if (button == btnVariation)
+		{
+			processor.setVariation(btnVariation->getToggleState());
+		}
+		else if (button == btnFollow)
+		{
+			processor.setTempoFollowing(btnFollow->getToggleState());
+		}
+		txtTempo->setText(processor.getSongTempo());
+	}
+
+	void MusicPluginEditor::comboBoxChanged(ComboBox* comboBox)
+	{
+		//the metronome takes the new clicks with the next block
+		if (comboBox == boxMetronome)
+		{
+			processor.setMetronomeSubdivision(boxMetronome->getSelectedId() - 1);
+		}
+	}
+
+	void MusicPluginEditor::chooseSong()
+	{
+		//the menu is built from the library, the midi files are not opened
+		LibraryFilter filter;
+		if (txtSong->getText() != processor.getSongName())
+		{
+			filter.text = txtSong->getText();
+		}
+		std::vector<LibraryEntry> songs = processor.getLibrary().find(filter);
+		PopupMenu menu;
+		for (size_t i = 0; i < songs.size(); i++)
+		{
+			LibraryEntry const& song = songs[i];
+			int seconds = int(song.duration + 0.5);
+			menu.addItem(int(i) + 1, String(song.name) + "  (" + String(int(song.bpm + 0.5)) + " bpm, "
+				+ String(song.numerator) + "/" + String(song.denominator) + ", "
+				+ String(seconds / 60) + ":" + String(seconds % 60).paddedLeft('0', 2) + ")");
+		}
+		if (songs.empty())
+		{
+			menu.addItem(-2, processor.getLibrary().isScanning() ? "Songs werden gelesen..." : "Kein Song gefunden", false);
+		}
+		menu.addSeparator();
+		menu.addItem(-1, "Andere Datei...");
+		int result = menu.showAt(btnSong);
+		String songname;
+		if (result > 0)
+		{
+			songname = songs[size_t(result - 1)].name;
+		}
+		else if (result == -1)
+		{
+			FileChooser chooser("MIDI File auswhlen", MidiReader::getSongFolder(), "*.mid");
+			if (chooser.browseForFileToOpen())
+			{
+				songname = chooser.getResult().getFileName();
+			}
+		}
+		if (songname.isNotEmpty())
+		{
+			processor.changeSong(songname.toStdString());
+			txtSong->setText(songname);
+		}
+	}
+
+	void MusicPluginEditor::timerCallback()
+	{
+		//the list is updated once for all notes of the interval
+		NoteLogEntry entries[64];
+		int rows = 0;
+		for (int count = processor.readNoteLog(entries, 64); count > 0; count = processor.readNoteLog(entries, 64))
+		{
+			for (int i = 0; i < count; i++)
+			{
+				rows = noteRows->addRow(entries[i]);
+			}
+		}
+		if (rows > 0)
+		{
+			boxNotes->updateContent();
+			boxNotes->scrollToEnsureRowIsOnscreen(rows - 1);
 			boxNotes->repaint();
 		}
+		//the tempo changes while it follows the musicians
+		if (processor.isTempoFollowing())
+		{
+			txtTempo->setText(processor.getSongTempo(), false);
+		}
 	}
 }
@@ -3,28 +3,45 @@
 
 namespace ttmm
 {
-	class MusicPluginEditor : public juce::AudioProcessorEditor
+	class MusicPluginEditor : public juce::AudioProcessorEditor, public Button::Listener, public ComboBox::Listener, private juce::Timer
 	{
 	public:
 		MusicPluginEditor(DynamicComposition &);
 		~MusicPluginEditor() = default;
 
 		void paint(Graphics&) override;
-		void addContent(String content);
+		void buttonClicked(Button* button) override; //<change the song with btnSong, the tempo with btnPlus and btnMinus, jump and loop with btnJump and btnLoop, the generated accompaniment with btnVariation, following the musicians with btnFollow
+		void comboBoxChanged(ComboBox* comboBox) override; //<change the clicks per beat of the metronome with boxMetronome
+		void timerCallback() override; //<add the notes played since the last call to boxNotes, show the followed tempo
 
 	private:
+		void chooseSong(); //<show the songs of the library matching txtSong and change to the selected one
+
 		const int WIN_WIDTH = 500;
 		const int WIN_HEIGHT = 500;
 		const int PADDING = 10;
+		const double TEMPO_STEP = 0.05; //<tempo change of one click, relative to the tempo of the song
+		const int NOTES_INTERVAL = 50; //<milliseconds between two updates of boxNotes
 
 		TextEditor* txtSong;
 		TextEditor* txtTempo;
+		TextEditor* txtFirstBar;
+		TextEditor* txtLastBar;
 		Label* lblSong;
 		Label* lblTempo;
+		Label* lblBars;
+		Label* lblMetronome;
 		TextButton* btnSong;
 		TextButton* btnPlus;
 		TextButton* btnMinus;
+		TextButton* btnJump;
+		TextButton* btnLoop;
+		ComboBox* boxMetronome;
+		ToggleButton* btnAccent;
+		ToggleButton* btnVariation;
+		ToggleButton* btnFollow;
 		ListBox* boxNotes;
+		ListDisplay* noteRows; //<the model of boxNotes
 
 		DynamicComposition& processor;
 
@@ -0,0 +1,41 @@
+#include "NoteLog.h"
+
+#include <algorithm>
+
+using namespace ttmm;
+
+NoteLog::NoteLog()
+    : fifo(CAPACITY)
+    , ring(CAPACITY)
+    , dropped(0)
+{
+}
+
+bool NoteLog::push(NoteLogEntry const& entry)
+{
+    if (this->fifo.getFreeSpace() == 0)
+    {
+        this->dropped++;
+        return false;
+    }
+    int start1, size1, start2, size2;
+    this->fifo.prepareToWrite(1, start1, size1, start2, size2);
+    this->ring[size1 > 0 ? start1 : start2] = entry;
+    this->fifo.finishedWrite(1);
+    return true;
+}
+
+int NoteLog::pop(NoteLogEntry* entries, int maxEntries)
+{
+    int start1, size1, start2, size2;
+    this->fifo.prepareToRead(std::min(maxEntries, this->fifo.getNumReady()), start1, size1, start2, size2);
+    std::copy(this->ring.begin() + start1, this->ring.begin() + start1 + size1, entries);
+    std::copy(this->ring.begin() + start2, this->ring.begin() + start2 + size2, entries + size1);
+    this->fifo.finishedRead(size1 + size2);
+    return size1 + size2;
+}
+
+int NoteLog::getDropped() const
+{
+    return this->dropped.load();
+}
@@ -0,0 +1,74 @@
+/**
+* @file NoteLog.cpp
+* @author FH-Minden Musikinformatik 2015, Musicgroup (Marcel, Patrick, Scott)
+* @brief Passes the played notes from the audio thread to the editor without locking
+*
+*/
+#ifndef TTMM_NOTE_LOG_H
+#define TTMM_NOTE_LOG_H
+
+#include <atomic>
+#include <vector>
+#include <cstdint>
+
+#include "../../TTMM/JuceLibraryCode/JuceHeader.h"
+
+namespace ttmm
+{
+/**
+	* @struct NoteLogEntry
+	* @brief A played note on, the text shown for it is only built when its row is painted
+	*/
+struct NoteLogEntry
+{
+    int64_t sample; ///<song sample of the note on
+    uint8_t channel; ///<midi channel (1-16)
+    uint8_t nodeNumber; ///<a node number value (0-127)
+    uint8_t velocity; ///<a velocity of a note (1-127)
+};
+
+/**
+	* @class NoteLog
+	* @brief A lock-free ring of CAPACITY entries with one writer, the audio thread, and one reader, the message thread.
+	*		  Writing never blocks or allocates, if the reader is too slow the entry is dropped and counted.
+	*
+	* @see NoteLogEntry, ListDisplay, MusicPluginEditor
+	*/
+class NoteLog
+{
+public:
+    static const int CAPACITY = 1024; ///<entries which can wait for the reader
+
+    /**
+		* Constructor: create an empty NoteLog
+		*/
+    NoteLog();
+    /**
+		* Add an entry, called by the audio thread
+		*
+		* @param entry the played note
+		* @return false if the ring is full, the entry is dropped then
+		*/
+    bool push(NoteLogEntry const& entry);
+    /**
+		* Take the oldest entries out of the ring, called by the message thread
+		*
+		* @param entries an array to copy the entries to
+		* @param maxEntries the size of the array
+		* @return the number of copied entries
+		*/
+    int pop(NoteLogEntry* entries, int maxEntries);
+    /**
+		* Get the number of entries which did not fit into the ring
+		*
+		* @return the number of dropped entries
+		*/
+    int getDropped() const;
+
+private:
+    juce::AbstractFifo fifo; ///<indices of the lock-free ring
+    std::vector<NoteLogEntry> ring; ///<the entries
+    std::atomic<int> dropped; ///<entries which did not fit into the ring
+};
+}
+#endif
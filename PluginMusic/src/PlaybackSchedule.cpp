@@ -0,0 +1,424 @@
+#include "PlaybackSchedule.h"
+#include "FileWriter.h"
+#include "TimeTools.h"
+
+#include <algorithm>
+#include <cmath>
+
+using namespace ttmm;
+
+namespace
+{
+int64_t toSamples(TempoMap const& tempoMap, double tick, double samplerate)
+{
+    return static_cast<int64_t>(std::floor(tempoMap.tickToSamples(tick, samplerate) + 0.5));
+}
+
+PlaybackNote toPlaybackNote(TempoMap const& tempoMap, double on, double off,
+    int32_t nodeNumber, int32_t velocity, double samplerate)
+{
+    PlaybackNote note = {};
+    note.on = toSamples(tempoMap, on, samplerate);
+    note.off = toSamples(tempoMap, off, samplerate);
+    note.nodeNumber = nodeNumber;
+    note.velocity = velocity;
+    return note;
+}
+}
+
+PlaybackSchedule::PlaybackSchedule()
+{
+}
+
+PlaybackSchedule::~PlaybackSchedule()
+{
+    delete this->pageStream;
+}
+
+void PlaybackSchedule::prepare(Song& song, double samplerate)
+{
+    this->clear();
+    TempoMap const& tempoMap = song.getTempoMap();
+    double end = 0;
+    for (int t = 0; t < song.getNumberofTracks(); t++)
+    {
+        Track* track = song.getTrackp(t);
+        this->addTrack(track, t, tempoMap, samplerate);
+        end = std::max(end, track->getEnd());
+    }
+    if (song.getNumberofTracks() == 0)
+    {
+        return;
+    }
+    //all tracks repeat together after the longest one
+    this->length = toSamples(tempoMap, end, samplerate);
+    //the strokes of all tracks are played in order of their start
+    std::stable_sort(this->strokes.begin(), this->strokes.end(),
+        [](PlaybackStroke const& a, PlaybackStroke const& b) { return a.start < b.start; });
+    this->buildEvents();
+    this->buildIndex(tempoMap, end, samplerate);
+}
+
+void PlaybackSchedule::addTrack(Track* track, int32_t trackIndex, TempoMap const& tempoMap, double samplerate)
+{
+    for (int channelNr : track->getChannelNumbers())
+    {
+        Channel* channel = track->getChannelp(channelNr);
+        for (int index : channel->getStrokeNumbers())
+        {
+            Stroke* stroke = channel->getStrokep(index);
+            PlaybackStroke playbackStroke = {};
+            playbackStroke.track = trackIndex;
+            playbackStroke.firstTone = int32_t(this->tones.size());
+            playbackStroke.firstNote = int32_t(this->notes.size());
+            for (auto& nodeOfTone : stroke->getNodeOfTone())
+            {
+                this->tones.push_back(toPlaybackNote(tempoMap, nodeOfTone.getTimestamp(),
+                    nodeOfTone.getTimestamp() + nodeOfTone.getDelta(),
+                    nodeOfTone.getNodeNumber(), nodeOfTone.getLength(), samplerate));
+            }
+            for (auto& node : stroke->getNodes())
+            {
+                this->notes.push_back(toPlaybackNote(tempoMap, node.getTimestamp(),
+                    node.getTimestamp() + node.getDelta(),
+                    node.getNodeNumber(), node.getLength(), samplerate));
+            }
+            playbackStroke.toneCount = int32_t(this->tones.size()) - playbackStroke.firstTone;
+            playbackStroke.noteCount = int32_t(this->notes.size()) - playbackStroke.firstNote;
+            //the stroke covers all of its events
+            playbackStroke.start = toSamples(tempoMap, stroke->getStart(), samplerate);
+            playbackStroke.end = playbackStroke.start;
+            for (int32_t i = 0; i < playbackStroke.toneCount; i++)
+            {
+                PlaybackNote const& tone = this->tones[playbackStroke.firstTone + i];
+                playbackStroke.start = std::min(playbackStroke.start, tone.on);
+                playbackStroke.end = std::max(playbackStroke.end, tone.off);
+            }
+            for (int32_t i = 0; i < playbackStroke.noteCount; i++)
+            {
+                PlaybackNote const& note = this->notes[playbackStroke.firstNote + i];
+                playbackStroke.start = std::min(playbackStroke.start, note.on);
+                playbackStroke.end = std::max(playbackStroke.end, note.off);
+            }
+            this->strokes.push_back(playbackStroke);
+        }
+    }
+    PlaybackTrack playbackTrack = {};
+    this->tracks.push_back(playbackTrack);
+}
+
+void PlaybackSchedule::buildEvents()
+{
+    for (int32_t t = 0; t < int32_t(this->tracks.size()); t++)
+    {
+        PlaybackTrack& track = this->tracks[t];
+        track.firstEvent = int32_t(this->events.size());
+        auto addEvent = [&](int64_t sample, int32_t type, int32_t stroke, int32_t index)
+        {
+            if (!this->isPlayed(sample))
+            {
+                return;
+            }
+            PlaybackEvent event = { sample, type, stroke, index };
+            this->events.push_back(event);
+        };
+        for (int32_t s = 0; s < int32_t(this->strokes.size()); s++)
+        {
+            PlaybackStroke const& stroke = this->strokes[s];
+            //a stroke without nodes of tone has no key to transpose its nodes, it is not played
+            if (stroke.track != t || stroke.toneCount == 0)
+            {
+                continue;
+            }
+            //the StrokeType is chosen before the events of the stroke are played
+            addEvent(this->tones[stroke.firstTone].on, PlaybackEvent::STROKE_START, s, s);
+            for (int32_t i = stroke.firstTone; i < stroke.firstTone + stroke.toneCount; i++)
+            {
+                addEvent(this->tones[i].on, PlaybackEvent::TONE_ON, s, i);
+                addEvent(this->tones[i].off, PlaybackEvent::TONE_OFF, s, i);
+            }
+            for (int32_t i = stroke.firstNote; i < stroke.firstNote + stroke.noteCount; i++)
+            {
+                addEvent(this->notes[i].on, PlaybackEvent::NOTE_ON, s, i);
+                addEvent(this->notes[i].off, PlaybackEvent::NOTE_OFF, s, i);
+            }
+        }
+        //events at the same sample keep the order of their strokes
+        std::stable_sort(this->events.begin() + track.firstEvent, this->events.end(),
+            [](PlaybackEvent const& a, PlaybackEvent const& b) { return a.sample < b.sample; });
+        track.eventCount = int32_t(this->events.size()) - track.firstEvent;
+    }
+}
+
+//events far outside the song come from nodes without a valid timestamp, they were never played
+bool PlaybackSchedule::isPlayed(int64_t sample) const
+{
+    return sample >= -this->length && sample < 2 * this->length;
+}
+
+void PlaybackSchedule::buildIndex(TempoMap const& tempoMap, double end, double samplerate)
+{
+    for (int bar = 0;; bar++)
+    {
+        double barTick = tempoMap.barToTick(bar);
+        if (barTick >= end)
+        {
+            break;
+        }
+        this->bars.push_back(toSamples(tempoMap, barTick, samplerate));
+        TimeSignatureChange const& signature = tempoMap.getTimeSignature(barTick);
+        double beatTicks = tempoMap.getTicksPerQuarter() * 4.0 / double(signature.denominator);
+        for (int beat = 0; beat < signature.numerator && barTick + beat * beatTicks < end; beat++)
+        {
+            this->beats.push_back(toSamples(tempoMap, barTick + beat * beatTicks, samplerate));
+        }
+    }
+    if (this->bars.empty())
+    {
+        return;
+    }
+    //list every stroke and note which is played in all bars it overlaps, like buildEvents does
+    vector<vector<PlaybackRef>> refsOfBar(this->bars.size());
+    auto addRef = [&](int32_t kind, int32_t stroke, int32_t index)
+    {
+        PlaybackRef ref = { kind, stroke, index };
+        int64_t on, off;
+        this->getRange(ref, on, off);
+        if (!this->isPlayed(on))
+        {
+            return;
+        }
+        //without its end the node sounds until the events repeat
+        if (!this->isPlayed(off))
+        {
+            off = 2 * this->length;
+        }
+        int last = this->getBarAt(std::max(on, off - 1));
+        for (int bar = this->getBarAt(on); bar <= last; bar++)
+        {
+            refsOfBar[bar].push_back(ref);
+        }
+    };
+    for (int32_t s = 0; s < int32_t(this->strokes.size()); s++)
+    {
+        PlaybackStroke const& stroke = this->strokes[s];
+        if (stroke.toneCount == 0)
+        {
+            continue;
+        }
+        addRef(PlaybackRef::STROKE, s, s);
+        for (int32_t i = 0; i < stroke.toneCount; i++)
+        {
+            addRef(PlaybackRef::TONE, s, stroke.firstTone + i);
+        }
+        for (int32_t i = 0; i < stroke.noteCount; i++)
+        {
+            addRef(PlaybackRef::NOTE, s, stroke.firstNote + i);
+        }
+    }
+    for (auto const& refs : refsOfBar)
+    {
+        this->barRefStart.push_back(int32_t(this->barRefs.size()));
+        this->barRefs.insert(this->barRefs.end(), refs.begin(), refs.end());
+    }
+    this->barRefStart.push_back(int32_t(this->barRefs.size()));
+    //the nodes of tone of the first stroke sounding at each beat
+    this->chords.assign(this->beats.size(), PlaybackChord());
+    for (size_t beat = 0; beat < this->beats.size(); beat++)
+    {
+        PlaybackChord& chord = this->chords[beat];
+        int32_t found = -1;
+        this->forEachSounding(this->beats[beat], [&](PlaybackRef const& ref)
+        {
+            if (ref.kind != PlaybackRef::TONE || (found != -1 && ref.stroke != found)
+                || chord.count == PlaybackChord::MAX_TONES)
+            {
+                return;
+            }
+            PlaybackStroke const& stroke = this->strokes[ref.stroke];
+            PlaybackNote const* tone = &this->tones[stroke.firstTone];
+            found = ref.stroke;
+            chord.terz = uint8_t(stroke.toneCount > 1 ? tone[1].nodeNumber : tone[0].nodeNumber);
+            chord.tones[chord.count++] = uint8_t(this->tones[ref.index].nodeNumber);
+        });
+        std::sort(chord.tones, chord.tones + chord.count);
+    }
+}
+
+//every event carries the nodes of tone of its stroke, so a page can be played without the strokes
+bool PlaybackSchedule::stream(juce::File const& file)
+{
+    TIMED_BLOCK("PlaybackSchedule::stream")
+    vector<StreamEvent> records;
+    records.reserve(this->events.size());
+    for (auto const& event : this->events)
+    {
+        PlaybackStroke const& stroke = this->strokes[event.stroke];
+        PlaybackNote const* tone = &this->tones[stroke.firstTone];
+        StreamEvent record = {};
+        record.sample = event.sample;
+        record.end = event.sample;
+        record.type = event.type;
+        record.stroke = event.stroke;
+        record.key = uint8_t(tone[0].nodeNumber);
+        record.terz = uint8_t(stroke.toneCount > 1 ? tone[1].nodeNumber : tone[0].nodeNumber);
+        PlaybackNote const* note = nullptr;
+        switch (event.type)
+        {
+        case PlaybackEvent::STROKE_START:
+            record.end = std::max(event.sample, stroke.end);
+            break;
+        case PlaybackEvent::TONE_ON:
+        case PlaybackEvent::TONE_OFF:
+            note = &this->tones[event.index];
+            break;
+        default:
+            note = &this->notes[event.index];
+            break;
+        }
+        if (note != nullptr)
+        {
+            record.nodeNumber = uint8_t(note->nodeNumber);
+            record.velocity = uint8_t(note->velocity);
+            if (event.type == PlaybackEvent::TONE_ON || event.type == PlaybackEvent::NOTE_ON)
+            {
+                record.end = std::max(event.sample, note->off);
+            }
+        }
+        records.push_back(record);
+    }
+    //the runs of the tracks are merged, events at the same sample keep the order of their tracks
+    std::stable_sort(records.begin(), records.end(),
+        [](StreamEvent const& a, StreamEvent const& b) { return a.sample < b.sample; });
+    ScheduleStream* opened = new ScheduleStream();
+    if (!ScheduleStream::write(records, this->length, file) || !opened->open(file))
+    {
+        ttmm::logfileMusic->write("could not stream schedule to " + file.getFullPathName().toStdString());
+        delete opened;
+        file.deleteFile();
+        return false;
+    }
+    delete this->pageStream;
+    this->pageStream = opened;
+    //only the bars, beats and chords stay in memory, swapping releases the memory of the vectors
+    vector<PlaybackStroke>().swap(this->strokes);
+    vector<PlaybackNote>().swap(this->tones);
+    vector<PlaybackNote>().swap(this->notes);
+    vector<PlaybackEvent>().swap(this->events);
+    vector<PlaybackTrack>().swap(this->tracks);
+    vector<int32_t>().swap(this->barRefStart);
+    vector<PlaybackRef>().swap(this->barRefs);
+    return true;
+}
+
+ScheduleStream const* PlaybackSchedule::getStream() const
+{
+    return this->pageStream;
+}
+
+void PlaybackSchedule::prefetch(int64_t first, int64_t end) const
+{
+    if (this->pageStream != nullptr)
+    {
+        this->pageStream->require(first, end);
+    }
+}
+
+void PlaybackSchedule::clear()
+{
+    delete this->pageStream;
+    this->pageStream = nullptr;
+    this->length = 0;
+    this->strokes.clear();
+    this->tones.clear();
+    this->notes.clear();
+    this->events.clear();
+    this->tracks.clear();
+    this->bars.clear();
+    this->beats.clear();
+    this->chords.clear();
+    this->barRefStart.clear();
+    this->barRefs.clear();
+}
+
+int64_t PlaybackSchedule::getLength() const
+{
+    return this->length;
+}
+
+vector<PlaybackStroke> const& PlaybackSchedule::getStrokes() const
+{
+    return this->strokes;
+}
+
+vector<PlaybackNote> const& PlaybackSchedule::getTones() const
+{
+    return this->tones;
+}
+
+vector<PlaybackNote> const& PlaybackSchedule::getNotes() const
+{
+    return this->notes;
+}
+
+vector<PlaybackEvent> const& PlaybackSchedule::getEvents() const
+{
+    return this->events;
+}
+
+vector<PlaybackTrack> const& PlaybackSchedule::getTracks() const
+{
+    return this->tracks;
+}
+
+int PlaybackSchedule::getBarCount() const
+{
+    return int(this->bars.size());
+}
+
+int64_t PlaybackSchedule::getBarStart(int bar) const
+{
+    return this->bars[bar];
+}
+
+int64_t PlaybackSchedule::getBarEnd(int bar) const
+{
+    return (bar + 1 < int(this->bars.size())) ? this->bars[bar + 1] : this->length;
+}
+
+int PlaybackSchedule::getBarAt(int64_t sample) const
+{
+    auto it = std::upper_bound(this->bars.begin(), this->bars.end(), sample);
+    return std::max(0, int(it - this->bars.begin()) - 1);
+}
+
+vector<int64_t> const& PlaybackSchedule::getBeats() const
+{
+    return this->beats;
+}
+
+int PlaybackSchedule::getBeatAt(int64_t sample) const
+{
+    auto it = std::upper_bound(this->beats.begin(), this->beats.end(), sample);
+    return std::max(0, int(it - this->beats.begin()) - 1);
+}
+
+vector<PlaybackChord> const& PlaybackSchedule::getChords() const
+{
+    return this->chords;
+}
+
+void PlaybackSchedule::getRange(PlaybackRef const& ref, int64_t& on, int64_t& off) const
+{
+    if (ref.kind == PlaybackRef::STROKE)
+    {
+        on = this->strokes[ref.index].start;
+        off = this->strokes[ref.index].end;
+    }
+    else
+    {
+        PlaybackNote const& note = (ref.kind == PlaybackRef::TONE) ? this->tones[ref.index] : this->notes[ref.index];
+        on = note.on;
+        off = note.off;
+    }
+}
@@ -0,0 +1,322 @@
+/**
+* @file PlaybackSchedule.cpp
+* @author FH-Minden Musikinformatik 2015, Musicgroup (Marcel, Patrick, Scott)
+* @brief The events of a track with their positions precomputed in samples
+*
+*/
+#ifndef TTMM_PLAYBACK_SCHEDULE_H
+#define TTMM_PLAYBACK_SCHEDULE_H
+
+#include <vector>
+#include <cstdint>
+#include "../Model/Song.h"
+#include "ScheduleStream.h"
+
+namespace ttmm
+{
+using std::vector;
+
+/**
+	* @struct PlaybackNote
+	* @brief A note of the schedule, the node number is the one of the Tonika stroke
+	*/
+struct PlaybackNote
+{
+    int64_t on; ///<sample position of the note on, relative to the start of the song
+    int64_t off; ///<sample position of the note off, relative to the start of the song
+    int32_t nodeNumber; ///<a node number value (0-127)
+    int32_t velocity; ///<a velocity of a note (0-127)
+};
+
+/**
+	* @struct PlaybackStroke
+	* @brief A stroke (Tonart) of the schedule and the ranges of its notes
+	*/
+struct PlaybackStroke
+{
+    int64_t start; ///<sample position of the first event of the stroke
+    int64_t end; ///<sample position of the last event of the stroke
+    int32_t firstTone; ///<index of the first node of tone in PlaybackSchedule::getTones
+    int32_t toneCount; ///<number of nodes of tone
+    int32_t firstNote; ///<index of the first node in PlaybackSchedule::getNotes
+    int32_t noteCount; ///<number of nodes
+    int32_t track; ///<index of the track of the stroke in the song
+};
+
+/**
+	* @struct PlaybackEvent
+	* @brief A single note on or off of a track, or the start of a stroke where its StrokeType is chosen
+	*/
+struct PlaybackEvent
+{
+    static const int32_t STROKE_START = 0; ///<the stroke starts, index refers to getStrokes
+    static const int32_t TONE_ON = 1; ///<index refers to getTones
+    static const int32_t TONE_OFF = 2; ///<index refers to getTones
+    static const int32_t NOTE_ON = 3; ///<index refers to getNotes
+    static const int32_t NOTE_OFF = 4; ///<index refers to getNotes
+
+    int64_t sample; ///<sample position of the event, relative to the start of the song
+    int32_t type; ///<one of the constants above
+    int32_t stroke; ///<index of the stroke in getStrokes
+    int32_t index; ///<index in the vector given by type
+};
+
+/**
+	* @struct PlaybackChord
+	* @brief The nodes of tone of the stroke sounding at a beat, with the node numbers of the Tonika stroke
+	*/
+struct PlaybackChord
+{
+    static const int MAX_TONES = 4; ///<nodes of tone kept per beat
+
+    uint8_t tones[MAX_TONES]; ///<node numbers of the nodes of tone, lowest first
+    uint8_t count; ///<number of nodes of tone, 0 if no stroke sounds at the beat
+    uint8_t terz; ///<node number of the second node of tone of the stroke, the first one if there is none
+};
+
+/**
+	* @struct PlaybackTrack
+	* @brief The range of the events of a track in PlaybackSchedule::getEvents
+	*/
+struct PlaybackTrack
+{
+    int32_t firstEvent; ///<index of the first event of the track
+    int32_t eventCount; ///<number of events, sorted by sample
+};
+
+/**
+	* @struct PlaybackRef
+	* @brief Refers to a stroke, a node of tone or a node of the schedule
+	*/
+struct PlaybackRef
+{
+    static const int32_t STROKE = 0; ///<index refers to getStrokes
+    static const int32_t TONE = 1; ///<index refers to getTones
+    static const int32_t NOTE = 2; ///<index refers to getNotes
+
+    int32_t kind; ///<STROKE, TONE or NOTE
+    int32_t stroke; ///<index of the stroke in getStrokes
+    int32_t index; ///<index in the vector given by kind
+};
+
+/**
+	* @class PlaybackSchedule
+	* @brief The events of all tracks of a song with their positions precomputed in samples at the samplerate of the host.
+	*		  Each track keeps its own time ordered run of events, a player merges the runs with one cursor per track.
+	*		  The song repeats after getLength() samples, so the schedule itself is never changed while playing.
+	*		  An index of the bars and beats allows to seek in O(log n), for each bar the strokes and notes
+	*		  overlapping it are listed, so the notes sounding at a position are found without scanning the track.
+	*		  For each beat the chord sounding at it is kept, generated accompaniment reads it without the events.
+	*		  Long songs can be streamed: the events are moved into the pages of a ScheduleStream and only the
+	*		  bars, beats and chords stay in memory.
+	*
+	* @see Track, TempoMap, MidiHandler, Transport, ScheduleStream
+	*/
+class PlaybackSchedule
+{
+public:
+    /**
+		* Constructor: create an empty schedule
+		*/
+    PlaybackSchedule();
+    /**
+		* Destructor: close the stream of a streamed schedule
+		*/
+    ~PlaybackSchedule();
+    PlaybackSchedule(PlaybackSchedule const&) = delete;
+    PlaybackSchedule& operator=(PlaybackSchedule const&) = delete;
+    /**
+		* Convert all tracks of a song to sample positions
+		*
+		* @param song the song to play, a song without tracks leaves the schedule empty
+		* @param samplerate samplerate of host
+		*/
+    void prepare(Song& song, double samplerate);
+    /**
+		* Remove all events of the schedule
+		*/
+    void clear();
+    /**
+		* Write the events to a page file and play them from there, the strokes, notes and events are removed from memory
+		*
+		* @param file the page file, it is deleted with the schedule
+		* @return true if the schedule is streamed, otherwise it is kept in memory
+		*/
+    bool stream(juce::File const& file);
+    /**
+		* Get the stream of a streamed schedule
+		*
+		* @return the stream, nullptr if the events are kept in memory
+		*/
+    ScheduleStream const* getStream() const;
+    /**
+		* Wait until the events of a range can be read from the stream, called by a background thread before it
+		* reads them. Nothing is done if the events are kept in memory.
+		*
+		* @param first the first song sample of the range
+		* @param end the song sample after the range
+		*/
+    void prefetch(int64_t first, int64_t end) const;
+    /**
+		* Get the length of the longest track, after which the song repeats
+		*
+		* @return the length in samples, 0 if the schedule is empty
+		*/
+    int64_t getLength() const;
+    /**
+		* Get all strokes
+		*
+		* @return the strokes sorted by their start
+		*/
+    vector<PlaybackStroke> const& getStrokes() const;
+    /**
+		* Get the nodes of tone of all strokes
+		*
+		* @return the nodes of tone, grouped by stroke
+		*/
+    vector<PlaybackNote> const& getTones() const;
+    /**
+		* Get the nodes of all strokes
+		*
+		* @return the nodes, grouped by stroke
+		*/
+    vector<PlaybackNote> const& getNotes() const;
+    /**
+		* Get the note ons and offs of all tracks
+		*
+		* @return the events, grouped by track and sorted by sample inside each track
+		*/
+    vector<PlaybackEvent> const& getEvents() const;
+    /**
+		* Get the event ranges of the tracks
+		*
+		* @return a range in getEvents for each track of the song
+		*/
+    vector<PlaybackTrack> const& getTracks() const;
+    /**
+		* Get the number of bars of the song
+		*
+		* @return the number of bars, the last one may be incomplete
+		*/
+    int getBarCount() const;
+    /**
+		* Get the start of a bar
+		*
+		* @param bar index of the bar, starting with 0
+		* @return the sample position of the first beat of the bar
+		*/
+    int64_t getBarStart(int bar) const;
+    /**
+		* Get the end of a bar
+		*
+		* @param bar index of the bar, starting with 0
+		* @return the sample position of the next bar, or the length of the song for the last bar
+		*/
+    int64_t getBarEnd(int bar) const;
+    /**
+		* Find the bar of a position in O(log n)
+		*
+		* @param sample a position inside the song
+		* @return index of the bar
+		*/
+    int getBarAt(int64_t sample) const;
+    /**
+		* Get the starts of all beats
+		*
+		* @return the sample positions of the beats, the denominator of the time signature gives the length of a beat.
+		*		   The metronome clicks on them.
+		*/
+    vector<int64_t> const& getBeats() const;
+    /**
+		* Find the beat of a position in O(log n)
+		*
+		* @param sample a position inside the song
+		* @return index of the beat in getBeats
+		*/
+    int getBeatAt(int64_t sample) const;
+    /**
+		* Get the chords of all beats, they are kept when the schedule is streamed
+		*
+		* @return a chord for each beat in getBeats
+		*/
+    vector<PlaybackChord> const& getChords() const;
+    /**
+		* Call a function for every stroke and note which covers a position: start <= sample < end
+		*
+		* @param sample a position inside the song
+		* @param f a function taking a PlaybackRef const&
+		*/
+    template <typename F>
+    void forEachSounding(int64_t sample, F f) const
+    {
+        if (this->barRefStart.empty())
+        {
+            return;
+        }
+        int bar = this->getBarAt(sample);
+        for (int32_t i = this->barRefStart[bar]; i < this->barRefStart[bar + 1]; i++)
+        {
+            PlaybackRef const& ref = this->barRefs[i];
+            int64_t on, off;
+            this->getRange(ref, on, off);
+            if (on <= sample && sample < off)
+            {
+                f(ref);
+            }
+        }
+    }
+
+private:
+    /**
+		* Get the samples covered by a stroke or note
+		*
+		* @param ref the stroke or note
+		* @param on is set to the first sample
+		* @param off is set to the sample after the last one
+		*/
+    void getRange(PlaybackRef const& ref, int64_t& on, int64_t& off) const;
+    /**
+		* Add the strokes, nodes of tone and nodes of a track
+		*
+		* @param track the track to add
+		* @param trackIndex index of the track in the song
+		* @param tempoMap the tempo map of the song
+		* @param samplerate samplerate of host
+		*/
+    void addTrack(Track* track, int32_t trackIndex, TempoMap const& tempoMap, double samplerate);
+    /**
+		* List the events of each track in time order
+		*/
+    void buildEvents();
+    /**
+		* Check whether an event at a sample is played, events far outside the song come from nodes
+		* without a valid timestamp
+		*
+		* @param sample the sample of the event
+		* @return true if the event is inside [-length, 2 * length)
+		*/
+    bool isPlayed(int64_t sample) const;
+    /**
+		* Build the bar and beat index and list the strokes and notes of each bar
+		*
+		* @param tempoMap the tempo map of the song
+		* @param end the end tick of the song
+		* @param samplerate samplerate of host
+		*/
+    void buildIndex(TempoMap const& tempoMap, double end, double samplerate);
+
+    int64_t length = 0; ///<length of the longest track in samples
+    vector<PlaybackStroke> strokes; ///<all strokes of all tracks
+    vector<PlaybackNote> tones; ///<nodes of tone of all strokes
+    vector<PlaybackNote> notes; ///<nodes of all strokes
+    vector<PlaybackEvent> events; ///<note ons and offs, grouped by track
+    vector<PlaybackTrack> tracks; ///<range of the events of each track
+    vector<int64_t> bars; ///<sample positions of the bars
+    vector<int64_t> beats; ///<sample positions of the beats
+    vector<PlaybackChord> chords; ///<the chord sounding at each beat
+    vector<int32_t> barRefStart; ///<first entry of each bar in barRefs, one more entry than bars
+    vector<PlaybackRef> barRefs; ///<strokes and notes overlapping each bar, grouped by bar
+    ScheduleStream* pageStream = nullptr; ///<the events of a streamed schedule, nullptr if they are kept in memory
+};
+}
+#endif
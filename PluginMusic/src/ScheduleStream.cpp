@@ -0,0 +1,374 @@
+#include "ScheduleStream.h"
+#include "FileWriter.h"
+#include "TimeTools.h"
+
+#include <cstring>
+#include <chrono>
+
+using namespace ttmm;
+
+namespace
+{
+const char MAGIC[4] = { 'T', 'T', 'S', 'P' };
+
+template <typename T>
+bool writeArray(juce::OutputStream& out, std::vector<T> const& source)
+{
+    return source.empty() || out.write(source.data(), sizeof(T) * source.size());
+}
+}
+
+ScheduleStream::ScheduleStream()
+    : position(0)
+    , misses(0)
+    , latePages(0)
+    , stopPrefetch(true)
+    , wakeUp(false)
+{
+    for (auto& slot : this->slots)
+    {
+        slot.page.store(NO_PAGE);
+        slot.readers.store(0);
+    }
+}
+
+ScheduleStream::~ScheduleStream()
+{
+    this->close();
+}
+
+int64_t ScheduleStream::floorDiv(int64_t value, int64_t divisor)
+{
+    int64_t quotient = value / divisor;
+    return (value % divisor < 0) ? quotient - 1 : quotient;
+}
+
+//the pages are written one after another, the ons which are still sounding are carried into the next page
+bool ScheduleStream::write(std::vector<StreamEvent> const& events, int64_t length, juce::File const& file)
+{
+    TIMED_BLOCK("ScheduleStream::write")
+    Header header = {};
+    memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = VERSION;
+    header.length = length;
+    if (!events.empty())
+    {
+        header.firstSample = events.front().sample;
+        header.lastSample = events.back().sample;
+        header.firstPage = floorDiv(header.firstSample, PAGE_SAMPLES);
+        header.pageCount = floorDiv(header.lastSample, PAGE_SAMPLES) - header.firstPage + 1;
+    }
+    //a FileOutputStream appends to an existing file
+    file.deleteFile();
+    juce::FileOutputStream out(file);
+    if (out.failedToOpen() || !out.write(&header, sizeof(header)))
+    {
+        return false;
+    }
+    std::vector<PageEntry> table;
+    std::vector<StreamEvent> sounding;
+    std::vector<StreamEvent> carry;
+    size_t next = 0;
+    for (int64_t page = header.firstPage; page < header.firstPage + header.pageCount; page++)
+    {
+        int64_t pageStart = page * PAGE_SAMPLES;
+        int64_t pageEnd = pageStart + PAGE_SAMPLES;
+        carry.clear();
+        for (auto const& event : sounding)
+        {
+            if (event.end > pageStart)
+            {
+                carry.push_back(event);
+            }
+        }
+        sounding.swap(carry);
+        PageEntry entry = {};
+        entry.offset = out.getPosition();
+        entry.carryCount = int32_t(sounding.size());
+        size_t first = next;
+        while (next < events.size() && events[next].sample < pageEnd)
+        {
+            next++;
+        }
+        entry.eventCount = int32_t(next - first);
+        if (!writeArray(out, sounding)
+            || (entry.eventCount > 0 && !out.write(&events[first], sizeof(StreamEvent) * entry.eventCount)))
+        {
+            return false;
+        }
+        table.push_back(entry);
+        for (size_t i = first; i < next; i++)
+        {
+            if (events[i].end > pageEnd)
+            {
+                sounding.push_back(events[i]);
+            }
+        }
+    }
+    header.tableOffset = out.getPosition();
+    if (!writeArray(out, table) || !out.setPosition(0) || !out.write(&header, sizeof(header)))
+    {
+        return false;
+    }
+    out.flush();
+    return out.getStatus().wasOk();
+}
+
+bool ScheduleStream::open(juce::File const& file)
+{
+    this->close();
+    Header header;
+    {
+        juce::FileInputStream in(file);
+        if (in.failedToOpen() || in.read(&header, sizeof(header)) != int(sizeof(header)))
+        {
+            return false;
+        }
+    }
+    if (memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0 || header.version != VERSION
+        || header.length <= 0 || header.pageCount < 0
+        || header.tableOffset + int64_t(sizeof(PageEntry)) * header.pageCount != file.getSize())
+    {
+        ttmm::logfileMusic->write("invalid page file: " + file.getFullPathName().toStdString());
+        return false;
+    }
+    this->file = file;
+    this->length = header.length;
+    this->firstSample = header.firstSample;
+    this->lastSample = header.lastSample;
+    this->firstPage = header.firstPage;
+    this->pageCount = header.pageCount;
+    this->tableOffset = header.tableOffset;
+    this->position.store(0);
+    this->misses.store(0);
+    this->latePages.store(0);
+    {
+        std::lock_guard<std::mutex> lock(this->mapMutex);
+        this->fill(0);
+    }
+    this->stopPrefetch.store(false);
+    this->prefetchThread = std::thread(&ScheduleStream::run, this);
+    if (!this->prefetchThread.joinable())
+    {
+        ttmm::logger.write("Failed to start the ScheduleStream thread");
+    }
+    return true;
+}
+
+void ScheduleStream::close()
+{
+    this->stopPrefetch.store(true);
+    if (this->prefetchThread.joinable())
+    {
+        this->prefetchThread.join();
+    }
+    for (auto& slot : this->slots)
+    {
+        slot.page.store(NO_PAGE);
+        delete slot.map;
+        slot.map = nullptr;
+        slot.events = nullptr;
+    }
+    //the page file is temporary, it belongs to the stream
+    if (this->file != juce::File::nonexistent)
+    {
+        this->file.deleteFile();
+        this->file = juce::File::nonexistent;
+    }
+    this->length = 0;
+    this->pageCount = 0;
+}
+
+int64_t ScheduleStream::getLength() const
+{
+    return this->length;
+}
+
+bool ScheduleStream::getRepetitions(int64_t first, int64_t end, int64_t& firstRepetition, int64_t& lastRepetition) const
+{
+    if (this->length <= 0 || this->pageCount == 0 || end <= first)
+    {
+        return false;
+    }
+    //events before the start or after the end of the song overlap the neighbouring repetitions
+    firstRepetition = std::max(int64_t(0), floorDiv(first - this->lastSample - 1, this->length) + 1);
+    lastRepetition = floorDiv(end - 1 - this->firstSample, this->length);
+    return firstRepetition <= lastRepetition;
+}
+
+void ScheduleStream::require(int64_t first, int64_t end)
+{
+    if (this->length <= 0 || this->pageCount == 0 || end <= first)
+    {
+        return;
+    }
+    this->position.store(first);
+    //the prefetch thread maps the pages before they are needed, only if it is late they are mapped here.
+    //fill maps the pages of all repetitions around a position, a range never spans more than two pages.
+    std::lock_guard<std::mutex> lock(this->mapMutex);
+    this->latePages += this->fill(first);
+    if (floorDiv(end - 1, PAGE_SAMPLES) != floorDiv(first, PAGE_SAMPLES))
+    {
+        this->latePages += this->fill(end - 1);
+    }
+}
+
+ScheduleStream::Slot* ScheduleStream::acquire(int64_t page, int64_t sample) const
+{
+    if (page < this->firstPage || page >= this->firstPage + this->pageCount)
+    {
+        return nullptr;
+    }
+    for (auto& slot : this->slots)
+    {
+        if (slot.page.load() != page)
+        {
+            continue;
+        }
+        //the page may be replaced between the check and the announcement, so check again
+        slot.readers++;
+        if (slot.page.load() == page)
+        {
+            return &slot;
+        }
+        slot.readers--;
+    }
+    this->misses++;
+    this->position.store(sample);
+    this->wakeUp.store(true);
+    return nullptr;
+}
+
+void ScheduleStream::release(Slot* slot) const
+{
+    slot->readers--;
+}
+
+void ScheduleStream::run()
+{
+    int64_t mapped = NO_PAGE;
+    while (!this->stopPrefetch.load())
+    {
+        {
+            std::lock_guard<std::mutex> lock(this->mapMutex);
+            int64_t sample = this->position.load();
+            int64_t page = floorDiv(sample, PAGE_SAMPLES);
+            if (page != mapped)
+            {
+                //keep the pages ahead of the position mapped, the page file is read in the background
+                this->fill(sample);
+                mapped = page;
+            }
+        }
+        //a miss sets the flag, the audio thread does not notify
+        if (!this->wakeUp.exchange(false))
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(WAKE_POLL_MS));
+        }
+    }
+}
+
+int ScheduleStream::fill(int64_t sample)
+{
+    //the pages needed next, the current page first; at the end of the song the first pages follow
+    int64_t needed[RESIDENT_PAGES];
+    int count = 0;
+    for (int k = -1; k <= PREFETCH_PAGES && count < RESIDENT_PAGES; k++)
+    {
+        int64_t inTrack = (sample + k * PAGE_SAMPLES) % this->length;
+        inTrack = (inTrack < 0) ? inTrack + this->length : inTrack;
+        int64_t candidates[3] = { inTrack, inTrack - this->length, inTrack + this->length };
+        for (int64_t candidate : candidates)
+        {
+            int64_t page = floorDiv(candidate, PAGE_SAMPLES);
+            if (page >= this->firstPage && page < this->firstPage + this->pageCount && count < RESIDENT_PAGES
+                && std::find(needed, needed + count, page) == needed + count)
+            {
+                needed[count++] = page;
+            }
+        }
+    }
+    int mappedPages = 0;
+    for (int i = 0; i < count; i++)
+    {
+        Slot* free = nullptr;
+        bool resident = false;
+        for (auto& slot : this->slots)
+        {
+            int64_t page = slot.page.load();
+            if (page == needed[i])
+            {
+                resident = true;
+                break;
+            }
+            if (free == nullptr && std::find(needed, needed + count, page) == needed + count)
+            {
+                free = &slot;
+            }
+        }
+        if (!resident && free != nullptr)
+        {
+            this->mapPage(*free, needed[i]);
+            mappedPages++;
+        }
+    }
+    return mappedPages;
+}
+
+void ScheduleStream::mapPage(Slot& slot, int64_t page)
+{
+    //no new reader finds the slot, wait for the ones which found it before
+    slot.page.store(NO_PAGE);
+    while (slot.readers.load() != 0)
+    {
+        std::this_thread::yield();
+    }
+    delete slot.map;
+    slot.map = nullptr;
+    slot.events = nullptr;
+    slot.carryCount = 0;
+    slot.eventCount = 0;
+    PageEntry entry = {};
+    {
+        juce::FileInputStream in(this->file);
+        if (in.failedToOpen() || !in.setPosition(this->tableOffset + int64_t(sizeof(PageEntry)) * (page - this->firstPage))
+            || in.read(&entry, sizeof(entry)) != int(sizeof(entry)))
+        {
+            ttmm::logfileMusic->write("could not read page table: " + this->file.getFullPathName().toStdString());
+            return;
+        }
+    }
+    int64_t size = int64_t(sizeof(StreamEvent)) * (entry.carryCount + entry.eventCount);
+    if (size > 0)
+    {
+        slot.map = new juce::MemoryMappedFile(this->file, juce::Range<juce::int64>(entry.offset, entry.offset + size),
+            juce::MemoryMappedFile::readOnly);
+        if (slot.map->getData() == nullptr)
+        {
+            ttmm::logfileMusic->write("could not map page: ", int(page));
+            return;
+        }
+        //the mapping starts at a multiple of the page size of the system
+        char const* data = static_cast<char const*>(slot.map->getData()) + (entry.offset - slot.map->getRange().getStart());
+        slot.events = reinterpret_cast<StreamEvent const*>(data);
+        //touch the memory pages, so the audio thread does not wait for the disk
+        volatile char touch = 0;
+        for (int64_t i = 0; i < size; i += 4096)
+        {
+            touch += data[i];
+        }
+    }
+    slot.carryCount = entry.carryCount;
+    slot.eventCount = entry.eventCount;
+    slot.page.store(page);
+}
+
+int ScheduleStream::getMisses() const
+{
+    return this->misses.load();
+}
+
+int ScheduleStream::getLatePages() const
+{
+    return this->latePages.load();
+}
@@ -0,0 +1,300 @@
+/**
+* @file ScheduleStream.cpp
+* @author FH-Minden Musikinformatik 2015, Musicgroup (Marcel, Patrick, Scott)
+* @brief Plays a compiled schedule from pages of a memory-mapped file, so long songs need constant memory
+*
+*/
+#ifndef TTMM_SCHEDULE_STREAM_H
+#define TTMM_SCHEDULE_STREAM_H
+
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <vector>
+#include <algorithm>
+#include <cstdint>
+
+#include "../../TTMM/JuceLibraryCode/JuceHeader.h"
+
+namespace ttmm
+{
+/**
+	* @struct StreamEvent
+	* @brief An event of the schedule with everything needed to play it, so a page does not refer to other pages
+	*/
+struct StreamEvent
+{
+    int64_t sample; ///<sample position of the event, relative to the start of the song
+    int64_t end; ///<the stroke or note of an on event sounds until this sample, for the other events end equals sample
+    int32_t type; ///<one of the constants of PlaybackEvent
+    int32_t stroke; ///<index of the stroke in the compiled schedule
+    uint8_t nodeNumber; ///<node number of the node or node of tone (0-127)
+    uint8_t velocity; ///<velocity of the node or node of tone (0-127)
+    uint8_t key; ///<node number of the first node of tone of the stroke
+    uint8_t terz; ///<node number of the second node of tone of the stroke, the first one if there is none
+    int32_t reserved; ///<keeps the size a multiple of 8
+};
+
+/**
+	* @class ScheduleStream
+	* @brief The events of a schedule stored in pages of PAGE_SAMPLES song samples in a file. Each page lists the
+	*		  events starting in it and the stroke and note ons started before it and still sounding at its start.
+	*		  Only RESIDENT_PAGES pages are mapped at a time, a prefetch thread maps the pages around the position
+	*		  which was played last, so the memory does not grow with the length of the song.
+	*		  Reading never blocks: the audio thread skips a page which is not mapped and counts a miss. It wakes
+	*		  the prefetch thread by a flag the thread polls every WAKE_POLL_MS.
+	*		  A background thread can wait for the pages it reads next with require.
+	*
+	* @see PlaybackSchedule, MidiHandler, LookaheadRenderer
+	*/
+class ScheduleStream
+{
+public:
+    static const int64_t PAGE_SAMPLES = 65536; ///<song samples of a page, about 1.5 seconds
+    static const int RESIDENT_PAGES = 8; ///<pages mapped at the same time
+    static const int PREFETCH_PAGES = 4; ///<pages mapped ahead of the position played last
+    static const int STROKE_SLOTS = 256; ///<StrokeTypes kept by a player, strokes sounding together must fit
+    static const uint32_t VERSION = 1; ///<layout version of the page file
+    static const int WAKE_POLL_MS = 1; ///<interval the prefetch thread checks the position played last
+
+    /**
+		* Constructor: create a closed ScheduleStream
+		*/
+    ScheduleStream();
+    /**
+		* Destructor: close the stream and delete its file
+		*/
+    ~ScheduleStream();
+    ScheduleStream(ScheduleStream const&) = delete;
+    ScheduleStream& operator=(ScheduleStream const&) = delete;
+    /**
+		* Write the events of a schedule as pages to a file
+		*
+		* @param events the events of all tracks, sorted by sample. Events at the same sample are played in this order.
+		* @param length the length of the song in samples, after which it repeats
+		* @param file the file to write, it is replaced
+		* @return true if the file was written
+		*/
+    static bool write(std::vector<StreamEvent> const& events, int64_t length, juce::File const& file);
+    /**
+		* Open a page file and start the prefetch thread. The file is deleted when the stream is closed.
+		*
+		* @param file a file written by write
+		* @return true if the file is valid
+		*/
+    bool open(juce::File const& file);
+    /**
+		* Stop the prefetch thread, unmap all pages and delete the file
+		*/
+    void close();
+    /**
+		* Get the length of the song
+		*
+		* @return the length in samples, 0 if the stream is closed
+		*/
+    int64_t getLength() const;
+    /**
+		* Wait until the pages of a range are mapped, called by a background thread before it reads them
+		*
+		* @param first the first song sample of the range, including the repetition
+		* @param end the song sample after the range
+		*/
+    void require(int64_t first, int64_t end);
+    /**
+		* Call a function for every event of a range in order of the samples, the events of a repetition follow
+		* the ones of the previous repetition. Events of pages which are not mapped are skipped.
+		*
+		* @param first the first song sample of the range, including the repetition
+		* @param end the song sample after the range
+		* @param f a function taking a StreamEvent const& and the int64_t song sample of the event in its repetition
+		*/
+    template <typename F>
+    void forEachEvent(int64_t first, int64_t end, F f) const
+    {
+        int64_t firstRepetition, lastRepetition;
+        if (!this->getRepetitions(first, end, firstRepetition, lastRepetition))
+        {
+            return;
+        }
+        for (int64_t repetition = firstRepetition; repetition <= lastRepetition; repetition++)
+        {
+            int64_t offset = repetition * this->length;
+            for (int64_t page = floorDiv(first - offset, PAGE_SAMPLES); page <= floorDiv(end - 1 - offset, PAGE_SAMPLES); page++)
+            {
+                Slot* slot = this->acquire(page, first);
+                if (slot == nullptr)
+                {
+                    continue;
+                }
+                StreamEvent const* begin = slot->events + slot->carryCount;
+                StreamEvent const* last = begin + slot->eventCount;
+                StreamEvent const* event = std::lower_bound(begin, last, first - offset,
+                    [](StreamEvent const& e, int64_t s) { return e.sample < s; });
+                for (; event != last && event->sample < end - offset; ++event)
+                {
+                    f(*event, event->sample + offset);
+                }
+                this->release(slot);
+            }
+        }
+    }
+    /**
+		* Call a function for every stroke and note which covers a position: sample <= position < end
+		*
+		* @param position a position inside the song, the repetition is removed
+		* @param f a function taking a StreamEvent const&
+		*/
+    template <typename F>
+    void forEachSounding(int64_t position, F f) const
+    {
+        if (this->length <= 0)
+        {
+            return;
+        }
+        int64_t inTrack = position % this->length;
+        Slot* slot = this->acquire(floorDiv(inTrack, PAGE_SAMPLES), inTrack);
+        if (slot == nullptr)
+        {
+            return;
+        }
+        for (StreamEvent const* event = slot->events; event != slot->events + slot->carryCount + slot->eventCount; ++event)
+        {
+            if (event->sample > inTrack)
+            {
+                break;
+            }
+            if (inTrack < event->end)
+            {
+                f(*event);
+            }
+        }
+        this->release(slot);
+    }
+    /**
+		* Get the number of reads of pages which were not mapped
+		*
+		* @return the number of missed pages since open
+		*/
+    int getMisses() const;
+    /**
+		* Get the number of pages a background thread had to map itself
+		*
+		* @return the number of pages which were not prefetched in time since open
+		*/
+    int getLatePages() const;
+
+private:
+    static const int64_t NO_PAGE = INT64_MIN; ///<page of an empty slot
+
+    /**
+		* @struct Header
+		* @brief Leading block of the page file, the pages follow and the table of the pages is at the end
+		*/
+    struct Header
+    {
+        char magic[4]; ///<always "TTSP"
+        uint32_t version; ///<layout version, see VERSION
+        int64_t length; ///<length of the song in samples
+        int64_t firstSample; ///<sample of the first event
+        int64_t lastSample; ///<sample of the last event
+        int64_t firstPage; ///<index of the first page, negative if the song starts with a count-in
+        int64_t pageCount; ///<number of pages
+        int64_t tableOffset; ///<position of the table of the pages in the file
+    };
+
+    /**
+		* @struct PageEntry
+		* @brief Position of a page in the file
+		*/
+    struct PageEntry
+    {
+        int64_t offset; ///<position of the first event of the page in the file
+        int32_t carryCount; ///<number of ons sounding at the start of the page, they come first
+        int32_t eventCount; ///<number of events starting in the page
+    };
+
+    /**
+		* @struct Slot
+		* @brief A mapped page, readers announce themselves so the page is not unmapped while it is read
+		*/
+    struct Slot
+    {
+        std::atomic<int64_t> page; ///<index of the mapped page, NO_PAGE if the slot is empty or being replaced
+        std::atomic<int> readers; ///<number of threads reading the page
+        juce::MemoryMappedFile* map = nullptr; ///<the mapped range of the file
+        StreamEvent const* events = nullptr; ///<the carried ons followed by the events of the page
+        int32_t carryCount = 0; ///<number of carried ons
+        int32_t eventCount = 0; ///<number of events starting in the page
+    };
+
+    /**
+		* Division rounding towards -infinity, the song starts with negative samples
+		*
+		* @param value the dividend
+		* @param divisor the divisor, greater than 0
+		* @return the rounded quotient
+		*/
+    static int64_t floorDiv(int64_t value, int64_t divisor);
+    /**
+		* Find the repetitions of the song whose events overlap a range
+		*
+		* @param first the first song sample of the range
+		* @param end the song sample after the range
+		* @param firstRepetition is set to the first repetition
+		* @param lastRepetition is set to the last repetition
+		* @return false if no repetition overlaps the range
+		*/
+    bool getRepetitions(int64_t first, int64_t end, int64_t& firstRepetition, int64_t& lastRepetition) const;
+    /**
+		* Find the slot of a mapped page and announce a reader, never blocks
+		*
+		* @param page index of the page
+		* @param sample the song sample which is read, the prefetch thread continues there on a miss
+		* @return the slot, nullptr if the page is empty or not mapped
+		*/
+    Slot* acquire(int64_t page, int64_t sample) const;
+    /**
+		* End reading a slot returned by acquire
+		*
+		* @param slot the slot
+		*/
+    void release(Slot* slot) const;
+    /**
+		* Loop of the prefetch thread
+		*/
+    void run();
+    /**
+		* Map the pages around a position which are not mapped yet, the caller holds mapMutex
+		*
+		* @param sample the song sample played next
+		* @return the number of pages which were mapped
+		*/
+    int fill(int64_t sample);
+    /**
+		* Replace the page of a slot, the caller holds mapMutex
+		*
+		* @param slot the slot
+		* @param page index of the page to map
+		*/
+    void mapPage(Slot& slot, int64_t page);
+
+    juce::File file; ///<the page file, deleted by close
+    int64_t length = 0; ///<length of the song in samples
+    int64_t firstSample = 0; ///<sample of the first event
+    int64_t lastSample = 0; ///<sample of the last event
+    int64_t firstPage = 0; ///<index of the first page
+    int64_t pageCount = 0; ///<number of pages
+    int64_t tableOffset = 0; ///<position of the table of the pages in the file
+
+    mutable Slot slots[RESIDENT_PAGES]; ///<the mapped pages
+    mutable std::atomic<int64_t> position; ///<song sample read last, the prefetch thread maps the pages around it
+    mutable std::atomic<int> misses; ///<reads of pages which were not mapped
+    std::atomic<int> latePages; ///<pages mapped by require instead of the prefetch thread
+
+    std::mutex mapMutex; ///<only one thread maps pages at a time, the audio thread never takes it
+    std::thread prefetchThread; ///<the prefetch thread
+    std::atomic<bool> stopPrefetch; ///<is set to true, when the prefetch thread shall end
+    mutable std::atomic<bool> wakeUp; ///<set by the audio thread after a miss, polled by the prefetch thread
+};
+}
+#endif
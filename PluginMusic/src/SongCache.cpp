@@ -0,0 +1,142 @@
+#include "SongCache.h"
+
+using namespace ttmm;
+
+namespace
+{
+const char MAGIC[4] = { 'T', 'T', 'S', 'C' };
+
+//64 bit FNV-1a, fast enough to hash a midi file on every start
+uint64_t fnv1a(void const* data, size_t size)
+{
+    uint64_t hash = 14695981039346656037ULL;
+    auto bytes = static_cast<unsigned char const*>(data);
+    for (size_t i = 0; i < size; i++)
+    {
+        hash ^= bytes[i];
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+template <typename T>
+void readArray(vector<T>& target, char const*& position, int32_t count)
+{
+    auto first = reinterpret_cast<T const*>(position);
+    target.assign(first, first + count);
+    position += sizeof(T) * count;
+}
+
+template <typename T>
+bool writeArray(juce::OutputStream& out, vector<T> const& source)
+{
+    return source.empty() || out.write(source.data(), sizeof(T) * source.size());
+}
+}
+
+SongCache::SongCache(juce::File const& songFile)
+    : songFile(songFile)
+    , cacheFile(songFile.getSiblingFile(songFile.getFileName() + ".ttsc"))
+{
+}
+
+juce::File SongCache::getCacheFile() const
+{
+    return this->cacheFile;
+}
+
+bool SongCache::hashSongFile()
+{
+    juce::MemoryMappedFile song(this->songFile, juce::MemoryMappedFile::readOnly);
+    if (song.getData() == nullptr)
+    {
+        return false;
+    }
+    this->songSize = int64_t(song.getSize());
+    this->songHash = fnv1a(song.getData(), song.getSize());
+    return true;
+}
+
+bool SongCache::load(SongSchedule& schedule)
+{
+    TIMED_BLOCK("SongCache::load")
+    if (!this->cacheFile.existsAsFile() || !this->hashSongFile())
+    {
+        return false;
+    }
+    juce::MemoryMappedFile cache(this->cacheFile, juce::MemoryMappedFile::readOnly);
+    if (cache.getData() == nullptr || cache.getSize() < sizeof(Header))
+    {
+        return false;
+    }
+    Header const* header = static_cast<Header const*>(cache.getData());
+    if (memcmp(header->magic, MAGIC, sizeof(MAGIC)) != 0
+        || header->version != VERSION
+        || header->songHash != this->songHash
+        || header->songSize != this->songSize
+        || header->numTempos < 0 || header->numSignatures < 0
+        || header->numTracks < 0 || header->numStrokes < 0 || header->numNodes < 0)
+    {
+        ttmm::logfileMusic->write("song cache is outdated: " + this->cacheFile.getFullPathName().toStdString());
+        return false;
+    }
+    size_t expectedSize = sizeof(Header)
+        + sizeof(TempoChange) * header->numTempos
+        + sizeof(TimeSignatureChange) * header->numSignatures
+        + sizeof(ScheduledTrack) * header->numTracks
+        + sizeof(ScheduledStroke) * header->numStrokes
+        + sizeof(ScheduledNode) * header->numNodes;
+    if (cache.getSize() != expectedSize)
+    {
+        ttmm::logfileMusic->write("song cache is truncated: " + this->cacheFile.getFullPathName().toStdString());
+        return false;
+    }
+    schedule.clear();
+    schedule.bpm = short(header->bpm);
+    schedule.ticksPerQuarter = header->ticksPerQuarter;
+    char const* position = static_cast<char const*>(cache.getData()) + sizeof(Header);
+    readArray(schedule.tempos, position, header->numTempos);
+    readArray(schedule.signatures, position, header->numSignatures);
+    readArray(schedule.tracks, position, header->numTracks);
+    readArray(schedule.strokes, position, header->numStrokes);
+    readArray(schedule.nodes, position, header->numNodes);
+    return true;
+}
+
+bool SongCache::store(SongSchedule const& schedule)
+{
+    if (this->songSize == 0 && !this->hashSongFile())
+    {
+        return false;
+    }
+    Header header = {};
+    memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = VERSION;
+    header.songHash = this->songHash;
+    header.songSize = this->songSize;
+    header.ticksPerQuarter = schedule.ticksPerQuarter;
+    header.bpm = schedule.bpm;
+    header.numTempos = int32_t(schedule.tempos.size());
+    header.numSignatures = int32_t(schedule.signatures.size());
+    header.numTracks = int32_t(schedule.tracks.size());
+    header.numStrokes = int32_t(schedule.strokes.size());
+    header.numNodes = int32_t(schedule.nodes.size());
+
+    //write to a temporary file first, so a crash never leaves a half written cache behind
+    juce::TemporaryFile temp(this->cacheFile);
+    {
+        juce::FileOutputStream out(temp.getFile());
+        if (out.failedToOpen()
+            || !out.write(&header, sizeof(header))
+            || !writeArray(out, schedule.tempos)
+            || !writeArray(out, schedule.signatures)
+            || !writeArray(out, schedule.tracks)
+            || !writeArray(out, schedule.strokes)
+            || !writeArray(out, schedule.nodes))
+        {
+            ttmm::logfileMusic->write("could not write song cache: " + this->cacheFile.getFullPathName().toStdString());
+            return false;
+        }
+    }
+    return temp.overwriteTargetFileWithTemporary();
+}
@@ -0,0 +1,92 @@
+/**
+* @file SongCache.cpp
+* @author FH-Minden Musikinformatik 2015, Musicgroup (Marcel, Patrick, Scott)
+* @brief Binary cache of a compiled song, stored next to the midi file
+*
+*/
+#ifndef TTMM_SONG_CACHE_H
+#define TTMM_SONG_CACHE_H
+
+#include <cstdint>
+
+#include "FileWriter.h"
+#include "TimeTools.h"
+#include "../Model/SongSchedule.h"
+#include "../../TTMM/JuceLibraryCode/JuceHeader.h"
+
+namespace ttmm
+{
+/**
+	* @class SongCache
+	* @brief Writes a compiled SongSchedule to "<song>.mid.ttsc" and maps it back on the next start.
+	*		  The cache is keyed by a hash of the midi file, so an edited song is compiled again.
+	*		  Bump VERSION whenever the layout of SongSchedule changes.
+	*
+	* @see SongSchedule, MidiReader
+	*/
+class SongCache
+{
+public:
+    static const uint32_t VERSION = 3; ///<layout version of the cache file
+
+    /**
+		* Constructor: create a SongCache for a midi file
+		*
+		* @param songFile the midi file the cache belongs to
+		*/
+    SongCache(juce::File const& songFile);
+    /**
+		* Map the cache file and copy it into the schedule
+		*
+		* @param schedule a reference to the schedule to fill
+		* @return true if a valid cache for the current midi file exists, otherwise false
+		*/
+    bool load(SongSchedule& schedule);
+    /**
+		* Write the schedule to the cache file
+		*
+		* @param schedule the compiled schedule of the midi file
+		* @return true if the cache was written
+		*/
+    bool store(SongSchedule const& schedule);
+    /**
+		* Get the file the cache is stored in
+		*
+		* @return the cache file next to the midi file
+		*/
+    juce::File getCacheFile() const;
+
+private:
+    /**
+		* @struct Header
+		* @brief Leading block of the cache file, followed by the tempos, signatures, tracks, strokes and nodes arrays
+		*/
+    struct Header
+    {
+        char magic[4]; ///<always "TTSC"
+        uint32_t version; ///<layout version, see VERSION
+        uint64_t songHash; ///<FNV-1a hash of the midi file
+        int64_t songSize; ///<size of the midi file in bytes
+        double ticksPerQuarter; ///<resolution of the tempo map
+        int32_t bpm; ///<beats per minute of the song
+        int32_t numTempos; ///<number of TempoChange entries
+        int32_t numSignatures; ///<number of TimeSignatureChange entries
+        int32_t numTracks; ///<number of ScheduledTrack entries
+        int32_t numStrokes; ///<number of ScheduledStroke entries
+        int32_t numNodes; ///<number of ScheduledNode entries
+    };
+
+    /**
+		* Hash the content of the midi file
+		*
+		* @return true if the midi file could be read
+		*/
+    bool hashSongFile();
+
+    juce::File songFile; ///<the midi file
+    juce::File cacheFile; ///<the cache file next to the midi file
+    uint64_t songHash = 0; ///<FNV-1a hash of the midi file
+    int64_t songSize = 0; ///<size of the midi file in bytes
+};
+}
+#endif
@@ -0,0 +1,341 @@
+#include "SongLibrary.h"
+#include "MidiReader.h"
+#include "TimeTools.h"
+
+#include <algorithm>
+#include <cstring>
+#include <unordered_map>
+
+using namespace ttmm;
+
+namespace
+{
+const char MAGIC[4] = { 'T', 'T', 'S', 'L' };
+
+//the index file is a header followed by a record and the name of every song
+struct Header
+{
+    char magic[4];
+    uint32_t version;
+    int32_t count;
+};
+
+struct Record
+{
+    int64_t fileSize;
+    int64_t modified;
+    double duration;
+    double bpm;
+    double minBpm;
+    double maxBpm;
+    int32_t trackCount;
+    int32_t noteCount;
+    int32_t tempoChanges;
+    int32_t numerator;
+    int32_t denominator;
+    int32_t keySignature;
+    int32_t isMajor;
+    int32_t nameLength;
+};
+
+bool byName(LibraryEntry const& a, LibraryEntry const& b)
+{
+    return a.name < b.name;
+}
+}
+
+double LibraryEntry::getNoteDensity() const
+{
+    return (this->duration > 0) ? this->noteCount / this->duration : 0;
+}
+
+SongLibrary::SongLibrary(juce::File const& folder)
+    : folder(folder)
+    , indexFile(folder.getChildFile("library.ttsl"))
+    , scanning(false)
+    , cancelScan(false)
+{
+}
+
+SongLibrary::~SongLibrary()
+{
+    this->cancelScan.store(true);
+    if (this->scanThread.joinable())
+    {
+        this->scanThread.join();
+    }
+}
+
+void SongLibrary::startScan()
+{
+    //the host thread must not wait for a whole scan of the folder
+    if (this->scanning.load())
+    {
+        return;
+    }
+    //the thread of the last scan has already ended
+    if (this->scanThread.joinable())
+    {
+        this->scanThread.join();
+    }
+    this->cancelScan.store(false);
+    this->scanning.store(true);
+    this->scanThread = std::thread(&SongLibrary::scan, this);
+    if (!this->scanThread.joinable())
+    {
+        this->scanning.store(false);
+        ttmm::logger.write("Failed to start the SongLibrary thread");
+    }
+}
+
+bool SongLibrary::isScanning() const
+{
+    return this->scanning.load();
+}
+
+std::vector<LibraryEntry> SongLibrary::find(LibraryFilter const& filter) const
+{
+    std::vector<LibraryEntry> result;
+    std::lock_guard<std::mutex> lock(this->entriesMutex);
+    for (auto const& entry : this->entries)
+    {
+        //an unreadable file stays in the index, so it is not read again until it changes
+        if (entry.trackCount > 0 && (filter.text.isEmpty() || String(entry.name).containsIgnoreCase(filter.text))
+            && entry.bpm >= filter.minBpm && entry.bpm <= filter.maxBpm
+            && (filter.maxDuration <= 0 || entry.duration <= filter.maxDuration)
+            && (filter.numerator == 0 || entry.numerator == filter.numerator))
+        {
+            result.push_back(entry);
+        }
+    }
+    return result;
+}
+
+//only the meta events and note ons are looked at, no Song is built
+bool SongLibrary::readEntry(juce::File const& file, LibraryEntry& entry)
+{
+    entry.trackCount = 0;
+    entry.noteCount = 0;
+    entry.duration = 0;
+    entry.bpm = entry.minBpm = entry.maxBpm = 0;
+    entry.tempoChanges = 0;
+    entry.numerator = entry.denominator = 4;
+    entry.keySignature = 0;
+    entry.isMajor = 1;
+    juce::FileInputStream input(file);
+    juce::MidiFile midiFile;
+    if (input.failedToOpen() || !midiFile.readFrom(input))
+    {
+        return false;
+    }
+    TempoMap tempoMap = MidiReader::readTempoMap(midiFile);
+    entry.trackCount = midiFile.getNumTracks();
+    entry.duration = tempoMap.tickToSeconds(midiFile.getLastTimestamp());
+    entry.bpm = entry.minBpm = entry.maxBpm = tempoMap.getBpm(0);
+    for (auto const& tempo : tempoMap.getTempoChanges())
+    {
+        double bpm = 60.0 / tempo.secondsPerQuarter;
+        entry.minBpm = std::min(entry.minBpm, bpm);
+        entry.maxBpm = std::max(entry.maxBpm, bpm);
+    }
+    entry.tempoChanges = int32_t(tempoMap.getTempoChanges().size());
+    TimeSignatureChange const& signature = tempoMap.getTimeSignature(0);
+    entry.numerator = signature.numerator;
+    entry.denominator = signature.denominator;
+    double keyTick = -1;
+    for (int t = 0; t < midiFile.getNumTracks(); t++)
+    {
+        juce::MidiMessageSequence const* seq = midiFile.getTrack(t);
+        for (int i = 0; i < seq->getNumEvents(); i++)
+        {
+            juce::MidiMessage const& m = seq->getEventPointer(i)->message;
+            if (m.isNoteOn())
+            {
+                entry.noteCount++;
+            }
+            else if (m.isKeySignatureMetaEvent() && (keyTick < 0 || m.getTimeStamp() < keyTick))
+            {
+                //the first key signature of all tracks
+                keyTick = m.getTimeStamp();
+                //juce returns the byte unsigned, flats are negative
+                entry.keySignature = int8_t(m.getKeySignatureNumberOfSharpsOrFlats());
+                entry.isMajor = m.isKeySignatureMajorKey() ? 1 : 0;
+            }
+        }
+    }
+    return true;
+}
+
+void SongLibrary::scan()
+{
+    TIMED_BLOCK("SongLibrary::scan")
+    std::vector<LibraryEntry> known;
+    {
+        std::lock_guard<std::mutex> lock(this->entriesMutex);
+        known = this->entries;
+    }
+    if (known.empty() && this->loadIndex(known))
+    {
+        //the songs can be browsed while the folder is compared
+        std::lock_guard<std::mutex> lock(this->entriesMutex);
+        this->entries = known;
+    }
+    std::unordered_map<std::string, size_t> byFileName;
+    for (size_t i = 0; i < known.size(); i++)
+    {
+        byFileName[known[i].name] = i;
+    }
+    juce::Array<juce::File> files;
+    this->folder.findChildFiles(files, juce::File::findFiles, false, "*.mid");
+    std::vector<LibraryEntry> index(size_t(files.size()));
+    std::vector<int> changed;
+    for (int i = 0; i < files.size(); i++)
+    {
+        LibraryEntry& entry = index[size_t(i)];
+        entry.name = files[i].getFileName().toStdString();
+        entry.fileSize = files[i].getSize();
+        entry.modified = files[i].getLastModificationTime().toMilliseconds();
+        auto it = byFileName.find(entry.name);
+        if (it != byFileName.end() && known[it->second].fileSize == entry.fileSize
+            && known[it->second].modified == entry.modified)
+        {
+            entry = known[it->second];
+        }
+        else
+        {
+            changed.push_back(i);
+        }
+    }
+    //read the new and changed files on a pool of worker threads, each takes the next file until none is left
+    std::atomic<size_t> next(0);
+    auto work = [&]()
+    {
+        for (size_t k = next++; k < changed.size() && !this->cancelScan.load(); k = next++)
+        {
+            int i = changed[k];
+            if (!readEntry(files[i], index[size_t(i)]))
+            {
+                ttmm::logfileMusic->write("could not read song " + index[size_t(i)].name);
+            }
+        }
+    };
+    size_t workerCount = std::min(size_t(std::max(1u, std::thread::hardware_concurrency())), changed.size());
+    std::vector<std::thread> workers;
+    for (size_t w = 1; w < workerCount; w++)
+    {
+        workers.push_back(std::thread(work));
+    }
+    work();
+    for (auto& worker : workers)
+    {
+        worker.join();
+    }
+    if (!this->cancelScan.load())
+    {
+        std::sort(index.begin(), index.end(), byName);
+        if ((!changed.empty() || index.size() != known.size()) && !this->storeIndex(index))
+        {
+            ttmm::logfileMusic->write("could not write song library " + this->indexFile.getFullPathName().toStdString());
+        }
+        ttmm::logfileMusic->write("song library: " + std::to_string(index.size()) + " songs, read ", int(changed.size()));
+        std::lock_guard<std::mutex> lock(this->entriesMutex);
+        this->entries.swap(index);
+    }
+    this->scanning.store(false);
+}
+
+bool SongLibrary::loadIndex(std::vector<LibraryEntry>& index) const
+{
+    if (!this->indexFile.existsAsFile())
+    {
+        return false;
+    }
+    juce::MemoryMappedFile file(this->indexFile, juce::MemoryMappedFile::readOnly);
+    if (file.getData() == nullptr || file.getSize() < sizeof(Header))
+    {
+        return false;
+    }
+    char const* position = static_cast<char const*>(file.getData());
+    char const* end = position + file.getSize();
+    Header header;
+    memcpy(&header, position, sizeof(header));
+    position += sizeof(header);
+    if (memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0 || header.version != VERSION || header.count < 0)
+    {
+        ttmm::logfileMusic->write("song library is outdated: " + this->indexFile.getFullPathName().toStdString());
+        return false;
+    }
+    index.clear();
+    for (int32_t i = 0; i < header.count; i++)
+    {
+        Record record;
+        if (end - position < ptrdiff_t(sizeof(record)))
+        {
+            return false;
+        }
+        memcpy(&record, position, sizeof(record));
+        position += sizeof(record);
+        if (record.nameLength < 0 || end - position < record.nameLength)
+        {
+            return false;
+        }
+        LibraryEntry entry;
+        entry.name.assign(position, size_t(record.nameLength));
+        position += record.nameLength;
+        entry.fileSize = record.fileSize;
+        entry.modified = record.modified;
+        entry.trackCount = record.trackCount;
+        entry.noteCount = record.noteCount;
+        entry.duration = record.duration;
+        entry.bpm = record.bpm;
+        entry.minBpm = record.minBpm;
+        entry.maxBpm = record.maxBpm;
+        entry.tempoChanges = record.tempoChanges;
+        entry.numerator = record.numerator;
+        entry.denominator = record.denominator;
+        entry.keySignature = record.keySignature;
+        entry.isMajor = record.isMajor;
+        index.push_back(entry);
+    }
+    return true;
+}
+
+bool SongLibrary::storeIndex(std::vector<LibraryEntry> const& index) const
+{
+    Header header = {};
+    memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = VERSION;
+    header.count = int32_t(index.size());
+    //write to a temporary file first, so a crash never leaves a half written index behind
+    juce::TemporaryFile temp(this->indexFile);
+    {
+        juce::FileOutputStream out(temp.getFile());
+        if (out.failedToOpen() || !out.write(&header, sizeof(header)))
+        {
+            return false;
+        }
+        for (auto const& entry : index)
+        {
+            Record record = {};
+            record.fileSize = entry.fileSize;
+            record.modified = entry.modified;
+            record.duration = entry.duration;
+            record.bpm = entry.bpm;
+            record.minBpm = entry.minBpm;
+            record.maxBpm = entry.maxBpm;
+            record.trackCount = entry.trackCount;
+            record.noteCount = entry.noteCount;
+            record.tempoChanges = entry.tempoChanges;
+            record.numerator = entry.numerator;
+            record.denominator = entry.denominator;
+            record.keySignature = entry.keySignature;
+            record.isMajor = entry.isMajor;
+            record.nameLength = int32_t(entry.name.size());
+            if (!out.write(&record, sizeof(record)) || !out.write(entry.name.data(), entry.name.size()))
+            {
+                return false;
+            }
+        }
+    }
+    return temp.overwriteTargetFileWithTemporary();
+}
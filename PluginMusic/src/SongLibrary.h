@@ -0,0 +1,146 @@
+/**
+* @file SongLibrary.cpp
+* @author FH-Minden Musikinformatik 2015, Musicgroup (Marcel, Patrick, Scott)
+* @brief Index of the songs in the Soundfiles folder, so they can be browsed without reading the midi files
+*
+*/
+#ifndef TTMM_SONG_LIBRARY_H
+#define TTMM_SONG_LIBRARY_H
+
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <vector>
+#include <string>
+#include <cstdint>
+
+#include "FileWriter.h"
+#include "../Model/TempoMap.h"
+#include "../../TTMM/JuceLibraryCode/JuceHeader.h"
+
+namespace ttmm
+{
+/**
+	* @struct LibraryEntry
+	* @brief What the index knows about a midi file
+	*/
+struct LibraryEntry
+{
+    std::string name; ///<the name of the song file in the Soundfiles folder
+    int64_t fileSize; ///<size of the midi file in bytes
+    int64_t modified; ///<last modification of the midi file in milliseconds since 1970
+    int32_t trackCount; ///<number of tracks of the midi file, 0 if it could not be read
+    int32_t noteCount; ///<number of note ons of all tracks
+    double duration; ///<length of the song in seconds
+    double bpm; ///<tempo at the start of the song
+    double minBpm; ///<slowest tempo of the song
+    double maxBpm; ///<fastest tempo of the song
+    int32_t tempoChanges; ///<number of set-tempo events
+    int32_t numerator; ///<numerator of the time signature at the start
+    int32_t denominator; ///<denominator of the time signature at the start
+    int32_t keySignature; ///<sharps (positive) or flats (negative) of the key signature at the start
+    int32_t isMajor; ///<1 for a major key, 0 for a minor key
+
+    /**
+		* Get the number of notes per second
+		*
+		* @return the note density, 0 for an empty song
+		*/
+    double getNoteDensity() const;
+};
+
+/**
+	* @struct LibraryFilter
+	* @brief Selects entries of the library, every criterion has to match
+	*/
+struct LibraryFilter
+{
+    String text; ///<part of the name, ignoring case; empty matches every song
+    double minBpm = 0; ///<slowest accepted tempo at the start
+    double maxBpm = 1000; ///<fastest accepted tempo at the start
+    double maxDuration = 0; ///<longest accepted song in seconds, 0 for any length
+    int numerator = 0; ///<accepted numerator of the time signature, 0 for any
+};
+
+/**
+	* @class SongLibrary
+	* @brief Keeps an index of the midi files of a folder in memory and in "library.ttsl" inside the folder.
+	*		  A scan runs on a background thread and reads only new or changed files (by size and modification time),
+	*		  spread over a pool of worker threads. Browsing and filtering only use the index in memory.
+	*		  Bump VERSION whenever the layout of the index file changes.
+	*
+	* @see LibraryEntry, LibraryFilter, MidiReader
+	*/
+class SongLibrary
+{
+public:
+    static const uint32_t VERSION = 1; ///<layout version of the index file
+
+    /**
+		* Constructor: create an empty library of a folder
+		*
+		* @param folder the folder of the midi files
+		*/
+    SongLibrary(juce::File const& folder);
+    /**
+		* Destructor: cancel a running scan
+		*/
+    ~SongLibrary();
+    /**
+		* Load the index file and update it on a background thread.
+		* While a scan is running nothing happens, that scan brings the index up to date.
+		*/
+    void startScan();
+    /**
+		* Check whether a scan is running
+		*
+		* @return true until the index is up to date
+		*/
+    bool isScanning() const;
+    /**
+		* Find the songs matching a filter, only the index in memory is used.
+		* Files which could not be read are never found.
+		*
+		* @param filter the criteria the songs have to match
+		* @return the matching entries sorted by name
+		*/
+    std::vector<LibraryEntry> find(LibraryFilter const& filter) const;
+    /**
+		* Read the information about a midi file
+		*
+		* @param file the midi file
+		* @param entry is filled with the information, trackCount is 0 if the file could not be read
+		* @return false if the file is no readable midi file
+		*/
+    static bool readEntry(juce::File const& file, LibraryEntry& entry);
+
+private:
+    /**
+		* Loop of the background thread: compare the folder with the index, read the changed files and store the index
+		*/
+    void scan();
+    /**
+		* Read the index file
+		*
+		* @param index is filled with the entries of the file
+		* @return false if there is no valid index file
+		*/
+    bool loadIndex(std::vector<LibraryEntry>& index) const;
+    /**
+		* Write the index file
+		*
+		* @param index the entries to write
+		* @return true if the file was written
+		*/
+    bool storeIndex(std::vector<LibraryEntry> const& index) const;
+
+    juce::File folder; ///<the folder of the midi files
+    juce::File indexFile; ///<the index file inside the folder
+    mutable std::mutex entriesMutex; ///<protects entries
+    std::vector<LibraryEntry> entries; ///<the index in memory, sorted by name
+    std::thread scanThread; ///<the background thread of the scan
+    std::atomic<bool> scanning; ///<is true while the background thread runs
+    std::atomic<bool> cancelScan; ///<is set to true, when the scan shall end early
+};
+}
+#endif
@@ -0,0 +1,253 @@
+#include "SongLoader.h"
+#include "TimeTools.h"
+
+#include <algorithm>
+#include <chrono>
+
+using namespace ttmm;
+
+LoadedSong::LoadedSong()
+    : song(0)
+{
+}
+
+SongLoader::SongLoader()
+    : retireFifo(RETIRE_CAPACITY)
+    , retireRing(RETIRE_CAPACITY)
+    , stopLoader(true)
+{
+    for (auto& slot : this->slots)
+    {
+        slot.store(nullptr);
+    }
+}
+
+SongLoader::~SongLoader()
+{
+    this->stop();
+}
+
+//read the song from the cache or, if it is missing or outdated, from the midi file
+LoadedSong* SongLoader::load(std::string songname, double samplerate)
+{
+    TIMED_BLOCK("loadSong")
+    MidiReader reader(songname);
+    if (!reader.getSongFile().existsAsFile())
+    {
+        ttmm::logfileMusic->write("## Error: there is no song file named \"" + songname + "\"");
+        return nullptr;
+    }
+    LoadedSong* loaded = new LoadedSong();
+    SongSchedule schedule;
+    SongCache cache(reader.getSongFile());
+    if (cache.load(schedule))
+    {
+        schedule.restore(loaded->song);
+        loaded->name = reader.getSongFile().getFileName();
+        ttmm::logfileMusic->write("restored Song structure from cache");
+    }
+    else
+    {
+        // read Midifile to Songobj
+        loaded->name = reader.readToSong(loaded->song);
+        ttmm::logfileMusic->write("read mididata to Song structure");
+        //generate all tracks, they are played together
+        for (int i = 0; i < 4; i++)
+        {
+            for (int t = 0; t < loaded->song.getNumberofTracks(); t++)
+            {
+                loaded->song.generateTrack(t);
+            }
+        }
+        ttmm::logfileMusic->write("generated tracks of Song: ", loaded->song.getNumberofTracks());
+        // for test whether or not we have read Midifile to Songobj exactly
+        loaded->song.readAllTracks();
+        ttmm::logfileMusic->write("printed out the song structure");
+        schedule.compile(loaded->song);
+        if (cache.store(schedule))
+        {
+            ttmm::logfileMusic->write("wrote song cache " + cache.getCacheFile().getFullPathName().toStdString());
+        }
+    }
+    loaded->schedule.prepare(loaded->song, samplerate);
+    if (loaded->schedule.getEvents().size() > STREAM_EVENTS)
+    {
+        //the events are written to a temporary page file, the song itself is not needed to play them
+        juce::File pageFile = juce::File::getSpecialLocation(juce::File::tempDirectory)
+            .getNonexistentChildFile(loaded->name.upToLastOccurrenceOf(".", false, false), ".ttsp", false);
+        size_t events = loaded->schedule.getEvents().size();
+        if (loaded->schedule.stream(pageFile))
+        {
+            loaded->song = Song(loaded->song.getBpm());
+            ttmm::logfileMusic->write("streaming song events: ", int(events));
+        }
+    }
+    //the audio thread changes to the song without allocating
+    loaded->handler.prepare(loaded->schedule);
+    return loaded;
+}
+
+void SongLoader::start(double samplerate, LookaheadRenderer const& renderer, LoadedSong const& playing)
+{
+    this->stop();
+    this->samplerate = samplerate;
+    this->renderer = &renderer;
+    {
+        std::lock_guard<std::mutex> lock(this->requestMutex);
+        this->setlistPosition = 0;
+        this->playingName = playing.name;
+    }
+    this->stopLoader.store(false);
+    this->loaderThread = std::thread(&SongLoader::run, this);
+    if (!this->loaderThread.joinable())
+    {
+        ttmm::logger.write("Failed to start the SongLoader thread");
+    }
+}
+
+void SongLoader::stop()
+{
+    {
+        std::lock_guard<std::mutex> lock(this->requestMutex);
+        this->stopLoader.store(true);
+        this->requests.clear();
+    }
+    this->wakeUp.notify_one();
+    if (this->loaderThread.joinable())
+    {
+        this->loaderThread.join();
+    }
+    //the songs were loaded for the old samplerate, the renderer does not play any of them
+    for (auto& slot : this->slots)
+    {
+        delete slot.exchange(nullptr);
+    }
+    this->renderer = nullptr;
+    this->reclaim();
+}
+
+void SongLoader::request(std::string songname)
+{
+    {
+        std::lock_guard<std::mutex> lock(this->requestMutex);
+        this->requests.push_back(songname);
+    }
+    this->wakeUp.notify_one();
+}
+
+void SongLoader::setSetlist(std::vector<std::string> const& songnames)
+{
+    {
+        std::lock_guard<std::mutex> lock(this->requestMutex);
+        this->setlist = songnames;
+        this->setlistPosition = 0;
+    }
+    //a preloaded song of the old setlist is not played any more
+    delete this->slots[END_OF_SONG].exchange(nullptr);
+    this->wakeUp.notify_one();
+}
+
+bool SongLoader::isReady(Slot slot) const
+{
+    return this->slots[slot].load() != nullptr && this->retireFifo.getFreeSpace() > 0;
+}
+
+LoadedSong* SongLoader::take(Slot slot)
+{
+    return this->slots[slot].exchange(nullptr);
+}
+
+bool SongLoader::retire(LoadedSong* song, LoadedSong const* successor, uint32_t seek)
+{
+    if (this->retireFifo.getFreeSpace() == 0)
+    {
+        return false;
+    }
+    int start1, size1, start2, size2;
+    this->retireFifo.prepareToWrite(1, start1, size1, start2, size2);
+    RetiredSong& entry = this->retireRing[size1 > 0 ? start1 : start2];
+    entry.song = song;
+    entry.successor = successor;
+    entry.seek = seek;
+    this->retireFifo.finishedWrite(1);
+    return true;
+}
+
+String SongLoader::getPlayingName()
+{
+    std::lock_guard<std::mutex> lock(this->requestMutex);
+    return this->playingName;
+}
+
+void SongLoader::run()
+{
+    while (!this->stopLoader.load())
+    {
+        std::string songname;
+        Slot slot = SLOT_COUNT;
+        {
+            std::unique_lock<std::mutex> lock(this->requestMutex);
+            if (!this->requests.empty())
+            {
+                //only the latest request is loaded, the others were replaced before they were ready
+                songname = this->requests.back();
+                this->requests.clear();
+                slot = NEXT_BAR;
+            }
+            else if (this->setlistPosition < this->setlist.size() && this->slots[END_OF_SONG].load() == nullptr)
+            {
+                //the previous song of the setlist was taken, preload the next one
+                songname = this->setlist[this->setlistPosition++];
+                slot = END_OF_SONG;
+            }
+            else
+            {
+                //replaced songs are collected even if there is no request
+                this->wakeUp.wait_for(lock, std::chrono::milliseconds(10));
+            }
+        }
+        if (slot != SLOT_COUNT)
+        {
+            ttmm::logfileMusic->write("loading song " + songname);
+            LoadedSong* loaded = load(songname, this->samplerate);
+            //a missing song is skipped, the next one of the setlist is loaded instead
+            if (loaded != nullptr)
+            {
+                this->publish(slot, loaded);
+            }
+        }
+        this->reclaim();
+    }
+}
+
+void SongLoader::publish(Slot slot, LoadedSong* song)
+{
+    //a song which was not taken in time is replaced
+    delete this->slots[slot].exchange(song);
+}
+
+void SongLoader::reclaim()
+{
+    int ready = this->retireFifo.getNumReady();
+    if (ready > 0)
+    {
+        int start1, size1, start2, size2;
+        this->retireFifo.prepareToRead(ready, start1, size1, start2, size2);
+        this->retired.insert(this->retired.end(), this->retireRing.begin() + start1, this->retireRing.begin() + start1 + size1);
+        this->retired.insert(this->retired.end(), this->retireRing.begin() + start2, this->retireRing.begin() + start2 + size2);
+        this->retireFifo.finishedRead(size1 + size2);
+        //the successor of the last replaced song is played now, it is not deleted before its own entry
+        std::lock_guard<std::mutex> lock(this->requestMutex);
+        this->playingName = this->retired.back().successor->name;
+    }
+    //songs whose schedule may still be rendered are kept, without a renderer no schedule is used any more
+    auto unused = std::stable_partition(this->retired.begin(), this->retired.end(), [this](RetiredSong const& entry)
+    {
+        return this->renderer != nullptr && !this->renderer->hasReachedSeek(entry.seek);
+    });
+    for (auto it = unused; it != this->retired.end(); ++it)
+    {
+        delete it->song;
+    }
+    this->retired.erase(unused, this->retired.end());
+}
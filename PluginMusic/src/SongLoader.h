@@ -0,0 +1,194 @@
+/**
+* @file SongLoader.cpp
+* @author FH-Minden Musikinformatik 2015, Musicgroup (Marcel, Patrick, Scott)
+* @brief Loads songs on a background thread, so the playback continues while a song is read
+*
+*/
+#ifndef TTMM_SONG_LOADER_H
+#define TTMM_SONG_LOADER_H
+
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <vector>
+#include <deque>
+#include <string>
+#include <cstdint>
+
+#include "FileWriter.h"
+#include "../Model/Song.h"
+#include "../Model/SongSchedule.h"
+#include "MidiReader.h"
+#include "PlaybackSchedule.h"
+#include "LookaheadRenderer.h"
+#include "SongCache.h"
+#include "../../TTMM/JuceLibraryCode/JuceHeader.h"
+
+namespace ttmm
+{
+/**
+	* @struct LoadedSong
+	* @brief A song together with its schedule, everything the audio thread needs to play it
+	*/
+struct LoadedSong
+{
+    /**
+		* Constructor: create an empty song
+		*/
+    LoadedSong();
+
+    Song song; ///<the song structure
+    PlaybackSchedule schedule; ///<the events of all tracks in samples
+    MidiHandler handler; ///<prepared for the schedule by the loader, the renderer takes it over at the change of the song
+    String name; ///<the name of the song (filename)
+};
+
+/**
+	* @class SongLoader
+	* @brief Reads and compiles songs on a background thread. A loaded song is published in a slot,
+	*		  the audio thread takes it out with an atomic exchange and plays it from the next bar
+	*		  (NEXT_BAR) or after the end of the current song (END_OF_SONG). The songs of a setlist are
+	*		  preloaded one by one into the END_OF_SONG slot, so the next song is ready when the current one ends.
+	*		  A song replaced by the audio thread is handed back and deleted by the background thread,
+	*		  as soon as the LookaheadRenderer does not use its schedule any more.
+	*
+	* @see LoadedSong, LookaheadRenderer, DynamicComposition
+	*/
+class SongLoader
+{
+public:
+    /**
+		* Enum type for the moment a loaded song is played
+		*/
+    enum Slot
+    {
+        NEXT_BAR, ///<the song replaces the current one at the next bar
+        END_OF_SONG, ///<the song follows the current one, used by the setlist
+        SLOT_COUNT
+    };
+
+    static const int RETIRE_CAPACITY = 16; ///<size of the ring of replaced songs
+    static const size_t STREAM_EVENTS = 200000; ///<songs with more events are streamed from a page file
+
+    /**
+		* Constructor: create a stopped SongLoader
+		*/
+    SongLoader();
+    /**
+		* Destructor: stop the background thread and delete all songs it owns
+		*/
+    ~SongLoader();
+    /**
+		* Read a song from its cache next to the midi file and compile its schedule.
+		* Only if there is no valid cache, the midi file is read, generated and the cache is written.
+		* The schedule of a long song is streamed, then only its bars and beats stay in memory.
+		*
+		* @param songname the name of the song file in the Soundfiles folder
+		* @param samplerate samplerate of host
+		* @return the loaded song, the caller owns it, nullptr if there is no such song file
+		*/
+    static LoadedSong* load(std::string songname, double samplerate);
+    /**
+		* Start the background thread, songs are loaded for this samplerate
+		*
+		* @param samplerate samplerate of host
+		* @param renderer the renderer which plays the schedules of the songs
+		* @param playing the song which is played now
+		*/
+    void start(double samplerate, LookaheadRenderer const& renderer, LoadedSong const& playing);
+    /**
+		* Stop the background thread and delete all loaded and replaced songs.
+		* The renderer must not play a replaced song any more.
+		*/
+    void stop();
+    /**
+		* Load a song in the background, it replaces the current song at the next bar. Can be called from the GUI thread.
+		*
+		* @param songname the name of the song file in the Soundfiles folder
+		*/
+    void request(std::string songname);
+    /**
+		* Set the songs which are played after the current one, can be called from the GUI thread
+		*
+		* @param songnames the names of the song files in the Soundfiles folder
+		*/
+    void setSetlist(std::vector<std::string> const& songnames);
+    /**
+		* Check whether a song is ready and can be taken, called by the audio thread
+		*
+		* @param slot the slot of the song
+		* @return true if take would return a song
+		*/
+    bool isReady(Slot slot) const;
+    /**
+		* Take a loaded song out of its slot, called by the audio thread
+		*
+		* @param slot the slot of the song
+		* @return the song, nullptr if none is ready. The caller owns it.
+		*/
+    LoadedSong* take(Slot slot);
+    /**
+		* Hand a replaced song back for deletion, called by the audio thread without blocking
+		*
+		* @param song the song which is not played any more
+		* @param successor the song which is played now
+		* @param seek the seek of the renderer which switched to the successor
+		* @return false if the ring is full, the song is not taken then
+		*/
+    bool retire(LoadedSong* song, LoadedSong const* successor, uint32_t seek);
+    /**
+		* Get the name of the song which is played now
+		*
+		* @return the name of the song (filename)
+		*/
+    String getPlayingName();
+
+private:
+    /**
+		* @struct RetiredSong
+		* @brief A replaced song which waits for its deletion
+		*/
+    struct RetiredSong
+    {
+        LoadedSong* song; ///<the replaced song
+        LoadedSong const* successor; ///<the song played instead
+        uint32_t seek; ///<the song is deleted when the renderer reached this seek
+    };
+
+    /**
+		* Loop of the background thread
+		*/
+    void run();
+    /**
+		* Put a loaded song into a slot, a song which was not taken yet is deleted
+		*
+		* @param slot the slot of the song
+		* @param song the loaded song
+		*/
+    void publish(Slot slot, LoadedSong* song);
+    /**
+		* Delete the replaced songs which are not used by the renderer any more
+		*/
+    void reclaim();
+
+    double samplerate = 44100; ///<samplerate of host
+    LookaheadRenderer const* renderer = nullptr; ///<the renderer which plays the schedules
+    std::atomic<LoadedSong*> slots[SLOT_COUNT]; ///<loaded songs, waiting for the audio thread
+
+    juce::AbstractFifo retireFifo; ///<indices of the lock-free ring of replaced songs
+    std::vector<RetiredSong> retireRing; ///<replaced songs, written by the audio thread
+    std::vector<RetiredSong> retired; ///<replaced songs taken out of the ring, only used by the background thread
+
+    std::mutex requestMutex; ///<protects the requests, the setlist and the name of the playing song
+    std::deque<std::string> requests; ///<songs to load for the next bar
+    std::vector<std::string> setlist; ///<songs played one after another
+    size_t setlistPosition = 0; ///<next song of the setlist to preload
+    String playingName; ///<the name of the song which is played now
+
+    std::thread loaderThread; ///<the background thread
+    std::atomic<bool> stopLoader; ///<is set to true, when the background thread shall end
+    std::condition_variable wakeUp; ///<wakes the background thread when there is a request
+};
+}
+#endif
@@ -0,0 +1,102 @@
+#include "Transport.h"
+
+#include <algorithm>
+#include <cmath>
+
+using namespace ttmm;
+
+const double Transport::MIN_RATE = 0.25;
+const double Transport::MAX_RATE = 4.0;
+
+namespace
+{
+//the first song sample at or after a fixed point position, rounds towards +infinity for negative positions too
+int64_t firstSampleAt(int64_t position)
+{
+    int64_t one = int64_t(1) << PlaybackBlock::FRACTION_BITS;
+    int64_t sample = position / one;
+    return (position % one > 0) ? sample + 1 : sample;
+}
+}
+
+bool PlaybackBlock::contains(int64_t sample) const
+{
+    return (sample >= this->firstSample) && (sample < this->endSample);
+}
+
+int PlaybackBlock::toSamplePosition(int64_t sample) const
+{
+    return this->offset + static_cast<int>((sample * (int64_t(1) << FRACTION_BITS) - this->startPosition) / this->rate);
+}
+
+PlaybackBlock PlaybackBlock::atOriginalTempo(int64_t firstSample, int numSamples)
+{
+    PlaybackBlock block;
+    block.rate = 1 << FRACTION_BITS;
+    block.numSamples = numSamples;
+    block.offset = 0;
+    block.firstSample = firstSample;
+    block.endSample = firstSample + numSamples;
+    block.startPosition = firstSample * block.rate;
+    block.endPosition = block.endSample * block.rate;
+    return block;
+}
+
+Transport::Transport()
+    : rate(RATE_ONE)
+{
+}
+
+void Transport::prepare(double samplerate, double startSeconds)
+{
+    this->samplerate = samplerate;
+    this->position = static_cast<int64_t>(std::floor(startSeconds * samplerate + 0.5)) * RATE_ONE;
+}
+
+PlaybackBlock Transport::nextBlock(int numSamples, int offset, int64_t endSample)
+{
+    //read the rate once, the whole block is played with it
+    PlaybackBlock block;
+    block.rate = this->rate.load();
+    if (endSample < INT64_MAX / RATE_ONE)
+    {
+        //samples of the host until endSample, rounded up
+        int64_t remaining = endSample * RATE_ONE - this->position;
+        int64_t maxSamples = (remaining + block.rate - 1) / block.rate;
+        numSamples = int(std::max(int64_t(0), std::min(int64_t(numSamples), maxSamples)));
+    }
+    block.numSamples = numSamples;
+    block.offset = offset;
+    block.startPosition = this->position;
+    block.endPosition = this->position + int64_t(numSamples) * block.rate;
+    block.firstSample = firstSampleAt(block.startPosition);
+    block.endSample = firstSampleAt(block.endPosition);
+    this->position = block.endPosition;
+    return block;
+}
+
+void Transport::seek(int64_t sample)
+{
+    this->position = sample * RATE_ONE;
+}
+
+void Transport::setRate(double rate)
+{
+    rate = std::min(std::max(rate, MIN_RATE), MAX_RATE);
+    this->rate.store(static_cast<int>(rate * RATE_ONE + 0.5));
+}
+
+double Transport::getRate() const
+{
+    return double(this->rate.load()) / RATE_ONE;
+}
+
+double Transport::getPositionInSeconds() const
+{
+    return double(this->position) / RATE_ONE / this->samplerate;
+}
+
+int64_t Transport::getPositionInSamples() const
+{
+    return firstSampleAt(this->position);
+}
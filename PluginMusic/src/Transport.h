@@ -0,0 +1,134 @@
+/**
+* @file Transport.cpp
+* @author FH-Minden Musikinformatik 2015, Musicgroup (Marcel, Patrick, Scott)
+* @brief Playback position of the song as a sample counter
+*
+*/
+#ifndef TTMM_TRANSPORT_H
+#define TTMM_TRANSPORT_H
+
+#include <atomic>
+#include <cstdint>
+
+namespace ttmm
+{
+/**
+	* @struct PlaybackBlock
+	* @brief The part of the song which is played in one processBlock.
+	*		  The song is measured in samples at its original tempo (song samples); the rate of the transport
+	*		  decides how many song samples are played in a block. Positions are kept as 48.16 fixed point numbers,
+	*		  so membership and sample positions are exact integer arithmetic.
+	*
+	* @see Transport, MidiHandler
+	*/
+struct PlaybackBlock
+{
+    static const int FRACTION_BITS = 16; ///<number of fractional bits of the positions and the rate
+
+    int64_t startPosition; ///<position of the first sample of the block in 1/2^16 song samples
+    int64_t endPosition; ///<position after the last sample of the block in 1/2^16 song samples
+    int64_t firstSample; ///<first song sample played in this block
+    int64_t endSample; ///<first song sample played after this block
+    int32_t rate; ///<song samples per sample of the host in 16.16 fixed point
+    int numSamples; ///<number of samples of the host in this block
+    int offset; ///<sample position of the first sample of the block inside the MidiBuffer
+
+    /**
+		* Check whether a song sample is played in this block
+		*
+		* @param sample a position in song samples
+		* @return true if firstSample <= sample < endSample
+		*/
+    bool contains(int64_t sample) const;
+    /**
+		* Convert a song sample in this block to the sample position inside the MidiBuffer
+		*
+		* @param sample a position in song samples, has to be contained in the block
+		* @return a sample position between offset and offset + numSamples - 1
+		*/
+    int toSamplePosition(int64_t sample) const;
+    /**
+		* Create a block which plays song samples at the original tempo of the song
+		*
+		* @param firstSample first song sample of the block
+		* @param numSamples number of song samples of the block
+		* @return a block with rate 1.0
+		*/
+    static PlaybackBlock atOriginalTempo(int64_t firstSample, int numSamples);
+};
+
+/**
+	* @class Transport
+	* @brief Advances the playback position as an integer sample counter, block by block.
+	*		  The schedule of the song is precomputed in samples at its original tempo; a rate factor
+	*		  scales the playback. The rate can be changed from any thread, it is read once per block,
+	*		  so a change takes effect with the next block and the song itself is never touched.
+	*
+	* @see PlaybackSchedule, PlaybackBlock, DynamicComposition
+	*/
+class Transport
+{
+public:
+    /**
+		* Constructor: create a Transport with the original tempo of the song
+		*/
+    Transport();
+    /**
+		* Reset the transport to a position
+		*
+		* @param samplerate samplerate of host
+		* @param startSeconds position in seconds the playback starts at (negative for a count-in)
+		*/
+    void prepare(double samplerate, double startSeconds);
+    /**
+		* Get the part of the song played in the next block and advance the position
+		*
+		* @param numSamples buffersize
+		* @param offset sample position of the block inside the MidiBuffer, if a buffer is played in parts
+		* @param endSample the block is shortened so it ends at this song sample at the latest (e.g. the end of a loop)
+		* @return the song samples of the block and how to convert them to sample positions
+		*/
+    PlaybackBlock nextBlock(int numSamples, int offset = 0, int64_t endSample = INT64_MAX);
+    /**
+		* Jump to a position, the next block starts there. Only called by the audio thread.
+		*
+		* @param sample the position in song samples
+		*/
+    void seek(int64_t sample);
+    /**
+		* Change the playback rate, thread safe
+		*
+		* @param rate 1.0 is the tempo of the song, limited to MIN_RATE..MAX_RATE
+		*/
+    void setRate(double rate);
+    /**
+		* Get the playback rate
+		*
+		* @return 1.0 is the tempo of the song
+		*/
+    double getRate() const;
+    /**
+		* Get the current position at the original tempo of the song
+		*
+		* @return the position in seconds
+		*/
+    double getPositionInSeconds() const;
+    /**
+		* Get the first song sample of the next block
+		*
+		* @return the position in song samples
+		*/
+    int64_t getPositionInSamples() const;
+
+    static const double MIN_RATE; ///<slowest playback, a quarter of the tempo
+    static const double MAX_RATE; ///<fastest playback, four times the tempo
+
+private:
+    static const int RATE_ONE = 1 << PlaybackBlock::FRACTION_BITS; ///<fixed point representation of the rate 1.0
+
+    double samplerate = 44100; ///<samplerate of host
+    int64_t position = 0; ///<the start of the next block in 1/2^16 song samples
+    std::atomic<int> rate; ///<playback rate in 16.16 fixed point, written by the GUI, read by the audio thread
+};
+}
+#endif
@@ -0,0 +1,545 @@
+#include "VariationEngine.h"
+#include "MidiHandler.h"
+#include "FileWriter.h"
+#include "TimeTools.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <limits>
+
+using namespace ttmm;
+
+//rows: the figure of the previous bar, columns: the figure of the next bar (HOLD, PULSE, BROKEN, ALBERTI, FILL)
+const double VariationEngine::TRANSITIONS[FIGURE_COUNT][FIGURE_COUNT] = {
+    { 4.0, 3.0, 2.0, 1.0, 1.0 },
+    { 2.0, 4.0, 2.0, 2.0, 1.0 },
+    { 1.0, 2.0, 4.0, 2.0, 1.0 },
+    { 1.0, 2.0, 2.0, 4.0, 1.0 },
+    { 3.0, 2.0, 2.0, 2.0, 0.0 }
+};
+
+const double VariationEngine::DENSITY[FIGURE_COUNT] = { 0.0, 0.4, 0.7, 0.8, 1.0 };
+
+namespace
+{
+const int MAX_BEATS = 16; ///<beats of a bar which get their own notes
+const int LOWEST_NODE = 36; ///<lowest node of a voiced chord
+const int HIGHEST_NODE = 96; ///<highest node of a voiced chord
+const double PULSE_LENGTH = 0.5; ///<part of the beat a chord of PULSE sounds
+const double OFFBEAT_WEIGHT = 0.7; ///<velocity of a note between the beats, relative to the first beat
+const double BEAT_WEIGHT = 0.85; ///<velocity of a note on the other beats, relative to the first beat
+}
+
+VariationEngine::VariationEngine()
+    : random(2015)
+    , local(LOCAL_BARS)
+    , lateBars(0)
+    , fifo(RING_BARS)
+    , ring(RING_BARS)
+    , renderedBar(0)
+    , accuracy(0)
+    , enabled(false)
+    , stopGenerator(true)
+{
+}
+
+VariationEngine::~VariationEngine()
+{
+    this->stop();
+}
+
+void VariationEngine::start(PlaybackSchedule const& schedule, int64_t startSample, IPCSongInfo_IPCMusician const& musician)
+{
+    this->stop();
+    this->requestSchedule = &schedule;
+    this->requestSample = startSample;
+    this->requestMusician = musician;
+    this->requestCount++;
+    this->adoptRequest();
+    this->playing = &schedule;
+    this->renderRestart = this->requestCount;
+    this->fifo.reset();
+    this->localHead = 0;
+    this->localCount = 0;
+    this->soundingNotes.reset();
+    this->pendingOffs.reset();
+    this->lateBar = -1;
+    this->lateBars.store(0);
+    this->accuracy.store(musician.accuracy());
+    this->renderedBar.store(this->nextBar);
+    //generate the first bars before the renderer fills its ring
+    while (this->generateNext())
+    {
+    }
+    this->stopGenerator.store(false);
+    this->generateThread = std::thread(&VariationEngine::run, this);
+    if (!this->generateThread.joinable())
+    {
+        ttmm::logger.write("Failed to start the VariationEngine thread");
+    }
+}
+
+void VariationEngine::stop()
+{
+    {
+        std::lock_guard<std::mutex> lock(this->requestMutex);
+        this->stopGenerator.store(true);
+    }
+    this->wakeUp.notify_one();
+    this->adopted.notify_all();
+    if (this->generateThread.joinable())
+    {
+        this->generateThread.join();
+    }
+}
+
+void VariationEngine::restart(PlaybackSchedule const& schedule, int64_t sample, IPCSongInfo_IPCMusician const& musician)
+{
+    //the generated notes played before the position and sounding at it are ended there
+    this->pendingOffs.reset();
+    for (int i = 0; i < this->localCount; i++)
+    {
+        VariationBar const& bar = this->local[(this->localHead + i) % LOCAL_BARS];
+        if (sample < bar.start || sample >= bar.end)
+        {
+            continue;
+        }
+        for (int n = 0; n < bar.count; n++)
+        {
+            VariationBar::Note const& note = bar.notes[n];
+            if (note.on < sample && sample < note.off && this->soundingNotes[note.nodeNumber])
+            {
+                this->pendingOffs.set(note.nodeNumber);
+            }
+        }
+    }
+    //the notes turned on after the position are rendered again
+    this->soundingNotes = this->pendingOffs;
+    this->localHead = 0;
+    this->localCount = 0;
+    this->playing = &schedule;
+    int64_t start, end;
+    this->renderedBar.store(std::max(int64_t(0), findBar(schedule, sample, start, end)));
+    std::unique_lock<std::mutex> lock(this->requestMutex);
+    this->requestSchedule = &schedule;
+    this->requestSample = sample;
+    this->requestMusician = musician;
+    this->renderRestart = ++this->requestCount;
+    this->wakeUp.notify_one();
+    //the bars of the old position are dropped by takeBar, wait until the background thread left the old schedule
+    this->adopted.wait(lock, [this]() { return this->adoptedCount == this->requestCount || this->stopGenerator.load(); });
+}
+
+void VariationEngine::render(PlaybackBlock const& block, juce::MidiBuffer& midiBuffer)
+{
+    if (this->playing == nullptr)
+    {
+        return;
+    }
+    bool play = this->enabled.load();
+    std::bitset<128> offs = play ? this->pendingOffs : (this->pendingOffs | this->soundingNotes);
+    this->pendingOffs.reset();
+    for (size_t i = 0; offs.any() && i < offs.size(); i++)
+    {
+        if (offs[i])
+        {
+            juce::MidiMessage m = juce::MidiMessage::noteOff(CHANNEL, int(i), (uint8)0);
+            m.setTimeStamp(double(block.firstSample));
+            midiBuffer.addEvent(m, block.toSamplePosition(block.firstSample));
+            this->soundingNotes.reset(i);
+            offs.reset(i);
+        }
+    }
+    int64_t start, end;
+    int64_t bar = findBar(*this->playing, std::max(block.firstSample, int64_t(0)), start, end);
+    if (bar < 0)
+    {
+        //nothing is generated for the count-in
+        return;
+    }
+    this->renderedBar.store(bar);
+    this->wakeUp.notify_one();
+    if (start == block.firstSample && bar > 0)
+    {
+        //the offs of a bar end at the start of the next one, a block starting there plays those of the previous bar
+        bar--;
+        getBarRange(*this->playing, bar, start, end);
+    }
+    for (; start < block.endSample; bar++, getBarRange(*this->playing, bar, start, end))
+    {
+        VariationBar const* generated = this->takeBar(bar);
+        if (generated == nullptr)
+        {
+            //the previous bar is missing after a restart at its end, it has nothing left to play
+            if (end > block.firstSample && bar != this->lateBar)
+            {
+                this->lateBar = bar;
+                this->lateBars++;
+            }
+            continue;
+        }
+        for (int n = 0; play && n < generated->count; n++)
+        {
+            VariationBar::Note const& note = generated->notes[n];
+            if (block.contains(note.on))
+            {
+                juce::MidiMessage m = juce::MidiMessage::noteOn(CHANNEL, note.nodeNumber, (uint8)note.velocity);
+                m.setTimeStamp(double(note.on));
+                midiBuffer.addEvent(m, block.toSamplePosition(note.on));
+                this->soundingNotes.set(note.nodeNumber);
+            }
+            if (block.contains(note.off) && this->soundingNotes[note.nodeNumber])
+            {
+                juce::MidiMessage m = juce::MidiMessage::noteOff(CHANNEL, note.nodeNumber, (uint8)0);
+                m.setTimeStamp(double(note.off));
+                midiBuffer.addEvent(m, block.toSamplePosition(note.off));
+                this->soundingNotes.reset(note.nodeNumber);
+            }
+        }
+    }
+}
+
+void VariationEngine::setEnabled(bool enabled)
+{
+    this->enabled.store(enabled);
+}
+
+bool VariationEngine::isEnabled() const
+{
+    return this->enabled.load();
+}
+
+void VariationEngine::setAccuracy(int accuracy)
+{
+    this->accuracy.store(accuracy);
+}
+
+int VariationEngine::getLateBars() const
+{
+    return this->lateBars.load();
+}
+
+void VariationEngine::run()
+{
+    while (!this->stopGenerator.load())
+    {
+        {
+            std::lock_guard<std::mutex> lock(this->requestMutex);
+            if (this->requestCount != this->adoptedCount)
+            {
+                this->adoptRequest();
+                this->adopted.notify_all();
+            }
+        }
+        if (!this->generateNext())
+        {
+            //the lookahead is full, wait until the renderer moved on or restarted
+            std::unique_lock<std::mutex> lock(this->requestMutex);
+            if (this->requestCount == this->adoptedCount && !this->stopGenerator.load())
+            {
+                this->wakeUp.wait_for(lock, std::chrono::milliseconds(2));
+            }
+        }
+    }
+}
+
+void VariationEngine::adoptRequest()
+{
+    this->schedule = this->requestSchedule;
+    this->generatedRestart = this->requestCount;
+    this->adoptedCount = this->requestCount;
+    MidiHandler::toStrokeType(this->requestMusician.tune(), this->strokeType);
+    this->velocity = std::max(0, std::min(int(this->requestMusician.volumech2()), 127));
+    //the Markov chain continues with the figure and the voicing generated last
+    int64_t start, end;
+    this->nextBar = std::max(int64_t(0), findBar(*this->schedule, this->requestSample, start, end));
+}
+
+bool VariationEngine::generateNext()
+{
+    if (this->schedule == nullptr || this->schedule->getBarCount() == 0 || this->schedule->getLength() <= 0
+        || this->nextBar > this->renderedBar.load() + LOOKAHEAD_BARS || this->fifo.getFreeSpace() == 0)
+    {
+        return false;
+    }
+    int start1, size1, start2, size2;
+    this->fifo.prepareToWrite(1, start1, size1, start2, size2);
+    this->generateBar(this->nextBar, this->ring[size1 > 0 ? start1 : start2]);
+    this->fifo.finishedWrite(1);
+    this->nextBar++;
+    return true;
+}
+
+void VariationEngine::generateBar(int64_t bar, VariationBar& result)
+{
+    TIMED_BLOCK("VariationEngine::generateBar")
+    PlaybackSchedule const& schedule = *this->schedule;
+    int inSong = int(bar % schedule.getBarCount());
+    int64_t offset = (bar / schedule.getBarCount()) * schedule.getLength();
+    result.bar = bar;
+    result.restart = this->generatedRestart;
+    result.count = 0;
+    getBarRange(schedule, bar, result.start, result.end);
+    //the beats of the bar and their chords, a bar without beats stays silent
+    int64_t beats[MAX_BEATS + 1];
+    int beatIndex[MAX_BEATS];
+    int beatCount = 0;
+    auto const& allBeats = schedule.getBeats();
+    for (int beat = allBeats.empty() ? 0 : schedule.getBeatAt(result.start - offset);
+        beat < int(allBeats.size()) && allBeats[beat] + offset < result.end && beatCount < MAX_BEATS; beat++)
+    {
+        if (allBeats[beat] + offset >= result.start)
+        {
+            beatIndex[beatCount] = beat;
+            beats[beatCount++] = allBeats[beat] + offset;
+        }
+    }
+    //the figure starts with the first beat a chord sounds at
+    int tones[MAX_VOICES];
+    int toneCount = 0;
+    int firstBeat = 0;
+    for (; firstBeat < beatCount; firstBeat++)
+    {
+        toneCount = this->findChord(beatIndex[firstBeat], tones);
+        if (toneCount > 0)
+        {
+            break;
+        }
+    }
+    beats[beatCount] = result.end;
+    double energy = 1.0 / (1.0 + std::exp(-double(this->accuracy.load()) / ACCURACY_SCALE));
+    bool phraseEnd = (inSong % PHRASE_BARS == PHRASE_BARS - 1) || (inSong == schedule.getBarCount() - 1);
+    this->figure = this->chooseFigure(this->figure, energy, phraseEnd);
+    result.figure = this->figure;
+    if (toneCount == 0 || this->velocity == 0)
+    {
+        return;
+    }
+    int voiced[MAX_VOICES];
+    this->voiceChord(tones, toneCount, voiced);
+    std::copy(voiced, voiced + toneCount, this->voicing);
+    this->voiceCount = toneCount;
+
+    double loudness = this->velocity * (0.8 + 0.2 * energy);
+    auto add = [&](int64_t on, int64_t off, int nodeNumber, double weight)
+    {
+        off = std::min(off, result.end);
+        if (result.count == VariationBar::MAX_NOTES || off <= on || nodeNumber < 0 || nodeNumber > 127)
+        {
+            return;
+        }
+        VariationBar::Note& note = result.notes[result.count++];
+        note.on = on;
+        note.off = off;
+        note.nodeNumber = uint8_t(nodeNumber);
+        note.velocity = uint8_t(std::max(1, std::min(int(loudness * weight + 0.5), 127)));
+    };
+    auto beatWeight = [](int beat) { return (beat == 0) ? 1.0 : BEAT_WEIGHT; };
+    int last = beatCount - 1;
+    switch (this->figure)
+    {
+    case HOLD:
+        for (int v = 0; v < toneCount; v++)
+        {
+            add(beats[firstBeat], result.end, voiced[v], beatWeight(firstBeat));
+        }
+        break;
+    case PULSE:
+        for (int beat = firstBeat; beat < beatCount; beat++)
+        {
+            int64_t length = int64_t((beats[beat + 1] - beats[beat]) * PULSE_LENGTH);
+            for (int v = 0; v < toneCount; v++)
+            {
+                add(beats[beat], beats[beat] + length, voiced[v], beatWeight(beat));
+            }
+        }
+        break;
+    case BROKEN:
+    case ALBERTI:
+    {
+        //two notes per beat, each sounds until the next one; -1 is the highest tone of the chord
+        static const int ALBERTI_ORDER[4] = { 0, -1, 1, -1 };
+        int step = 0;
+        for (int beat = firstBeat; beat < beatCount; beat++)
+        {
+            int64_t half = (beats[beat + 1] - beats[beat]) / 2;
+            for (int h = 0; h < 2; h++, step++)
+            {
+                int voice = step % toneCount;
+                if (this->figure == ALBERTI)
+                {
+                    voice = (ALBERTI_ORDER[step % 4] < 0) ? toneCount - 1 : std::min(ALBERTI_ORDER[step % 4], toneCount - 1);
+                }
+                int64_t on = beats[beat] + h * half;
+                add(on, on + half, voiced[voice], (h == 0) ? beatWeight(beat) : OFFBEAT_WEIGHT);
+            }
+        }
+        break;
+    }
+    case FILL:
+    {
+        //the chord until the last beat, then four notes running up through the chord
+        if (last > firstBeat)
+        {
+            for (int v = 0; v < toneCount; v++)
+            {
+                add(beats[firstBeat], beats[last], voiced[v], beatWeight(firstBeat));
+            }
+        }
+        int64_t quarter = (beats[last + 1] - beats[last]) / 4;
+        for (int i = 0; i < 4; i++)
+        {
+            int64_t on = beats[last] + i * quarter;
+            add(on, on + quarter, voiced[i % toneCount] + 12 * (i / toneCount), (i == 0) ? beatWeight(last) : OFFBEAT_WEIGHT);
+        }
+        break;
+    }
+    default:
+        break;
+    }
+}
+
+int VariationEngine::findChord(int beat, int tones[MAX_VOICES])
+{
+    //the chords are kept in memory, also for a streamed schedule, so no page is read ahead of the renderer
+    PlaybackChord const& chord = this->schedule->getChords()[beat];
+    int count = 0;
+    for (int i = 0; i < chord.count; i++)
+    {
+        int transposed = Stroke::transpose(chord.tones[i], chord.terz, this->strokeType);
+        if (std::find(tones, tones + count, transposed) == tones + count)
+        {
+            tones[count++] = transposed;
+        }
+    }
+    std::sort(tones, tones + count);
+    return count;
+}
+
+VariationEngine::Figure VariationEngine::chooseFigure(Figure previous, double energy, bool phraseEnd)
+{
+    //an accurate musician gets the busy figures, an inaccurate one the calm figures
+    double weights[FIGURE_COUNT];
+    for (int next = 0; next < FIGURE_COUNT; next++)
+    {
+        weights[next] = TRANSITIONS[previous][next] * (1.0 + 2.0 * energy * DENSITY[next])
+            * (1.0 + 2.0 * (1.0 - energy) * (1.0 - DENSITY[next]));
+    }
+    weights[FILL] *= phraseEnd ? 4.0 : 0.1;
+    std::discrete_distribution<int> distribution(weights, weights + FIGURE_COUNT);
+    return Figure(distribution(this->random));
+}
+
+void VariationEngine::voiceChord(int const tones[MAX_VOICES], int count, int voicing[MAX_VOICES])
+{
+    std::copy(tones, tones + count, voicing);
+    if (this->voiceCount == 0)
+    {
+        return;
+    }
+    //try every inversion in every octave, the sum of the steps of the voices is the cost
+    std::uniform_real_distribution<double> jitter(0.0, 2.0);
+    double best = std::numeric_limits<double>::max();
+    for (int inversion = 0; inversion < count; inversion++)
+    {
+        int candidate[MAX_VOICES];
+        candidate[0] = tones[inversion];
+        for (int i = 1; i < count; i++)
+        {
+            int nodeNumber = tones[(inversion + i) % count];
+            while (nodeNumber <= candidate[i - 1])
+            {
+                nodeNumber += 12;
+            }
+            while (nodeNumber - 12 > candidate[i - 1])
+            {
+                nodeNumber -= 12;
+            }
+            candidate[i] = nodeNumber;
+        }
+        for (int shift = -24; shift <= 24; shift += 12)
+        {
+            if (candidate[0] + shift < LOWEST_NODE || candidate[count - 1] + shift > HIGHEST_NODE)
+            {
+                continue;
+            }
+            double cost = jitter(this->random);
+            for (int i = 0; i < count; i++)
+            {
+                int step = std::numeric_limits<int>::max();
+                for (int j = 0; j < this->voiceCount; j++)
+                {
+                    step = std::min(step, std::abs(candidate[i] + shift - this->voicing[j]));
+                }
+                cost += step;
+            }
+            if (cost < best)
+            {
+                best = cost;
+                for (int i = 0; i < count; i++)
+                {
+                    voicing[i] = candidate[i] + shift;
+                }
+            }
+        }
+    }
+}
+
+int64_t VariationEngine::findBar(PlaybackSchedule const& schedule, int64_t sample, int64_t& start, int64_t& end)
+{
+    int64_t length = schedule.getLength();
+    if (sample < 0 || length <= 0 || schedule.getBarCount() == 0)
+    {
+        return -1;
+    }
+    int64_t bar = (sample / length) * schedule.getBarCount() + schedule.getBarAt(sample % length);
+    getBarRange(schedule, bar, start, end);
+    return bar;
+}
+
+void VariationEngine::getBarRange(PlaybackSchedule const& schedule, int64_t bar, int64_t& start, int64_t& end)
+{
+    int inSong = int(bar % schedule.getBarCount());
+    int64_t offset = (bar / schedule.getBarCount()) * schedule.getLength();
+    start = offset + schedule.getBarStart(inSong);
+    end = offset + schedule.getBarEnd(inSong);
+}
+
+VariationBar const* VariationEngine::takeBar(int64_t bar)
+{
+    for (int i = 0; i < this->localCount; i++)
+    {
+        VariationBar const& kept = this->local[(this->localHead + i) % LOCAL_BARS];
+        if (kept.bar == bar)
+        {
+            return &kept;
+        }
+    }
+    while (this->fifo.getNumReady() > 0)
+    {
+        int start1, size1, start2, size2;
+        this->fifo.prepareToRead(1, start1, size1, start2, size2);
+        VariationBar const& next = this->ring[size1 > 0 ? start1 : start2];
+        //bars of an earlier restart or of bars already played are dropped
+        VariationBar* kept = nullptr;
+        if (next.restart == this->renderRestart && next.bar >= bar)
+        {
+            if (this->localCount == LOCAL_BARS)
+            {
+                this->localHead = (this->localHead + 1) % LOCAL_BARS;
+                this->localCount--;
+            }
+            kept = &this->local[(this->localHead + this->localCount) % LOCAL_BARS];
+            *kept = next;
+            this->localCount++;
+        }
+        this->fifo.finishedRead(1);
+        this->wakeUp.notify_one();
+        if (kept != nullptr)
+        {
+            return (kept->bar == bar) ? kept : nullptr;
+        }
+    }
+    return nullptr;
+}
@@ -0,0 +1,275 @@
+/**
+* @file VariationEngine.cpp
+* @author FH-Minden Musikinformatik 2015, Musicgroup (Marcel, Patrick, Scott)
+* @brief Generates the accompaniment of the next bars from the musician state on a background thread
+*
+*/
+#ifndef TTMM_VARIATION_ENGINE_H
+#define TTMM_VARIATION_ENGINE_H
+
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <vector>
+#include <bitset>
+#include <random>
+#include <cstdint>
+
+#include "PlaybackSchedule.h"
+#include "Transport.h"
+#include "../../TTMM/JuceLibraryCode/JuceHeader.h"
+#include "DataExchange.pb.h"
+
+namespace ttmm
+{
+/**
+	* @struct VariationBar
+	* @brief The generated accompaniment of one bar, all notes start and end inside the bar
+	*/
+struct VariationBar
+{
+    static const int MAX_NOTES = 64; ///<notes of a bar, further notes are not generated
+
+    /**
+		* @struct Note
+		* @brief A generated note with its position in song samples
+		*/
+    struct Note
+    {
+        int64_t on; ///<song sample of the note on, including the repetition
+        int64_t off; ///<song sample of the note off, at most the end of the bar
+        uint8_t nodeNumber; ///<a node number value (0-127)
+        uint8_t velocity; ///<a velocity of a note (1-127)
+    };
+
+    int64_t bar; ///<index of the bar, counted over the repetitions of the song
+    int64_t start; ///<song sample of the start of the bar, including the repetition
+    int64_t end; ///<song sample of the start of the next bar
+    uint32_t restart; ///<the restart the bar was generated for
+    int32_t figure; ///<the figure chosen for the bar
+    int32_t count; ///<number of notes
+    Note notes[MAX_NOTES]; ///<notes sorted by their on
+};
+
+/**
+	* @class VariationEngine
+	* @brief Generates the accompaniment of the next LOOKAHEAD_BARS bars on a background thread and plays it on
+	*		  channel CHANNEL. For each bar a figure (held chord, pulse, broken chord, Alberti bass or a fill at the
+	*		  end of a phrase) is chosen by a Markov chain over the figures of the previous bars. The accuracy of the
+	*		  musician shifts the chain towards denser figures, the tune selects the StrokeType of the chord like for
+	*		  the other channels and the volume of the first accompaniment sets the velocity. The inversion of the
+	*		  chord is chosen to move the voices as little as possible from the previous bar.
+	*		  The bars are published through a lock-free ring, the background thread of the LookaheadRenderer takes
+	*		  them while it renders its windows, so generating never costs time of the audio thread.
+	*		  Changes of the accuracy take effect for the bars generated next, a change of tune or volume restarts
+	*		  the generation at the window the renderer renders again.
+	*
+	* @see LookaheadRenderer, PlaybackSchedule
+	*/
+class VariationEngine
+{
+public:
+    static const int CHANNEL = 6; ///<midi channel of the generated accompaniment
+    static const int LOOKAHEAD_BARS = 2; ///<bars generated ahead of the bar the renderer renders
+    static const int RING_BARS = 8; ///<number of bars in the ring
+    static const int LOCAL_BARS = 4; ///<bars kept by the renderer after taking them out of the ring
+    static const int PHRASE_BARS = 4; ///<a fill is likely in the last bar of a phrase
+    static const int ACCURACY_SCALE = 10; ///<width of the logistic curve which maps the accuracy to 0..1
+
+    /**
+		* Constructor: create a stopped VariationEngine without variation
+		*/
+    VariationEngine();
+    /**
+		* Destructor: stop the background thread
+		*/
+    ~VariationEngine();
+    /**
+		* Generate the first bars and start the background thread, a running thread is stopped before
+		*
+		* @param schedule the events to play, must not change until stop or restart is called
+		* @param startSample the song sample the playback starts at
+		* @param musician the musician state the first bars are generated with
+		*/
+    void start(PlaybackSchedule const& schedule, int64_t startSample, IPCSongInfo_IPCMusician const& musician);
+    /**
+		* Stop the background thread
+		*/
+    void stop();
+    /**
+		* Generate again from a position, called by the thread which renders. Returns when the background thread
+		* does not use the schedule given before any more. The notes which were played and would sound at the
+		* position end there with the next call of render.
+		*
+		* @param schedule the events to play, must not change until the next stop or restart
+		* @param sample the song sample the rendering continues at
+		* @param musician the musician state the bars are generated with
+		*/
+    void restart(PlaybackSchedule const& schedule, int64_t sample, IPCSongInfo_IPCMusician const& musician);
+    /**
+		* Add the generated notes of a block of song samples to a MidiBuffer, called by the thread which renders.
+		* Never waits, the notes of bars which were not generated in time are skipped.
+		*
+		* @param block the song samples of the block, the blocks have to follow each other
+		* @param midiBuffer a reference to the MidiBuffer of the block
+		*/
+    void render(PlaybackBlock const& block, juce::MidiBuffer& midiBuffer);
+    /**
+		* Turn the generated accompaniment on or off, can be called from any thread
+		*
+		* @param enabled true to play the generated accompaniment
+		*/
+    void setEnabled(bool enabled);
+    /**
+		* Check whether the generated accompaniment is played
+		*
+		* @return true if it is played
+		*/
+    bool isEnabled() const;
+    /**
+		* Update the accuracy of the musician, called by the audio thread. It is used for the bars generated next.
+		*
+		* @param accuracy the accuracy of the merged musician state
+		*/
+    void setAccuracy(int accuracy);
+    /**
+		* Get the number of bars which were not generated in time
+		*
+		* @return the number of bars since start, whose notes were skipped
+		*/
+    int getLateBars() const;
+
+private:
+    /**
+		* The figures the accompaniment of a bar is made of
+		*/
+    enum Figure
+    {
+        HOLD, ///<the chord is held for the whole bar
+        PULSE, ///<the chord is struck short on every beat
+        BROKEN, ///<the tones of the chord one after another, two per beat
+        ALBERTI, ///<lowest, highest, middle, highest tone, two per beat
+        FILL, ///<the chord is held until the last beat, which runs up through the chord
+        FIGURE_COUNT ///<number of figures
+    };
+
+    static const int MAX_VOICES = PlaybackChord::MAX_TONES; ///<most tones of a chord
+    static const double TRANSITIONS[FIGURE_COUNT][FIGURE_COUNT]; ///<weights of the next figure for each figure
+    static const double DENSITY[FIGURE_COUNT]; ///<how busy a figure sounds, between 0 and 1
+
+    /**
+		* Loop of the background thread, generates bars until the lookahead is full
+		*/
+    void run();
+    /**
+		* Take over the position and musician state of the last restart, the caller holds requestMutex
+		*/
+    void adoptRequest();
+    /**
+		* Generate the next bar into the ring
+		*
+		* @return false if the ring or the lookahead is full
+		*/
+    bool generateNext();
+    /**
+		* Generate the accompaniment of a bar
+		*
+		* @param bar index of the bar, counted over the repetitions of the song
+		* @param result the bar to fill
+		*/
+    void generateBar(int64_t bar, VariationBar& result);
+    /**
+		* Get the tones of the chord sounding at a beat, transposed to the StrokeType of the tune
+		*
+		* @param beat index of the beat in PlaybackSchedule::getBeats
+		* @param tones is filled with the node numbers of the chord, lowest first
+		* @return the number of tones, 0 if no chord sounds
+		*/
+    int findChord(int beat, int tones[MAX_VOICES]);
+    /**
+		* Choose the next figure with the Markov chain
+		*
+		* @param previous the figure of the previous bar
+		* @param energy the accuracy of the musician mapped to 0..1
+		* @param phraseEnd true for the last bar of a phrase
+		* @return the figure of the bar
+		*/
+    Figure chooseFigure(Figure previous, double energy, bool phraseEnd);
+    /**
+		* Choose the inversion and octave of a chord which is closest to the previous voicing
+		*
+		* @param tones the tones of the chord
+		* @param count number of tones
+		* @param voicing is set to the voiced chord, lowest tone first
+		*/
+    void voiceChord(int const tones[MAX_VOICES], int count, int voicing[MAX_VOICES]);
+    /**
+		* Find the bar of a song sample
+		*
+		* @param schedule the schedule of the song
+		* @param sample a song sample, including the repetition
+		* @param start is set to the start of the bar, including the repetition
+		* @param end is set to the start of the next bar, including the repetition
+		* @return index of the bar counted over the repetitions, -1 before the song starts or for an empty song
+		*/
+    static int64_t findBar(PlaybackSchedule const& schedule, int64_t sample, int64_t& start, int64_t& end);
+    /**
+		* Get the samples of a bar
+		*
+		* @param schedule the schedule of the song, it has at least one bar
+		* @param bar index of the bar counted over the repetitions
+		* @param start is set to the start of the bar, including the repetition
+		* @param end is set to the start of the next bar, including the repetition
+		*/
+    static void getBarRange(PlaybackSchedule const& schedule, int64_t bar, int64_t& start, int64_t& end);
+    /**
+		* Get a generated bar, bars are taken out of the ring until it is found. Never waits.
+		*
+		* @param bar index of the bar
+		* @return the bar, nullptr if it was not generated yet
+		*/
+    VariationBar const* takeBar(int64_t bar);
+
+    //state of the background thread
+    PlaybackSchedule const* schedule = nullptr; ///<the schedule the bars are generated for
+    uint32_t generatedRestart = 0; ///<the restart the generated bars belong to
+    int64_t nextBar = 0; ///<bar generated next
+    Figure figure = HOLD; ///<figure of the bar generated last
+    int voicing[MAX_VOICES]; ///<voiced chord of the bar generated last
+    int voiceCount = 0; ///<number of tones of voicing
+    StrokeType strokeType = StrokeType::Tonika; ///<StrokeType selected by the tune
+    int velocity = 0; ///<velocity of the accompaniment
+    std::mt19937 random; ///<random numbers of the Markov chain
+
+    //state of the thread which renders
+    PlaybackSchedule const* playing = nullptr; ///<the schedule which is rendered
+    uint32_t renderRestart = 0; ///<the last restart, bars of earlier restarts are dropped
+    std::vector<VariationBar> local; ///<bars taken out of the ring
+    int localHead = 0; ///<index of the oldest bar in local
+    int localCount = 0; ///<number of bars in local
+    std::bitset<128> soundingNotes; ///<generated notes which were turned on and not yet off
+    std::bitset<128> pendingOffs; ///<notes ended with the next call of render after a restart
+    int64_t lateBar = -1; ///<the bar counted last in lateBars
+    std::atomic<int> lateBars; ///<bars which were not generated in time
+
+    //shared state
+    juce::AbstractFifo fifo; ///<indices of the lock-free ring, one writer and one reader
+    std::vector<VariationBar> ring; ///<the generated bars
+    std::atomic<int64_t> renderedBar; ///<bar rendered last, the background thread generates LOOKAHEAD_BARS ahead of it
+    std::atomic<int> accuracy; ///<accuracy of the musician, written by the audio thread
+    std::atomic<bool> enabled; ///<true if the generated accompaniment is played
+    PlaybackSchedule const* requestSchedule = nullptr; ///<schedule of the last restart, protected by requestMutex
+    int64_t requestSample = 0; ///<position of the last restart, protected by requestMutex
+    IPCSongInfo_IPCMusician requestMusician; ///<musician state of the last restart, protected by requestMutex
+    uint32_t requestCount = 0; ///<number of restarts, protected by requestMutex
+    uint32_t adoptedCount = 0; ///<number of restarts the background thread took over, protected by requestMutex
+
+    std::thread generateThread; ///<the background thread
+    std::atomic<bool> stopGenerator; ///<is set to true, when the background thread shall end
+    std::mutex requestMutex; ///<protects the restart requests and the waiting of the background thread
+    std::condition_variable wakeUp; ///<wakes the background thread when there is work
+    std::condition_variable adopted; ///<wakes the thread waiting in restart
+};
+}
+#endif
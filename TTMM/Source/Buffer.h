@@ -51,7 +51,7 @@ private:
 
 public:
     using size_type = typename Buffer::size_type;
-    using data_type = typename BufferDataType;
+    using data_type = BufferDataType;
 
     RingBuffer() {}
     ~RingBuffer() = default;
@@ -106,6 +106,16 @@ public:
     virtual BufferDataType const* getLatestEvent() const;
     // BufferDataType const* getLatestEventBefore(Timestamp timestamp) const;
 
+    /**
+     Return an event by its age, without copying the buffer.
+     @param age 0 for the latest event, must be less than @code currentSize().
+     @return A ref to the event pushed @code age events before the latest one.
+    */
+    BufferDataType const& getEvent(size_type age) const
+    {
+        return buffer[(insertPosition + BufferSize - 1 - age) % BufferSize];
+    }
+
     /**
      Returns the current size of the buffer which is <= BufferSize.
      @return currentSize
@@ -177,9 +187,9 @@ void ttmm::RingBuffer<BufferDataType, BufferSize>::popAll(
     output.clear();
 
     // Get the current oldest element
-    auto oldest = (currentBufferSize == BufferSize ? (insertPosition + 1) % BufferSize : 0);
+    auto oldest = (currentBufferSize == BufferSize ? insertPosition : 0);
 
-    for (Buffer::size_type i = 0; i < currentBufferSize; ++i)
+    for (size_type i = 0; i < currentBufferSize; ++i)
     {
         output.push_back(buffer[(oldest + i) % BufferSize]);
     }
@@ -197,9 +207,9 @@ void ttmm::RingBuffer<BufferDataType, BufferSize>::getCopyOfAll(
     output.clear();
 
     // Get the current oldest element
-    auto oldest = (currentBufferSize == BufferSize ? (insertPosition + 1) % BufferSize : 0);
+    auto oldest = (currentBufferSize == BufferSize ? insertPosition : 0);
 
-    for (Buffer::size_type i = 0; i < currentBufferSize; ++i)
+    for (size_type i = 0; i < currentBufferSize; ++i)
     {
         output.push_back(buffer[(oldest + i) % BufferSize]);
     }
@@ -53,12 +53,14 @@ void protobuf_AssignDesc_DataExchange_2eproto() {
       ::google::protobuf::MessageFactory::generated_factory(),
       sizeof(IPCSongInfo));
   IPCSongInfo_IPCMusician_descriptor_ = IPCSongInfo_descriptor_->nested_type(0);
-  static const int IPCSongInfo_IPCMusician_offsets_[5] = {
+  static const int IPCSongInfo_IPCMusician_offsets_[7] = {
     GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(IPCSongInfo_IPCMusician, accuracy_),
     GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(IPCSongInfo_IPCMusician, volumech1_),
     GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(IPCSongInfo_IPCMusician, volumech2_),
     GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(IPCSongInfo_IPCMusician, volumech3_),
     GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(IPCSongInfo_IPCMusician, tune_),
+    GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(IPCSongInfo_IPCMusician, tempo_),
+    GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(IPCSongInfo_IPCMusician, phase_),
   };
   IPCSongInfo_IPCMusician_reflection_ =
     new ::google::protobuf::internal::GeneratedMessageReflection(
@@ -106,15 +108,16 @@ void protobuf_AddDesc_DataExchange_2eproto() {
   GOOGLE_PROTOBUF_VERIFY_VERSION;
 
   ::google::protobuf::DescriptorPool::InternalAddGeneratedFile(
-    "\n\022DataExchange.proto\022\004ttmm\"\303\002\n\013IPCSongIn"
+    "\n\022DataExchange.proto\022\004ttmm\"\341\002\n\013IPCSongIn"
     "fo\022/\n\010musician\030\001 \003(\0132\035.ttmm.IPCSongInfo."
-    "IPCMusician\032\202\002\n\013IPCMusician\022\020\n\010accuracy\030"
+    "IPCMusician\032\240\002\n\013IPCMusician\022\020\n\010accuracy\030"
     "\001 \001(\021\022\025\n\tvolumeCh1\030\002 \001(\021:\002-1\022\025\n\tvolumeCh"
     "2\030\003 \001(\021:\002-1\022\025\n\tvolumeCh3\030\004 \001(\021:\002-1\0220\n\004tu"
     "ne\030\005 \001(\0162\".ttmm.IPCSongInfo.IPCMusician."
-    "Tune\"j\n\004Tune\022\010\n\004NONE\020\000\022\013\n\007LEFT_UP\020\001\022\r\n\tM"
-    "IDDLE_UP\020\002\022\014\n\010RIGHT_UP\020\003\022\r\n\tLEFT_DOWN\020\004\022"
-    "\017\n\013MIDDLE_DOWN\020\005\022\016\n\nRIGHT_DOWN\020\006", 352);
+    "Tune\022\r\n\005tempo\030\006 \001(\002\022\r\n\005phase\030\007 \001(\002\"j\n\004Tu"
+    "ne\022\010\n\004NONE\020\000\022\013\n\007LEFT_UP\020\001\022\r\n\tMIDDLE_UP\020\002"
+    "\022\014\n\010RIGHT_UP\020\003\022\r\n\tLEFT_DOWN\020\004\022\017\n\013MIDDLE_"
+    "DOWN\020\005\022\016\n\nRIGHT_DOWN\020\006", 382);
   ::google::protobuf::MessageFactory::InternalRegisterGeneratedFile(
     "DataExchange.proto", &protobuf_RegisterTypes);
   IPCSongInfo::default_instance_ = new IPCSongInfo();
@@ -170,6 +173,8 @@ const int IPCSongInfo_IPCMusician::kVolumeCh1FieldNumber;
 const int IPCSongInfo_IPCMusician::kVolumeCh2FieldNumber;
 const int IPCSongInfo_IPCMusician::kVolumeCh3FieldNumber;
 const int IPCSongInfo_IPCMusician::kTuneFieldNumber;
+const int IPCSongInfo_IPCMusician::kTempoFieldNumber;
+const int IPCSongInfo_IPCMusician::kPhaseFieldNumber;
 #endif  // !_MSC_VER
 
 IPCSongInfo_IPCMusician::IPCSongInfo_IPCMusician()
@@ -195,6 +200,8 @@ void IPCSongInfo_IPCMusician::SharedCtor() {
   volumech2_ = -1;
   volumech3_ = -1;
   tune_ = 0;
+  tempo_ = 0;
+  phase_ = 0;
   ::memset(_has_bits_, 0, sizeof(_has_bits_));
 }
 
@@ -230,12 +237,14 @@ IPCSongInfo_IPCMusician* IPCSongInfo_IPCMusician::New() const {
 }
 
 void IPCSongInfo_IPCMusician::Clear() {
-  if (_has_bits_[0 / 32] & 31) {
+  if (_has_bits_[0 / 32] & 127) {
     accuracy_ = 0;
     volumech1_ = -1;
     volumech2_ = -1;
     volumech3_ = -1;
     tune_ = 0;
+    tempo_ = 0;
+    phase_ = 0;
   }
   ::memset(_has_bits_, 0, sizeof(_has_bits_));
   mutable_unknown_fields()->Clear();
@@ -326,6 +335,36 @@ bool IPCSongInfo_IPCMusician::MergePartialFromCodedStream(
         } else {
           goto handle_unusual;
         }
+        if (input->ExpectTag(53)) goto parse_tempo;
+        break;
+      }
+
+      // optional float tempo = 6;
+      case 6: {
+        if (tag == 53) {
+         parse_tempo:
+          DO_((::google::protobuf::internal::WireFormatLite::ReadPrimitive<
+                   float, ::google::protobuf::internal::WireFormatLite::TYPE_FLOAT>(
+                 input, &tempo_)));
+          set_has_tempo();
+        } else {
+          goto handle_unusual;
+        }
+        if (input->ExpectTag(61)) goto parse_phase;
+        break;
+      }
+
+      // optional float phase = 7;
+      case 7: {
+        if (tag == 61) {
+         parse_phase:
+          DO_((::google::protobuf::internal::WireFormatLite::ReadPrimitive<
+                   float, ::google::protobuf::internal::WireFormatLite::TYPE_FLOAT>(
+                 input, &phase_)));
+          set_has_phase();
+        } else {
+          goto handle_unusual;
+        }
         if (input->ExpectAtEnd()) goto success;
         break;
       }
@@ -381,6 +420,16 @@ void IPCSongInfo_IPCMusician::SerializeWithCachedSizes(
       5, this->tune(), output);
   }
 
+  // optional float tempo = 6;
+  if (has_tempo()) {
+    ::google::protobuf::internal::WireFormatLite::WriteFloat(6, this->tempo(), output);
+  }
+
+  // optional float phase = 7;
+  if (has_phase()) {
+    ::google::protobuf::internal::WireFormatLite::WriteFloat(7, this->phase(), output);
+  }
+
   if (!unknown_fields().empty()) {
     ::google::protobuf::internal::WireFormat::SerializeUnknownFields(
         unknown_fields(), output);
@@ -417,6 +466,16 @@ void IPCSongInfo_IPCMusician::SerializeWithCachedSizes(
       5, this->tune(), target);
   }
 
+  // optional float tempo = 6;
+  if (has_tempo()) {
+    target = ::google::protobuf::internal::WireFormatLite::WriteFloatToArray(6, this->tempo(), target);
+  }
+
+  // optional float phase = 7;
+  if (has_phase()) {
+    target = ::google::protobuf::internal::WireFormatLite::WriteFloatToArray(7, this->phase(), target);
+  }
+
   if (!unknown_fields().empty()) {
     target = ::google::protobuf::internal::WireFormat::SerializeUnknownFieldsToArray(
         unknown_fields(), target);
@@ -463,6 +522,16 @@ int IPCSongInfo_IPCMusician::ByteSize() const {
         ::google::protobuf::internal::WireFormatLite::EnumSize(this->tune());
     }
 
+    // optional float tempo = 6;
+    if (has_tempo()) {
+      total_size += 1 + 4;
+    }
+
+    // optional float phase = 7;
+    if (has_phase()) {
+      total_size += 1 + 4;
+    }
+
   }
   if (!unknown_fields().empty()) {
     total_size +=
@@ -505,6 +574,12 @@ void IPCSongInfo_IPCMusician::MergeFrom(const IPCSongInfo_IPCMusician& from) {
     if (from.has_tune()) {
       set_tune(from.tune());
     }
+    if (from.has_tempo()) {
+      set_tempo(from.tempo());
+    }
+    if (from.has_phase()) {
+      set_phase(from.phase());
+    }
   }
   mutable_unknown_fields()->MergeFrom(from.unknown_fields());
 }
@@ -533,6 +608,8 @@ void IPCSongInfo_IPCMusician::Swap(IPCSongInfo_IPCMusician* other) {
     std::swap(volumech2_, other->volumech2_);
     std::swap(volumech3_, other->volumech3_);
     std::swap(tune_, other->tune_);
+    std::swap(tempo_, other->tempo_);
+    std::swap(phase_, other->phase_);
     std::swap(_has_bits_[0], other->_has_bits_[0]);
     _unknown_fields_.Swap(&other->_unknown_fields_);
     std::swap(_cached_size_, other->_cached_size_);
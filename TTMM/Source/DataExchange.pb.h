@@ -180,6 +180,20 @@ class IPCSongInfo_IPCMusician : public ::google::protobuf::Message {
   inline ::ttmm::IPCSongInfo_IPCMusician_Tune tune() const;
   inline void set_tune(::ttmm::IPCSongInfo_IPCMusician_Tune value);
 
+  // optional float tempo = 6;
+  inline bool has_tempo() const;
+  inline void clear_tempo();
+  static const int kTempoFieldNumber = 6;
+  inline float tempo() const;
+  inline void set_tempo(float value);
+
+  // optional float phase = 7;
+  inline bool has_phase() const;
+  inline void clear_phase();
+  static const int kPhaseFieldNumber = 7;
+  inline float phase() const;
+  inline void set_phase(float value);
+
   // @@protoc_insertion_point(class_scope:ttmm.IPCSongInfo.IPCMusician)
  private:
   inline void set_has_accuracy();
@@ -192,6 +206,10 @@ class IPCSongInfo_IPCMusician : public ::google::protobuf::Message {
   inline void clear_has_volumech3();
   inline void set_has_tune();
   inline void clear_has_tune();
+  inline void set_has_tempo();
+  inline void clear_has_tempo();
+  inline void set_has_phase();
+  inline void clear_has_phase();
 
   ::google::protobuf::UnknownFieldSet _unknown_fields_;
 
@@ -202,6 +220,8 @@ class IPCSongInfo_IPCMusician : public ::google::protobuf::Message {
   ::google::protobuf::int32 volumech2_;
   ::google::protobuf::int32 volumech3_;
   int tune_;
+  float tempo_;
+  float phase_;
   friend void  protobuf_AddDesc_DataExchange_2eproto();
   friend void protobuf_AssignDesc_DataExchange_2eproto();
   friend void protobuf_ShutdownFile_DataExchange_2eproto();
@@ -421,6 +441,54 @@ inline void IPCSongInfo_IPCMusician::set_tune(::ttmm::IPCSongInfo_IPCMusician_Tu
   // @@protoc_insertion_point(field_set:ttmm.IPCSongInfo.IPCMusician.tune)
 }
 
+// optional float tempo = 6;
+inline bool IPCSongInfo_IPCMusician::has_tempo() const {
+  return (_has_bits_[0] & 0x00000020u) != 0;
+}
+inline void IPCSongInfo_IPCMusician::set_has_tempo() {
+  _has_bits_[0] |= 0x00000020u;
+}
+inline void IPCSongInfo_IPCMusician::clear_has_tempo() {
+  _has_bits_[0] &= ~0x00000020u;
+}
+inline void IPCSongInfo_IPCMusician::clear_tempo() {
+  tempo_ = 0;
+  clear_has_tempo();
+}
+inline float IPCSongInfo_IPCMusician::tempo() const {
+  // @@protoc_insertion_point(field_get:ttmm.IPCSongInfo.IPCMusician.tempo)
+  return tempo_;
+}
+inline void IPCSongInfo_IPCMusician::set_tempo(float value) {
+  set_has_tempo();
+  tempo_ = value;
+  // @@protoc_insertion_point(field_set:ttmm.IPCSongInfo.IPCMusician.tempo)
+}
+
+// optional float phase = 7;
+inline bool IPCSongInfo_IPCMusician::has_phase() const {
+  return (_has_bits_[0] & 0x00000040u) != 0;
+}
+inline void IPCSongInfo_IPCMusician::set_has_phase() {
+  _has_bits_[0] |= 0x00000040u;
+}
+inline void IPCSongInfo_IPCMusician::clear_has_phase() {
+  _has_bits_[0] &= ~0x00000040u;
+}
+inline void IPCSongInfo_IPCMusician::clear_phase() {
+  phase_ = 0;
+  clear_has_phase();
+}
+inline float IPCSongInfo_IPCMusician::phase() const {
+  // @@protoc_insertion_point(field_get:ttmm.IPCSongInfo.IPCMusician.phase)
+  return phase_;
+}
+inline void IPCSongInfo_IPCMusician::set_phase(float value) {
+  set_has_phase();
+  phase_ = value;
+  // @@protoc_insertion_point(field_set:ttmm.IPCSongInfo.IPCMusician.phase)
+}
+
 // -------------------------------------------------------------------
 
 // IPCSongInfo
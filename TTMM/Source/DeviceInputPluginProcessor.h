@@ -9,6 +9,8 @@
 
 #include <thread>
 #include <mutex>
+#include <cmath>
+#include <algorithm>
 #include <Windows.h>
 #include "DataExchange.pb.h"
 #include "IPCConnection.h"
@@ -16,6 +18,7 @@
 #include "Buffer.h"
 #include "TimeTools.h"
 #include "FileWriter.h"
+#include "PerformanceRecorder.h"
 
 namespace ttmm
 {
@@ -59,6 +62,9 @@ public:
         , inputDevice(inputDevice)
         , connection{ this }
     {
+        inputTrack = recorder.addTrack("Eingaben");
+        gateTrack = recorder.addTrack("Gates");
+        metronomTrack = recorder.addTrack("Metronom");
         bool openedOk = connection.connectToPipe(PIPE_NAME, 1000);
         if (openedOk)
         {
@@ -115,10 +121,22 @@ public:
         }
 
         uhrenvergleich();
+
+        // only events played from now on are recorded
+        for (auto& m : musicians)
+        {
+            m.setLastCapturedTimestamp(TimeInfo::timeInfo().now());
+            m.setCapturedNote(-1);
+        }
+        if (!recorder.start(PerformanceRecorder::makeFile(getName().toStdString())))
+        {
+            ttmm::logfileGeneral->write("## Error: Starting the recording failed!");
+        }
     }
 
     void shutdown() override final
     {
+        stopRecording();
         close(inputDevice);
         if (inputDevice.isOpen())
         {
@@ -167,12 +185,22 @@ protected:
     virtual int getDefaultToleranceNoteValue() const = 0;
     virtual bool canSend() { return false; }
 
+    /**
+      Concrete Plugins define how an event of a Musician is written to the recording.
+      @param event The event of the Musician.
+      @param[out] note The note of the event.
+      @param[out] velocity The velocity of the event, 1-127.
+      @return true if the event is recorded.
+    */
+    virtual bool captureNote(typename Musician::BufferData const& event, int& note, int& velocity) const { return false; }
+
 private:
     // @todo: read config file for metronom
     int metronomChannel = 1; ///< The fixed channel where the Metronome is received.
     int audioMainChannel = 2; ///< The fixed main channel for received messages.
     int audioSideChannel = 3; ///< The fixed side channel for received messages.
     int toleranceNoteValue = 16; ///< Tolerance value used during comparison of musicians events
+    int metronomBeatVelocity = 100; ///< Metronome notes with a lower velocity subdivide the beat.
 
     /**
      Number of parameters defined in this abstract Plug.
@@ -183,13 +211,54 @@ private:
         return 3;
     }
 
+    PerformanceRecorder recorder; ///< Records the events of the Musicians, the gates and the metronome.
+    int inputTrack = -1; ///< Track of the events of the Musicians, one channel per Musician.
+    int gateTrack = -1; ///< Track of the gates, controller @code GATE_CONTROLLER per Musician.
+    int metronomTrack = -1; ///< Track of the received metronome notes.
+    static const int GATE_CONTROLLER = 80; ///< Controller recording whether a Musician played correct.
+    static const int METRONOM_CLICK_MS = 10; ///< Length of a recorded metronome note, its note-off is not recorded.
+
     IPCConnection connection;
     const std::string PIPE_NAME = "18cmPENIS";
     virtual bool init(Device& device, Samplerate sampleRate) = 0;
     virtual void close(Device& device) = 0;
 
     // @todo: Retrieve bpm from config file
-    float bpm = 120.0;
+    float bpm = 120.0; ///< Follows the metronome, so a tempo change in PluginMusic reaches the tolerance.
+    Timestamp lastMetronom; ///< Time of the last received metronome beat.
+    bool hasLastMetronom = false; ///< Whether @code lastMetronom is valid.
+
+    /**
+     * Convert a timestamp to the seconds used by @code TempoFollower.
+     * @param t The timestamp.
+     * @return Seconds since the clock comparison.
+     */
+    static double toSeconds(Timestamp t)
+    {
+        return TimeInfo::timeInfo().ns(t) / 1000000000.0;
+    }
+
+    /**
+     * Update @code bpm from the interval between two metronome beats.
+     * The interval is divided by the nearest number of quarters at the current bpm,
+     * so a skipped block does not halve the tempo. Implausible values are ignored,
+     * the others are smoothed.
+     * @param timeOfNote Timestamp of the metronome beat just received.
+     */
+    void followMetronom(Timestamp timeOfNote);
+
+    /**
+     * Write the events a Musician created since the last call to the recording.
+     * Each event sounds until the next event of the Musician.
+     * @param index Index of the Musician, gives the channel.
+     * @param m The Musician.
+     */
+    void captureEvents(size_t index, Musician& m);
+
+    /**
+     * End the notes still sounding in the recording and write the file.
+     */
+    void stopRecording();
 
     /**
      * Utility method to evaluate precision of a musician.
@@ -281,7 +350,21 @@ void ttmm::DeviceInputPluginProcessor<Device, Musician,
 	    {
 			ttmm::logger.write("metronomChannel arrives: " + std::to_string(channel) + " == " + std::to_string(metronomChannel));
 			newBuffer.addEvent(msg, samplePosition);
-			noteHistory.push(MidiNoteMessage(timeAfter(timeNow, samplePosition * sampleDuration), msg));
+			auto timeOfNote = timeAfter(timeNow, samplePosition * sampleDuration);
+			// clicks between the beats are matched, but only the beats give the tempo
+			if (msg.getVelocity() >= metronomBeatVelocity)
+			{
+				followMetronom(timeOfNote);
+				for (auto& m : musicians)
+				{
+					m.getTempoFollower().addBeat(toSeconds(timeOfNote), bpm);
+				}
+			}
+			noteHistory.push(MidiNoteMessage(timeOfNote, msg));
+			recorder.record(metronomTrack, toSeconds(timeOfNote), msg);
+			// the note-offs of the metronome pass through untouched, the click gets an end of its own
+			recorder.record(metronomTrack, toSeconds(timeOfNote) + METRONOM_CLICK_MS / 1000.0,
+			                static_cast<uint8_t>(0x80 | (channel - 1)), static_cast<uint8_t>(msg.getNoteNumber()), 0);
 	    }
 
 	    // @todo Let the actual plugins deicide what to do with audioMain/audioSideChannel
@@ -355,6 +438,7 @@ void ttmm::DeviceInputPluginProcessor<Device, Musician,
     for (size_t i = 0; i < musicians.size(); ++i)
     {
         auto& m = musicians[i];
+        captureEvents(i, m);
 
         // nothing to do if no event from Musician or no notes yet
         if (m.getHistory().isEmpty() || (noteHistory.isEmpty()))
@@ -362,6 +446,14 @@ void ttmm::DeviceInputPluginProcessor<Device, Musician,
             continue;
         }
 
+        // every new event updates the tempo of the musician, it ignores events it has seen
+        // (the latest event of a KinectMusician is their last stomp, there may be none)
+        auto latestEvent = m.getHistory().getLatestEvent();
+        if (latestEvent != nullptr)
+        {
+            m.getTempoFollower().addHit(toSeconds(latestEvent->timestamp));
+        }
+
         auto musicianPlayedCorrect = false;
         auto lastNote = const_cast<MidiNoteMessage*>(noteHistory.getLatestEvent());
         auto timeLastNote = lastNote->timestamp;
@@ -400,6 +492,8 @@ void ttmm::DeviceInputPluginProcessor<Device, Musician,
             m.decreaseAccuracy();
             m.playedCorrect = false;
         }
+        recorder.record(gateTrack, toSeconds(TimeInfo::timeInfo().now()),
+            static_cast<uint8_t>(0xB0 | (i & 0x0F)), GATE_CONTROLLER, musicianPlayedCorrect ? 127 : 0);
 
         // store musician to SongInfo object
         IPCSongInfo::IPCMusician* musi;
@@ -410,6 +504,11 @@ void ttmm::DeviceInputPluginProcessor<Device, Musician,
                 IPCSongInfo::IPCMusician::Tune::IPCSongInfo_IPCMusician_Tune_NONE);
             calculateCustomValues(m, musi);
             musi->set_accuracy(m.getAccuracy());
+            if (m.getTempoFollower().hasEstimate())
+            {
+                musi->set_tempo(static_cast<float>(m.getTempoFollower().getTempo()));
+                musi->set_phase(static_cast<float>(m.getTempoFollower().getPhase()));
+            }
         }
     }
 
@@ -448,6 +547,91 @@ bool ttmm::DeviceInputPluginProcessor<Device, Musician,
     return (timeLatestEvent > lowerBound) && (timeLatestEvent < upperBound);
 }
 
+// Passt das Tempo an den Abstand der Metronom-Noten an
+template <typename Device, typename Musician, size_t bufferSize>
+void ttmm::DeviceInputPluginProcessor<Device, Musician,
+    bufferSize>::followMetronom(Timestamp timeOfNote)
+{
+    if (hasLastMetronom)
+    {
+        auto interval = std::chrono::duration<double>(timeOfNote - lastMetronom).count();
+        auto quarters = std::max(1.0, std::floor(interval * bpm / 60.0 + 0.5));
+        auto measuredBpm = 60.0 * quarters / interval;
+        // ignore gaps and restarts of the song
+        if (interval > 0 && quarters <= 4 && measuredBpm >= 30 && measuredBpm <= 300)
+        {
+            bpm = static_cast<float>(bpm + (measuredBpm - bpm) * 0.5);
+        }
+    }
+    lastMetronom = timeOfNote;
+    hasLastMetronom = true;
+}
+
+// Schreibt die neuen Ereignisse eines Musikanten in die Aufnahme
+template <typename Device, typename Musician, size_t bufferSize>
+void ttmm::DeviceInputPluginProcessor<Device, Musician,
+    bufferSize>::captureEvents(size_t index, Musician& m)
+{
+    auto& history = m.getHistory();
+    if (!recorder.isRecording() || history.isEmpty())
+    {
+        return;
+    }
+
+    // the history is searched from the latest event back to the first one not yet recorded
+    size_t newEvents = 0;
+    while (newEvents < history.currentSize()
+        && history.getEvent(newEvents).timestamp > m.getLastCapturedTimestamp())
+    {
+        newEvents++;
+    }
+
+    auto channel = static_cast<uint8_t>(index & 0x0F);
+    while (newEvents > 0)
+    {
+        auto const& event = history.getEvent(--newEvents);
+        m.setLastCapturedTimestamp(event.timestamp);
+        int note, velocity;
+        if (!captureNote(event, note, velocity))
+        {
+            continue;
+        }
+        auto time = toSeconds(event.timestamp);
+        if (m.getCapturedNote() >= 0)
+        {
+            recorder.record(inputTrack, time, 0x80 | channel, static_cast<uint8_t>(m.getCapturedNote()), 0);
+        }
+        recorder.record(inputTrack, time, 0x90 | channel, static_cast<uint8_t>(note),
+            static_cast<uint8_t>(std::min(std::max(velocity, 1), 127)));
+        m.setCapturedNote(note);
+    }
+}
+
+template <typename Device, typename Musician, size_t bufferSize>
+void ttmm::DeviceInputPluginProcessor<Device, Musician,
+    bufferSize>::stopRecording()
+{
+    if (!recorder.isRecording())
+    {
+        return;
+    }
+    auto time = toSeconds(TimeInfo::timeInfo().now());
+    for (size_t i = 0; i < musicians.size(); ++i)
+    {
+        if (musicians[i].getCapturedNote() >= 0)
+        {
+            recorder.record(inputTrack, time, static_cast<uint8_t>(0x80 | (i & 0x0F)),
+                static_cast<uint8_t>(musicians[i].getCapturedNote()), 0);
+            musicians[i].setCapturedNote(-1);
+        }
+    }
+    recorder.stop();
+    if (recorder.getDropped() > 0)
+    {
+        ttmm::logfileGeneral->write("Events missing in the recording: ", recorder.getDropped());
+    }
+}
+
 // Helfer-Methoder fr Synchronisation der Plugins auf gemeinsame Startzeit
 template <typename Device, typename Musician, size_t bufferSize>
 void ttmm::DeviceInputPluginProcessor<Device, Musician, bufferSize>::
@@ -8,7 +8,7 @@ namespace ttmm {
     struct GeneralException : public std::exception {
         GeneralException(std::string const& message) : exception(), message(message) {}
 
-        const char* what() const override final { return message.c_str(); }
+        const char* what() const throw() override final { return message.c_str(); }
     private:
         std::string message;
     };
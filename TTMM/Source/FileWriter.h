@@ -47,18 +47,18 @@ static FileWriter &logger = FileWriter::instance; ///< globally accessible ref
 //==================================================================================
 // The following are provided to keep the usages of a previous filewriter
 // working
-static FileWriter *logfileMusic =
+static FileWriter *const logfileMusic =
     &FileWriter::instance; ///< @deprecated Just use ttmm::logger instead
-static FileWriter *logfileMetronom =
+static FileWriter *const logfileMetronom =
     &FileWriter::instance; ///< @deprecated Just use ttmm::logger instead
-static FileWriter *logfileMidiReader =
+static FileWriter *const logfileMidiReader =
     &FileWriter::instance; ///< @deprecated Just use ttmm::logger instead
-static FileWriter *logfileMidiHandler =
+static FileWriter *const logfileMidiHandler =
     &FileWriter::instance; ///< @deprecated Just use ttmm::logger instead
-static FileWriter *logfileDrum =
+static FileWriter *const logfileDrum =
     &FileWriter::instance; ///< @deprecated Just use ttmm::logger instead
-static FileWriter *logfileKinect =
+static FileWriter *const logfileKinect =
     &FileWriter::instance; ///< @deprecated Just use ttmm::logger instead
-static FileWriter *logfileGeneral =
+static FileWriter *const logfileGeneral =
     &FileWriter::instance; ///< @deprecated Just use ttmm::logger instead
 }
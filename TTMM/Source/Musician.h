@@ -7,6 +7,7 @@
 
 #include "Buffer.h"
 #include "ExceptionTypes.h"
+#include "TempoFollower.h"
 
 namespace ttmm {
 
@@ -29,6 +30,7 @@ public:
   void increaseAccuracy() { accuracy++; }
   void decreaseAccuracy() { accuracy--; }
   int getAccuracy() const { return accuracy; }
+  TempoFollower& getTempoFollower() { return tempoFollower; }
   float getVolumeFactor() { return volumefactor; };
 
   void pushEvent(InputData& event) {
@@ -47,6 +49,17 @@ public:
   void setLastMatchedNoteTimestamp(Timestamp ts) {
       lastMatchedNoteTimestamp = ts;
   }
+
+  Timestamp getLastCapturedTimestamp() const {
+      return lastCapturedTimestamp;
+  }
+
+  void setLastCapturedTimestamp(Timestamp ts) {
+      lastCapturedTimestamp = ts;
+  }
+
+  int getCapturedNote() const { return capturedNote; }
+  void setCapturedNote(int note) { capturedNote = note; }
   virtual BufferData* pushData(BufferData const& preparedData) {
       return &history.push(preparedData);
   }
@@ -63,6 +76,9 @@ private:
   bool active = false;
   Buffer history;
   int accuracy = 0;
+  TempoFollower tempoFollower;
   Timestamp lastMatchedNoteTimestamp;
+  Timestamp lastCapturedTimestamp; ///< Time of the latest event written to the recording.
+  int capturedNote = -1; ///< Note of the latest event in the recording, -1 if none sounds.
 };
 }
@@ -0,0 +1,286 @@
+#include "PerformanceRecorder.h"
+
+#include <algorithm>
+#include <cmath>
+
+using namespace ttmm;
+
+PerformanceRecorder::PerformanceRecorder()
+    : fifo(CAPACITY)
+    , ring(CAPACITY)
+    , recording(false)
+    , dropped(0)
+    , written(0)
+    , stopWriter(false)
+{
+}
+
+PerformanceRecorder::~PerformanceRecorder()
+{
+    stop();
+}
+
+int PerformanceRecorder::addTrack(std::string const& name)
+{
+    if (recording.load() || static_cast<int>(tracks.size()) >= MAX_TRACKS)
+    {
+        return -1;
+    }
+    Track track;
+    track.name = name;
+    tracks.push_back(track);
+    return static_cast<int>(tracks.size()) - 1;
+}
+
+bool PerformanceRecorder::start(juce::File const& file)
+{
+    stop();
+    target = file;
+    fifo.reset();
+    dropped = 0;
+    written = 0;
+
+    juce::File temp = juce::File::getSpecialLocation(juce::File::tempDirectory);
+    for (auto& track : tracks)
+    {
+        track.file = temp.getNonexistentChildFile(file.getFileNameWithoutExtension(), ".trk", false);
+        track.out = new juce::FileOutputStream(track.file, CHUNK_BYTES);
+        if (track.out->failedToOpen())
+        {
+            for (auto& opened : tracks)
+            {
+                delete opened.out;
+                opened.out = nullptr;
+                opened.file.deleteFile();
+            }
+            return false;
+        }
+        track.chunk.clear();
+        track.chunk.reserve(CHUNK_BYTES + 16);
+        track.lastTick = 0;
+        track.bytes = 0;
+        track.events = 0;
+
+        // every track starts with its name
+        track.chunk.push_back(0);
+        track.chunk.push_back(0xFF);
+        track.chunk.push_back(0x03);
+        appendVariable(track.chunk, static_cast<uint32_t>(track.name.size()));
+        track.chunk.insert(track.chunk.end(), track.name.begin(), track.name.end());
+    }
+
+    stopWriter = false;
+    recording = true;
+    writerThread = std::thread(&PerformanceRecorder::run, this);
+    return true;
+}
+
+void PerformanceRecorder::stop()
+{
+    if (!recording.load())
+    {
+        return;
+    }
+    recording = false;
+    {
+        std::lock_guard<std::mutex> lock(writerMutex);
+        stopWriter = true;
+    }
+    wakeUp.notify_one();
+    if (writerThread.joinable())
+    {
+        writerThread.join();
+    }
+    drain();
+    finish();
+}
+
+bool PerformanceRecorder::isRecording() const
+{
+    return recording.load();
+}
+
+bool PerformanceRecorder::record(int track, double time, juce::MidiMessage const& msg)
+{
+    int size = msg.getRawDataSize();
+    juce::uint8 const* data = msg.getRawData();
+    if (size < 2 || size > 3 || data[0] < 0x80 || data[0] >= 0xF0)
+    {
+        return false;
+    }
+    return record(track, time, data[0], data[1], size == 3 ? data[2] : 0);
+}
+
+bool PerformanceRecorder::record(int track, double time, uint8_t status, uint8_t data1, uint8_t data2)
+{
+    if (!recording.load() || track < 0 || track >= static_cast<int>(tracks.size()))
+    {
+        return false;
+    }
+    if (fifo.getFreeSpace() == 0)
+    {
+        dropped++;
+        return false;
+    }
+    CaptureEvent event;
+    event.time = time;
+    event.track = static_cast<uint8_t>(track);
+    // program change and channel pressure have only one data byte
+    event.size = (status & 0xE0) == 0xC0 ? 2 : 3;
+    event.data[0] = status;
+    event.data[1] = data1 & 0x7F;
+    event.data[2] = data2 & 0x7F;
+
+    int start1, size1, start2, size2;
+    fifo.prepareToWrite(1, start1, size1, start2, size2);
+    ring[size1 > 0 ? start1 : start2] = event;
+    fifo.finishedWrite(1);
+    return true;
+}
+
+int PerformanceRecorder::getDropped() const
+{
+    return dropped.load();
+}
+
+int64_t PerformanceRecorder::getWritten() const
+{
+    return written.load();
+}
+
+juce::File PerformanceRecorder::makeFile(std::string const& name)
+{
+    juce::File folder = juce::File::getCurrentWorkingDirectory().getChildFile("Recordings");
+    folder.createDirectory();
+    juce::String prefix = juce::String(name) + juce::Time::getCurrentTime().formatted("_%Y-%m-%d_%H-%M-%S");
+    return folder.getNonexistentChildFile(prefix, ".mid", false);
+}
+
+void PerformanceRecorder::run()
+{
+    while (!stopWriter.load())
+    {
+        drain();
+        std::unique_lock<std::mutex> lock(writerMutex);
+        wakeUp.wait_for(lock, std::chrono::milliseconds(10), [this] { return stopWriter.load(); });
+    }
+}
+
+void PerformanceRecorder::drain()
+{
+    int start1, size1, start2, size2;
+    fifo.prepareToRead(fifo.getNumReady(), start1, size1, start2, size2);
+    for (int i = 0; i < size1; i++)
+    {
+        encode(ring[start1 + i]);
+    }
+    for (int i = 0; i < size2; i++)
+    {
+        encode(ring[start2 + i]);
+    }
+    fifo.finishedRead(size1 + size2);
+}
+
+void PerformanceRecorder::encode(CaptureEvent const& event)
+{
+    Track& track = tracks[event.track];
+    // the events of different threads may arrive slightly out of order, a delta time is never negative
+    int64_t tick = std::max(static_cast<int64_t>(std::floor(event.time * TICKS_PER_SECOND + 0.5)), track.lastTick);
+    appendVariable(track.chunk, static_cast<uint32_t>(std::min<int64_t>(tick - track.lastTick, 0x0FFFFFFF)));
+    track.lastTick = tick;
+    track.chunk.insert(track.chunk.end(), event.data, event.data + event.size);
+    track.events++;
+    written++;
+    if (track.chunk.size() >= CHUNK_BYTES)
+    {
+        writeChunk(track);
+    }
+}
+
+void PerformanceRecorder::writeChunk(Track& track)
+{
+    if (track.chunk.empty() || track.out == nullptr)
+    {
+        return;
+    }
+    track.out->write(track.chunk.data(), track.chunk.size());
+    track.bytes += track.chunk.size();
+    track.chunk.clear();
+}
+
+bool PerformanceRecorder::finish()
+{
+    int used = 0;
+    for (auto& track : tracks)
+    {
+        writeChunk(track);
+        delete track.out;
+        track.out = nullptr;
+        if (track.events > 0)
+        {
+            used++;
+        }
+    }
+
+    // FileOutputStream appends to an existing file
+    target.deleteFile();
+    bool ok = false;
+    {
+        juce::FileOutputStream out(target);
+        if (!out.failedToOpen())
+        {
+            out.write("MThd", 4);
+            out.writeIntBigEndian(6);
+            out.writeShortBigEndian(1);
+            out.writeShortBigEndian(static_cast<short>(used + 1));
+            out.writeShortBigEndian(TICKS_PER_QUARTER);
+
+            // the conductor track only holds the tempo, the ticks are a fixed grid of seconds
+            juce::uint8 const conductor[] = { 0x00, 0xFF, 0x51, 0x03,
+                                              static_cast<juce::uint8>(TEMPO >> 16),
+                                              static_cast<juce::uint8>(TEMPO >> 8),
+                                              static_cast<juce::uint8>(TEMPO),
+                                              0x00, 0xFF, 0x2F, 0x00 };
+            out.write("MTrk", 4);
+            out.writeIntBigEndian(sizeof(conductor));
+            out.write(conductor, sizeof(conductor));
+
+            juce::uint8 const endOfTrack[] = { 0x00, 0xFF, 0x2F, 0x00 };
+            for (auto& track : tracks)
+            {
+                if (track.events == 0)
+                {
+                    continue;
+                }
+                out.write("MTrk", 4);
+                out.writeIntBigEndian(static_cast<int>(track.bytes + sizeof(endOfTrack)));
+                juce::FileInputStream in(track.file);
+                out.writeFromInputStream(in, track.bytes);
+                out.write(endOfTrack, sizeof(endOfTrack));
+            }
+            out.flush();
+            ok = out.getStatus().wasOk();
+        }
+    }
+    for (auto& track : tracks)
+    {
+        track.file.deleteFile();
+    }
+    return ok;
+}
+
+void PerformanceRecorder::appendVariable(std::vector<uint8_t>& out, uint32_t value)
+{
+    uint8_t bytes[4];
+    int count = 0;
+    do
+    {
+        bytes[count++] = value & 0x7F;
+        value >>= 7;
+    } while (value > 0 && count < 4);
+    while (count > 1)
+    {
+        out.push_back(bytes[--count] | 0x80);
+    }
+    out.push_back(bytes[0]);
+}
@@ -0,0 +1,190 @@
+/**
+ * @file PerformanceRecorder.h
+ * @author FH-Minden Musikinformatik 2015, Musicgroup (Marcel, Patrick, Scott)
+ * @brief Declaration of @code CaptureEvent and @code PerformanceRecorder
+ */
+
+#ifndef TTMM_PERFORMANCE_RECORDER_H
+#define TTMM_PERFORMANCE_RECORDER_H
+
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <vector>
+#include <string>
+#include <cstdint>
+
+#include "../JuceLibraryCode/JuceHeader.h"
+
+namespace ttmm
+{
+
+/**
+ * @struct CaptureEvent
+ * @brief A midi message waiting in the ring of the @code PerformanceRecorder.
+ */
+struct CaptureEvent
+{
+    double time; ///< Seconds since the time zero of @code TimeInfo.
+    uint8_t track; ///< Index of the track, see @code PerformanceRecorder::addTrack.
+    uint8_t size; ///< Number of used bytes in @code data.
+    uint8_t data[3]; ///< The status byte and the data bytes.
+};
+
+/**
+ * @class PerformanceRecorder
+ * @brief Writes what was played to a multi-track Standard MIDI File while it is played.
+ *
+ * The audio thread puts the messages into a preallocated lock-free ring, @code record never
+ * blocks or allocates. A background thread takes them out, encodes them with delta times and
+ * appends them in chunks of @code CHUNK_BYTES to a temporary file per track, so a session of
+ * several hours does not grow in memory. @code stop writes the header and copies the tracks
+ * into the final file (format 1).
+ * All plugins count the time from the time zero of @code TimeInfo, which is synchronised
+ * by the clock comparison, so the files of the plugins line up.
+ * There is only one writer: all tracks have to be recorded by the same thread.
+ */
+class PerformanceRecorder
+{
+public:
+    static const int CAPACITY = 8192; ///< Messages which can wait for the background thread.
+    static const int CHUNK_BYTES = 4096; ///< Encoded bytes of a track which are written at once.
+    static const int TICKS_PER_QUARTER = 960; ///< Division of the file.
+    static const int TEMPO = 500000; ///< Microseconds per quarter, the ticks are a fixed grid of seconds.
+    static const int TICKS_PER_SECOND = TICKS_PER_QUARTER * 1000000 / TEMPO; ///< Resolution of the times.
+    static const int MAX_TRACKS = 32; ///< Most tracks of a file.
+
+    PerformanceRecorder();
+
+    /**
+     * Finishes the file if still recording.
+     */
+    ~PerformanceRecorder();
+
+    PerformanceRecorder(PerformanceRecorder const&) = delete;
+    PerformanceRecorder& operator=(PerformanceRecorder const&) = delete;
+
+    /**
+     * Add a track, only while not recording.
+     * @param name The name of the track written to the file.
+     * @return The index of the track, -1 if there are @code MAX_TRACKS tracks already.
+     */
+    int addTrack(std::string const& name);
+
+    /**
+     * Start recording into a file, a running recording is finished before.
+     * @param file The Standard MIDI File to write, it is replaced.
+     * @return true if the temporary files could be created.
+     */
+    bool start(juce::File const& file);
+
+    /**
+     * Stop the background thread and write the file. Tracks without messages are left out.
+     */
+    void stop();
+
+    /**
+     * @return true between @code start and @code stop.
+     */
+    bool isRecording() const;
+
+    /**
+     * Queue a message, called by the thread which plays. Never blocks or allocates.
+     * @param track Index of the track.
+     * @param time Seconds since the time zero of @code TimeInfo.
+     * @param msg A channel message, others are ignored.
+     * @return false if not recording or the ring is full, the message is dropped then.
+     */
+    bool record(int track, double time, juce::MidiMessage const& msg);
+
+    /**
+     * Queue a channel message given by its bytes.
+     * @see record
+     */
+    bool record(int track, double time, uint8_t status, uint8_t data1, uint8_t data2);
+
+    /**
+     * @return Number of messages which did not fit into the ring since @code start.
+     */
+    int getDropped() const;
+
+    /**
+     * @return Number of messages written to the temporary files since @code start.
+     */
+    int64_t getWritten() const;
+
+    /**
+     * Create a new file name in the folder "Recordings" of the working directory.
+     * @param name Start of the file name, the date and time are appended.
+     * @return A file which does not exist yet.
+     */
+    static juce::File makeFile(std::string const& name);
+
+private:
+    /**
+     * @struct Track
+     * @brief A track being written, only used by the background thread while recording.
+     */
+    struct Track
+    {
+        std::string name; ///< Name of the track.
+        juce::File file; ///< The temporary file of the encoded messages.
+        juce::FileOutputStream* out = nullptr; ///< Stream to the temporary file.
+        std::vector<uint8_t> chunk; ///< Encoded messages not yet written.
+        int64_t lastTick = 0; ///< Time of the last message, the next delta time starts here.
+        int64_t bytes = 0; ///< Bytes in the temporary file.
+        int64_t events = 0; ///< Messages of the track.
+    };
+
+    /**
+     * Loop of the background thread.
+     */
+    void run();
+
+    /**
+     * Take all queued messages out of the ring and encode them, called by the background thread.
+     */
+    void drain();
+
+    /**
+     * Append a message to the chunk of its track and write the chunk if it is full.
+     * @param event The message.
+     */
+    void encode(CaptureEvent const& event);
+
+    /**
+     * Write the chunk of a track to its temporary file.
+     * @param track The track.
+     */
+    void writeChunk(Track& track);
+
+    /**
+     * Write the header and the tracks to the final file and delete the temporary files.
+     * @return true if the file was written.
+     */
+    bool finish();
+
+    /**
+     * Append a number as variable length quantity.
+     * @param out The bytes to append to.
+     * @param value A number below 2^28.
+     */
+    static void appendVariable(std::vector<uint8_t>& out, uint32_t value);
+
+    std::vector<Track> tracks; ///< The tracks, fixed while recording.
+    juce::File target; ///< The file written by @code stop.
+    juce::AbstractFifo fifo; ///< Indices of the lock-free ring, one writer and one reader.
+    std::vector<CaptureEvent> ring; ///< The queued messages.
+    std::atomic<bool> recording; ///< true between start and stop.
+    std::atomic<int> dropped; ///< Messages which did not fit into the ring.
+    std::atomic<int64_t> written; ///< Messages written to the temporary files.
+
+    std::thread writerThread; ///< The background thread.
+    std::atomic<bool> stopWriter; ///< Is set to true, when the background thread shall end.
+    std::mutex writerMutex; ///< Lets the background thread wait.
+    std::condition_variable wakeUp; ///< Wakes the background thread to end it.
+};
+}
+
+#endif
@@ -0,0 +1,175 @@
+#include "TempoFollower.h"
+
+#include <cmath>
+#include <algorithm>
+
+using namespace ttmm;
+
+const double TempoFollower::HIT_DEVIATION = 0.04;
+const double TempoFollower::PHASE_NOISE = 0.01;
+const double TempoFollower::PERIOD_NOISE = 0.008;
+const double TempoFollower::INITIAL_PERIOD_DEVIATION = 0.1;
+const double TempoFollower::GATE = 3.0;
+const double TempoFollower::MIN_PERIOD = 0.2;
+const double TempoFollower::MAX_PERIOD = 2.0;
+
+TempoFollower::TempoFollower()
+{
+    reset();
+}
+
+void TempoFollower::reset()
+{
+    started = false;
+    updates = 0;
+    rejectedInRow = 0;
+    phase = 0.0;
+    innovation = 0.0;
+    covariance[0][0] = covariance[0][1] = covariance[1][0] = covariance[1][1] = 0.0;
+}
+
+void TempoFollower::addBeat(double time, double bpm)
+{
+    if (bpm > 0.0)
+    {
+        metronomeBeat = time;
+        metronomePeriod = 60.0 / bpm;
+        hasMetronome = true;
+    }
+}
+
+// Kalman-Filter mit dem Zustand (Zeit des letzten Schlags, Schlaglaenge),
+// jeder Schlag des Musikers ist ein Schritt, das Ereignis misst die Zeit des Schlags
+bool TempoFollower::addHit(double time)
+{
+    if (time <= lastHit)
+    {
+        return false;
+    }
+    lastHit = time;
+    if (!started)
+    {
+        restart(time);
+        return true;
+    }
+
+    // the event belongs to the closest beat of the musician, a second event on the same beat is skipped
+    double beats = std::floor((time - beatTime) / period + 0.5);
+    if (beats < 1.0)
+    {
+        return false;
+    }
+    if (beats > MAX_GAP_BEATS)
+    {
+        restart(time);
+        return true;
+    }
+
+    // predict the beat: the beat time moves by the beat length, both drift with every beat
+    double p00 = covariance[0][0] + beats * (covariance[0][1] + covariance[1][0]) + beats * beats * covariance[1][1]
+        + beats * PHASE_NOISE * PHASE_NOISE;
+    double p01 = covariance[0][1] + beats * covariance[1][1];
+    double p11 = covariance[1][1] + beats * PERIOD_NOISE * PERIOD_NOISE;
+    double predicted = beatTime + beats * period;
+
+    double residual = time - predicted;
+    double variance = p00 + HIT_DEVIATION * HIT_DEVIATION;
+    if (residual * residual > GATE * GATE * variance)
+    {
+        rejected++;
+        if (++rejectedInRow >= MAX_REJECTED)
+        {
+            // the musician changed their tempo, the rejected events give the new beat length
+            restart(time);
+            return true;
+        }
+        lastRejected = time;
+        return false;
+    }
+
+    double gainTime = p00 / variance;
+    double gainPeriod = p01 / variance;
+    beatTime = predicted + gainTime * residual;
+    period = std::min(std::max(period + gainPeriod * residual, MIN_PERIOD), MAX_PERIOD);
+    covariance[0][0] = (1.0 - gainTime) * p00;
+    covariance[0][1] = covariance[1][0] = (1.0 - gainTime) * p01;
+    covariance[1][1] = p11 - gainPeriod * p01;
+    innovation = residual;
+    rejectedInRow = 0;
+    updates++;
+    updatePhase();
+    return true;
+}
+
+void TempoFollower::restart(double time)
+{
+    if (started)
+    {
+        restarts++;
+    }
+    started = true;
+    beatTime = time;
+    period = metronomePeriod;
+    if (rejectedInRow > 0 && time - lastRejected >= MIN_PERIOD && time - lastRejected <= MAX_PERIOD)
+    {
+        period = time - lastRejected;
+    }
+    covariance[0][0] = HIT_DEVIATION * HIT_DEVIATION;
+    covariance[0][1] = covariance[1][0] = 0.0;
+    covariance[1][1] = INITIAL_PERIOD_DEVIATION * INITIAL_PERIOD_DEVIATION;
+    innovation = 0.0;
+    rejectedInRow = 0;
+    updates = 1;
+    updatePhase();
+}
+
+void TempoFollower::updatePhase()
+{
+    if (!hasMetronome)
+    {
+        phase = 0.0;
+        return;
+    }
+    double position = (beatTime - metronomeBeat) / metronomePeriod;
+    phase = position - std::floor(position + 0.5);
+}
+
+bool TempoFollower::hasEstimate() const
+{
+    return started && updates >= MIN_UPDATES;
+}
+
+double TempoFollower::getTempo() const
+{
+    return 60.0 / period;
+}
+
+double TempoFollower::getPhase() const
+{
+    return phase;
+}
+
+double TempoFollower::getTempoDeviation() const
+{
+    return 60.0 / (period * period) * std::sqrt(std::max(covariance[1][1], 0.0));
+}
+
+double TempoFollower::getLastInnovation() const
+{
+    return innovation;
+}
+
+int TempoFollower::getUpdates() const
+{
+    return updates;
+}
+
+int TempoFollower::getRejected() const
+{
+    return rejected;
+}
+
+int TempoFollower::getRestarts() const
+{
+    return restarts;
+}
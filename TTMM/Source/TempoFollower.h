@@ -0,0 +1,135 @@
+/**
+ * @file TempoFollower.h
+ * @author FH-Minden Musikinformatik 2015, Musicgroup (Marcel, Patrick, Scott)
+ * @brief Declaration of @code TempoFollower
+ */
+
+#ifndef TTMM_TEMPO_FOLLOWER_H
+#define TTMM_TEMPO_FOLLOWER_H
+
+namespace ttmm
+{
+
+/**
+ * @class TempoFollower
+ * @brief Estimates the tempo and the phase a musician plays in from the times of their events.
+ *
+ * The musician is modelled as a clock of their own: the time of the last beat and the length
+ * of the beats of the musician. A Kalman filter updates both with every event in O(1); the
+ * event is assigned to the beat of the musician closest to it. Events far off the expected
+ * beat are rejected, after @code MAX_REJECTED rejections in a row the filter starts again, so
+ * a sudden change of the tempo is followed as well.
+ * The metronome only gives the start value of the beat length and the grid the phase is
+ * measured against, so the estimate does not depend on the tempo it is used to steer.
+ * All times are in seconds, so the follower can be driven by an offline simulation.
+ */
+class TempoFollower
+{
+public:
+    static const int MAX_REJECTED = 3; ///< Rejected events in a row after which the filter starts again.
+    static const int MAX_GAP_BEATS = 8; ///< A longer pause between two events starts the filter again.
+    static const int MIN_UPDATES = 4; ///< Accepted events until the estimate is used.
+
+    TempoFollower();
+
+    /**
+     * Forget the musician, the next event starts the filter again.
+     */
+    void reset();
+
+    /**
+     * Take a beat of the metronome as reference.
+     * @param time Time of the click in seconds.
+     * @param bpm Tempo of the metronome.
+     */
+    void addBeat(double time, double bpm);
+
+    /**
+     * Update the estimate with an event of the musician. Events at or before the last one
+     * are ignored, so the latest event can be passed repeatedly.
+     * @param time Time of the event in seconds.
+     * @return true if the event was accepted.
+     */
+    bool addHit(double time);
+
+    /**
+     * @return true if enough events were accepted for a stable estimate.
+     */
+    bool hasEstimate() const;
+
+    /**
+     * @return The tempo the musician plays in, in beats per minute.
+     */
+    double getTempo() const;
+
+    /**
+     * @return The beat of the musician relative to the metronome in beats, between -0.5 and 0.5.
+     *         Positive if the musician is late.
+     */
+    double getPhase() const;
+
+    /**
+     * @return The standard deviation of the estimated tempo in beats per minute.
+     */
+    double getTempoDeviation() const;
+
+    /**
+     * @return The difference between the last event and its expected time in seconds.
+     */
+    double getLastInnovation() const;
+
+    /**
+     * @return Number of accepted events since the filter started.
+     */
+    int getUpdates() const;
+
+    /**
+     * @return Number of rejected events since the object was created.
+     */
+    int getRejected() const;
+
+    /**
+     * @return Number of times the filter started again since the object was created.
+     */
+    int getRestarts() const;
+
+private:
+    static const double HIT_DEVIATION; ///< Spread of the events around the beat in seconds.
+    static const double PHASE_NOISE; ///< Change of the beat time per beat in seconds.
+    static const double PERIOD_NOISE; ///< Change of the beat length per beat in seconds.
+    static const double INITIAL_PERIOD_DEVIATION; ///< Uncertainty of the beat length of the metronome.
+    static const double GATE; ///< Events further off than this many standard deviations are rejected.
+    static const double MIN_PERIOD; ///< Shortest beat length, 300 bpm.
+    static const double MAX_PERIOD; ///< Longest beat length, 30 bpm.
+
+    /**
+     * Start the filter at an event with the beat length of the metronome.
+     * @param time Time of the event in seconds.
+     */
+    void restart(double time);
+
+    /**
+     * Measure the last beat of the musician against the beat grid of the metronome.
+     */
+    void updatePhase();
+
+    bool started = false; ///< Whether an event started the filter.
+    double beatTime = 0.0; ///< Estimated time of the last beat of the musician.
+    double period = 0.5; ///< Estimated length of a beat of the musician.
+    double covariance[2][2]; ///< Covariance of beatTime and period.
+    double lastHit = -1.0; ///< Time of the last event passed to addHit.
+    double lastRejected = 0.0; ///< Time of the last rejected event.
+    double phase = 0.0; ///< Last beat of the musician relative to the metronome.
+    double innovation = 0.0; ///< Difference of the last event to its expected time.
+    int updates = 0; ///< Accepted events since the last restart.
+    int rejectedInRow = 0; ///< Rejected events since the last accepted one.
+    int rejected = 0; ///< All rejected events.
+    int restarts = 0; ///< All restarts.
+
+    bool hasMetronome = false; ///< Whether a beat of the metronome was received.
+    double metronomeBeat = 0.0; ///< Time of the last click of the metronome.
+    double metronomePeriod = 0.5; ///< Length of a beat of the metronome.
+};
+}
+
+#endif
@@ -22,8 +22,8 @@ namespace std {
      * @return The minimum of @code seconds and @code dur1, expressed in units of @code Dur.
      */
     template<typename Dur>
-    typename Dur min(std::chrono::duration<double> const& seconds, typename Dur const & dur1) {
-        return std::min(dur1, duration_cast<Dur>(seconds));
+    Dur min(std::chrono::duration<double> const& seconds, Dur const & dur1) {
+        return std::min(dur1, std::chrono::duration_cast<Dur>(seconds));
     }
 
 }
@@ -209,7 +209,7 @@ public:
   * Time passed since @code timeZero in units of @code Clock
   */
   typename Clock::time_point now() const {
-      return Clock::time_point(Clock::now() - timeZero);
+      return typename Clock::time_point(Clock::now() - timeZero);
   }
 
   /**
@@ -248,11 +248,11 @@ public:
    * @param[in] timestamp The timepoint
    * @return The timestamp represented in ms.
    */
-  const double ms(typename Clock::time_point const &timestamp) const {
+  double ms(typename Clock::time_point const &timestamp) const {
       return static_cast<double>(duration_cast<milliseconds>(timestamp.time_since_epoch()).count());
   }
 
-  const double ns(typename Clock::time_point const &timestamp) const {
+  double ns(typename Clock::time_point const &timestamp) const {
       return static_cast<double>(duration_cast<nanoseconds>(timestamp.time_since_epoch()).count());
   }
   /**
@@ -261,7 +261,7 @@ public:
   * @param[in] timestamp The reference timepoint
   * @return The milliseconds passed from @code timeZero until @code timestamp.
   */
-  const double ms() const { return ms(now()); }
+  double ms() const { return ms(now()); }
 
   /**
    * Access the singleton instance in constant context.